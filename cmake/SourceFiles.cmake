@@ -46,17 +46,31 @@ set(HOST_SOURCES
     host/HostManager.cpp host/HostManager.h
     host/audiomanager.cpp host/audiomanager.h
     host/audiothread.cpp host/audiothread.h
+    host/audiocapturetap.cpp host/audiocapturetap.h
     host/cameramanager.cpp host/cameramanager.h
     host/usbcontrol.cpp host/usbcontrol.h
     host/multimediabackend.cpp host/multimediabackend.h
     host/imagecapturer.cpp host/imagecapturer.h
+    host/framebus.cpp host/framebus.h
+    host/framelatency.cpp host/framelatency.h
+    host/presentationqueue.cpp host/presentationqueue.h
+    host/frametiming.cpp host/frametiming.h
+    host/recordingsegmenter.cpp host/recordingsegmenter.h
     host/backend/ffmpegbackendhandler.cpp host/backend/ffmpegbackendhandler.h
     host/backend/qtmultimediabackendhandler.cpp host/backend/qtmultimediabackendhandler.h
     host/backend/qtbackendhandler.cpp host/backend/qtbackendhandler.h
     host/backend/ffmpeg/capturethread.cpp host/backend/ffmpeg/capturethread.h
     host/backend/ffmpeg/ffmpeg_hardware_accelerator.cpp host/backend/ffmpeg/ffmpeg_hardware_accelerator.h
     host/backend/ffmpeg/ffmpeg_device_manager.cpp host/backend/ffmpeg/ffmpeg_device_manager.h
+    host/backend/ffmpeg/ffmpeg_replay_source.cpp host/backend/ffmpeg/ffmpeg_replay_source.h
     host/backend/ffmpeg/ffmpeg_frame_processor.cpp host/backend/ffmpeg/ffmpeg_frame_processor.h
+    host/backend/ffmpeg/ffmpeg_frame_pool.cpp host/backend/ffmpeg/ffmpeg_frame_pool.h
+    host/backend/ffmpeg/ffmpeg_decode_governor.cpp host/backend/ffmpeg/ffmpeg_decode_governor.h
+    host/backend/ffmpeg/ffmpeg_pixel_converter.cpp host/backend/ffmpeg/ffmpeg_pixel_converter.h
+    host/backend/ffmpeg/ffmpeg_frame_diff.cpp host/backend/ffmpeg/ffmpeg_frame_diff.h
+    host/backend/ffmpeg/ffmpeg_decode_pipeline.cpp host/backend/ffmpeg/ffmpeg_decode_pipeline.h
+    host/backend/ffmpeg/ffmpeg_restart_decoder.cpp host/backend/ffmpeg/ffmpeg_restart_decoder.h
+    host/backend/ffmpeg/ffmpeg_capability_cache.cpp host/backend/ffmpeg/ffmpeg_capability_cache.h
     host/backend/ffmpeg/ffmpeg_recorder.cpp host/backend/ffmpeg/ffmpeg_recorder.h
     host/backend/ffmpeg/ffmpeg_device_validator.cpp host/backend/ffmpeg/ffmpeg_device_validator.h
     host/backend/ffmpeg/ffmpeg_hotplug_handler.cpp host/backend/ffmpeg/ffmpeg_hotplug_handler.h
@@ -202,6 +216,7 @@ set(UI_CORE_SOURCES
     ui/loghandler.cpp ui/loghandler.h
     ui/mainwindow.cpp ui/mainwindow.h ui/mainwindow.ui
     ui/videopane.cpp ui/videopane.h
+    ui/glvideoitem.cpp ui/glvideoitem.h
     ui/languagemanager.cpp ui/languagemanager.h
     ui/screensavermanager.cpp ui/screensavermanager.h
     ui/screenscale.h ui/screenscale.cpp
@@ -257,6 +272,7 @@ set(WCH_SOURCES
 # UI initializer sources
 set(UI_INITIALIZER_SOURCES
     ui/initializer/mainwindowinitializer.cpp ui/initializer/mainwindowinitializer.h
+    ui/initializer/startuptaskgraph.cpp ui/initializer/startuptaskgraph.h
 )
 
 # UI statusbar sources
@@ -318,6 +334,7 @@ set(UI_PREFERENCES_SOURCES
 set(LOG_SOURCES
     log/logcategoryregistry.cpp log/logcategoryregistry.h
     log/opflogging.h
+    log/startuptrace.cpp log/startuptrace.h
 )
 
 # Combine all source files
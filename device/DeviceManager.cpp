@@ -15,6 +15,7 @@
 #include <QtSerialPort/QSerialPortInfo>
 #include <algorithm>
 #include "log/opflogging.h"
+#include "log/startuptrace.h"
 
 OPF_LOGGING_CATEGORY(log_device_manager, "opf.device.manager")
 
@@ -73,6 +74,7 @@ void DeviceManager::initializePlatformManager()
 
 QList<DeviceInfo> DeviceManager::discoverDevices()
 {
+    OPF_STARTUP_SPAN("DeviceManager::discoverDevices", "device");
     QMutexLocker locker(&m_mutex);
     
     if (!m_platformManager) {
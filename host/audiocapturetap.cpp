@@ -0,0 +1,151 @@
+#include "audiocapturetap.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QThread>
+#include <cstring>
+
+#include "log/opflogging.h"
+OPF_LOGGING_CATEGORY(log_audio_capture_tap, "opf.host.audiocapturetap")
+
+int AudioCaptureFormat::bytesPerSample() const
+{
+    switch (sampleFormat) {
+    case UInt8: return 1;
+    case Int16: return 2;
+    case Int32: return 4;
+    case Float: return 4;
+    default: return 0;
+    }
+}
+
+AudioRingBuffer::AudioRingBuffer(size_t capacity)
+{
+    size_t size = 1024;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    m_buffer.resize(size);
+    m_mask = size - 1;
+}
+
+bool AudioRingBuffer::push(const char* data, qint64 bytes, qint64 captureNs)
+{
+    if (bytes <= 0) {
+        return true;
+    }
+    const quint64 head = m_head.load(std::memory_order_relaxed);
+    const quint64 tail = m_tail.load(std::memory_order_acquire);
+    const quint64 needed = sizeof(ChunkHeader) + static_cast<quint64>(bytes);
+    if (needed > m_buffer.size() - (head - tail)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const ChunkHeader header{captureNs, bytes};
+    copyIn(head, &header, sizeof(header));
+    copyIn(head + sizeof(header), data, static_cast<size_t>(bytes));
+    m_head.store(head + needed, std::memory_order_release);
+    return true;
+}
+
+bool AudioRingBuffer::pop(QByteArray* data, qint64* captureNs)
+{
+    const quint64 tail = m_tail.load(std::memory_order_relaxed);
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+
+    ChunkHeader header;
+    copyOut(tail, &header, sizeof(header));
+    data->resize(static_cast<qsizetype>(header.bytes));
+    copyOut(tail + sizeof(header), data->data(), static_cast<size_t>(header.bytes));
+    *captureNs = header.captureNs;
+    m_tail.store(tail + sizeof(header) + static_cast<quint64>(header.bytes), std::memory_order_release);
+    return true;
+}
+
+void AudioRingBuffer::copyIn(quint64 position, const void* data, size_t bytes)
+{
+    const size_t offset = static_cast<size_t>(position) & m_mask;
+    const size_t first = qMin(bytes, m_buffer.size() - offset);
+    std::memcpy(m_buffer.data() + offset, data, first);
+    std::memcpy(m_buffer.data(), static_cast<const char*>(data) + first, bytes - first);
+}
+
+void AudioRingBuffer::copyOut(quint64 position, void* data, size_t bytes) const
+{
+    const size_t offset = static_cast<size_t>(position) & m_mask;
+    const size_t first = qMin(bytes, m_buffer.size() - offset);
+    std::memcpy(data, m_buffer.data() + offset, first);
+    std::memcpy(static_cast<char*>(data) + first, m_buffer.data(), bytes - first);
+}
+
+AudioCaptureTap& AudioCaptureTap::instance()
+{
+    static AudioCaptureTap tap;
+    return tap;
+}
+
+qint64 AudioCaptureTap::now()
+{
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed();
+}
+
+void AudioCaptureTap::setFormat(const AudioCaptureFormat& format)
+{
+    QMutexLocker locker(&m_mutex);
+    m_format = format;
+    qCDebug(log_audio_capture_tap) << "Capture format" << format.sampleRate << "Hz"
+                                   << format.channels << "ch, sample format" << format.sampleFormat;
+}
+
+AudioCaptureFormat AudioCaptureTap::format() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_format;
+}
+
+void AudioCaptureTap::publish(const char* data, qint64 bytes, qint64 captureNs)
+{
+    // Announce the publisher before looking at the ring, so detach() either
+    // sees it or this call sees no ring
+    m_publishers.fetch_add(1);
+    if (AudioRingBuffer* ring = m_ring.load()) {
+        ring->push(data, bytes, captureNs < 0 ? now() : captureNs);
+    }
+    m_publishers.fetch_sub(1);
+}
+
+AudioRingBuffer* AudioCaptureTap::attach(size_t capacityBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_owned) {
+        qCWarning(log_audio_capture_tap) << "Audio capture tap already attached, replacing ring";
+    }
+    std::unique_ptr<AudioRingBuffer> previous = std::move(m_owned);
+    m_owned = std::make_unique<AudioRingBuffer>(capacityBytes);
+    m_ring.store(m_owned.get());
+    while (m_publishers.load() > 0) {
+        QThread::yieldCurrentThread();
+    }
+    return m_owned.get();
+}
+
+void AudioCaptureTap::detach()
+{
+    QMutexLocker locker(&m_mutex);
+    m_ring.store(nullptr);
+    while (m_publishers.load() > 0) {
+        QThread::yieldCurrentThread();
+    }
+    if (m_owned) {
+        qCDebug(log_audio_capture_tap) << "Audio capture tap detached, dropped chunks:" << m_owned->droppedChunks();
+    }
+    m_owned.reset();
+}
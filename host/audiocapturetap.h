@@ -0,0 +1,98 @@
+#ifndef AUDIOCAPTURETAP_H
+#define AUDIOCAPTURETAP_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Layout of the PCM the audio thread captures: interleaved, native endian.
+struct AudioCaptureFormat {
+    enum SampleFormat { Unknown, UInt8, Int16, Int32, Float };
+
+    int sampleRate = 0;
+    int channels = 0;
+    SampleFormat sampleFormat = Unknown;
+
+    bool isValid() const { return sampleRate > 0 && channels > 0 && sampleFormat != Unknown; }
+    int bytesPerSample() const;
+    int bytesPerFrame() const { return bytesPerSample() * channels; }
+};
+
+// Single-producer, single-consumer ring of PCM chunks, each stamped with
+// the monotonic time its last sample was captured.
+//
+// Neither side takes a lock or allocates on push, so the audio thread never
+// waits on the recorder. A chunk that does not fit is dropped whole and
+// counted; the consumer sees the gap in the timestamps and fills it.
+class AudioRingBuffer
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit AudioRingBuffer(size_t capacity);
+
+    // Producer only. False when the chunk did not fit and was dropped.
+    bool push(const char* data, qint64 bytes, qint64 captureNs);
+
+    // Consumer only. False when the ring is empty.
+    bool pop(QByteArray* data, qint64* captureNs);
+
+    size_t capacity() const { return m_buffer.size(); }
+    quint64 droppedChunks() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct ChunkHeader {
+        qint64 captureNs;
+        qint64 bytes;
+    };
+
+    void copyIn(quint64 position, const void* data, size_t bytes);
+    void copyOut(quint64 position, void* data, size_t bytes) const;
+
+    std::vector<char> m_buffer;
+    size_t m_mask;
+    std::atomic<quint64> m_head{0};      // Written by the producer
+    std::atomic<quint64> m_tail{0};      // Written by the consumer
+    std::atomic<quint64> m_dropped{0};
+};
+
+// Hands the PCM that AudioThread reads from the capture device to a recorder.
+//
+// AudioThread publishes every buffer it reads; while nothing is attached
+// that is one atomic load. A recorder attaches a ring for the length of a
+// recording and drains it on its own thread. Capture timestamps come from
+// now(), the clock the recorder also stamps video frames with, so the two
+// tracks can be lined up without trusting either device's clock.
+class AudioCaptureTap
+{
+public:
+    static AudioCaptureTap& instance();
+
+    // Monotonic clock shared by audio and video timestamps, in nanoseconds
+    static qint64 now();
+
+    // Audio thread: what publish() delivers; an invalid format means no capture
+    void setFormat(const AudioCaptureFormat& format);
+    AudioCaptureFormat format() const;
+
+    // Audio thread, lock-free. captureNs < 0 means now().
+    void publish(const char* data, qint64 bytes, qint64 captureNs = -1);
+
+    // Recorder: starts buffering into a new ring and returns it. The ring
+    // stays valid until detach(), which waits for a publish() in progress.
+    AudioRingBuffer* attach(size_t capacityBytes);
+    void detach();
+    bool isAttached() const { return m_ring.load() != nullptr; }
+
+private:
+    AudioCaptureTap() = default;
+
+    mutable QMutex m_mutex;            // Format, and attach/detach
+    AudioCaptureFormat m_format;
+    std::unique_ptr<AudioRingBuffer> m_owned;
+    std::atomic<AudioRingBuffer*> m_ring{nullptr};
+    std::atomic<int> m_publishers{0};
+};
+
+#endif // AUDIOCAPTURETAP_H
@@ -1,4 +1,5 @@
 #include "audiothread.h"
+#include "audiocapturetap.h"
 #include "../global.h"
 #include <QDebug>
 #include <QLoggingCategory>
@@ -6,6 +7,21 @@
 
 OPF_LOGGING_CATEGORY(log_core_audio, "opf.core.audio")
 
+static AudioCaptureFormat captureFormatFor(const QAudioFormat& format)
+{
+    AudioCaptureFormat capture;
+    capture.sampleRate = format.sampleRate();
+    capture.channels = format.channelCount();
+    switch (format.sampleFormat()) {
+    case QAudioFormat::UInt8: capture.sampleFormat = AudioCaptureFormat::UInt8; break;
+    case QAudioFormat::Int16: capture.sampleFormat = AudioCaptureFormat::Int16; break;
+    case QAudioFormat::Int32: capture.sampleFormat = AudioCaptureFormat::Int32; break;
+    case QAudioFormat::Float: capture.sampleFormat = AudioCaptureFormat::Float; break;
+    default: capture.sampleFormat = AudioCaptureFormat::Unknown; break;
+    }
+    return capture;
+}
+
 AudioThread::AudioThread(const QAudioDevice& inputDevice, 
                        const QAudioDevice& outputDevice,
                        const QAudioFormat& format,
@@ -286,6 +302,10 @@ void AudioThread::run()
         
         qCDebug(log_core_audio) << "Audio sink started successfully, state:" << m_audioSink->state();
 
+        // Recordings pick the captured audio up from here
+        AudioCaptureTap& captureTap = AudioCaptureTap::instance();
+        captureTap.setFormat(captureFormatFor(m_audioSource->format()));
+
         // Buffer for audio data
         const int bufferSize = 4096;  // Adjust buffer size based on your needs
         char buffer[bufferSize];
@@ -373,6 +393,7 @@ void AudioThread::run()
                     // Log any successful reads
                     if (bytesRead > 0) {
                         // qCDebug(log_core_audio) << "Audio data: read" << bytesRead << "bytes from" << bytesAvailable << "available";
+                        captureTap.publish(buffer, bytesRead);
                         
                         // Double-check we haven't started cleanup between reads
                         m_mutex.lock();
@@ -407,6 +428,7 @@ void AudioThread::run()
         }
 
         qCDebug(log_core_audio) << "Exited main audio processing loop";
+        captureTap.setFormat(AudioCaptureFormat());
 
         // Mark cleanup as started to prevent any further access to IO devices
         m_mutex.lock();
@@ -6,6 +6,7 @@
 #include <QPointer>
 #include "../ffmpegbackendhandler.h"
 #include "ffmpeg_capture_manager.h"
+#include "../../frametiming.h"
 
 #include <QDebug>
 #include <QTimer>
@@ -66,6 +67,7 @@ void CaptureThread::run()
             // Process frame directly in capture thread to avoid packet invalidation
             // This ensures packet data remains valid during processing
             // Notify main handler that a frame is available for processing
+            FrameTimingRecorder::instance().recordCapture();
             emit frameAvailable();
             framesProcessed++;
 
@@ -0,0 +1,444 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+#include "ffmpeg_capability_cache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <functional>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cmath>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+#endif
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+namespace {
+
+constexpr const char* kFileName = "capture_capabilities.json";
+
+QJsonObject ModeToJson(const FFmpegCapabilityCache::Mode& mode)
+{
+    QJsonArray rates;
+    for (int rate : mode.framerates) {
+        rates.append(rate);
+    }
+    QJsonObject object;
+    object["format"] = mode.pixel_format;
+    object["width"] = mode.resolution.width();
+    object["height"] = mode.resolution.height();
+    object["framerates"] = rates;
+    return object;
+}
+
+FFmpegCapabilityCache::Mode ModeFromJson(const QJsonObject& object)
+{
+    FFmpegCapabilityCache::Mode mode;
+    mode.pixel_format = object["format"].toString();
+    mode.resolution = QSize(object["width"].toInt(), object["height"].toInt());
+    for (const QJsonValue& rate : object["framerates"].toArray()) {
+        mode.framerates.append(rate.toInt());
+    }
+    return mode;
+}
+
+QJsonObject EntryToJson(const FFmpegCapabilityCache::Entry& entry)
+{
+    QJsonArray modes;
+    for (const FFmpegCapabilityCache::Mode& mode : entry.modes) {
+        modes.append(ModeToJson(mode));
+    }
+    QJsonObject object;
+    object["key"] = entry.key;
+    object["devicePath"] = entry.device_path;
+    object["inputFormat"] = entry.input_format;
+    object["width"] = entry.open_resolution.width();
+    object["height"] = entry.open_resolution.height();
+    object["framerate"] = entry.open_framerate;
+    object["modes"] = modes;
+    if (entry.validated.isValid()) {
+        object["validated"] = entry.validated.toString(Qt::ISODate);
+    }
+    object["coldFirstFrameMs"] = entry.cold_first_frame_ms;
+    object["warmFirstFrameMs"] = entry.warm_first_frame_ms;
+    return object;
+}
+
+FFmpegCapabilityCache::Entry EntryFromJson(const QJsonObject& object)
+{
+    FFmpegCapabilityCache::Entry entry;
+    entry.key = object["key"].toString();
+    entry.device_path = object["devicePath"].toString();
+    entry.input_format = object["inputFormat"].toString();
+    entry.open_resolution = QSize(object["width"].toInt(), object["height"].toInt());
+    entry.open_framerate = object["framerate"].toInt();
+    for (const QJsonValue& mode : object["modes"].toArray()) {
+        entry.modes.append(ModeFromJson(mode.toObject()));
+    }
+    entry.validated = QDateTime::fromString(object["validated"].toString(), Qt::ISODate);
+    entry.cold_first_frame_ms = object["coldFirstFrameMs"].toInteger(-1);
+    entry.warm_first_frame_ms = object["warmFirstFrameMs"].toInteger(-1);
+    return entry;
+}
+
+bool ModeMatches(const FFmpegCapabilityCache::Mode& mode, const QSize& resolution, int framerate)
+{
+    if (mode.resolution != resolution) {
+        return false;
+    }
+    return framerate <= 0 || mode.framerates.isEmpty() || mode.framerates.contains(framerate);
+}
+
+bool SameModes(const QList<FFmpegCapabilityCache::Mode>& a, const QList<FFmpegCapabilityCache::Mode>& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (int i = 0; i < a.size(); ++i) {
+        if (a[i].pixel_format != b[i].pixel_format || a[i].resolution != b[i].resolution
+            || a[i].framerates != b[i].framerates) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef Q_OS_LINUX
+int RetryIoctl(int fd, unsigned long request, void* arg)
+{
+    int ret;
+    do {
+        ret = ioctl(fd, request, arg);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+// FFmpeg input_format name for a V4L2 fourcc; empty for formats the capture
+// path never asks for
+QString FormatName(quint32 fourcc)
+{
+    switch (fourcc) {
+    case V4L2_PIX_FMT_MJPEG: return QStringLiteral("mjpeg");
+    case V4L2_PIX_FMT_YUYV:  return QStringLiteral("yuyv422");
+    case V4L2_PIX_FMT_NV12:  return QStringLiteral("nv12");
+    case V4L2_PIX_FMT_H264:  return QStringLiteral("h264");
+    default:                 return QString();
+    }
+}
+
+int IntervalToRate(const v4l2_fract& interval)
+{
+    return interval.numerator > 0
+        ? static_cast<int>(std::lround(static_cast<double>(interval.denominator) / interval.numerator))
+        : 0;
+}
+
+QList<int> EnumerateRates(int fd, quint32 fourcc, const QSize& size)
+{
+    QList<int> rates;
+    v4l2_frmivalenum interval = {};
+    interval.pixel_format = fourcc;
+    interval.width = static_cast<quint32>(size.width());
+    interval.height = static_cast<quint32>(size.height());
+    for (interval.index = 0; RetryIoctl(fd, VIDIOC_ENUM_FRAMEINTERVALS, &interval) == 0; ++interval.index) {
+        // Stepwise ranges are rare on UVC; the shortest interval is the one that matters
+        const int rate = IntervalToRate(interval.type == V4L2_FRMIVAL_TYPE_DISCRETE
+                                            ? interval.discrete : interval.stepwise.min);
+        if (rate > 0 && !rates.contains(rate)) {
+            rates.append(rate);
+        }
+        if (interval.type != V4L2_FRMIVAL_TYPE_DISCRETE) {
+            break;
+        }
+    }
+    std::sort(rates.begin(), rates.end(), std::greater<int>());
+    return rates;
+}
+#endif
+
+}  // namespace
+
+FFmpegCapabilityCache& FFmpegCapabilityCache::Instance()
+{
+    static FFmpegCapabilityCache instance(DefaultPath());
+    return instance;
+}
+
+QString FFmpegCapabilityCache::DefaultPath()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation))
+        .filePath(QLatin1String(kFileName));
+}
+
+QString FFmpegCapabilityCache::MakeKey(const QString& vid, const QString& pid, const QString& port_chain)
+{
+    auto field = [](const QString& value) {
+        const QString trimmed = value.trimmed();
+        return trimmed.isEmpty() ? QStringLiteral("unknown") : trimmed;
+    };
+    return QStringLiteral("%1:%2|%3").arg(field(vid).toLower(), field(pid).toLower(), field(port_chain));
+}
+
+FFmpegCapabilityCache::FFmpegCapabilityCache(const QString& path)
+    : path_(path)
+    , loaded_(false)
+{
+}
+
+bool FFmpegCapabilityCache::Lookup(const QString& key, Entry* entry) const
+{
+    QMutexLocker locker(&mutex_);
+    LoadLocked();
+    auto it = entries_.constFind(key);
+    if (it == entries_.constEnd()) {
+        return false;
+    }
+    if (entry) {
+        *entry = it.value();
+    }
+    return true;
+}
+
+void FFmpegCapabilityCache::Store(const Entry& entry)
+{
+    if (entry.key.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&mutex_);
+    LoadLocked();
+    entries_.insert(entry.key, entry);
+    SaveLocked();
+}
+
+void FFmpegCapabilityCache::Invalidate(const QString& key)
+{
+    QMutexLocker locker(&mutex_);
+    LoadLocked();
+    if (entries_.remove(key) > 0) {
+        qCInfo(log_ffmpeg_backend) << "Capability cache: dropped entry" << key;
+        SaveLocked();
+    }
+}
+
+bool FFmpegCapabilityCache::HasEntryForPath(const QString& device_path) const
+{
+    QMutexLocker locker(&mutex_);
+    LoadLocked();
+    for (const Entry& entry : entries_) {
+        if (entry.device_path == device_path) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FFmpegCapabilityCache::Supports(const Entry& entry, const QSize& resolution, int framerate)
+{
+    if (entry.modes.isEmpty()) {
+        return entry.open_resolution == resolution
+            && (framerate <= 0 || entry.open_framerate == framerate);
+    }
+    for (const Mode& mode : entry.modes) {
+        if ((entry.input_format.isEmpty() || mode.pixel_format == entry.input_format)
+            && ModeMatches(mode, resolution, framerate)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QString FFmpegCapabilityCache::ChooseFormat(const Entry& entry, const QSize& resolution, int framerate)
+{
+    if (Supports(entry, resolution, framerate)) {
+        return entry.input_format;
+    }
+    for (const Mode& mode : entry.modes) {
+        if (ModeMatches(mode, resolution, framerate)) {
+            return mode.pixel_format;
+        }
+    }
+    return QString();
+}
+
+void FFmpegCapabilityCache::RecordOpen(const QString& key, const QString& device_path,
+                                       const QString& input_format, const QSize& resolution, int framerate)
+{
+    if (key.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&mutex_);
+    LoadLocked();
+    Entry& entry = entries_[key];
+    if (entry.key == key && entry.device_path == device_path && entry.input_format == input_format
+        && entry.open_resolution == resolution && entry.open_framerate == framerate) {
+        return;
+    }
+    entry.key = key;
+    entry.device_path = device_path;
+    entry.input_format = input_format;
+    entry.open_resolution = resolution;
+    entry.open_framerate = framerate;
+    qCInfo(log_ffmpeg_backend) << "Capability cache: recorded" << key << device_path
+                               << (input_format.isEmpty() ? QStringLiteral("auto") : input_format)
+                               << resolution << "@" << framerate << "fps";
+    SaveLocked();
+}
+
+bool FFmpegCapabilityCache::UpdateModes(const QString& key, const QList<Mode>& modes)
+{
+    if (key.isEmpty()) {
+        return false;
+    }
+    QMutexLocker locker(&mutex_);
+    LoadLocked();
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return false;
+    }
+    const bool changed = !SameModes(it->modes, modes);
+    it->modes = modes;
+    it->validated = QDateTime::currentDateTimeUtc();
+    SaveLocked();
+    return changed;
+}
+
+void FFmpegCapabilityCache::RecordFirstFrame(const QString& key, bool warm, qint64 elapsed_ms)
+{
+    if (key.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&mutex_);
+    LoadLocked();
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return;
+    }
+    (warm ? it->warm_first_frame_ms : it->cold_first_frame_ms) = elapsed_ms;
+    SaveLocked();
+}
+
+bool FFmpegCapabilityCache::LoadLocked() const
+{
+    if (loaded_) {
+        return true;
+    }
+    loaded_ = true;
+
+    QFile file(path_);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        qCWarning(log_ffmpeg_backend) << "Capability cache: ignoring unreadable" << path_ << error.errorString();
+        return false;
+    }
+    const QJsonObject root = document.object();
+    if (root["version"].toInt() != kVersion) {
+        qCInfo(log_ffmpeg_backend) << "Capability cache: ignoring version" << root["version"].toInt() << "file";
+        return false;
+    }
+    for (const QJsonValue& value : root["devices"].toArray()) {
+        Entry entry = EntryFromJson(value.toObject());
+        if (!entry.key.isEmpty()) {
+            entries_.insert(entry.key, entry);
+        }
+    }
+    qCDebug(log_ffmpeg_backend) << "Capability cache: loaded" << entries_.size() << "entries from" << path_;
+    return true;
+}
+
+bool FFmpegCapabilityCache::SaveLocked() const
+{
+    QJsonArray devices;
+    for (const Entry& entry : entries_) {
+        devices.append(EntryToJson(entry));
+    }
+    QJsonObject root;
+    root["version"] = kVersion;
+    root["devices"] = devices;
+
+    QDir().mkpath(QFileInfo(path_).absolutePath());
+    QSaveFile file(path_);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(root).toJson(QJsonDocument::Indented)) < 0
+        || !file.commit()) {
+        qCWarning(log_ffmpeg_backend) << "Capability cache: failed to write" << path_ << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QList<FFmpegCapabilityCache::Mode> FFmpegCapabilityCache::EnumerateModes(const QString& device_path)
+{
+    QList<Mode> modes;
+#ifdef Q_OS_LINUX
+    const int fd = open(device_path.toLocal8Bit().constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        qCDebug(log_ffmpeg_backend) << "Capability cache: cannot open" << device_path << "for enumeration";
+        return modes;
+    }
+
+    v4l2_fmtdesc format = {};
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    for (format.index = 0; RetryIoctl(fd, VIDIOC_ENUM_FMT, &format) == 0; ++format.index) {
+        const QString name = FormatName(format.pixelformat);
+        if (name.isEmpty()) {
+            continue;
+        }
+        v4l2_frmsizeenum size = {};
+        size.pixel_format = format.pixelformat;
+        for (size.index = 0; RetryIoctl(fd, VIDIOC_ENUM_FRAMESIZES, &size) == 0; ++size.index) {
+            Mode mode;
+            mode.pixel_format = name;
+            mode.resolution = size.type == V4L2_FRMSIZE_TYPE_DISCRETE
+                ? QSize(static_cast<int>(size.discrete.width), static_cast<int>(size.discrete.height))
+                : QSize(static_cast<int>(size.stepwise.max_width), static_cast<int>(size.stepwise.max_height));
+            mode.framerates = EnumerateRates(fd, format.pixelformat, mode.resolution);
+            modes.append(mode);
+            if (size.type != V4L2_FRMSIZE_TYPE_DISCRETE) {
+                break;
+            }
+        }
+    }
+    close(fd);
+#else
+    Q_UNUSED(device_path);
+#endif
+    return modes;
+}
@@ -0,0 +1,123 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+#ifndef FFMPEG_CAPABILITY_CACHE_H
+#define FFMPEG_CAPABILITY_CACHE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+/**
+ * @brief Persistent per-device record of known-good capture parameters
+ *
+ * Opening the capture device cold costs several v4l2-ctl process spawns, a
+ * probe open by the device validator and, on some firmware, one or two
+ * failed format attempts before the working one. None of that changes
+ * between runs for the same device, so the format the device last opened
+ * with and the modes it advertises are kept in a small JSON file, keyed by
+ * VID/PID and USB port chain. A warm start opens straight into the cached
+ * format; the entry is revalidated in the background once capture is
+ * running and dropped if the cached format ever fails to open.
+ *
+ * The firmware version is not part of the key: the HID side reads it in
+ * parallel with camera startup, so it is not reliably known yet when the
+ * key is needed. A firmware update that changes the advertised modes is
+ * picked up by the revalidation.
+ *
+ * Thread-safe. Instance() is the application-wide store; tests construct
+ * their own over a temporary file.
+ */
+class FFmpegCapabilityCache {
+public:
+    static constexpr int kVersion = 2;   // 2: firmware dropped from the key
+
+    // One pixel format / frame size pair and the rates it runs at
+    struct Mode {
+        QString pixel_format;       // FFmpeg input_format name ("mjpeg", "yuyv422")
+        QSize resolution;
+        QList<int> framerates;      // Whole frames per second, descending
+    };
+
+    struct Entry {
+        QString key;
+        QString device_path;
+        QString input_format;       // Format the last open succeeded with; empty = auto-detect
+        QSize open_resolution;      // Size the device actually negotiated
+        int open_framerate = 0;
+        QList<Mode> modes;          // Enumerated modes; empty where enumeration is unsupported
+        QDateTime validated;        // Last time the modes were enumerated
+        qint64 cold_first_frame_ms = -1;
+        qint64 warm_first_frame_ms = -1;
+    };
+
+    static FFmpegCapabilityCache& Instance();
+    static QString DefaultPath();
+
+    // Key for a device; empty fields are recorded as "unknown"
+    static QString MakeKey(const QString& vid, const QString& pid, const QString& port_chain);
+
+    explicit FFmpegCapabilityCache(const QString& path);
+
+    QString GetPath() const { return path_; }
+
+    bool Lookup(const QString& key, Entry* entry) const;
+    void Store(const Entry& entry);
+    void Invalidate(const QString& key);
+
+    // True if some entry was recorded for this device node
+    bool HasEntryForPath(const QString& device_path) const;
+
+    // Whether the entry says the device can deliver resolution at framerate
+    static bool Supports(const Entry& entry, const QSize& resolution, int framerate);
+
+    // Format to request for resolution at framerate: the cached one if it
+    // supports the mode, else the first enumerated format that does, else
+    // empty (no cached knowledge)
+    static QString ChooseFormat(const Entry& entry, const QSize& resolution, int framerate);
+
+    // Capture-path updates; each writes the file only if the entry changed
+    void RecordOpen(const QString& key, const QString& device_path, const QString& input_format,
+                    const QSize& resolution, int framerate);
+    bool UpdateModes(const QString& key, const QList<Mode>& modes);
+    void RecordFirstFrame(const QString& key, bool warm, qint64 elapsed_ms);
+
+    // Lists the device's formats, sizes and rates (V4L2 only; empty elsewhere
+    // or on error). Uses its own non-blocking handle, so it can run while
+    // the device is streaming.
+    static QList<Mode> EnumerateModes(const QString& device_path);
+
+private:
+    bool LoadLocked() const;   // Reads the file once, on first use
+    bool SaveLocked() const;
+
+    const QString path_;
+    mutable QMutex mutex_;
+    mutable QHash<QString, Entry> entries_;
+    mutable bool loaded_;
+};
+
+#endif // FFMPEG_CAPABILITY_CACHE_H
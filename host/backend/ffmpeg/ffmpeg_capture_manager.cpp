@@ -25,8 +25,11 @@
 #include "ffmpeg_device_manager.h"
 #include "ffmpeg_hardware_accelerator.h"
 #include "ffmpeg_device_validator.h"
+#include "ffmpeg_replay_source.h"
 #include "global.h"
 #include "ui/globalsetting.h"
+#include "host/framelatency.h"
+#include "host/frametiming.h"
 
 #include <QThread>
 #include <QDateTime>
@@ -54,6 +57,7 @@ FFmpegCaptureManager::FFmpegCaptureManager(FFmpegDeviceManager* deviceManager,
     , hardware_accelerator_(hardwareAccelerator)
     , device_validator_(deviceValidator)
     , packet_(nullptr)
+    , packet_read_ns_(0)
     , capture_running_(false)
     , video_stream_index_(-1)
     , interrupt_requested_(false)
@@ -227,6 +231,18 @@ bool FFmpegCaptureManager::ReadFrame()
         return false;
     }
 
+    // A replayed recording is read in order, each packet held back until its
+    // recorded time; skipping "stale" packets would skip the recording itself
+    if (FFmpegReplaySource* replay = device_manager_->GetReplaySource()) {
+        av_packet_unref(AV_PACKET_RAW(packet_));
+        int ret = replay->ReadPacket(formatContext, AV_PACKET_RAW(packet_), video_stream_index_, &interrupt_requested_);
+        packet_read_ns_ = FrameLatencyTracker::now();
+        if (ret == AVERROR_EOF) {
+            qCDebug(log_ffmpeg_backend) << "Replay finished after" << replay->GetPacketsRead() << "packets";
+        }
+        return ret >= 0;
+    }
+
     // ── LIVE-EDGE SEEKING ─────────────────────────────────────────────────────
     //
     // Problem: when the decoder (especially QSV) is slower than the camera frame
@@ -274,6 +290,7 @@ bool FFmpegCaptureManager::ReadFrame()
         int ret = av_read_frame(formatContext, AV_PACKET_RAW(packet_));
 
         qint64 readMs = readTimer.elapsed();
+        packet_read_ns_ = FrameLatencyTracker::now();
 
         if (ret < 0) {
             if (ret == AVERROR(EAGAIN)) {
@@ -316,6 +333,7 @@ bool FFmpegCaptureManager::ReadFrame()
         if (readMs >= kLiveEdgeMs || attempt == kMaxDiscard) {
             // Live-edge (or fallback) frame – use it.
             if (discarded > 0) {
+                FrameTimingRecorder::instance().recordDrop(FrameTimingRecorder::LiveEdgeDiscard, discarded);
                 qCDebug(log_ffmpeg_backend) << "Live-edge seek: discarded" << discarded
                                             << "stale buffered frames (read took" << readMs << "ms)";
             }
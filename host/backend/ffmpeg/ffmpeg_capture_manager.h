@@ -86,6 +86,10 @@ public:
     AVPacket* GetPacket() { return packet_; }
 #endif
     
+    // When av_read_frame returned the packet from GetPacket(), on the
+    // FrameLatencyTracker clock
+    qint64 GetPacketReadTime() const { return packet_read_ns_; }
+    
     // Video stream info
     int GetVideoStreamIndex() const { return video_stream_index_; }
     
@@ -128,6 +132,7 @@ private:
 #else
     AVPacket* packet_;
 #endif
+    qint64 packet_read_ns_;
     
     // Capture state
     bool capture_running_;
@@ -0,0 +1,188 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+
+#include "ffmpeg_decode_governor.h"
+
+#include <QLoggingCategory>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QtGlobal>
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+namespace {
+
+// Cheapest step first: halving the decode size before touching the frame
+// rate, then trading both down together.
+constexpr FFmpegDecodeGovernor::Level kLevels[] = {
+    {1, 0},
+    {2, 0},
+    {2, 30},
+    {4, 30},
+    {4, 20},
+    {8, 15},
+};
+constexpr int kLevelCount = static_cast<int>(sizeof(kLevels) / sizeof(kLevels[0]));
+
+// Upper bound on the step-up back-off, in windows
+constexpr int kMaxRaiseWindows = 64;
+
+} // namespace
+
+FFmpegDecodeGovernor::FFmpegDecodeGovernor()
+    : FFmpegDecodeGovernor(Config())
+{
+}
+
+FFmpegDecodeGovernor::FFmpegDecodeGovernor(const Config& config)
+    : enabled_(false)
+    , level_(0)
+{
+    SetConfig(config);
+}
+
+void FFmpegDecodeGovernor::SetConfig(const Config& config)
+{
+    QMutexLocker locker(&mutex_);
+    config_ = config;
+    config_.window_frames = qMax(1, config_.window_frames);
+    config_.raise_windows = qMax(1, config_.raise_windows);
+    config_.raise_ratio = qBound(0.0, config_.raise_ratio, 1.0);
+    config_.start_level = qBound(0, config_.start_level, kLevelCount - 1);
+    enabled_ = config_.budget_ms > 0.0;
+    ResetLocked();
+}
+
+FFmpegDecodeGovernor::Config FFmpegDecodeGovernor::GetConfig() const
+{
+    QMutexLocker locker(&mutex_);
+    return config_;
+}
+
+void FFmpegDecodeGovernor::Reset()
+{
+    QMutexLocker locker(&mutex_);
+    ResetLocked();
+}
+
+void FFmpegDecodeGovernor::ResetLocked()
+{
+    level_ = enabled_ ? config_.start_level : 0;
+    window_total_ms_ = 0.0;
+    window_frames_ = 0;
+    last_average_ms_ = 0.0;
+    good_windows_ = 0;
+    raise_windows_needed_ = config_.raise_windows;
+    just_raised_ = false;
+}
+
+bool FFmpegDecodeGovernor::RecordFrame(double elapsed_ms)
+{
+    if (!enabled_ || elapsed_ms < 0.0) {
+        return false;
+    }
+
+    QMutexLocker locker(&mutex_);
+    window_total_ms_ += elapsed_ms;
+    if (++window_frames_ < config_.window_frames) {
+        return false;
+    }
+
+    const double average = window_total_ms_ / window_frames_;
+    last_average_ms_ = average;
+    window_total_ms_ = 0.0;
+    window_frames_ = 0;
+
+    const int level = level_;
+    const Level before = LevelAt(level);
+
+    if (average > config_.budget_ms) {
+        good_windows_ = 0;
+        if (just_raised_) {
+            // The step up did not fit the budget: wait longer before the next try
+            raise_windows_needed_ = qMin(raise_windows_needed_ * 2, kMaxRaiseWindows);
+        }
+        just_raised_ = false;
+        if (level + 1 < kLevelCount) {
+            level_ = level + 1;
+            qCInfo(log_ffmpeg_backend).nospace()
+                << "Decode governor: " << average << " ms/frame over " << config_.budget_ms
+                << " ms budget, " << Describe(before) << " -> " << Describe(LevelAt(level + 1));
+            return true;
+        }
+        return false;
+    }
+
+    if (just_raised_) {
+        // The raised level held for a full window; settle the back-off
+        raise_windows_needed_ = qMax(config_.raise_windows, raise_windows_needed_ / 2);
+        just_raised_ = false;
+    }
+
+    if (average < config_.budget_ms * config_.raise_ratio && level > 0) {
+        if (++good_windows_ >= raise_windows_needed_) {
+            good_windows_ = 0;
+            just_raised_ = true;
+            level_ = level - 1;
+            qCInfo(log_ffmpeg_backend).nospace()
+                << "Decode governor: " << average << " ms/frame, headroom under " << config_.budget_ms
+                << " ms budget, " << Describe(before) << " -> " << Describe(LevelAt(level - 1));
+            return true;
+        }
+    } else {
+        good_windows_ = 0;
+    }
+    return false;
+}
+
+int FFmpegDecodeGovernor::LevelCount()
+{
+    return kLevelCount;
+}
+
+FFmpegDecodeGovernor::Level FFmpegDecodeGovernor::LevelAt(int index)
+{
+    return kLevels[qBound(0, index, kLevelCount - 1)];
+}
+
+double FFmpegDecodeGovernor::GetLastAverageMs() const
+{
+    QMutexLocker locker(&mutex_);
+    return last_average_ms_;
+}
+
+QString FFmpegDecodeGovernor::Describe(const Level& level)
+{
+    if (level.dct_denominator <= 1 && level.max_fps <= 0) {
+        return QStringLiteral("full");
+    }
+    QStringList parts;
+    if (level.dct_denominator > 1) {
+        parts << QString("1/%1 scale").arg(level.dct_denominator);
+    }
+    if (level.max_fps > 0) {
+        parts << QString("%1 fps cap").arg(level.max_fps);
+    }
+    return parts.join(", ");
+}
@@ -0,0 +1,109 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+
+#ifndef FFMPEG_DECODE_GOVERNOR_H
+#define FFMPEG_DECODE_GOVERNOR_H
+
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+/**
+ * @brief Closed-loop decode quality control against a per-frame time budget
+ *
+ * The frame processor reports how long each frame took to decode and convert.
+ * The governor averages those times over a window of frames and moves along a
+ * fixed ladder of levels. Each level pairs a minimum TurboJPEG DCT downscale
+ * with a display frame-rate cap. It steps down a level when a window's
+ * average exceeds the budget. It steps back up only after several windows
+ * below a fraction of the budget.
+ *
+ * Hysteresis comes from three sources:
+ * - the gap between the two thresholds;
+ * - the longer dwell before stepping up;
+ * - a back-off that doubles that dwell whenever a step up has to be undone
+ *   straight away, so a host sitting on a boundary settles instead of
+ *   oscillating.
+ *
+ * RecordFrame() may be called from several decode threads; GetLevel() is
+ * lock-free. Each call reports the time one thread spent on one frame, so
+ * with the pipelined decoder the budget bounds per-frame decode latency,
+ * not throughput: N workers each within budget sustain up to N frames per
+ * budget interval.
+ */
+class FFmpegDecodeGovernor {
+public:
+    struct Level {
+        int dct_denominator;   // Minimum DCT downscale: 1, 2, 4 or 8
+        int max_fps;           // Display frame-rate cap; 0 = uncapped
+    };
+
+    struct Config {
+        double budget_ms = 25.0;        // Target decode + convert time per frame; <= 0 disables
+        int window_frames = 30;         // Frames averaged per decision
+        double raise_ratio = 0.5;       // Step up when the average is below budget * raise_ratio
+        int raise_windows = 4;          // Consecutive good windows needed to step up
+        int start_level = 0;            // Level to start (and reset) at
+    };
+
+    FFmpegDecodeGovernor();
+    explicit FFmpegDecodeGovernor(const Config& config);
+
+    void SetConfig(const Config& config);   // Also resets to config.start_level
+    Config GetConfig() const;
+    bool IsEnabled() const { return enabled_; }
+
+    // Records one frame's decode + convert time; returns true if the level changed
+    bool RecordFrame(double elapsed_ms);
+
+    void Reset();
+
+    static int LevelCount();
+    static Level LevelAt(int index);
+    int GetLevelIndex() const { return level_; }
+    Level GetLevel() const { return LevelAt(level_); }
+    double GetLastAverageMs() const;
+
+    // Human-readable level, e.g. "full" or "1/2 scale, 30 fps cap"
+    static QString Describe(const Level& level);
+    QString Describe() const { return Describe(GetLevel()); }
+
+private:
+    void ResetLocked();
+
+    mutable QMutex mutex_;
+    Config config_;
+    std::atomic<bool> enabled_;
+    std::atomic<int> level_;
+
+    // Guarded by mutex_
+    double window_total_ms_;
+    int window_frames_;
+    double last_average_ms_;
+    int good_windows_;
+    int raise_windows_needed_;
+    bool just_raised_;
+};
+
+#endif // FFMPEG_DECODE_GOVERNOR_H
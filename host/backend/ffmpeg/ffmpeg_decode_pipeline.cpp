@@ -0,0 +1,329 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+#include "ffmpeg_decode_pipeline.h"
+#include "host/frametiming.h"
+#include <QLoggingCategory>
+#include <QDebug>
+#include <QThread>
+#include <QDateTime>
+#include <algorithm>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+FFmpegDecodePipeline::FFmpegDecodePipeline()
+    : queue_depth_(kDefaultQueueDepth)
+    , running_(false)
+    , delivering_(false)
+    , next_sequence_(0)
+    , next_delivery_(0)
+    , stat_frames_(0)
+    , stat_queue_drops_(0)
+    , stat_decode_failures_(0)
+    , stat_queue_wait_us_(0)
+    , stat_decode_us_(0)
+    , stat_reorder_wait_us_(0)
+    , stat_max_total_us_(0)
+{
+}
+
+FFmpegDecodePipeline::~FFmpegDecodePipeline()
+{
+    Stop();
+}
+
+int FFmpegDecodePipeline::ResolveWorkerCount(int requested)
+{
+    if (requested > 0) {
+        return qMin(requested, kMaxWorkers);
+    }
+
+    // Leave one core for the reader thread and the GUI; past four workers the
+    // USB capture rate, not decode throughput, is the limit.
+    return qBound(1, QThread::idealThreadCount() - 1, 4);
+}
+
+bool FFmpegDecodePipeline::Start(const Config& config, DecodeFunction decode, DeliverFunction deliver)
+{
+    Stop();
+
+    if (!decode || !deliver) {
+        return false;
+    }
+
+    const int worker_count = ResolveWorkerCount(config.worker_count);
+    {
+        QMutexLocker locker(&mutex_);
+        decode_ = std::move(decode);
+        deliver_ = std::move(deliver);
+        queue_depth_ = qBound(1, config.queue_depth, kMaxQueueDepth);
+        next_sequence_ = 0;
+        next_delivery_ = 0;
+        delivering_ = false;
+        stat_frames_ = 0;
+        stat_queue_drops_ = 0;
+        stat_decode_failures_ = 0;
+        stat_queue_wait_us_ = 0;
+        stat_decode_us_ = 0;
+        stat_reorder_wait_us_ = 0;
+        stat_max_total_us_ = 0;
+        clock_.start();
+        running_ = true;
+
+        for (int i = 0; i < worker_count; ++i) {
+            std::unique_ptr<QThread> worker(QThread::create([this]() { WorkerLoop(); }));
+            worker->setObjectName(QString("FFmpegDecodeWorker-%1").arg(i));
+            worker->start();
+            workers_.push_back(std::move(worker));
+        }
+    }
+
+    qCInfo(log_ffmpeg_backend) << "Decode pipeline started with" << worker_count
+                               << "workers, queue depth" << queue_depth_;
+    return true;
+}
+
+void FFmpegDecodePipeline::Stop()
+{
+    std::vector<std::unique_ptr<QThread>> workers;
+    {
+        QMutexLocker locker(&mutex_);
+        if (!running_ && workers_.empty()) {
+            return;
+        }
+        running_ = false;
+        workers.swap(workers_);
+        work_available_.wakeAll();
+    }
+
+    // Workers finish the packet they are decoding and exit; DeliverReady()
+    // checks running_, so nothing is handed out once Stop() has begun.
+    for (auto& worker : workers) {
+        worker->wait();
+    }
+
+    QMutexLocker locker(&mutex_);
+    queue_.clear();
+    completed_.clear();
+    spare_packets_.clear();
+    decode_ = nullptr;
+    deliver_ = nullptr;
+
+    qCDebug(log_ffmpeg_backend) << "Decode pipeline stopped";
+}
+
+bool FFmpegDecodePipeline::IsRunning() const
+{
+    QMutexLocker locker(&mutex_);
+    return running_;
+}
+
+int FFmpegDecodePipeline::GetWorkerCount() const
+{
+    QMutexLocker locker(&mutex_);
+    return static_cast<int>(workers_.size());
+}
+
+bool FFmpegDecodePipeline::Submit(AVPacket* packet, const QSize& target_size, qint64 read_ns,
+                                  qint64 capture_time_ms)
+{
+    if (!packet || !packet->data || packet->size <= 0) {
+        return false;
+    }
+
+    QMutexLocker locker(&mutex_);
+    if (!running_) {
+        return false;
+    }
+
+    AvPacketPtr reference = TakePacketLocked();
+    if (!reference || av_packet_ref(AV_PACKET_RAW(reference), packet) < 0) {
+        qCWarning(log_ffmpeg_backend) << "Decode pipeline: failed to reference packet";
+        RecyclePacketLocked(std::move(reference));
+        return false;
+    }
+
+    if (static_cast<int>(queue_.size()) >= queue_depth_) {
+        // Workers are behind: drop the oldest waiting packet. It is always
+        // newer than anything in flight, so an empty result keeps the
+        // in-order delivery moving past it.
+        Job dropped = std::move(queue_.front());
+        queue_.pop_front();
+        ++stat_queue_drops_;
+        FrameTimingRecorder::instance().recordDrop(FrameTimingRecorder::DecodeQueueFull);
+        RecyclePacketLocked(std::move(dropped.packet));
+        CompleteLocked(dropped.sequence, Result());
+    }
+
+    Job job;
+    job.sequence = next_sequence_++;
+    job.packet = std::move(reference);
+    job.target_size = target_size;
+    job.submitted_ns = clock_.nsecsElapsed();
+    job.read_ns = read_ns;
+    job.capture_time_ms = capture_time_ms < 0 ? QDateTime::currentMSecsSinceEpoch() : capture_time_ms;
+    queue_.push_back(std::move(job));
+    work_available_.wakeOne();
+    return true;
+}
+
+FFmpegDecodePipeline::LatencyStats FFmpegDecodePipeline::TakeLatencyStats()
+{
+    QMutexLocker locker(&mutex_);
+
+    LatencyStats stats;
+    stats.frames_delivered = stat_frames_;
+    stats.queue_drops = stat_queue_drops_;
+    stats.decode_failures = stat_decode_failures_;
+    if (stat_frames_ > 0) {
+        const double frames = static_cast<double>(stat_frames_);
+        stats.avg_queue_wait_ms = stat_queue_wait_us_ / frames / 1000.0;
+        stats.avg_decode_ms = stat_decode_us_ / frames / 1000.0;
+        stats.avg_reorder_wait_ms = stat_reorder_wait_us_ / frames / 1000.0;
+        stats.avg_total_ms = stats.avg_queue_wait_ms + stats.avg_decode_ms + stats.avg_reorder_wait_ms;
+        stats.max_total_ms = stat_max_total_us_ / 1000.0;
+    }
+
+    stat_frames_ = 0;
+    stat_queue_drops_ = 0;
+    stat_decode_failures_ = 0;
+    stat_queue_wait_us_ = 0;
+    stat_decode_us_ = 0;
+    stat_reorder_wait_us_ = 0;
+    stat_max_total_us_ = 0;
+    return stats;
+}
+
+void FFmpegDecodePipeline::WorkerLoop()
+{
+    for (;;) {
+        Job job;
+        {
+            QMutexLocker locker(&mutex_);
+            while (running_ && queue_.empty()) {
+                work_available_.wait(&mutex_);
+            }
+            if (!running_) {
+                return;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        Result result;
+        const qint64 started_ns = clock_.nsecsElapsed();
+        result.timing.sequence = job.sequence;
+        result.timing.read_ns = job.read_ns;
+        result.timing.capture_time_ms = job.capture_time_ms;
+        result.timing.queue_wait_us = (started_ns - job.submitted_ns) / 1000;
+        result.frame = decode_(AV_PACKET_RAW(job.packet), job.target_size);
+        result.decoded_ns = clock_.nsecsElapsed();
+        result.timing.decode_us = (result.decoded_ns - started_ns) / 1000;
+
+        {
+            QMutexLocker locker(&mutex_);
+            if (result.frame.IsNull() && running_) {
+                ++stat_decode_failures_;
+            }
+            RecyclePacketLocked(std::move(job.packet));
+            CompleteLocked(job.sequence, std::move(result));
+        }
+
+        DeliverReady();
+    }
+}
+
+void FFmpegDecodePipeline::CompleteLocked(qint64 sequence, Result result)
+{
+    if (sequence < next_delivery_) {
+        return;
+    }
+    completed_[sequence] = std::move(result);
+}
+
+void FFmpegDecodePipeline::DeliverReady()
+{
+    QMutexLocker locker(&mutex_);
+
+    // Only one thread delivers at a time; the others just leave their result
+    // in completed_ and the active deliverer picks it up on its next pass.
+    if (delivering_) {
+        return;
+    }
+    delivering_ = true;
+
+    while (running_) {
+        auto it = completed_.find(next_delivery_);
+        if (it == completed_.end()) {
+            break;
+        }
+
+        Result result = std::move(it->second);
+        completed_.erase(it);
+        ++next_delivery_;
+
+        if (result.frame.IsNull()) {
+            continue;  // Dropped or failed; nothing to show for this slot
+        }
+
+        result.timing.reorder_wait_us = (clock_.nsecsElapsed() - result.decoded_ns) / 1000;
+        const qint64 total_us = result.timing.queue_wait_us + result.timing.decode_us
+                                + result.timing.reorder_wait_us;
+        ++stat_frames_;
+        stat_queue_wait_us_ += result.timing.queue_wait_us;
+        stat_decode_us_ += result.timing.decode_us;
+        stat_reorder_wait_us_ += result.timing.reorder_wait_us;
+        stat_max_total_us_ = qMax(stat_max_total_us_, total_us);
+
+        locker.unlock();
+        deliver_(result.frame, result.timing);
+        locker.relock();
+    }
+
+    delivering_ = false;
+}
+
+AvPacketPtr FFmpegDecodePipeline::TakePacketLocked()
+{
+    if (!spare_packets_.empty()) {
+        AvPacketPtr packet = std::move(spare_packets_.back());
+        spare_packets_.pop_back();
+        return packet;
+    }
+    return make_av_packet();
+}
+
+void FFmpegDecodePipeline::RecyclePacketLocked(AvPacketPtr packet)
+{
+    if (!packet) {
+        return;
+    }
+    av_packet_unref(AV_PACKET_RAW(packet));
+    if (static_cast<int>(spare_packets_.size()) < queue_depth_ + kMaxWorkers) {
+        spare_packets_.push_back(std::move(packet));
+    }
+}
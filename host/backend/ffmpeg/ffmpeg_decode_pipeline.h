@@ -0,0 +1,168 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+#ifndef FFMPEG_DECODE_PIPELINE_H
+#define FFMPEG_DECODE_PIPELINE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QSize>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+#include "ffmpegutils.h"
+#include "ffmpeg_frame_processor.h"
+
+class QThread;
+
+/**
+ * @brief Pipelined multi-threaded decode stage for MJPEG capture
+ *
+ * The capture thread stays a pure reader: Submit() takes a reference to the
+ * packet it just read and returns immediately. A bounded queue feeds N decode
+ * workers, each decoding with its own thread-local TurboJPEG handle into
+ * pooled buffers. Finished frames are re-sequenced and delivered strictly in
+ * capture order, so display and recording never see frames go backwards.
+ *
+ * When the queue is full the oldest waiting packet is dropped - for a live
+ * KVM view the newest frame is always the one worth decoding.
+ */
+class FFmpegDecodePipeline {
+public:
+    static constexpr int kMaxWorkers = 8;
+    static constexpr int kDefaultQueueDepth = 4;
+    static constexpr int kMaxQueueDepth = 32;
+
+    struct Config {
+        int worker_count = 0;                   // 0 = pick from the CPU count
+        int queue_depth = kDefaultQueueDepth;   // Packets waiting for a worker
+    };
+
+    // Per-frame latency of each pipeline stage, in microseconds
+    struct FrameTiming {
+        qint64 sequence = 0;
+        qint64 queue_wait_us = 0;     // Submit() until a worker picked it up
+        qint64 decode_us = 0;         // Decode on the worker
+        qint64 reorder_wait_us = 0;   // Waiting for earlier frames to finish
+        qint64 read_ns = 0;           // Passed to Submit(), returned unchanged
+        qint64 capture_time_ms = 0;   // Wall-clock capture time, stamped at Submit()
+    };
+
+    // Aggregated stage latency since the previous TakeLatencyStats() call
+    struct LatencyStats {
+        qint64 frames_delivered = 0;
+        qint64 queue_drops = 0;
+        qint64 decode_failures = 0;
+        double avg_queue_wait_ms = 0.0;
+        double avg_decode_ms = 0.0;
+        double avg_reorder_wait_ms = 0.0;
+        double avg_total_ms = 0.0;
+        double max_total_ms = 0.0;
+    };
+
+    using DecodeFunction =
+        std::function<FFmpegFrameProcessor::DecodedFrame(AVPacket* packet, const QSize& target_size)>;
+    using DeliverFunction =
+        std::function<void(const FFmpegFrameProcessor::DecodedFrame& frame, const FrameTiming& timing)>;
+
+    FFmpegDecodePipeline();
+    ~FFmpegDecodePipeline();
+
+    FFmpegDecodePipeline(const FFmpegDecodePipeline&) = delete;
+    FFmpegDecodePipeline& operator=(const FFmpegDecodePipeline&) = delete;
+
+    // Resolves a configured worker count (0 = automatic) to the number of threads used
+    static int ResolveWorkerCount(int requested);
+
+    // Spawns the workers. deliver is called on a worker thread, one frame at a
+    // time and in submission order.
+    bool Start(const Config& config, DecodeFunction decode, DeliverFunction deliver);
+
+    // Joins the workers and discards queued packets; no callback runs after return.
+    void Stop();
+
+    bool IsRunning() const;
+    int GetWorkerCount() const;
+
+    // Queues a new reference to packet's data; the caller keeps ownership of
+    // packet and may unref it straight away. read_ns and capture_time_ms
+    // (< 0 = now) are handed back in the frame's FrameTiming, so the frame
+    // keeps the time it was captured rather than the time it was delivered.
+    // Returns false when not running.
+    bool Submit(AVPacket* packet, const QSize& target_size, qint64 read_ns = 0,
+                qint64 capture_time_ms = -1);
+
+    LatencyStats TakeLatencyStats();
+
+private:
+    struct Job {
+        qint64 sequence = 0;
+        AvPacketPtr packet;
+        QSize target_size;
+        qint64 submitted_ns = 0;
+        qint64 read_ns = 0;
+        qint64 capture_time_ms = 0;
+    };
+
+    struct Result {
+        FFmpegFrameProcessor::DecodedFrame frame;
+        FrameTiming timing;
+        qint64 decoded_ns = 0;
+    };
+
+    void WorkerLoop();
+    void CompleteLocked(qint64 sequence, Result result);
+    void DeliverReady();
+    AvPacketPtr TakePacketLocked();
+    void RecyclePacketLocked(AvPacketPtr packet);
+
+    mutable QMutex mutex_;
+    QWaitCondition work_available_;
+    std::deque<Job> queue_;
+    std::vector<AvPacketPtr> spare_packets_;   // Recycled AVPacket shells
+    std::map<qint64, Result> completed_;       // Decoded frames waiting for their turn
+    std::vector<std::unique_ptr<QThread>> workers_;
+
+    DecodeFunction decode_;
+    DeliverFunction deliver_;
+    int queue_depth_;
+    bool running_;
+    bool delivering_;
+    qint64 next_sequence_;
+    qint64 next_delivery_;
+    QElapsedTimer clock_;
+
+    // Latency accumulators (guarded by mutex_)
+    qint64 stat_frames_;
+    qint64 stat_queue_drops_;
+    qint64 stat_decode_failures_;
+    qint64 stat_queue_wait_us_;
+    qint64 stat_decode_us_;
+    qint64 stat_reorder_wait_us_;
+    qint64 stat_max_total_us_;
+};
+
+#endif // FFMPEG_DECODE_PIPELINE_H
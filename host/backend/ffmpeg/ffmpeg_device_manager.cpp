@@ -23,8 +23,11 @@
 #include "ffmpeg_device_manager.h"
 #include "ffmpeg_hardware_accelerator.h"
 #include "ffmpeg_amd_detector.h"
+#include "ffmpeg_replay_source.h"
+#include "ffmpeg_capability_cache.h"
 #include "global.h"
 #include "ui/globalsetting.h"
+#include "log/startuptrace.h"
 
 #include <QLoggingCategory>
 #include <QDateTime>
@@ -48,6 +51,7 @@ FFmpegDeviceManager::FFmpegDeviceManager()
     : format_context_(nullptr)
     , codec_context_(nullptr)
     , video_stream_index_(-1)
+    , warm_start_(false)
     , interrupt_requested_(false)
     , operation_start_time_(0)
 {
@@ -61,13 +65,27 @@ FFmpegDeviceManager::~FFmpegDeviceManager()
 bool FFmpegDeviceManager::OpenDevice(const QString& device_path, const QSize& resolution, 
                                      int framerate, FFmpegHardwareAccelerator* hw_accelerator)
 {
+    OPF_STARTUP_SPAN("FFmpegDeviceManager::OpenDevice", "camera");
     qCDebug(log_ffmpeg_backend) << "Opening input device:" << device_path;
     
     // Reset interrupt state for this new operation
     interrupt_requested_ = false;
     operation_start_time_ = QDateTime::currentMSecsSinceEpoch();
+    warm_start_ = false;
     
-    if (!InitializeInputStream(device_path, resolution, framerate)) {
+    // A replay file opened in place of the device is otherwise handled exactly
+    // like the camera, so everything downstream runs unchanged without hardware
+    QString replayPath = FFmpegReplaySource::OverridePath();
+    if (replayPath.isEmpty() && FFmpegReplaySource::IsReplayPath(device_path)) {
+        replayPath = device_path;
+    }
+    
+    if (!replayPath.isEmpty()) {
+        if (!InitializeReplayStream(replayPath, framerate)) {
+            qCWarning(log_ffmpeg_backend) << "Failed to open replay source" << replayPath;
+            return false;
+        }
+    } else if (!InitializeInputStream(device_path, resolution, framerate)) {
         qCWarning(log_ffmpeg_backend) << "Failed to initialize input stream";
         return false;
     }
@@ -84,6 +102,14 @@ bool FFmpegDeviceManager::OpenDevice(const QString& device_path, const QSize& re
     
     bool usingHw = (hw_accelerator != nullptr && hw_accelerator->IsHardwareAccelEnabled());
     
+    // A file has no ring buffer to go stale; warm-up and drain would only
+    // throw away the start of the recording
+    if (replay_source_) {
+        operation_start_time_ = 0;
+        qCDebug(log_ffmpeg_backend) << "Replay source opened successfully";
+        return true;
+    }
+    
     // WARM-UP: Force hardware codec (QSV/CUDA) to complete its deferred session
     // initialisation NOW, before we drain the ring buffer.
     //
@@ -114,6 +140,8 @@ bool FFmpegDeviceManager::OpenDevice(const QString& device_path, const QSize& re
 
 void FFmpegDeviceManager::CloseDevice()
 {
+    replay_source_.reset();
+    
     // Close codec context
     if (codec_context_) {
         avcodec_free_context(&codec_context_);
@@ -186,6 +214,24 @@ int FFmpegDeviceManager::InterruptCallback(void* ctx)
 
 bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, const QSize& resolution, int framerate)
 {
+    // WARM START: a device opened before goes straight into the format that
+    // worked last time (or that its enumerated modes list for this size),
+    // skipping the pre-configuration and the formats that are known to fail
+    QString firstFormat = QStringLiteral("mjpeg");
+    FFmpegCapabilityCache::Entry cached;
+    if (!capability_key_.isEmpty()
+        && FFmpegCapabilityCache::Instance().Lookup(capability_key_, &cached)
+        && cached.device_path == device_path) {
+        const QString format = FFmpegCapabilityCache::ChooseFormat(cached, resolution, framerate);
+        warm_start_ = FFmpegCapabilityCache::Supports(cached, resolution, framerate) || !format.isEmpty();
+        if (warm_start_) {
+            firstFormat = format;
+            qCInfo(log_ffmpeg_backend) << "Capability cache hit for" << capability_key_ << "- opening with"
+                                       << (format.isEmpty() ? QStringLiteral("auto-detected format") : format);
+        }
+    }
+    QString openedFormat = firstFormat;
+    
 #ifdef Q_OS_WIN
     // WINDOWS: Use DirectShow for video capture
     qCDebug(log_ffmpeg_backend) << "Windows platform detected - using DirectShow input";
@@ -215,7 +261,9 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
     AVDictionary* options = nullptr;
     av_dict_set(&options, "video_size", QString("%1x%2").arg(resolution.width()).arg(resolution.height()).toUtf8().constData(), 0);
     av_dict_set(&options, "framerate", QString::number(framerate).toUtf8().constData(), 0);
-    av_dict_set(&options, "input_format", "mjpeg", 0);
+    if (!firstFormat.isEmpty()) {
+        av_dict_set(&options, "input_format", firstFormat.toUtf8().constData(), 0);
+    }
     av_dict_set(&options, "preset", "preview", 0);
     
     // ============ MJPEG QUALITY OPTIMIZATIONS ============
@@ -240,13 +288,22 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
     // 5. Critical timeout to prevent blocking
     av_dict_set(&options, "timeout", "5000000", 0);
     
-    qCDebug(log_ffmpeg_backend) << "Trying DirectShow with MJPEG format, resolution" << resolution << "and framerate" << framerate;
+    qCDebug(log_ffmpeg_backend) << "Trying DirectShow with" << (firstFormat.isEmpty() ? QStringLiteral("auto-detected") : firstFormat)
+                                << "format, resolution" << resolution << "and framerate" << framerate;
     qCDebug(log_ffmpeg_backend) << "DirectShow device string:" << device_path;
     
     // Open input - device_path should be in format "video=Device Name"
     int ret = avformat_open_input(&format_context_, device_path.toUtf8().constData(), inputFormat, &options);
     av_dict_free(&options);
     
+    // A cached format that no longer opens (firmware or cable changed under
+    // the same key) is dropped and the usual probing takes over
+    if (ret < 0 && warm_start_) {
+        qCWarning(log_ffmpeg_backend) << "Cached capture format" << firstFormat << "failed, falling back to probing";
+        FFmpegCapabilityCache::Instance().Invalidate(capability_key_);
+        warm_start_ = false;
+    }
+    
     // If MJPEG fails, try without specifying codec (auto-detect)
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
@@ -273,6 +330,7 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
         
         ret = avformat_open_input(&format_context_, device_path.toUtf8().constData(), inputFormat, &fallbackOptions);
         av_dict_free(&fallbackOptions);
+        openedFormat.clear();
     }
     
     // If that fails, try minimal options
@@ -293,6 +351,7 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
         
         // Try with just the device path
         ret = avformat_open_input(&format_context_, device_path.toUtf8().constData(), inputFormat, nullptr);
+        openedFormat.clear();
     }
     
     if (ret < 0) {
@@ -311,25 +370,31 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
     // RESPONSIVENESS OPTIMIZATION: Configure device for minimal latency
     fprintf(stderr, "[DEBUG-FFMPEG] Opening video device: %s (%dx%d @ %d fps)\n",
             device_path.toUtf8().constData(), resolution.width(), resolution.height(), framerate);
-    qCDebug(log_ffmpeg_backend) << "Pre-configuring device for low-latency MJPEG capture...";
-    
-    QString configCommand = QString("v4l2-ctl --device=%1 --set-fmt-video=width=%2,height=%3,pixelformat=MJPG")
-                           .arg(device_path).arg(resolution.width()).arg(resolution.height());
-    int configResult = system(configCommand.toUtf8().constData());
-    
-    QString framerateCommand = QString("v4l2-ctl --device=%1 --set-parm=%2")
-                              .arg(device_path).arg(framerate);
-    int framerateResult = system(framerateCommand.toUtf8().constData());
-    
-    // RESPONSIVENESS: Try to configure minimal buffering for lower latency
-    QString bufferCommand = QString("v4l2-ctl --device=%1")
-                           .arg(device_path);
-    [[maybe_unused]] auto bufferResult = system(bufferCommand.toUtf8().constData()); // Don't check result - optional optimization
-    
-    if (configResult == 0 && framerateResult == 0) {
-        qCDebug(log_ffmpeg_backend) << "Device pre-configured successfully for low-latency MJPEG" << resolution << "at" << framerate << "fps";
+    // The v4l2 demuxer sets the format itself; the v4l2-ctl pre-configuration
+    // only helps a device whose working format is not known yet
+    if (warm_start_) {
+        qCDebug(log_ffmpeg_backend) << "Skipping v4l2-ctl pre-configuration (cached capture format)";
     } else {
-        qCWarning(log_ffmpeg_backend) << "Device pre-configuration failed, continuing with FFmpeg initialization";
+        qCDebug(log_ffmpeg_backend) << "Pre-configuring device for low-latency MJPEG capture...";
+        
+        QString configCommand = QString("v4l2-ctl --device=%1 --set-fmt-video=width=%2,height=%3,pixelformat=MJPG")
+                               .arg(device_path).arg(resolution.width()).arg(resolution.height());
+        int configResult = system(configCommand.toUtf8().constData());
+        
+        QString framerateCommand = QString("v4l2-ctl --device=%1 --set-parm=%2")
+                                  .arg(device_path).arg(framerate);
+        int framerateResult = system(framerateCommand.toUtf8().constData());
+        
+        // RESPONSIVENESS: Try to configure minimal buffering for lower latency
+        QString bufferCommand = QString("v4l2-ctl --device=%1")
+                               .arg(device_path);
+        [[maybe_unused]] auto bufferResult = system(bufferCommand.toUtf8().constData()); // Don't check result - optional optimization
+        
+        if (configResult == 0 && framerateResult == 0) {
+            qCDebug(log_ffmpeg_backend) << "Device pre-configured successfully for low-latency MJPEG" << resolution << "at" << framerate << "fps";
+        } else {
+            qCWarning(log_ffmpeg_backend) << "Device pre-configuration failed, continuing with FFmpeg initialization";
+        }
     }
     
     // Allocate format context
@@ -354,7 +419,9 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
     AVDictionary* options = nullptr;
     av_dict_set(&options, "video_size", QString("%1x%2").arg(resolution.width()).arg(resolution.height()).toUtf8().constData(), 0);
     av_dict_set(&options, "framerate", QString::number(framerate).toUtf8().constData(), 0);
-    av_dict_set(&options, "input_format", "mjpeg", 0); // Should work due to pre-configuration
+    if (!firstFormat.isEmpty()) {
+        av_dict_set(&options, "input_format", firstFormat.toUtf8().constData(), 0); // Pre-configured or cached
+    }
     
     // CRITICAL LOW-LATENCY OPTIMIZATIONS for KVM responsiveness:
     av_dict_set(&options, "fflags", "nobuffer", 0);        // Disable input buffering
@@ -364,12 +431,21 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
     av_dict_set(&options, "probesize", "32", 0);           // Minimal probe size for faster start
     av_dict_set(&options, "analyzeduration", "0", 0);      // Skip analysis to reduce startup delay
     
-    qCDebug(log_ffmpeg_backend) << "Trying low-latency MJPEG format with resolution" << resolution << "and framerate" << framerate;
+    qCDebug(log_ffmpeg_backend) << "Trying low-latency" << (firstFormat.isEmpty() ? QStringLiteral("auto-detected") : firstFormat)
+                                << "format with resolution" << resolution << "and framerate" << framerate;
     
     // Open input
     int ret = avformat_open_input(&format_context_, device_path.toUtf8().constData(), inputFormat, &options);
     av_dict_free(&options);
     
+    // A cached format that no longer opens (firmware or cable changed under
+    // the same key) is dropped and the usual probing takes over
+    if (ret < 0 && warm_start_) {
+        qCWarning(log_ffmpeg_backend) << "Cached capture format" << firstFormat << "failed, falling back to probing";
+        FFmpegCapabilityCache::Instance().Invalidate(capability_key_);
+        warm_start_ = false;
+    }
+    
     // If MJPEG fails, try YUYV422
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
@@ -394,6 +470,7 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
         
         ret = avformat_open_input(&format_context_, device_path.toUtf8().constData(), inputFormat, &yuvOptions);
         av_dict_free(&yuvOptions);
+        openedFormat = QStringLiteral("yuyv422");
     }
     
     // If that fails, try without specifying input format (auto-detect)
@@ -419,6 +496,7 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
         
         ret = avformat_open_input(&format_context_, device_path.toUtf8().constData(), inputFormat, &fallbackOptions);
         av_dict_free(&fallbackOptions);
+        openedFormat.clear();
     }
     
     // If everything fails, try minimal options
@@ -439,6 +517,7 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
         
         // Try with minimal options (just the device path)
         ret = avformat_open_input(&format_context_, device_path.toUtf8().constData(), inputFormat, nullptr);
+        openedFormat.clear();
     }
     
     if (ret < 0) {
@@ -473,6 +552,41 @@ bool FFmpegDeviceManager::InitializeInputStream(const QString& device_path, cons
     }
     qCDebug(log_ffmpeg_backend) << "Stream info found successfully";
     
+    // Remember what worked, with the size the device actually negotiated
+    if (!capability_key_.isEmpty()) {
+        QSize negotiated = resolution;
+        for (unsigned int i = 0; i < format_context_->nb_streams; ++i) {
+            const AVCodecParameters* params = format_context_->streams[i]->codecpar;
+            if (params->codec_type == AVMEDIA_TYPE_VIDEO && params->width > 0 && params->height > 0) {
+                negotiated = QSize(params->width, params->height);
+                break;
+            }
+        }
+        FFmpegCapabilityCache::Instance().RecordOpen(capability_key_, device_path, openedFormat, negotiated, framerate);
+    }
+    
+    return true;
+}
+
+bool FFmpegDeviceManager::InitializeReplayStream(const QString& replay_path, int framerate)
+{
+    FFmpegReplaySource::Options options;
+    QString error;
+    if (!FFmpegReplaySource::ParseSpec(replay_path, &options, &error)) {
+        qCCritical(log_ffmpeg_backend) << "Invalid replay path" << replay_path << ":" << error;
+        return false;
+    }
+    
+    replay_source_ = std::make_unique<FFmpegReplaySource>(options);
+    
+    AVIOInterruptCB interrupt;
+    interrupt.callback = FFmpegDeviceManager::InterruptCallback;
+    interrupt.opaque = this;
+    format_context_ = replay_source_->OpenInput(framerate, interrupt);
+    if (!format_context_) {
+        replay_source_.reset();
+        return false;
+    }
     return true;
 }
 
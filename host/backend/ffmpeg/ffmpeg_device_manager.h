@@ -25,6 +25,7 @@
 
 #include <QString>
 #include <QSize>
+#include <memory>
 
 #ifdef HAVE_FFMPEG
 extern "C" {
@@ -33,8 +34,9 @@ extern "C" {
 }
 #endif
 
-// Forward declaration
+// Forward declarations
 class FFmpegHardwareAccelerator;
+class FFmpegReplaySource;
 
 /**
  * @brief Manages FFmpeg device/stream operations
@@ -62,6 +64,9 @@ public:
     AVCodecContext* GetCodecContext() { return codec_context_; }
     int GetVideoStreamIndex() const { return video_stream_index_; }
     
+    // Non-null while a replay: path (or OPENTERFACE_REPLAY) stands in for the device
+    FFmpegReplaySource* GetReplaySource() { return replay_source_.get(); }
+    
     // Device capability detection
     struct CameraCapability {
         QSize resolution;
@@ -71,12 +76,19 @@ public:
     };
     bool GetMaxCameraCapability(const QString& device_path, CameraCapability& capability);
     
+    // Capability cache key (FFmpegCapabilityCache::MakeKey) for the next open;
+    // empty disables the cache
+    void SetCapabilityKey(const QString& key) { capability_key_ = key; }
+    // True if the last open went straight in with cached parameters
+    bool WasWarmStart() const { return warm_start_; }
+    
     // Interrupt handling
     void SetInterruptRequested(bool requested);
     static int InterruptCallback(void* ctx);
 
 private:
     bool InitializeInputStream(const QString& device_path, const QSize& resolution, int framerate);
+    bool InitializeReplayStream(const QString& replay_path, int framerate);
     bool FindVideoStream();
     bool SetupDecoder(FFmpegHardwareAccelerator* hw_accelerator);
     void WarmUpHardwareDecoder();
@@ -85,6 +97,9 @@ private:
     AVFormatContext* format_context_;
     AVCodecContext* codec_context_;
     int video_stream_index_;
+    std::unique_ptr<FFmpegReplaySource> replay_source_;
+    QString capability_key_;
+    bool warm_start_;
     
     volatile bool interrupt_requested_;
     qint64 operation_start_time_;
@@ -21,6 +21,7 @@
 */
 
 #include "ffmpeg_device_validator.h"
+#include "ffmpeg_capability_cache.h"
 #include "global.h"
 #include "ui/globalsetting.h"
 
@@ -72,6 +73,13 @@ bool FFmpegDeviceValidator::CheckCameraAvailable(const QString& devicePath,
         return true; // Rely on OS-specific checks above
     }
     
+    // A device node that has opened before needs no probe open; if the
+    // cached parameters have gone stale the capture open falls back itself
+    if (FFmpegCapabilityCache::Instance().HasEntryForPath(devicePath)) {
+        qCDebug(log_ffmpeg_backend) << "Device has cached capture capabilities, skipping FFmpeg compatibility check";
+        return true;
+    }
+    
     // FFmpeg compatibility check
     return CheckFFmpegCompatibility(devicePath);
 }
@@ -0,0 +1,217 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+#include "ffmpeg_frame_diff.h"
+#include <QRect>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define OPF_DIFF_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define OPF_DIFF_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+inline uint64_t Mix(uint64_t hash, uint32_t value)
+{
+    return (hash ^ value) * kFnvPrime;
+}
+
+// Bytes past the last whole 16-byte block of a row; the same for every ISA
+inline void SumTail(const uint8_t* data, int count, uint32_t& sum1, uint32_t& sum2)
+{
+    for (int i = 0; i < count; ++i) {
+        sum1 += data[i];
+        sum2 += sum1;
+    }
+}
+
+} // namespace
+
+FFmpegFrameDiff::FFmpegFrameDiff()
+    : format_(QImage::Format_Invalid)
+    , frames_(0)
+    , static_frames_(0)
+{
+}
+
+uint64_t FFmpegFrameDiff::HashTile(const uint8_t* data, int stride, int width_bytes, int rows)
+{
+    const int blocks = width_bytes / 16;
+    const int tail = width_bytes - blocks * 16;
+    uint32_t sum1[4] = {0, 0, 0, 0};
+    uint32_t sum2[4] = {0, 0, 0, 0};
+    uint32_t tail1 = 0;
+    uint32_t tail2 = 0;
+
+#if defined(OPF_DIFF_SSE2)
+    __m128i a = _mm_setzero_si128();
+    __m128i b = _mm_setzero_si128();
+    for (int y = 0; y < rows; ++y) {
+        const uint8_t* row = data + static_cast<ptrdiff_t>(y) * stride;
+        for (int i = 0; i < blocks; ++i) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i * 16));
+            a = _mm_add_epi32(a, v);
+            b = _mm_add_epi32(b, a);
+        }
+        SumTail(row + blocks * 16, tail, tail1, tail2);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sum1), a);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sum2), b);
+#elif defined(OPF_DIFF_NEON)
+    uint32x4_t a = vdupq_n_u32(0);
+    uint32x4_t b = vdupq_n_u32(0);
+    for (int y = 0; y < rows; ++y) {
+        const uint8_t* row = data + static_cast<ptrdiff_t>(y) * stride;
+        for (int i = 0; i < blocks; ++i) {
+            a = vaddq_u32(a, vreinterpretq_u32_u8(vld1q_u8(row + i * 16)));
+            b = vaddq_u32(b, a);
+        }
+        SumTail(row + blocks * 16, tail, tail1, tail2);
+    }
+    vst1q_u32(sum1, a);
+    vst1q_u32(sum2, b);
+#else
+    for (int y = 0; y < rows; ++y) {
+        const uint8_t* row = data + static_cast<ptrdiff_t>(y) * stride;
+        for (int i = 0; i < blocks; ++i) {
+            uint32_t lanes[4];
+            std::memcpy(lanes, row + i * 16, sizeof(lanes));
+            for (int k = 0; k < 4; ++k) {
+                sum1[k] += lanes[k];
+                sum2[k] += sum1[k];
+            }
+        }
+        SumTail(row + blocks * 16, tail, tail1, tail2);
+    }
+#endif
+
+    uint64_t hash = kFnvOffset;
+    for (int k = 0; k < 4; ++k) {
+        hash = Mix(hash, sum1[k]);
+        hash = Mix(hash, sum2[k]);
+    }
+    hash = Mix(hash, tail1);
+    return Mix(hash, tail2);
+}
+
+const char* FFmpegFrameDiff::IsaName()
+{
+#if defined(OPF_DIFF_SSE2)
+    return "SSE2";
+#elif defined(OPF_DIFF_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+FFmpegFrameDiff::Result FFmpegFrameDiff::Compare(const QImage& image)
+{
+    Result result;
+    if (image.isNull() || image.depth() < 8) {
+        Reset();
+        result.dirty = QRegion(image.rect());
+        return result;
+    }
+
+    const int width = image.width();
+    const int height = image.height();
+    const int bytes_per_pixel = image.depth() / 8;
+    const int stride = static_cast<int>(image.bytesPerLine());
+    const int columns = (width + kTileSize - 1) / kTileSize;
+    const int tile_rows = (height + kTileSize - 1) / kTileSize;
+    result.total_tiles = columns * tile_rows;
+
+    scratch_.resize(result.total_tiles);
+    for (int ty = 0; ty < tile_rows; ++ty) {
+        const int y = ty * kTileSize;
+        const int rows = std::min(kTileSize, height - y);
+        const uint8_t* line = image.constScanLine(y);
+        for (int tx = 0; tx < columns; ++tx) {
+            const int x = tx * kTileSize;
+            const int tile_width = std::min(kTileSize, width - x);
+            scratch_[ty * columns + tx] =
+                HashTile(line + x * bytes_per_pixel, stride, tile_width * bytes_per_pixel, rows);
+        }
+    }
+
+    const bool comparable = image.size() == size_ && image.format() == format_
+                            && hashes_.size() == scratch_.size();
+    if (!comparable) {
+        result.dirty = QRegion(image.rect());
+        result.dirty_tiles = result.total_tiles;
+    } else {
+        // One rectangle per horizontal run of changed tiles
+        for (int ty = 0; ty < tile_rows; ++ty) {
+            int run_start = -1;
+            for (int tx = 0; tx <= columns; ++tx) {
+                const int index = ty * columns + tx;
+                const bool dirty = tx < columns && scratch_[index] != hashes_[index];
+                if (dirty) {
+                    ++result.dirty_tiles;
+                    if (run_start < 0) {
+                        run_start = tx;
+                    }
+                } else if (run_start >= 0) {
+                    const QRect run(run_start * kTileSize, ty * kTileSize,
+                                    (tx - run_start) * kTileSize, kTileSize);
+                    result.dirty += run.intersected(image.rect());
+                    run_start = -1;
+                }
+            }
+        }
+    }
+
+    hashes_.swap(scratch_);
+    size_ = image.size();
+    format_ = image.format();
+
+    result.changed = result.dirty_tiles > 0;
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    if (!result.changed) {
+        static_frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void FFmpegFrameDiff::Reset()
+{
+    hashes_.clear();
+    size_ = QSize();
+    format_ = QImage::Format_Invalid;
+}
+
+double FFmpegFrameDiff::GetStaticFrameRatio() const
+{
+    const quint64 frames = GetFrameCount();
+    return frames > 0 ? static_cast<double>(GetStaticFrameCount()) / frames : 0.0;
+}
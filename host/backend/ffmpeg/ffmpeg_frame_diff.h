@@ -0,0 +1,91 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+#ifndef FFMPEG_FRAME_DIFF_H
+#define FFMPEG_FRAME_DIFF_H
+
+#include <QImage>
+#include <QRegion>
+#include <QSize>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Tile-hash change detection between consecutive decoded frames
+ *
+ * KVM targets mostly show a static desktop. Compare() splits each frame into
+ * kTileSize x kTileSize tiles, checksums every tile and compares the result
+ * with the previous frame's. The outcome tells the consumers what they can
+ * skip:
+ * - an unchanged frame needs no repaint, no upload and no colour conversion
+ *   for the recorder;
+ * - a changed frame comes with the region of tiles that differ.
+ *
+ * The checksum is a Fletcher-style running sum over 32-bit lanes (SSE2 on
+ * x86-64, NEON on ARM64, the same arithmetic in scalar code elsewhere), so
+ * a tile costs one pass over its bytes with no per-pixel branching. The
+ * second-order sum makes it sensitive to where bytes change, not only to
+ * what they add up to.
+ *
+ * Compare() must not be called concurrently with itself; the counters may be
+ * read from any thread.
+ */
+class FFmpegFrameDiff {
+public:
+    static constexpr int kTileSize = 64;
+
+    struct Result {
+        bool changed = true;
+        QRegion dirty;          // Changed tiles in image pixels; the whole frame on a size change
+        int dirty_tiles = 0;
+        int total_tiles = 0;
+    };
+
+    FFmpegFrameDiff();
+
+    // Compares image with the previous call's frame and keeps its hashes
+    Result Compare(const QImage& image);
+
+    // Forgets the previous frame: the next Compare() reports everything changed
+    void Reset();
+
+    quint64 GetFrameCount() const { return frames_.load(std::memory_order_relaxed); }
+    quint64 GetStaticFrameCount() const { return static_frames_.load(std::memory_order_relaxed); }
+    double GetStaticFrameRatio() const;
+
+    // Checksum of rows x width_bytes bytes starting at data
+    static uint64_t HashTile(const uint8_t* data, int stride, int width_bytes, int rows);
+    static const char* IsaName();
+
+private:
+    QSize size_;
+    QImage::Format format_;
+    std::vector<uint64_t> hashes_;
+    std::vector<uint64_t> scratch_;
+
+    std::atomic<quint64> frames_;
+    std::atomic<quint64> static_frames_;
+};
+
+#endif // FFMPEG_FRAME_DIFF_H
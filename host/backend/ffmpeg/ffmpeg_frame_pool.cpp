@@ -0,0 +1,237 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+#include "ffmpeg_frame_pool.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtGlobal>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Row and buffer alignment; keeps every scanline on a cache line boundary so
+// SIMD converters and TurboJPEG can write full vectors.
+constexpr qsizetype kAlignment = 64;
+
+qsizetype AlignUp(qsizetype value)
+{
+    return (value + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+qsizetype BytesPerLine(int width, QImage::Format format)
+{
+    const int bits_per_pixel = QImage::toPixelFormat(format).bitsPerPixel();
+    return AlignUp((static_cast<qsizetype>(width) * bits_per_pixel + 7) / 8);
+}
+
+} // namespace
+
+struct FFmpegFramePool::Buffer {
+    uchar* data = nullptr;
+    qsizetype size_bytes = 0;
+    quint64 generation = 0;
+    // Set only while the buffer is checked out, so an image that outlives the
+    // pool object still has somewhere to return to.
+    std::shared_ptr<State> owner;
+
+    ~Buffer() { qFreeAligned(data); }
+};
+
+struct FFmpegFramePool::State {
+    mutable QMutex mutex;
+    std::vector<std::unique_ptr<Buffer>> buffers;  // Every buffer owned by the pool
+    std::vector<Buffer*> free_list;                // Idle subset of buffers
+    int capacity = 0;
+    qsizetype buffer_bytes = 0;
+    quint64 generation = 0;
+    qint64 allocations = 0;
+    qint64 fallbacks = 0;
+
+    Buffer* AllocateLocked()
+    {
+        auto buffer = std::make_unique<Buffer>();
+        buffer->data = static_cast<uchar*>(qMallocAligned(buffer_bytes, kAlignment));
+        if (!buffer->data) {
+            return nullptr;
+        }
+        buffer->size_bytes = buffer_bytes;
+        buffer->generation = generation;
+        ++allocations;
+        buffers.push_back(std::move(buffer));
+        return buffers.back().get();
+    }
+
+    void DropFreeLocked()
+    {
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                     [this](const std::unique_ptr<Buffer>& buffer) {
+                                         return std::find(free_list.begin(), free_list.end(),
+                                                          buffer.get()) != free_list.end();
+                                     }),
+                      buffers.end());
+        free_list.clear();
+    }
+
+    void EraseLocked(Buffer* buffer)
+    {
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                     [buffer](const std::unique_ptr<Buffer>& candidate) {
+                                         return candidate.get() == buffer;
+                                     }),
+                      buffers.end());
+    }
+
+    void ResizeLocked(qsizetype bytes)
+    {
+        // Buffers still checked out carry the old generation and are freed on
+        // release instead of being recycled.
+        ++generation;
+        buffer_bytes = bytes;
+        DropFreeLocked();
+    }
+};
+
+FFmpegFramePool::FFmpegFramePool(int capacity)
+    : state_(std::make_shared<State>())
+{
+    state_->capacity = qMax(1, capacity);
+}
+
+FFmpegFramePool::~FFmpegFramePool() = default;
+
+void FFmpegFramePool::Configure(const QSize& max_frame_size)
+{
+    if (max_frame_size.isEmpty()) {
+        return;
+    }
+
+    const qsizetype bytes = BytesPerLine(max_frame_size.width(), QImage::Format_ARGB32)
+                            * max_frame_size.height();
+
+    QMutexLocker locker(&state_->mutex);
+    if (bytes != state_->buffer_bytes) {
+        state_->ResizeLocked(bytes);
+    }
+    while (static_cast<int>(state_->buffers.size()) < state_->capacity) {
+        Buffer* buffer = state_->AllocateLocked();
+        if (!buffer) {
+            break;
+        }
+        state_->free_list.push_back(buffer);
+    }
+}
+
+void FFmpegFramePool::SetCapacity(int capacity)
+{
+    QMutexLocker locker(&state_->mutex);
+    state_->capacity = qMax(1, capacity);
+    while (static_cast<int>(state_->buffers.size()) > state_->capacity
+           && !state_->free_list.empty()) {
+        Buffer* idle = state_->free_list.back();
+        state_->free_list.pop_back();
+        state_->EraseLocked(idle);
+    }
+}
+
+QImage FFmpegFramePool::Acquire(const QSize& size, QImage::Format format)
+{
+    if (size.isEmpty() || format == QImage::Format_Invalid) {
+        return QImage();
+    }
+
+    const qsizetype bytes_per_line = BytesPerLine(size.width(), format);
+    const qsizetype needed = bytes_per_line * size.height();
+
+    Buffer* buffer = nullptr;
+    {
+        QMutexLocker locker(&state_->mutex);
+        if (needed > state_->buffer_bytes) {
+            // Source resolution grew beyond what Configure() was told about.
+            state_->ResizeLocked(needed);
+        }
+
+        if (!state_->free_list.empty()) {
+            buffer = state_->free_list.back();
+            state_->free_list.pop_back();
+        } else if (static_cast<int>(state_->buffers.size()) < state_->capacity) {
+            buffer = state_->AllocateLocked();
+        }
+
+        if (!buffer) {
+            ++state_->fallbacks;
+        } else {
+            buffer->owner = state_;
+        }
+    }
+
+    if (!buffer) {
+        return QImage(size, format);
+    }
+
+    return QImage(buffer->data, size.width(), size.height(), bytes_per_line, format,
+                  &FFmpegFramePool::ReleaseBuffer, buffer);
+}
+
+void FFmpegFramePool::Clear()
+{
+    QMutexLocker locker(&state_->mutex);
+    state_->ResizeLocked(state_->buffer_bytes);
+}
+
+FFmpegFramePool::Stats FFmpegFramePool::GetStats() const
+{
+    QMutexLocker locker(&state_->mutex);
+    Stats stats;
+    stats.capacity = state_->capacity;
+    stats.allocated = static_cast<int>(state_->buffers.size());
+    stats.free = static_cast<int>(state_->free_list.size());
+    stats.allocations = state_->allocations;
+    stats.fallbacks = state_->fallbacks;
+    return stats;
+}
+
+void FFmpegFramePool::ReleaseBuffer(void* info)
+{
+    Buffer* buffer = static_cast<Buffer*>(info);
+    if (!buffer) {
+        return;
+    }
+
+    // Take the owner reference first: if this is the last one, the state (and
+    // with it this buffer) is destroyed only after the locker below unlocks.
+    std::shared_ptr<State> state = std::move(buffer->owner);
+    if (!state) {
+        return;
+    }
+
+    QMutexLocker locker(&state->mutex);
+    if (buffer->generation == state->generation
+        && static_cast<int>(state->buffers.size()) <= state->capacity) {
+        state->free_list.push_back(buffer);
+        return;
+    }
+
+    state->EraseLocked(buffer);
+}
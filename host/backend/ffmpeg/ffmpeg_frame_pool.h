@@ -0,0 +1,90 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+#ifndef FFMPEG_FRAME_POOL_H
+#define FFMPEG_FRAME_POOL_H
+
+#include <QImage>
+#include <QSize>
+#include <memory>
+
+/**
+ * @brief Fixed-size pool of recycled decode buffers handed out as QImages
+ *
+ * Every buffer is sized for the negotiated capture resolution at 4 bytes per
+ * pixel, so any decode output that fits (RGB888 or ARGB32, full size or
+ * DCT-downscaled) reuses an existing allocation. The QImage returned by
+ * Acquire() wraps the pooled memory directly; Qt's implicit sharing keeps the
+ * buffer alive while the image is referenced by latest-frame storage, a queued
+ * frameReadyImage signal or the recorder, and the image cleanup hook returns
+ * it to the pool once the last reference is dropped - on whichever thread
+ * that happens to be.
+ *
+ * When all buffers are checked out Acquire() falls back to a regular heap
+ * QImage, so a slow consumer degrades to the old behaviour instead of stalling
+ * the capture thread.
+ */
+class FFmpegFramePool {
+public:
+    static constexpr int kDefaultCapacity = 6;
+
+    struct Stats {
+        int capacity = 0;          // Maximum number of pooled buffers
+        int allocated = 0;         // Buffers currently owned by the pool
+        int free = 0;              // Buffers waiting to be reused
+        qint64 allocations = 0;    // Buffer allocations since creation
+        qint64 fallbacks = 0;      // Acquire() calls served from the heap
+    };
+
+    explicit FFmpegFramePool(int capacity = kDefaultCapacity);
+    ~FFmpegFramePool();
+
+    FFmpegFramePool(const FFmpegFramePool&) = delete;
+    FFmpegFramePool& operator=(const FFmpegFramePool&) = delete;
+
+    // Size buffers for the given capture resolution and pre-allocate them so
+    // steady-state capture performs no per-frame buffer allocations.
+    void Configure(const QSize& max_frame_size);
+
+    // Changes the buffer limit; idle buffers above a lower limit are freed now,
+    // busy ones when they are released.
+    void SetCapacity(int capacity);
+
+    // Returns an image backed by a pooled buffer (or a heap image if exhausted).
+    QImage Acquire(const QSize& size, QImage::Format format);
+
+    // Drops all idle buffers; buffers still in use are freed when released.
+    void Clear();
+
+    Stats GetStats() const;
+
+private:
+    struct Buffer;
+    struct State;
+
+    static void ReleaseBuffer(void* info);
+
+    std::shared_ptr<State> state_;
+};
+
+#endif // FFMPEG_FRAME_POOL_H
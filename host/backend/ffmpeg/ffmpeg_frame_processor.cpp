@@ -21,9 +21,12 @@
 */
 
 #include "ffmpeg_frame_processor.h"
+#include "ffmpeg_pixel_converter.h"
+#include "host/frametiming.h"
 #include <QLoggingCategory>
 #include <QDebug>
 #include <QThread>
+#include <QtMath>
 #include <cstring>
 #include <vector>
 #include <algorithm>
@@ -35,6 +38,73 @@ extern "C" {
 
 Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
 
+namespace {
+
+// Walks the JPEG marker segments up to the start of scan. Returns true when the
+// data is a complete baseline/progressive JPEG that any decoder can open on its
+// own: SOI first, Huffman tables present (many UVC devices omit DHT and rely on
+// the MJPEG default tables), a frame header, and EOI at the end.
+bool InspectStandaloneJpeg(const uint8_t* data, int size, QSize* dimensions)
+{
+    if (!data || size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+
+    bool has_huffman_tables = false;
+    bool reached_scan = false;
+    QSize frame_size;
+    int pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        const uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {
+            ++pos;  // Fill byte
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+            pos += 2;  // Standalone markers carry no length
+            continue;
+        }
+
+        const int length = (data[pos + 2] << 8) | data[pos + 3];
+        if (length < 2 || pos + 2 + length > size) {
+            return false;
+        }
+        if (marker == 0xC4) {
+            has_huffman_tables = true;
+        } else if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC8 && marker != 0xCC) {
+            // SOFn: precision(1) height(2) width(2)
+            if (length >= 8) {
+                frame_size = QSize((data[pos + 7] << 8) | data[pos + 8], (data[pos + 5] << 8) | data[pos + 6]);
+            }
+        } else if (marker == 0xDA) {
+            reached_scan = true;
+            break;
+        }
+        pos += 2 + length;
+    }
+
+    if (!reached_scan || !has_huffman_tables || frame_size.isEmpty()) {
+        return false;
+    }
+
+    // Capture drivers may pad the packet after EOI
+    const int tail_start = qMax(pos, size - 32);
+    for (int i = size - 2; i >= tail_start; --i) {
+        if (data[i] == 0xFF && data[i + 1] == 0xD9) {
+            if (dimensions) {
+                *dimensions = frame_size;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
 FFmpegFrameProcessor::FFmpegFrameProcessor()
     : sws_context_(nullptr)
     , last_width_(-1)
@@ -50,6 +120,12 @@ FFmpegFrameProcessor::FFmpegFrameProcessor()
     , dropped_frames_(0)
     , frame_count_(0)
     , startup_frames_to_skip_(0)           // Don't skip startup frames for MJPEG
+    , region_frames_since_full_(0)
+    , decode_region_enabled_(true)
+    , frame_pool_extra_(0)
+    , frame_pool_reserve_(0)
+    , governor_downscale_enabled_(true)
+    , turbojpeg_enabled_(true)
     , stop_requested_(false)
 #ifdef HAVE_LIBJPEG_TURBO
     , turbojpeg_handle_(nullptr)
@@ -70,6 +146,9 @@ FFmpegFrameProcessor::FFmpegFrameProcessor()
     }
 #endif
 
+    qCDebug(log_ffmpeg_backend) << "Raw format converters use"
+                                << FFmpegPixelConverter::IsaName(FFmpegPixelConverter::Best().isa) << "kernels";
+
     // Start high-resolution process timer used for frame pacing decisions
     last_process_timer_.start();
 
@@ -176,16 +255,57 @@ void FFmpegFrameProcessor::ResetFrameCount()
     last_process_timer_.restart();
 }
 
+void FFmpegFrameProcessor::ConfigureFramePool(const QSize& capture_resolution, int extra_frames_in_flight)
+{
+    if (!capture_resolution.isValid() || capture_resolution.isEmpty()) {
+        return;
+    }
+
+    // Pipelined decoding keeps one frame per worker plus the reorder window
+    // checked out on top of what the display and recorder hold.
+    frame_pool_extra_ = qMax(0, extra_frames_in_flight);
+    frame_pool_.SetCapacity(FFmpegFramePool::kDefaultCapacity + frame_pool_extra_ + frame_pool_reserve_);
+    frame_pool_.Configure(capture_resolution);
+    FFmpegFramePool::Stats stats = frame_pool_.GetStats();
+    qCDebug(log_ffmpeg_backend) << "Frame pool configured for" << capture_resolution
+                               << "buffers:" << stats.allocated << "/" << stats.capacity;
+}
+
+void FFmpegFrameProcessor::SetFramePoolReserve(int frames)
+{
+    // Only raises the limit; the extra buffers are allocated on demand and
+    // trimmed again once the reserve is released.
+    frame_pool_reserve_ = qMax(0, frames);
+    frame_pool_.SetCapacity(FFmpegFramePool::kDefaultCapacity + frame_pool_extra_ + frame_pool_reserve_);
+}
+
 QImage FFmpegFrameProcessor::GetLatestFrame() const
 {
+    // Frames are never written after being published, so handing out a shared
+    // reference is safe; a caller that modifies it gets its own copy via COW.
     QMutexLocker locker(&mutex_);
-    return latest_frame_.copy();
+    return latest_frame_;
 }
 
-QImage FFmpegFrameProcessor::GetLatestOriginalFrame() const
+QImage FFmpegFrameProcessor::GetLatestOriginalFrame(bool decode_if_missing) const
 {
+    QByteArray mjpeg;
+    {
+        QMutexLocker locker(&mutex_);
+        if (!latest_original_frame_.isNull() || !decode_if_missing || latest_mjpeg_.isEmpty()) {
+            return latest_original_frame_;
+        }
+        mjpeg = latest_mjpeg_;
+    }
+    
+    // Only the display copy of this frame was decoded: screenshots still get
+    // full resolution, decoded here rather than for every frame
+    QImage original = QImage::fromData(mjpeg, "JPEG");
     QMutexLocker locker(&mutex_);
-    return latest_original_frame_.copy();
+    if (latest_original_frame_.isNull() && latest_mjpeg_.isSharedWith(mjpeg)) {
+        latest_original_frame_ = original;
+    }
+    return original;
 }
 
 QSize FFmpegFrameProcessor::GetNativeJpegSize() const
@@ -194,14 +314,31 @@ QSize FFmpegFrameProcessor::GetNativeJpegSize() const
     return native_jpeg_size_;
 }
 
+QByteArray FFmpegFrameProcessor::GetLatestMjpegFrame(QSize* size) const
+{
+    QMutexLocker locker(&mutex_);
+    if (size) {
+        *size = latest_mjpeg_size_;
+    }
+    return latest_mjpeg_;
+}
+
 bool FFmpegFrameProcessor::ShouldDropFrame(bool is_recording)
 {
     // Use high-resolution elapsed time (microsecond precision) to avoid millisecond rounding errors.
     qint64 elapsed_us = last_process_timer_.nsecsElapsed() / 1000; // microseconds since last restart
     qint64 threshold_us = (is_recording ? frame_drop_threshold_recording_ : frame_drop_threshold_display_) * 1000LL;
+    
+    // Display frame-rate cap from the decode governor. Allow 10% early so
+    // camera jitter does not drop every other frame at the capped rate.
+    const int governor_fps = governor_.GetLevel().max_fps;
+    if (!is_recording && governor_fps > 0) {
+        threshold_us = qMax(threshold_us, 900000LL / governor_fps);
+    }
 
     if (elapsed_us < threshold_us) {
         ++dropped_frames_;
+        FrameTimingRecorder::instance().recordDrop(FrameTimingRecorder::RateLimited);
         return true;
     }
 
@@ -232,75 +369,313 @@ bool FFmpegFrameProcessor::IsHardwareDecoder(const AVCodecContext* codec_context
 }
 
 
-QImage FFmpegFrameProcessor::ProcessPacketToImage(AVPacket* packet, AVCodecContext* codec_context, 
-                                                   bool is_recording, const QSize& targetSize)
+FFmpegFrameProcessor::DecodedFrame FFmpegFrameProcessor::ProcessPacket(AVPacket* packet,
+                                                                       AVCodecContext* codec_context,
+                                                                       bool is_recording, const QSize& targetSize)
 {
     if (stop_requested_) {
-        return QImage();
+        return DecodedFrame();
     }
     
     if (!packet || !codec_context) {
-        return QImage();
+        return DecodedFrame();
     }
     
     // Validate packet data
     if (packet->size <= 0 || !packet->data) {
-        return QImage();
+        return DecodedFrame();
     }
     
     // Frame dropping for responsiveness
     if (ShouldDropFrame(is_recording)) {
-        return QImage();
+        return DecodedFrame();
+    }
+    
+    DecodedFrame frame = DecodePacket(packet, codec_context, targetSize);
+    if (!PublishFrame(&frame)) {
+        return DecodedFrame();
+    }
+    
+    return frame;  // wraps a pooled buffer shared with latest_frame_; no deep copy needed
+}
+
+FFmpegFrameProcessor::DecodedFrame FFmpegFrameProcessor::DecodePacket(AVPacket* packet,
+                                                                      AVCodecContext* codec_context,
+                                                                      const QSize& targetSize)
+{
+    if (stop_requested_ || !packet || !codec_context || packet->size <= 0 || !packet->data) {
+        return DecodedFrame();
     }
     
+    DecodedFrame frame;
+    QElapsedTimer decode_timer;
+    decode_timer.start();
+    
     // PRIORITY 1: Hardware acceleration decoding (highest priority)
     // Check if codec is a hardware decoder before attempting decode
     bool is_hardware_decoder = IsHardwareDecoder(codec_context);
     if (is_hardware_decoder) {
         qCDebug(log_ffmpeg_backend) << "Using hardware decoder:" << codec_context->codec->name;
         // Proceed directly to FFmpeg hardware decoding
-        return ProcessWithFFmpegDecoding(packet, codec_context, is_recording, targetSize);
-    }
-    
+        frame = ProcessWithFFmpegDecoding(packet, codec_context, targetSize);
+    } else {
 #ifdef HAVE_LIBJPEG_TURBO
-    // PRIORITY 2: TurboJPEG acceleration (for MJPEG only, when no hardware acceleration)
-    if (codec_context->codec_id == AV_CODEC_ID_MJPEG) {
-        tjhandle handle = GetThreadLocalTurboJPEGHandle();
-        if (handle) {
-            QImage turbojpeg_result = DecodeMJPEGWithTurboJPEG(packet, targetSize, handle);
-            if (!turbojpeg_result.isNull()) {
-                // qCDebug(log_ffmpeg_backend) << "Successfully decoded with TurboJPEG acceleration";
-                // Don't scale here — the display layer (VideoPane) handles aspect-ratio-
-                // preserving fit with centering (letterboxing/pillarboxing).  Scaling to
-                // a narrow target with KeepAspectRatio would shrink the video unnecessarily.
-
-                // Update frame count and store frames
-                frame_count_++;
-                if (frame_count_ > startup_frames_to_skip_) {
-                    QMutexLocker locker(&mutex_);
-                    latest_frame_ = turbojpeg_result.copy();
-                    latest_original_frame_ = turbojpeg_result.copy();
+        // PRIORITY 2: TurboJPEG acceleration (for MJPEG only, when no hardware acceleration)
+        if (codec_context->codec_id == AV_CODEC_ID_MJPEG && turbojpeg_enabled_) {
+            // Each calling thread gets its own decompressor, so pipeline workers
+            // decode independent packets without any shared decoder state.
+            tjhandle handle = GetThreadLocalTurboJPEGHandle();
+            if (handle) {
+                QRect region;
+                bool governor_scaled = false;
+                QImage turbojpeg_result = DecodeMJPEGWithTurboJPEG(packet, targetSize, handle,
+                                                                   &region, &governor_scaled);
+                if (!turbojpeg_result.isNull()) {
+                    // Don't scale here — the display layer (VideoPane) handles aspect-ratio-
+                    // preserving fit with centering (letterboxing/pillarboxing).  Scaling to
+                    // a narrow target with KeepAspectRatio would shrink the video unnecessarily.
+                    frame.image = turbojpeg_result;
+                    if (!region.isEmpty()) {
+                        frame.region = region;  // Completed by PublishFrame()
+                    } else if (!governor_scaled) {
+                        frame.original = turbojpeg_result;  // Governor-scaled frames are display only
+                    }
                 }
-
-                return turbojpeg_result;
+            }
+            if (frame.IsNull()) {
+                qCDebug(log_ffmpeg_backend) << "TurboJPEG failed, falling back to CPU decode";
             }
         }
-        qCDebug(log_ffmpeg_backend) << "TurboJPEG failed, falling back to CPU decode";
-    }
 #endif
+        
+        // PRIORITY 3: CPU direct decoding (fallback when no acceleration available)
+        if (frame.IsNull()) {
+            qCDebug(log_ffmpeg_backend) << "Using CPU decoder:" << codec_context->codec->name;
+            frame = ProcessWithFFmpegDecoding(packet, codec_context, targetSize);
+        }
+    }
+    
+    // Keep the compressed source alongside the pixels: screenshot and remote
+    // consumers can then serve the camera's own JPEG without re-encoding.
+    // The copy runs here, on the decoding thread, never on the reader thread.
+    if (!frame.IsNull() && codec_context->codec_id == AV_CODEC_ID_MJPEG
+        && InspectStandaloneJpeg(packet->data, packet->size, &frame.mjpeg_size)) {
+        frame.mjpeg = QByteArray(reinterpret_cast<const char*>(packet->data), packet->size);
+    }
+    
+    if (!frame.IsNull()) {
+        governor_.RecordFrame(decode_timer.nsecsElapsed() / 1e6);
+    }
+    
+    return frame;
+}
+
+bool FFmpegFrameProcessor::PublishFrame(DecodedFrame* frame)
+{
+    if (!frame || frame->IsNull()) {
+        return false;
+    }
+    
+    // Skip startup frames if configured
+    if (++frame_count_ <= startup_frames_to_skip_) {
+        return false;
+    }
+    
+    // Store frames.  The pooled images are shared by reference (QImage COW
+    // ref-counting is thread-safe); a buffer returns to the pool once the GUI
+    // and the next published frame have both released it.
+    QMutexLocker locker(&mutex_);
+    if (frame->IsRegionComposite()) {
+        if (!ComposeRegionLocked(frame)) {
+            return false;
+        }
+        // Only the display frame advances: outside the region it is up to a
+        // refresh interval old, which screenshots must not pick up
+        latest_frame_ = frame->image;
+        return true;
+    }
+    
+    if (!decode_region_.isEmpty() && frame->image.size() == native_jpeg_size_
+        && frame->image.format() == QImage::Format_RGB888) {
+        region_canvas_ = frame->image;  // Base for the following region decodes
+    } else {
+        region_canvas_ = QImage();
+    }
+    region_spare_ = QImage();
+    
+    latest_frame_ = frame->image;               // Frame for display
+    latest_original_frame_ = frame->original;   // Original frame for screenshots
+    latest_mjpeg_ = frame->mjpeg;               // Cleared too when this frame has none
+    latest_mjpeg_size_ = frame->mjpeg_size;
+    return true;
+}
+
+bool FFmpegFrameProcessor::ComposeRegionLocked(DecodedFrame* frame)
+{
+    const QRect region = frame->region;
+    const QImage patch = frame->image;
+    const QImage canvas = region_canvas_;
+    if (canvas.isNull() || !canvas.rect().contains(region) || patch.size() != region.size()
+        || patch.format() != canvas.format()) {
+        return false;  // Region reset or resolution changed while this frame was decoding
+    }
+    
+    const int bytes_per_pixel = canvas.depth() / 8;
+    auto copy_rect = [bytes_per_pixel](const QImage& src, const QPoint& from, QImage* dst, const QRect& to) {
+        const qsizetype row_bytes = static_cast<qsizetype>(to.width()) * bytes_per_pixel;
+        for (int y = 0; y < to.height(); ++y) {
+            memcpy(dst->scanLine(to.top() + y) + to.left() * bytes_per_pixel,
+                   src.constScanLine(from.y() + y) + from.x() * bytes_per_pixel, row_bytes);
+        }
+    };
     
-    // PRIORITY 3: CPU direct decoding (fallback when no acceleration available)
-    qCDebug(log_ffmpeg_backend) << "Using CPU decoder:" << codec_context->codec->name;
-    return ProcessWithFFmpegDecoding(packet, codec_context, is_recording, targetSize);
+    // The previous canvas is normally free again by now; bringing it up to
+    // date only takes the area the last region decode changed. Otherwise
+    // start from a full copy of the current canvas.
+    QImage image;
+    if (region_spare_.size() == canvas.size() && region_spare_.format() == canvas.format()
+        && region_spare_.isDetached()) {
+        image = std::move(region_spare_);
+        copy_rect(canvas, region_spare_stale_.topLeft(), &image, region_spare_stale_);
+    } else {
+        image = frame_pool_.Acquire(canvas.size(), canvas.format());
+        if (image.isNull()) {
+            return false;
+        }
+        copy_rect(canvas, QPoint(0, 0), &image, canvas.rect());
+    }
+    copy_rect(patch, QPoint(0, 0), &image, region);
+    
+    region_spare_ = canvas;
+    region_spare_stale_ = region;
+    region_canvas_ = image;
+    frame->image = image;
+    return true;
+}
+
+bool FFmpegFrameProcessor::SupportsParallelDecode(const AVCodecContext* codec_context) const
+{
+#ifdef HAVE_LIBJPEG_TURBO
+    return codec_context && codec_context->codec_id == AV_CODEC_ID_MJPEG
+           && !IsHardwareDecoder(codec_context);
+#else
+    // libavcodec decoding shares one codec context and is serialised anyway
+    Q_UNUSED(codec_context);
+    return false;
+#endif
+}
+
+void FFmpegFrameProcessor::SetDecodeRegion(const QRectF& region)
+{
+    QRectF normalized = region.intersected(QRectF(0.0, 0.0, 1.0, 1.0));
+    QMutexLocker locker(&mutex_);
+    if (normalized == decode_region_) {
+        return;
+    }
+    decode_region_ = normalized;
+    if (decode_region_.isEmpty()) {
+        region_canvas_ = QImage();  // Give the buffers back to the pool
+        region_spare_ = QImage();
+    }
+    qCDebug(log_ffmpeg_backend) << "Decode region set to" << decode_region_;
+}
+
+void FFmpegFrameProcessor::ConfigureDecodeGovernor(const FFmpegDecodeGovernor::Config& config)
+{
+    governor_.SetConfig(config);
+    if (governor_.IsEnabled()) {
+        qCInfo(log_ffmpeg_backend) << "Decode governor: budget" << config.budget_ms << "ms/frame, starting at"
+                                   << governor_.Describe();
+    } else {
+        qCInfo(log_ffmpeg_backend) << "Decode governor disabled";
+    }
+}
+
+void FFmpegFrameProcessor::ConfigureStripDecode(int threads)
+{
+#ifdef HAVE_LIBJPEG_TURBO
+    restart_decoder_.SetThreadCount(FFmpegRestartDecoder::ResolveThreadCount(threads));
+#else
+    Q_UNUSED(threads);
+#endif
+}
+
+void FFmpegFrameProcessor::SetDecodeRegionEnabled(bool enabled)
+{
+    decode_region_enabled_ = enabled;
+}
+
+bool FFmpegFrameProcessor::SupportsRegionDecode(const AVCodecContext* codec_context) const
+{
+#ifdef HAVE_TURBOJPEG_CROP
+    return decode_region_enabled_ && turbojpeg_enabled_
+           && codec_context && codec_context->codec_id == AV_CODEC_ID_MJPEG
+           && !IsHardwareDecoder(codec_context);
+#else
+    Q_UNUSED(codec_context);
+    return false;
+#endif
+}
+
+QRect FFmpegFrameProcessor::RegionToDecode(const QSize& native_size, int subsamp)
+{
+#ifdef HAVE_TURBOJPEG_CROP
+    // Widen the region a little so scrolling shows fresh pixels before the
+    // new region arrives from the GUI thread
+    static constexpr int kRegionMargin = 32;
+    // Full decode every N frames keeps the hidden area and screenshots current
+    static constexpr int kFullRefreshFrames = 30;
+    // Above this share of the frame a cropped decode saves too little
+    static constexpr double kMaxRegionFraction = 0.7;
+
+    if (!decode_region_enabled_ || subsamp < 0 || subsamp >= TJ_NUMSAMP) {
+        return QRect();
+    }
+
+    QMutexLocker locker(&mutex_);
+    if (decode_region_.isEmpty() || region_canvas_.size() != native_size
+        || ++region_frames_since_full_ >= kFullRefreshFrames) {
+        region_frames_since_full_ = 0;
+        return QRect();
+    }
+
+    const int width = native_size.width();
+    const int height = native_size.height();
+    QRect region(qFloor(decode_region_.left() * width) - kRegionMargin,
+                 qFloor(decode_region_.top() * height) - kRegionMargin,
+                 qCeil(decode_region_.width() * width) + 2 * kRegionMargin,
+                 qCeil(decode_region_.height() * height) + 2 * kRegionMargin);
+    region = region.intersected(QRect(0, 0, width, height));
+
+    // TurboJPEG crops horizontally on iMCU boundaries only
+    const int mcu_width = tjMCUWidth[subsamp];
+    region.setLeft(region.left() / mcu_width * mcu_width);
+
+    if (region.isEmpty()
+        || static_cast<double>(region.width()) * region.height() > kMaxRegionFraction * width * height) {
+        return QRect();
+    }
+    return region;
+#else
+    Q_UNUSED(native_size);
+    Q_UNUSED(subsamp);
+    return QRect();
+#endif
 }
 
-QImage FFmpegFrameProcessor::ProcessWithFFmpegDecoding(AVPacket* packet, AVCodecContext* codec_context,
-                                                      bool /*is_recording*/, const QSize& targetSize)
+FFmpegFrameProcessor::DecodedFrame FFmpegFrameProcessor::ProcessWithFFmpegDecoding(AVPacket* packet,
+                                                                                   AVCodecContext* codec_context,
+                                                                                   const QSize& targetSize)
 {
+    // codec_context, temp_frame_ and the scaling context are single-threaded
+    // resources; a TurboJPEG failure on a pipeline worker can land here while
+    // another worker is still inside.
+    QMutexLocker decode_locker(&decode_mutex_);
+
     if (!temp_frame_) {
         temp_frame_ = make_av_frame();
         if (!temp_frame_) {
-            return QImage();
+            return DecodedFrame();
         }
     }
 
@@ -311,7 +686,7 @@ QImage FFmpegFrameProcessor::ProcessWithFFmpegDecoding(AVPacket* packet, AVCodec
         av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
         qCWarning(log_ffmpeg_backend) << "avcodec_send_packet failed:" << QString::fromUtf8(errbuf)
                                       << "packet size:" << packet->size;
-        return QImage();
+        return DecodedFrame();
     }
 
     // Receive frame from decoder
@@ -322,14 +697,14 @@ QImage FFmpegFrameProcessor::ProcessWithFFmpegDecoding(AVPacket* packet, AVCodec
             av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
             qCWarning(log_ffmpeg_backend) << "avcodec_receive_frame failed:" << QString::fromUtf8(errbuf);
         }
-        return QImage();
+        return DecodedFrame();
     }
     
     // Validate frame data
     if (!AV_FRAME_RAW(temp_frame_)->data[0] || 
         AV_FRAME_RAW(temp_frame_)->width <= 0 || 
         AV_FRAME_RAW(temp_frame_)->height <= 0) {
-        return QImage();
+        return DecodedFrame();
     }
     
     // Handle hardware frames
@@ -342,12 +717,12 @@ QImage FFmpegFrameProcessor::ProcessWithFFmpegDecoding(AVPacket* packet, AVCodec
     if (is_hardware_frame) {
         sw_frame = make_av_frame();
         if (!sw_frame) {
-            return QImage();
+            return DecodedFrame();
         }
         
         ret = av_hwframe_transfer_data(AV_FRAME_RAW(sw_frame), AV_FRAME_RAW(temp_frame_), 0);
         if (ret < 0) {
-            return QImage();
+            return DecodedFrame();
         }
         
         av_frame_copy_props(AV_FRAME_RAW(sw_frame), AV_FRAME_RAW(temp_frame_));
@@ -360,46 +735,26 @@ QImage FFmpegFrameProcessor::ProcessWithFFmpegDecoding(AVPacket* packet, AVCodec
     QSize frameSize(frame_width, frame_height);
     bool needOriginal = targetSize.isValid() && !targetSize.isEmpty() && targetSize != frameSize;
     
-    QImage result;
-    QImage originalResult;
+    DecodedFrame result;
     
     if (needOriginal) {
         // OPTIMIZATION: Convert NV12→RGB once at full resolution, then use Qt's
         // fast RGB rescaler for the display-size copy.  This avoids running the
         // comparatively expensive sws_scale (YUV→RGB) twice on the same frame.
-        originalResult = ConvertFrameToImage(frame_to_convert, QSize());  // full-res RGB
-        result = originalResult.scaled(targetSize, Qt::IgnoreAspectRatio, // pure RGB resize
-                                       Qt::SmoothTransformation);
+        result.original = ConvertFrameToImage(frame_to_convert, QSize());  // full-res RGB
+        result.image = result.original.scaled(targetSize, Qt::IgnoreAspectRatio, // pure RGB resize
+                                              Qt::SmoothTransformation);
     } else {
         // Only need one version (either scaled or original)
-        result = ConvertFrameToImage(frame_to_convert, targetSize.isValid() ? targetSize : QSize());
-        originalResult = result;  // Same image serves as both
+        result.image = ConvertFrameToImage(frame_to_convert, targetSize.isValid() ? targetSize : QSize());
+        result.original = result.image;  // Same image serves as both
     }
     
     if (sw_frame) {
         AV_FRAME_RESET(sw_frame);
     }
     
-    // Update statistics and store latest frames
-    if (!result.isNull()) {
-        frame_count_++;
-        
-        // Skip startup frames if configured
-        if (frame_count_ <= startup_frames_to_skip_) {
-            return QImage();
-        }
-        
-        // Store frames.  QImage uses Qt's COW (copy-on-write) ref-counting which is
-        // thread-safe for shared ownership, so no redundant deep copy is needed here.
-        // The mutex protects the assignment of the pointer/ref-count itself.
-        {
-            QMutexLocker locker(&mutex_);
-            latest_frame_ = result;          // Frame for display (COW shared, deep copy on first write)
-            latest_original_frame_ = originalResult;  // Original frame for screenshots
-        }
-    }
-    
-    return result;  // result is a freshly-allocated QImage; no extra deep copy needed
+    return result;
 }
 
 QImage FFmpegFrameProcessor::ConvertFrameToImage(AVFrame* frame, const QSize& targetSize)
@@ -428,24 +783,35 @@ QImage FFmpegFrameProcessor::ConvertFrameToImage(AVFrame* frame, const QSize& ta
         }
     }
 
+    const bool nativeSize = !effectiveTarget.isValid() ||
+        (effectiveTarget.width() == width && effectiveTarget.height() == height);
+
+    // FASTEST PATH: raw capture formats at native size go through the SIMD
+    // converters straight into RGB32 - no swscale context lookup or lock
+    if (nativeSize && FFmpegPixelConverter::CanConvert(format)) {
+        QImage image = frame_pool_.Acquire(QSize(width, height), QImage::Format_RGB32);
+        if (!image.isNull() && FFmpegPixelConverter::ConvertFrame(frame, &image)) {
+            return image;
+        }
+    }
+
     // OPTIMIZATION: Skip conversion entirely if frame already matches (effective) target
     if (effectiveTarget.isValid() && 
         frame->width == effectiveTarget.width() && 
         frame->height == effectiveTarget.height() &&
-        (format == AV_PIX_FMT_RGB24 || format == AV_PIX_FMT_BGR24)) {
-        // Direct copy without scaling - FASTEST PATH
+        format == AV_PIX_FMT_RGB24) {
+        // Direct copy without scaling
         return ConvertRgbFrameDirectlyToImage(frame);
     }
 
-    // Try fast path for RGB formats only if no scaling needed
-    if ((format == AV_PIX_FMT_RGB24 || format == AV_PIX_FMT_BGR24 || 
-         format == AV_PIX_FMT_RGBA || format == AV_PIX_FMT_BGRA ||
-         format == AV_PIX_FMT_BGR0 || format == AV_PIX_FMT_RGB0) &&
+    // Try fast path for RGB24 only if no scaling needed
+    if (format == AV_PIX_FMT_RGB24 &&
         (!effectiveTarget.isValid() || (effectiveTarget.width() == width && effectiveTarget.height() == height))) {
         return ConvertRgbFrameDirectlyToImage(frame);  // Already returns deep copy
     }
 
-    // Use scaling for other formats or when target size is specified
+    // Use scaling for other formats (including 32-bit RGB, which swscale
+    // swizzles) or when target size is specified
     return ConvertWithScalingToImage(frame, effectiveTarget);  // Already returns deep copy
 }
 
@@ -454,30 +820,23 @@ QImage FFmpegFrameProcessor::ConvertRgbFrameDirectlyToImage(AVFrame* frame) {
     int width = frame->width;
     int height = frame->height;
 
-    // Allocate a new QImage with its own memory
-    QImage image(width, height, QImage::Format_RGB888);
+    // RGB24 only: a pooled buffer that is not fully overwritten would show
+    // an earlier frame. BGR24 is handled by FFmpegPixelConverter.
+    if (format != AV_PIX_FMT_RGB24) {
+        return ConvertWithScalingToImage(frame, QSize(width, height));
+    }
+
+    // Pooled buffer; the image owns it exclusively until it is published
+    QImage image = frame_pool_.Acquire(QSize(width, height), QImage::Format_RGB888);
     if (image.isNull()) {
         return QImage();
     }
 
-    if (format == AV_PIX_FMT_RGB24) {
-        // Direct copy
-        for (int y = 0; y < height; ++y) {
-            memcpy(image.scanLine(y), frame->data[0] + y * frame->linesize[0], width * 3);
-        }
-    } else if (format == AV_PIX_FMT_BGR24) {
-        // BGR to RGB conversion during copy
-        for (int y = 0; y < height; ++y) {
-            const uint8_t* src = frame->data[0] + y * frame->linesize[0];
-            uint8_t* dst = image.scanLine(y);
-            for (int x = 0; x < width; ++x) {
-                dst[x*3+0] = src[x*3+2]; // R = B
-                dst[x*3+1] = src[x*3+1]; // G = G
-                dst[x*3+2] = src[x*3+0]; // B = R
-            }
-        }
+    // Direct copy
+    for (int y = 0; y < height; ++y) {
+        memcpy(image.scanLine(y), frame->data[0] + y * frame->linesize[0], width * 3);
     }
-    return image; // Fully independent
+    return image;
 }
 
 QImage FFmpegFrameProcessor::ConvertWithScalingToImage(AVFrame* frame, const QSize& targetSize)
@@ -507,7 +866,7 @@ QImage FFmpegFrameProcessor::ConvertWithScalingToImage(AVFrame* frame, const QSi
     // (24-bit unaligned, 3 bytes/pixel).  sws_scale writes BGRA which maps directly
     // to QImage::Format_ARGB32 on little-endian platforms (BGRA bytes = 0xAARRGGBB).
     // 32-bit alignment lets SIMD gather/scatter operate on natural word boundaries.
-    QImage image(targetWidth, targetHeight, QImage::Format_ARGB32);
+    QImage image = frame_pool_.Acquire(QSize(targetWidth, targetHeight), QImage::Format_ARGB32);
     if (image.isNull()) {
         return QImage();
     }
@@ -537,11 +896,12 @@ QImage FFmpegFrameProcessor::ConvertWithScalingToImage(AVFrame* frame, const QSi
         return QImage();
     }
     
-    return image;  // image was constructed fresh above with its own storage; no copy needed
+    return image;  // pooled buffer owned solely by this image; no copy needed
 }
 
 #ifdef HAVE_LIBJPEG_TURBO
-QImage FFmpegFrameProcessor::DecodeMJPEGWithTurboJPEG(AVPacket* packet, const QSize& targetSize, tjhandle handle)
+QImage FFmpegFrameProcessor::DecodeMJPEGWithTurboJPEG(AVPacket* packet, const QSize& targetSize, tjhandle handle,
+                                                      QRect* region, bool* governor_scaled)
 {
     if (!handle || !packet || !packet->data || packet->size <= 0) {
         return QImage();
@@ -562,9 +922,20 @@ QImage FFmpegFrameProcessor::DecodeMJPEGWithTurboJPEG(AVPacket* packet, const QS
         native_jpeg_size_ = QSize(width, height);
     }
     
+#ifdef HAVE_TURBOJPEG_CROP
+    // Zoomed view: decode only what the viewer can see, at full detail
+    const QRect decode_region = region ? RegionToDecode(QSize(width, height), subsamp) : QRect();
+    if (!decode_region.isEmpty()) {
+        QImage region_image = DecodeMJPEGRegion(packet, decode_region, handle);
+        if (!region_image.isNull()) {
+            *region = decode_region;
+            return region_image;
+        }
+    }
+#endif
+    
     // Determine target size for scaling
-    int target_width = width;
-    int target_height = height;
+    int dct_denominator = 1;
 
     if (targetSize.isValid() && !targetSize.isEmpty()) {
         // TurboJPEG supports built-in DCT scaling at discrete ratios:
@@ -591,29 +962,44 @@ QImage FFmpegFrameProcessor::DecodeMJPEGWithTurboJPEG(AVPacket* packet, const QS
             double scale = qMin(scale_x, scale_y);
 
             if (scale <= 0.125) {
-                target_width = width / 8;
-                target_height = height / 8;
+                dct_denominator = 8;
             } else if (scale <= 0.25) {
-                target_width = width / 4;
-                target_height = height / 4;
+                dct_denominator = 4;
             } else if (scale <= 0.5) {
-                target_width = width / 2;
-                target_height = height / 2;
+                dct_denominator = 2;
             }
         }
         // else: keep original size — caller will handle final scaling
     }
     
-    // Create QImage for output
-    QImage image(target_width, target_height, QImage::Format_RGB888);
+    // The governor may ask for a coarser decode than the viewport needs when
+    // this host cannot keep up with the frame budget
+    const int governor_denominator = governor_downscale_enabled_ ? governor_.GetLevel().dct_denominator : 1;
+    if (governor_denominator > dct_denominator) {
+        dct_denominator = governor_denominator;
+        if (governor_scaled) {
+            *governor_scaled = true;
+        }
+    }
+    const int target_width = width / dct_denominator;
+    const int target_height = height / dct_denominator;
+    
+    // Decode straight into a recycled pool buffer
+    QImage image = frame_pool_.Acquire(QSize(target_width, target_height), QImage::Format_RGB888);
     if (image.isNull()) {
         return QImage();
     }
     
+    // Large frames with restart markers decode as parallel strips; anything
+    // else, or a strip that fails, goes through the whole-frame decode
+    const bool decoded_in_strips = restart_decoder_.Decode(packet->data, packet->size, dct_denominator,
+                                                           image.bits(), image.bytesPerLine(), TJPF_RGB, handle);
+    
     // Decompress directly to QImage buffer
-    if (tjDecompress2(handle, packet->data, packet->size,
-                     image.bits(), target_width, image.bytesPerLine(),
-                     target_height, TJPF_RGB, TJFLAG_FASTDCT) < 0) {
+    if (!decoded_in_strips
+        && tjDecompress2(handle, packet->data, packet->size,
+                         image.bits(), target_width, image.bytesPerLine(),
+                         target_height, TJPF_RGB, TJFLAG_FASTDCT) < 0) {
         qCWarning(log_ffmpeg_backend) << "TurboJPEG decompress failed:" << tjGetErrorStr();
         return QImage();
     }
@@ -628,6 +1014,44 @@ QImage FFmpegFrameProcessor::DecodeMJPEGWithTurboJPEG(AVPacket* packet, const QS
 }
 #endif
 
+#ifdef HAVE_TURBOJPEG_CROP
+QImage FFmpegFrameProcessor::DecodeMJPEGRegion(AVPacket* packet, const QRect& region, tjhandle handle)
+{
+    // Only the region is decoded here; PublishFrame() places it on the
+    // canvas in capture order
+    QImage image = frame_pool_.Acquire(region.size(), QImage::Format_RGB888);
+    if (image.isNull()) {
+        return QImage();
+    }
+
+    const tjscalingfactor unscaled = {1, 1};
+    const tjregion uncropped = {0, 0, 0, 0};
+    const tjregion cropped = {region.x(), region.y(), region.width(), region.height()};
+    const int pitch = static_cast<int>(image.bytesPerLine());
+
+    int result = tj3DecompressHeader(handle, packet->data, packet->size);
+    if (result == 0) {
+        tj3Set(handle, TJPARAM_FASTDCT, 1);
+        result = tj3SetScalingFactor(handle, unscaled);
+    }
+    if (result == 0) {
+        result = tj3SetCroppingRegion(handle, cropped);
+    }
+    if (result == 0) {
+        result = tj3Decompress8(handle, packet->data, packet->size, image.bits(), pitch, TJPF_RGB);
+    }
+    if (result < 0) {
+        qCWarning(log_ffmpeg_backend) << "TurboJPEG region decode failed:" << tj3GetErrorStr(handle);
+    }
+    // The handle is reused for whole-frame decodes
+    tj3SetCroppingRegion(handle, uncropped);
+    if (result < 0) {
+        return QImage();
+    }
+    return image;
+}
+#endif
+
 void FFmpegFrameProcessor::UpdateScalingContext(int width, int height, AVPixelFormat format, const QSize& targetSize)
 {
     QMutexLocker locker(&mutex_);
@@ -24,10 +24,16 @@
 #define FFMPEG_FRAME_PROCESSOR_H
 
 #include <QImage>
+#include <QByteArray>
 #include <QMutex>
+#include <QRect>
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <atomic>
 #include "ffmpegutils.h"
+#include "ffmpeg_frame_pool.h"
+#include "ffmpeg_decode_governor.h"
+#include "ffmpeg_restart_decoder.h"
 
 #ifdef HAVE_FFMPEG
 extern "C" {
@@ -38,6 +44,10 @@ extern "C" {
 
 #ifdef HAVE_LIBJPEG_TURBO
 #include <turbojpeg.h>
+// libjpeg-turbo 3.0+ (tj3 API) can decompress a cropped region
+#if defined(TJ_NUMINIT) && !defined(HAVE_TURBOJPEG_CROP)
+#define HAVE_TURBOJPEG_CROP
+#endif
 #endif
 
 /**
@@ -50,28 +60,117 @@ extern "C" {
  * - Frame format conversion
  * - Frame dropping for responsiveness
  * - Latest frame storage for image capture
+ *
+ * Decoded images are backed by FFmpegFramePool buffers and shared by reference
+ * between latest-frame storage and the caller, so steady-state capture does not
+ * allocate or deep-copy pixel data per frame.
+ *
+ * ProcessPacket() runs the whole gate/decode/publish sequence on the
+ * calling thread. The pipelined decoder (FFmpegDecodePipeline) uses the
+ * individual steps instead: ShouldDropFrame() on the reader thread,
+ * DecodePacket() concurrently on its workers and PublishFrame() once frames
+ * are back in capture order.
  */
 class FFmpegFrameProcessor {
 public:
+    /**
+     * @brief Output of one decoded packet
+     *
+     * image is sized for display; original is the full-resolution frame used
+     * for screenshots. Both usually refer to the same pooled buffer.
+     * mjpeg holds the source packet when it is a complete, standalone JPEG
+     * (mjpeg_size is its native size), so it can be served without re-encoding.
+     *
+     * A non-empty region marks a region decode: DecodePacket() leaves only
+     * that part of the frame in image and no original, and PublishFrame()
+     * turns image into the full display frame by carrying the rest over
+     * from the previously published one.
+     */
+    struct DecodedFrame {
+        QImage image;
+        QImage original;
+        QByteArray mjpeg;
+        QSize mjpeg_size;
+        QRect region;
+        qint64 decoded_ns = 0;   // Set by the caller for latency tracking
+
+        bool IsNull() const { return image.isNull(); }
+        bool IsRegionComposite() const { return !region.isEmpty(); }
+    };
+
     FFmpegFrameProcessor();
     ~FFmpegFrameProcessor();
 
-    // Frame processing pipeline (returns QImage for thread safety)
-    QImage ProcessPacketToImage(AVPacket* packet, AVCodecContext* codec_context, 
-                                bool is_recording, const QSize& targetSize = QSize());
+    // Frame processing pipeline (returns implicitly shared QImages for thread safety)
+    DecodedFrame ProcessPacket(AVPacket* packet, AVCodecContext* codec_context,
+                               bool is_recording, const QSize& targetSize = QSize());
+
+    // Pipelined decoding steps (see class comment). PublishFrame() must see
+    // frames in capture order; it completes region-decoded frames in place.
+    bool ShouldDropFrame(bool is_recording);
+    DecodedFrame DecodePacket(AVPacket* packet, AVCodecContext* codec_context,
+                              const QSize& targetSize = QSize());
+    bool PublishFrame(DecodedFrame* frame);
+
+    // True when packets of this codec can be decoded on several threads at once
+    bool SupportsParallelDecode(const AVCodecContext* codec_context) const;
+    
+    // Region-of-interest decoding for zoomed views. region is the visible part
+    // of the frame in normalized (0..1) coordinates; empty means the whole
+    // frame. Display images stay full-size: only the region is decoded, the
+    // rest is carried over from the previous frame and refreshed periodically.
+    // Such frames have no original, so screenshots and remote consumers keep
+    // the latest fully decoded frame.
+    void SetDecodeRegion(const QRectF& region);
+    void SetDecodeRegionEnabled(bool enabled);  // e.g. off while re-encoding a recording
+    bool IsDecodeRegionEnabled() const { return decode_region_enabled_; }
+    // True when region decoding will actually run for this codec
+    bool SupportsRegionDecode(const AVCodecContext* codec_context) const;
     
-    // Latest frame access (thread-safe)
+    // Latest frame access (thread-safe, implicitly shared - no pixel copy).
+    // A frame the governor decoded below full resolution has no original;
+    // with decode_if_missing its camera JPEG is decoded once on request.
     QImage GetLatestFrame() const;
-    QImage GetLatestOriginalFrame() const;
+    QImage GetLatestOriginalFrame(bool decode_if_missing = true) const;
     QSize GetNativeJpegSize() const;
     
+    // Camera JPEG of the latest frame at native size; empty if the source is not
+    // MJPEG or its packets are not standalone JPEGs (e.g. no Huffman tables)
+    QByteArray GetLatestMjpegFrame(QSize* size = nullptr) const;
+    
     // Configuration
     void SetFrameDropThreshold(int display_threshold_ms, int recording_threshold_ms);
     void SetScalingQuality(const QString &quality);
+    void ConfigureFramePool(const QSize& capture_resolution, int extra_frames_in_flight = 0);
+    void SetFramePoolReserve(int frames);  // Frames held by a downstream queue (e.g. the recorder)
+    FFmpegFramePool::Stats GetFramePoolStats() const { return frame_pool_.GetStats(); }
+    
+    // Adaptive decode quality: DecodePacket() feeds the governor, whose level
+    // sets a minimum DCT downscale and a display frame-rate cap. Both only
+    // ever apply to the display image, never while recording.
+    void ConfigureDecodeGovernor(const FFmpegDecodeGovernor::Config& config);
+    void SetGovernorDownscaleEnabled(bool enabled) { governor_downscale_enabled_ = enabled; }
+    const FFmpegDecodeGovernor& GetDecodeGovernor() const { return governor_; }
+    
+    // Intra-frame parallel decode of large MJPEG frames that carry restart
+    // markers; threads as for FFmpegRestartDecoder::ResolveThreadCount()
+    void ConfigureStripDecode(int threads);
+    FFmpegRestartDecoder::Stats GetStripDecodeStats() const { return restart_decoder_.GetStats(); }
+    
+    // MJPEG goes through TurboJPEG when it is built in; off forces the
+    // libavcodec path (decoder comparisons, TurboJPEG-specific issues)
+    void SetTurboJpegEnabled(bool enabled) { turbojpeg_enabled_ = enabled; }
+    bool IsTurboJpegEnabled() const { return turbojpeg_enabled_; }
     
 #ifdef HAVE_LIBJPEG_TURBO
     // TurboJPEG fast MJPEG decoding
-    QImage DecodeMJPEGWithTurboJPEG(AVPacket* packet, const QSize& targetSize, tjhandle handle);
+    // region is set when only that part of the frame was decoded,
+    // governor_scaled when the governor decoded below targetSize
+    QImage DecodeMJPEGWithTurboJPEG(AVPacket* packet, const QSize& targetSize, tjhandle handle,
+                                    QRect* region = nullptr, bool* governor_scaled = nullptr);
+#endif
+#ifdef HAVE_TURBOJPEG_CROP
+    QImage DecodeMJPEGRegion(AVPacket* packet, const QRect& region, tjhandle handle);
 #endif
     void StopCaptureGracefully();
     void StartCapture();
@@ -91,11 +190,8 @@ private:
     QImage ConvertWithScalingToImage(AVFrame* frame, const QSize& targetSize = QSize());
     
     // FFmpeg decoding implementation (extracted from main processing logic)
-    QImage ProcessWithFFmpegDecoding(AVPacket* packet, AVCodecContext* codec_context, 
-                                     bool is_recording, const QSize& targetSize = QSize());
-    
-    // Frame dropping logic
-    bool ShouldDropFrame(bool is_recording);
+    DecodedFrame ProcessWithFFmpegDecoding(AVPacket* packet, AVCodecContext* codec_context,
+                                           const QSize& targetSize = QSize());
     
     // Helper methods
     bool IsHardwareDecoder(const AVCodecContext* codec_context) const;
@@ -125,15 +221,41 @@ private:
     QElapsedTimer last_process_timer_;   // high-resolution timer to avoid ms rounding issues
 
     // Statistics
-    int frame_count_;
+    std::atomic<int> frame_count_;
     int startup_frames_to_skip_;
     
     // Latest frame storage (thread-safe)
     mutable QMutex mutex_;
+    
+    // Serialises the libavcodec path, which shares codec_context and temp_frame_
+    QMutex decode_mutex_;
     QImage latest_frame_;
-    QImage latest_original_frame_;  // Original resolution frame before scaling
+    mutable QImage latest_original_frame_;  // Original resolution frame before scaling
+    QByteArray latest_mjpeg_;        // Source JPEG of latest_original_frame_ (implicitly shared)
+    QSize latest_mjpeg_size_;
     QSize native_jpeg_size_;         // True JPEG dimensions from header (unaffected by DCT scaling)
     
+    // Region-of-interest decoding (guarded by mutex_). The canvases are only
+    // written by PublishFrame(), so they follow capture order.
+    QRect RegionToDecode(const QSize& native_size, int subsamp);
+    bool ComposeRegionLocked(DecodedFrame* frame);
+    QRectF decode_region_;           // Normalized; empty = whole frame
+    QImage region_canvas_;           // Latest published native-size frame, source of the area outside the region
+    QImage region_spare_;            // Canvas published before it, reused once the display releases it
+    QRect region_spare_stale_;       // Where region_spare_ differs from region_canvas_
+    int region_frames_since_full_;
+    std::atomic<bool> decode_region_enabled_;
+    
+    // Recycled decode buffers sized to the capture resolution
+    FFmpegFramePool frame_pool_;
+    int frame_pool_extra_;      // Frames in flight inside the decode pipeline
+    int frame_pool_reserve_;    // Frames held by downstream consumers
+    
+    FFmpegDecodeGovernor governor_;
+    std::atomic<bool> governor_downscale_enabled_;
+    std::atomic<bool> turbojpeg_enabled_;
+    FFmpegRestartDecoder restart_decoder_;
+    
     // Thread control
     bool stop_requested_;
     
@@ -0,0 +1,748 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+
+#include "ffmpeg_pixel_converter.h"
+#include <QtGlobal>
+#include <cstring>
+
+#ifdef HAVE_FFMPEG
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define OPF_PIXEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define OPF_TARGET_AVX2
+#else
+#define OPF_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define OPF_PIXEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Shared fixed-point BT.601 formula
+//
+//   yt = limited ? ((max(Y, 16) - 16) * 149) >> 1 : Y << 6      (Q6, 1.164 / 1.0)
+//   B  = sat16(yt + cbu * (U - 128))
+//   G  = sat16(sat16(yt - cgu * (U - 128)) - cgv * (V - 128))
+//   R  = sat16(yt + crv * (V - 128))
+//   out = clamp((x + 32) >> 6, 0, 255)
+//
+// Every kernel below evaluates exactly this, so results do not depend on the
+// instruction set.
+// ---------------------------------------------------------------------------
+
+struct YuvCoefficients {
+    int16_t crv;
+    int16_t cgu;
+    int16_t cgv;
+    int16_t cbu;
+    bool limited;
+};
+
+constexpr YuvCoefficients kLimitedRange = {102, 25, 52, 129, true};   // 1.596 0.391 0.813 2.018
+constexpr YuvCoefficients kFullRange = {90, 22, 46, 113, false};      // 1.402 0.344 0.714 1.772
+
+inline const YuvCoefficients& Coefficients(FFmpegPixelConverter::Range range)
+{
+    return range == FFmpegPixelConverter::Range::kFull ? kFullRange : kLimitedRange;
+}
+
+inline int Saturate16(int value)
+{
+    return value < -32768 ? -32768 : (value > 32767 ? 32767 : value);
+}
+
+inline uint8_t Descale(int value)
+{
+    value = (value + 32) >> 6;
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+inline void YuvPixel(int y, int u, int v, const YuvCoefficients& c, uint8_t* dst)
+{
+    const int yt = c.limited ? ((qMax(y, 16) - 16) * 149) >> 1 : y << 6;
+    u -= 128;
+    v -= 128;
+    dst[0] = Descale(Saturate16(yt + c.cbu * u));
+    dst[1] = Descale(Saturate16(Saturate16(yt - c.cgu * u) - c.cgv * v));
+    dst[2] = Descale(Saturate16(yt + c.crv * v));
+    dst[3] = 0xFF;
+}
+
+// Row tails shared by every instruction set: convert pixels [x, width)
+
+inline void Bgr24RowScalar(const uint8_t* src, uint8_t* dst, int x, int width)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // Four pixels per step as 32-bit words: B0G0R0B1 G1R1B2G2 R2B3G3R3
+    for (; x + 4 <= width; x += 4) {
+        uint32_t w[3];
+        memcpy(w, src + x * 3, sizeof(w));
+        const uint32_t out[4] = {
+            w[0] | 0xFF000000u,
+            (w[0] >> 24) | (w[1] << 8) | 0xFF000000u,
+            (w[1] >> 16) | (w[2] << 16) | 0xFF000000u,
+            (w[2] >> 8) | 0xFF000000u,
+        };
+        memcpy(dst + x * 4, out, sizeof(out));
+    }
+#endif
+    for (; x < width; ++x) {
+        dst[x * 4 + 0] = src[x * 3 + 0];
+        dst[x * 4 + 1] = src[x * 3 + 1];
+        dst[x * 4 + 2] = src[x * 3 + 2];
+        dst[x * 4 + 3] = 0xFF;
+    }
+}
+
+inline void Yuyv422RowScalar(const uint8_t* src, uint8_t* dst, int x, int width, const YuvCoefficients& c)
+{
+    for (; x < width; ++x) {
+        const uint8_t* pair = src + (x / 2) * 4;
+        YuvPixel(src[x * 2], pair[1], pair[3], c, dst + x * 4);
+    }
+}
+
+inline void Nv12RowScalar(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int x, int width,
+                          const YuvCoefficients& c)
+{
+    for (; x < width; ++x) {
+        YuvPixel(y[x], uv[(x / 2) * 2], uv[(x / 2) * 2 + 1], c, dst + x * 4);
+    }
+}
+
+inline void Yuv420pRowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                             int x, int width, const YuvCoefficients& c)
+{
+    for (; x < width; ++x) {
+        YuvPixel(y[x], u[x / 2], v[x / 2], c, dst + x * 4);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Scalar
+// ---------------------------------------------------------------------------
+
+void Bgr24Scalar(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride, int width, int height)
+{
+    for (int row = 0; row < height; ++row) {
+        Bgr24RowScalar(src + row * src_stride, dst + row * dst_stride, 0, width);
+    }
+}
+
+void Yuyv422Scalar(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride, int width, int height,
+                   FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    for (int row = 0; row < height; ++row) {
+        Yuyv422RowScalar(src + row * src_stride, dst + row * dst_stride, 0, width, c);
+    }
+}
+
+void Nv12Scalar(const uint8_t* y, int y_stride, const uint8_t* uv, int uv_stride,
+                uint8_t* dst, int dst_stride, int width, int height, FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    for (int row = 0; row < height; ++row) {
+        Nv12RowScalar(y + row * y_stride, uv + (row / 2) * uv_stride, dst + row * dst_stride, 0, width, c);
+    }
+}
+
+void Yuv420pScalar(const uint8_t* y, int y_stride, const uint8_t* u, int u_stride,
+                   const uint8_t* v, int v_stride, uint8_t* dst, int dst_stride, int width, int height,
+                   FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    for (int row = 0; row < height; ++row) {
+        Yuv420pRowScalar(y + row * y_stride, u + (row / 2) * u_stride, v + (row / 2) * v_stride,
+                         dst + row * dst_stride, 0, width, c);
+    }
+}
+
+#ifdef OPF_PIXEL_X86
+// ---------------------------------------------------------------------------
+// SSE2 (baseline on x86-64): 8 pixels per YUV step
+// ---------------------------------------------------------------------------
+
+inline __m128i YTermSse2(__m128i y, bool limited)
+{
+    if (limited) {
+        const __m128i sixteen = _mm_set1_epi16(16);
+        y = _mm_sub_epi16(_mm_max_epi16(y, sixteen), sixteen);
+        return _mm_srli_epi16(_mm_mullo_epi16(y, _mm_set1_epi16(149)), 1);
+    }
+    return _mm_slli_epi16(y, 6);
+}
+
+inline __m128i DescaleSse2(__m128i value)
+{
+    return _mm_srai_epi16(_mm_adds_epi16(value, _mm_set1_epi16(32)), 6);
+}
+
+// y: raw luma, u/v: chroma already centred on zero; all eight 16-bit lanes
+inline void StoreYuvSse2(__m128i y, __m128i u, __m128i v, const YuvCoefficients& c, uint8_t* dst)
+{
+    const __m128i yt = YTermSse2(y, c.limited);
+    __m128i b = _mm_adds_epi16(yt, _mm_mullo_epi16(u, _mm_set1_epi16(c.cbu)));
+    __m128i g = _mm_subs_epi16(_mm_subs_epi16(yt, _mm_mullo_epi16(u, _mm_set1_epi16(c.cgu))),
+                               _mm_mullo_epi16(v, _mm_set1_epi16(c.cgv)));
+    __m128i r = _mm_adds_epi16(yt, _mm_mullo_epi16(v, _mm_set1_epi16(c.crv)));
+
+    b = _mm_packus_epi16(DescaleSse2(b), DescaleSse2(b));
+    g = _mm_packus_epi16(DescaleSse2(g), DescaleSse2(g));
+    r = _mm_packus_epi16(DescaleSse2(r), DescaleSse2(r));
+
+    const __m128i bg = _mm_unpacklo_epi8(b, g);
+    const __m128i ra = _mm_unpacklo_epi8(r, _mm_set1_epi8(static_cast<char>(0xFF)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(bg, ra));
+}
+
+// Interleaved U0 V0 U1 V1 ... (16-bit lanes) -> per-pixel U and V, centred
+inline void SplitChromaPairsSse2(__m128i uv, __m128i* u, __m128i* v)
+{
+    const __m128i bias = _mm_set1_epi16(128);
+    *u = _mm_sub_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)),
+                                           _MM_SHUFFLE(2, 2, 0, 0)), bias);
+    *v = _mm_sub_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)),
+                                           _MM_SHUFFLE(3, 3, 1, 1)), bias);
+}
+
+void Yuyv422Sse2(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride, int width, int height,
+                 FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* s = src + row * src_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + x * 2));
+            __m128i u, v;
+            SplitChromaPairsSse2(_mm_srli_epi16(packed, 8), &u, &v);
+            StoreYuvSse2(_mm_and_si128(packed, low_bytes), u, v, c, d + x * 4);
+        }
+        Yuyv422RowScalar(s, d, x, width, c);
+    }
+}
+
+void Nv12Sse2(const uint8_t* y, int y_stride, const uint8_t* uv, int uv_stride,
+              uint8_t* dst, int dst_stride, int width, int height, FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* ys = y + row * y_stride;
+        const uint8_t* uvs = uv + (row / 2) * uv_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + x));
+            const __m128i chroma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uvs + x));
+            const __m128i u = _mm_sub_epi16(_mm_and_si128(chroma, low_bytes), bias);
+            const __m128i v = _mm_sub_epi16(_mm_srli_epi16(chroma, 8), bias);
+            StoreYuvSse2(_mm_unpacklo_epi8(luma, zero), _mm_unpacklo_epi16(u, u), _mm_unpacklo_epi16(v, v),
+                         c, d + x * 4);
+            StoreYuvSse2(_mm_unpackhi_epi8(luma, zero), _mm_unpackhi_epi16(u, u), _mm_unpackhi_epi16(v, v),
+                         c, d + x * 4 + 32);
+        }
+        Nv12RowScalar(ys, uvs, d, x, width, c);
+    }
+}
+
+void Yuv420pSse2(const uint8_t* y, int y_stride, const uint8_t* u, int u_stride,
+                 const uint8_t* v, int v_stride, uint8_t* dst, int dst_stride, int width, int height,
+                 FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* ys = y + row * y_stride;
+        const uint8_t* us = u + (row / 2) * u_stride;
+        const uint8_t* vs = v + (row / 2) * v_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + x));
+            const __m128i cb = _mm_sub_epi16(
+                _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(us + x / 2)), zero), bias);
+            const __m128i cr = _mm_sub_epi16(
+                _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(vs + x / 2)), zero), bias);
+            StoreYuvSse2(_mm_unpacklo_epi8(luma, zero), _mm_unpacklo_epi16(cb, cb), _mm_unpacklo_epi16(cr, cr),
+                         c, d + x * 4);
+            StoreYuvSse2(_mm_unpackhi_epi8(luma, zero), _mm_unpackhi_epi16(cb, cb), _mm_unpackhi_epi16(cr, cr),
+                         c, d + x * 4 + 32);
+        }
+        Yuv420pRowScalar(ys, us, vs, d, x, width, c);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX2: 16 pixels per YUV step, byte shuffles for BGR24
+// ---------------------------------------------------------------------------
+
+OPF_TARGET_AVX2 inline __m256i YTermAvx2(__m256i y, bool limited)
+{
+    if (limited) {
+        const __m256i sixteen = _mm256_set1_epi16(16);
+        y = _mm256_sub_epi16(_mm256_max_epi16(y, sixteen), sixteen);
+        return _mm256_srli_epi16(_mm256_mullo_epi16(y, _mm256_set1_epi16(149)), 1);
+    }
+    return _mm256_slli_epi16(y, 6);
+}
+
+OPF_TARGET_AVX2 inline __m256i DescaleAvx2(__m256i value)
+{
+    return _mm256_srai_epi16(_mm256_adds_epi16(value, _mm256_set1_epi16(32)), 6);
+}
+
+// Sixteen pixels in lane order; see StoreYuvSse2
+OPF_TARGET_AVX2 inline void StoreYuvAvx2(__m256i y, __m256i u, __m256i v, const YuvCoefficients& c,
+                                         uint8_t* dst)
+{
+    const __m256i yt = YTermAvx2(y, c.limited);
+    __m256i b = _mm256_adds_epi16(yt, _mm256_mullo_epi16(u, _mm256_set1_epi16(c.cbu)));
+    __m256i g = _mm256_subs_epi16(_mm256_subs_epi16(yt, _mm256_mullo_epi16(u, _mm256_set1_epi16(c.cgu))),
+                                  _mm256_mullo_epi16(v, _mm256_set1_epi16(c.cgv)));
+    __m256i r = _mm256_adds_epi16(yt, _mm256_mullo_epi16(v, _mm256_set1_epi16(c.crv)));
+
+    // Packing and unpacking work per 128-bit lane: lane 0 ends up holding
+    // pixels 0-3 / 4-7, lane 1 pixels 8-11 / 12-15; reassemble at the end.
+    b = _mm256_packus_epi16(DescaleAvx2(b), DescaleAvx2(b));
+    g = _mm256_packus_epi16(DescaleAvx2(g), DescaleAvx2(g));
+    r = _mm256_packus_epi16(DescaleAvx2(r), DescaleAvx2(r));
+
+    const __m256i bg = _mm256_unpacklo_epi8(b, g);
+    const __m256i ra = _mm256_unpacklo_epi8(r, _mm256_set1_epi8(static_cast<char>(0xFF)));
+    const __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+    const __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+OPF_TARGET_AVX2 inline void SplitChromaPairsAvx2(__m256i uv, __m256i* u, __m256i* v)
+{
+    const __m256i bias = _mm256_set1_epi16(128);
+    *u = _mm256_sub_epi16(_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)),
+                                                 _MM_SHUFFLE(2, 2, 0, 0)), bias);
+    *v = _mm256_sub_epi16(_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)),
+                                                 _MM_SHUFFLE(3, 3, 1, 1)), bias);
+}
+
+OPF_TARGET_AVX2 void Bgr24Avx2(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride,
+                               int width, int height)
+{
+    // Spread 24 source bytes over two lanes (bytes 0-15 | 12-27), then insert
+    // an alpha byte after every pixel within each lane.
+    const __m256i spread = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                             0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* s = src + row * src_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        // The 32-byte load reads 8 bytes past the 8 pixels it converts
+        for (; x + 11 <= width; x += 8) {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + x * 3));
+            pixels = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(pixels, spread), shuffle);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + x * 4), _mm256_or_si256(pixels, alpha));
+        }
+        Bgr24RowScalar(s, d, x, width);
+    }
+}
+
+OPF_TARGET_AVX2 void Yuyv422Avx2(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride,
+                                 int width, int height, FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    const __m256i low_bytes = _mm256_set1_epi16(0x00FF);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* s = src + row * src_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            const __m256i packed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + x * 2));
+            __m256i u, v;
+            SplitChromaPairsAvx2(_mm256_srli_epi16(packed, 8), &u, &v);
+            StoreYuvAvx2(_mm256_and_si256(packed, low_bytes), u, v, c, d + x * 4);
+        }
+        Yuyv422RowScalar(s, d, x, width, c);
+    }
+}
+
+OPF_TARGET_AVX2 void Nv12Avx2(const uint8_t* y, int y_stride, const uint8_t* uv, int uv_stride,
+                              uint8_t* dst, int dst_stride, int width, int height,
+                              FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* ys = y + row * y_stride;
+        const uint8_t* uvs = uv + (row / 2) * uv_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            const __m256i luma = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + x)));
+            const __m256i chroma = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(uvs + x)));
+            __m256i u, v;
+            SplitChromaPairsAvx2(chroma, &u, &v);
+            StoreYuvAvx2(luma, u, v, c, d + x * 4);
+        }
+        Nv12RowScalar(ys, uvs, d, x, width, c);
+    }
+}
+
+OPF_TARGET_AVX2 void Yuv420pAvx2(const uint8_t* y, int y_stride, const uint8_t* u, int u_stride,
+                                 const uint8_t* v, int v_stride, uint8_t* dst, int dst_stride,
+                                 int width, int height, FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    const __m256i bias = _mm256_set1_epi16(128);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* ys = y + row * y_stride;
+        const uint8_t* us = u + (row / 2) * u_stride;
+        const uint8_t* vs = v + (row / 2) * v_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            const __m256i luma = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + x)));
+            const __m128i cb = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(us + x / 2));
+            const __m128i cr = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(vs + x / 2));
+            const __m256i cb16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(cb, cb)), bias);
+            const __m256i cr16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(cr, cr)), bias);
+            StoreYuvAvx2(luma, cb16, cr16, c, d + x * 4);
+        }
+        Yuv420pRowScalar(ys, us, vs, d, x, width, c);
+    }
+}
+
+bool CpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;   // OS does not save YMM state
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // OPF_PIXEL_X86
+
+#ifdef OPF_PIXEL_NEON
+// ---------------------------------------------------------------------------
+// NEON (baseline on AArch64): 8 pixels per YUV step, 16 for BGR24
+// ---------------------------------------------------------------------------
+
+inline int16x8_t YTermNeon(uint8x8_t y, bool limited)
+{
+    if (limited) {
+        return vreinterpretq_s16_u16(vshrq_n_u16(vmull_u8(vqsub_u8(y, vdup_n_u8(16)), vdup_n_u8(149)), 1));
+    }
+    return vreinterpretq_s16_u16(vshll_n_u8(y, 6));
+}
+
+inline int16x8_t CentreNeon(uint8x8_t chroma)
+{
+    return vreinterpretq_s16_u16(vsubl_u8(chroma, vdup_n_u8(128)));
+}
+
+// Returns B, G, R planes for eight pixels; u/v centred
+inline uint8x8x4_t YuvNeon(uint8x8_t y, int16x8_t u, int16x8_t v, const YuvCoefficients& c)
+{
+    const int16x8_t yt = YTermNeon(y, c.limited);
+    const int16x8_t b = vqaddq_s16(yt, vmulq_n_s16(u, c.cbu));
+    const int16x8_t g = vqsubq_s16(vqsubq_s16(yt, vmulq_n_s16(u, c.cgu)), vmulq_n_s16(v, c.cgv));
+    const int16x8_t r = vqaddq_s16(yt, vmulq_n_s16(v, c.crv));
+
+    uint8x8x4_t out;
+    out.val[0] = vqrshrun_n_s16(b, 6);
+    out.val[1] = vqrshrun_n_s16(g, 6);
+    out.val[2] = vqrshrun_n_s16(r, 6);
+    out.val[3] = vdup_n_u8(0xFF);
+    return out;
+}
+
+void Bgr24Neon(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride, int width, int height)
+{
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* s = src + row * src_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            const uint8x16x3_t bgr = vld3q_u8(s + x * 3);
+            uint8x16x4_t bgra;
+            bgra.val[0] = bgr.val[0];
+            bgra.val[1] = bgr.val[1];
+            bgra.val[2] = bgr.val[2];
+            bgra.val[3] = vdupq_n_u8(0xFF);
+            vst4q_u8(d + x * 4, bgra);
+        }
+        Bgr24RowScalar(s, d, x, width);
+    }
+}
+
+void Yuyv422Neon(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride, int width, int height,
+                 FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* s = src + row * src_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            // Y0 U Y1 V groups: even pixels, chroma, odd pixels
+            const uint8x8x4_t yuyv = vld4_u8(s + x * 2);
+            const int16x8_t u = CentreNeon(yuyv.val[1]);
+            const int16x8_t v = CentreNeon(yuyv.val[3]);
+            const uint8x8x4_t even = YuvNeon(yuyv.val[0], u, v, c);
+            const uint8x8x4_t odd = YuvNeon(yuyv.val[2], u, v, c);
+
+            uint8x16x4_t bgra;
+            for (int plane = 0; plane < 4; ++plane) {
+                const uint8x8x2_t zipped = vzip_u8(even.val[plane], odd.val[plane]);
+                bgra.val[plane] = vcombine_u8(zipped.val[0], zipped.val[1]);
+            }
+            vst4q_u8(d + x * 4, bgra);
+        }
+        Yuyv422RowScalar(s, d, x, width, c);
+    }
+}
+
+inline void StoreYuv16Neon(uint8x16_t y, uint8x8_t u, uint8x8_t v, const YuvCoefficients& c, uint8_t* dst)
+{
+    const uint8x8x2_t cb = vzip_u8(u, u);
+    const uint8x8x2_t cr = vzip_u8(v, v);
+    vst4_u8(dst, YuvNeon(vget_low_u8(y), CentreNeon(cb.val[0]), CentreNeon(cr.val[0]), c));
+    vst4_u8(dst + 32, YuvNeon(vget_high_u8(y), CentreNeon(cb.val[1]), CentreNeon(cr.val[1]), c));
+}
+
+void Nv12Neon(const uint8_t* y, int y_stride, const uint8_t* uv, int uv_stride,
+              uint8_t* dst, int dst_stride, int width, int height, FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* ys = y + row * y_stride;
+        const uint8_t* uvs = uv + (row / 2) * uv_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            const uint8x8x2_t chroma = vld2_u8(uvs + x);
+            StoreYuv16Neon(vld1q_u8(ys + x), chroma.val[0], chroma.val[1], c, d + x * 4);
+        }
+        Nv12RowScalar(ys, uvs, d, x, width, c);
+    }
+}
+
+void Yuv420pNeon(const uint8_t* y, int y_stride, const uint8_t* u, int u_stride,
+                 const uint8_t* v, int v_stride, uint8_t* dst, int dst_stride, int width, int height,
+                 FFmpegPixelConverter::Range range)
+{
+    const YuvCoefficients& c = Coefficients(range);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* ys = y + row * y_stride;
+        const uint8_t* us = u + (row / 2) * u_stride;
+        const uint8_t* vs = v + (row / 2) * v_stride;
+        uint8_t* d = dst + row * dst_stride;
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            StoreYuv16Neon(vld1q_u8(ys + x), vld1_u8(us + x / 2), vld1_u8(vs + x / 2), c, d + x * 4);
+        }
+        Yuv420pRowScalar(ys, us, vs, d, x, width, c);
+    }
+}
+#endif // OPF_PIXEL_NEON
+
+const FFmpegPixelConverter::Kernels kScalarKernels = {
+    FFmpegPixelConverter::Isa::kScalar, Bgr24Scalar, Yuyv422Scalar, Nv12Scalar, Yuv420pScalar};
+
+#ifdef OPF_PIXEL_X86
+// SSE2 has no byte shuffle; BGR24 stays on the word-at-a-time scalar kernel
+const FFmpegPixelConverter::Kernels kSse2Kernels = {
+    FFmpegPixelConverter::Isa::kSse2, Bgr24Scalar, Yuyv422Sse2, Nv12Sse2, Yuv420pSse2};
+const FFmpegPixelConverter::Kernels kAvx2Kernels = {
+    FFmpegPixelConverter::Isa::kAvx2, Bgr24Avx2, Yuyv422Avx2, Nv12Avx2, Yuv420pAvx2};
+#endif
+
+#ifdef OPF_PIXEL_NEON
+const FFmpegPixelConverter::Kernels kNeonKernels = {
+    FFmpegPixelConverter::Isa::kNeon, Bgr24Neon, Yuyv422Neon, Nv12Neon, Yuv420pNeon};
+#endif
+
+} // namespace
+
+bool FFmpegPixelConverter::IsSupported(Isa isa)
+{
+    switch (isa) {
+    case Isa::kScalar:
+        return true;
+#ifdef OPF_PIXEL_X86
+    case Isa::kSse2:
+        return true;
+    case Isa::kAvx2: {
+        static const bool has_avx2 = CpuHasAvx2();
+        return has_avx2;
+    }
+#endif
+#ifdef OPF_PIXEL_NEON
+    case Isa::kNeon:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+const FFmpegPixelConverter::Kernels& FFmpegPixelConverter::Get(Isa isa)
+{
+    if (!IsSupported(isa)) {
+        return kScalarKernels;
+    }
+    switch (isa) {
+#ifdef OPF_PIXEL_X86
+    case Isa::kSse2:
+        return kSse2Kernels;
+    case Isa::kAvx2:
+        return kAvx2Kernels;
+#endif
+#ifdef OPF_PIXEL_NEON
+    case Isa::kNeon:
+        return kNeonKernels;
+#endif
+    default:
+        return kScalarKernels;
+    }
+}
+
+const FFmpegPixelConverter::Kernels& FFmpegPixelConverter::Best()
+{
+    static const Kernels& best = []() -> const Kernels& {
+        for (Isa isa : {Isa::kAvx2, Isa::kNeon, Isa::kSse2}) {
+            if (IsSupported(isa)) {
+                return Get(isa);
+            }
+        }
+        return kScalarKernels;
+    }();
+    return best;
+}
+
+const char* FFmpegPixelConverter::IsaName(Isa isa)
+{
+    switch (isa) {
+    case Isa::kSse2:
+        return "SSE2";
+    case Isa::kAvx2:
+        return "AVX2";
+    case Isa::kNeon:
+        return "NEON";
+    case Isa::kScalar:
+    default:
+        return "scalar";
+    }
+}
+
+#ifdef HAVE_FFMPEG
+bool FFmpegPixelConverter::CanConvert(int pixel_format)
+{
+    switch (pixel_format) {
+    case AV_PIX_FMT_BGR24:
+    case AV_PIX_FMT_YUYV422:
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool FFmpegPixelConverter::ConvertFrame(const AVFrame* frame, QImage* dst)
+{
+    if (!frame || !dst || !frame->data[0] || frame->width <= 0 || frame->height <= 0
+        || dst->size() != QSize(frame->width, frame->height)
+        || (dst->format() != QImage::Format_RGB32 && dst->format() != QImage::Format_ARGB32)) {
+        return false;
+    }
+
+    const Kernels& kernels = Best();
+    uint8_t* out = dst->bits();
+    const int out_stride = static_cast<int>(dst->bytesPerLine());
+    const Range range = (frame->format == AV_PIX_FMT_YUVJ420P || frame->color_range == AVCOL_RANGE_JPEG)
+                            ? Range::kFull : Range::kLimited;
+
+    switch (frame->format) {
+    case AV_PIX_FMT_BGR24:
+        kernels.bgr24(frame->data[0], frame->linesize[0], out, out_stride, frame->width, frame->height);
+        return true;
+    case AV_PIX_FMT_YUYV422:
+        kernels.yuyv422(frame->data[0], frame->linesize[0], out, out_stride,
+                        frame->width, frame->height, range);
+        return true;
+    case AV_PIX_FMT_NV12:
+        if (!frame->data[1]) {
+            return false;
+        }
+        kernels.nv12(frame->data[0], frame->linesize[0], frame->data[1], frame->linesize[1],
+                     out, out_stride, frame->width, frame->height, range);
+        return true;
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        if (!frame->data[1] || !frame->data[2]) {
+            return false;
+        }
+        kernels.yuv420p(frame->data[0], frame->linesize[0], frame->data[1], frame->linesize[1],
+                        frame->data[2], frame->linesize[2], out, out_stride,
+                        frame->width, frame->height, range);
+        return true;
+    default:
+        return false;
+    }
+}
+#endif // HAVE_FFMPEG
@@ -0,0 +1,94 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+
+#ifndef FFMPEG_PIXEL_CONVERTER_H
+#define FFMPEG_PIXEL_CONVERTER_H
+
+#include <QImage>
+#include <cstdint>
+
+#ifdef HAVE_FFMPEG
+struct AVFrame;
+#endif
+
+/**
+ * @brief SIMD colour converters for the raw formats capture chips deliver
+ *
+ * Converts BGR24, YUYV422, NV12 and YUV(J)420P straight into
+ * QImage::Format_RGB32 (B,G,R,0xFF in memory), the layout the display and
+ * the frame pool already use. Kernels are plain functions selected once per
+ * process from the best instruction set the CPU supports (AVX2, SSE2 or NEON,
+ * with a scalar fallback), so a conversion is a direct call: no swscale
+ * context to look up, rebuild or lock.
+ *
+ * All kernels share one fixed-point BT.601 formula (6 fractional bits,
+ * saturating 16-bit arithmetic), so every instruction set produces
+ * bit-identical output and can be checked against the scalar reference.
+ * Scaling is not handled here; callers convert at native size.
+ */
+class FFmpegPixelConverter {
+public:
+    enum class Isa { kScalar, kSse2, kAvx2, kNeon };
+    enum class Range { kLimited, kFull };   // Y 16-235 (video) or 0-255 (JPEG)
+
+    using PackedFunction = void (*)(const uint8_t* src, int src_stride,
+                                    uint8_t* dst, int dst_stride, int width, int height);
+    using PackedYuvFunction = void (*)(const uint8_t* src, int src_stride,
+                                       uint8_t* dst, int dst_stride, int width, int height, Range range);
+    using Nv12Function = void (*)(const uint8_t* y, int y_stride, const uint8_t* uv, int uv_stride,
+                                  uint8_t* dst, int dst_stride, int width, int height, Range range);
+    using PlanarYuvFunction = void (*)(const uint8_t* y, int y_stride, const uint8_t* u, int u_stride,
+                                       const uint8_t* v, int v_stride,
+                                       uint8_t* dst, int dst_stride, int width, int height, Range range);
+
+    struct Kernels {
+        Isa isa;
+        PackedFunction bgr24;
+        PackedYuvFunction yuyv422;
+        Nv12Function nv12;
+        PlanarYuvFunction yuv420p;
+    };
+
+    // True when the kernels for isa are compiled in and this CPU can run them
+    static bool IsSupported(Isa isa);
+
+    // Kernel table for isa; the scalar table if isa is not supported
+    static const Kernels& Get(Isa isa);
+
+    // Fastest supported table, resolved on first use
+    static const Kernels& Best();
+
+    static const char* IsaName(Isa isa);
+
+#ifdef HAVE_FFMPEG
+    // True for the AVPixelFormat values ConvertFrame() handles
+    static bool CanConvert(int pixel_format);
+
+    // Converts a software frame into dst, which must be Format_RGB32 (or
+    // ARGB32) at the frame's size. Returns false for unsupported input.
+    static bool ConvertFrame(const AVFrame* frame, QImage* dst);
+#endif
+};
+
+#endif // FFMPEG_PIXEL_CONVERTER_H
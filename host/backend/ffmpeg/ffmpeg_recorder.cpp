@@ -21,19 +21,24 @@
 */
 
 #include "ffmpeg_recorder.h"
+#include "ffmpeg_frame_diff.h"
 
 #include <QDebug>
 #include <QLoggingCategory>
 #include <QDateTime>
+#include <QFile>
 #include <QFileInfo>
 #include <QImage>
 #include <QThread>
 #include <QImage>
 #include <QRect> 
+#include <QStringList>
 
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/channel_layout.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
 #include <libswscale/swscale.h>
@@ -41,6 +46,125 @@ extern "C" {
 
 Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
 
+namespace {
+// Device timestamps further than this from the wall clock re-anchor the
+// passthrough timeline (device restart, or time spent paused).
+constexpr qint64 kMaxSourceClockDriftMs = 500;
+
+// Segmented recordings push muxed data to disk at least this often
+constexpr qint64 kSegmentFlushIntervalMs = 1000;
+
+// With an audio track the video may not wander as far from the recording
+// clock before it is re-anchored
+constexpr qint64 kMaxSourceClockDriftWithAudioMs = 100;
+
+// Upper bound for the space reserved when a segment opens
+constexpr qint64 kMaxSegmentPreallocation = 4LL * 1024 * 1024 * 1024;
+
+// About 1.4 s of 48 kHz stereo float; the encoder thread drains it every
+// kAudioPollMs even when no video frame arrives
+constexpr size_t kAudioRingBytes = 512 * 1024;
+constexpr unsigned long kAudioPollMs = 20;
+
+// Audio further than this from its capture time is moved there at once
+// (first chunk, resume, device stall); between the soft and hard limits
+// the smoothed drift is worked off at most 1/kAudioCorrectionShare of a
+// chunk at a time, which is inaudible
+constexpr int64_t kAudioHardResyncMs = 200;
+constexpr int64_t kAudioSoftResyncMs = 20;
+constexpr int64_t kAudioCorrectionShare = 200;
+constexpr int64_t kMaxAudioPadMs = 5000;
+
+// Encoder frame size for codecs that take any size (PCM)
+constexpr int kDefaultAudioFrameSize = 1024;
+
+AVCodecID AudioCodecId(const QString& name)
+{
+    const QString codec = name.toLower();
+    if (codec == "aac") return AV_CODEC_ID_AAC;
+    if (codec == "opus") return AV_CODEC_ID_OPUS;
+    if (codec == "mp3") return AV_CODEC_ID_MP3;
+    if (codec == "flac") return AV_CODEC_ID_FLAC;
+    if (codec == "pcm") return AV_CODEC_ID_PCM_S16LE;
+    return AV_CODEC_ID_NONE;
+}
+
+bool CanConvertTo(AVSampleFormat format)
+{
+    switch (format) {
+    case AV_SAMPLE_FMT_FLT: case AV_SAMPLE_FMT_FLTP:
+    case AV_SAMPLE_FMT_S16: case AV_SAMPLE_FMT_S16P:
+    case AV_SAMPLE_FMT_S32: case AV_SAMPLE_FMT_S32P:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// The encoder's own preference among the formats the capture can be converted to
+AVSampleFormat PickSampleFormat(const AVCodec* codec)
+{
+    const AVSampleFormat* formats = nullptr;
+    int count = -1;  // -1: terminated by AV_SAMPLE_FMT_NONE
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61, 13, 100)
+    const void* configs = nullptr;
+    if (avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_SAMPLE_FORMAT, 0, &configs, &count) < 0) {
+        return AV_SAMPLE_FMT_NONE;
+    }
+    formats = static_cast<const AVSampleFormat*>(configs);
+#else
+    formats = codec->sample_fmts;
+#endif
+    if (!formats) {
+        return AV_SAMPLE_FMT_FLTP;  // Encoder accepts anything
+    }
+    for (int i = 0; count < 0 ? formats[i] != AV_SAMPLE_FMT_NONE : i < count; ++i) {
+        if (CanConvertTo(formats[i])) {
+            return formats[i];
+        }
+    }
+    return AV_SAMPLE_FMT_NONE;
+}
+
+// Interleaved capture sample as float in [-1, 1]
+float CaptureSample(const char* data, AudioCaptureFormat::SampleFormat format, int64_t index)
+{
+    switch (format) {
+    case AudioCaptureFormat::UInt8:
+        return (reinterpret_cast<const uint8_t*>(data)[index] - 128) / 128.0f;
+    case AudioCaptureFormat::Int16:
+        return reinterpret_cast<const int16_t*>(data)[index] / 32768.0f;
+    case AudioCaptureFormat::Int32:
+        return reinterpret_cast<const int32_t*>(data)[index] / 2147483648.0f;
+    case AudioCaptureFormat::Float:
+        return reinterpret_cast<const float*>(data)[index];
+    default:
+        return 0.0f;
+    }
+}
+
+void StoreSample(uint8_t** planes, AVSampleFormat format, int channels, int64_t frame, int channel, float value)
+{
+    value = qBound(-1.0f, value, 1.0f);
+    const bool planar = av_sample_fmt_is_planar(format);
+    const int64_t index = planar ? frame : frame * channels + channel;
+    uint8_t* plane = planes[planar ? channel : 0];
+    switch (format) {
+    case AV_SAMPLE_FMT_FLT: case AV_SAMPLE_FMT_FLTP:
+        reinterpret_cast<float*>(plane)[index] = value;
+        break;
+    case AV_SAMPLE_FMT_S16: case AV_SAMPLE_FMT_S16P:
+        reinterpret_cast<int16_t*>(plane)[index] = static_cast<int16_t>(value * 32767.0f);
+        break;
+    case AV_SAMPLE_FMT_S32: case AV_SAMPLE_FMT_S32P:
+        reinterpret_cast<int32_t*>(plane)[index] = static_cast<int32_t>(value * 2147483647.0);
+        break;
+    default:
+        break;
+    }
+}
+} // namespace
+
 FFmpegRecorder::FFmpegRecorder()
     : format_context_(nullptr),
       codec_context_(nullptr),
@@ -50,12 +174,44 @@ FFmpegRecorder::FFmpegRecorder()
       recording_packet_(nullptr),
       recording_active_(false),
       recording_paused_(false),
+      passthrough_(false),
+      last_passthrough_pts_(AV_NOPTS_VALUE),
+      last_passthrough_hash_(0),
+      last_passthrough_size_(-1),
+      last_passthrough_write_ms_(0),
+      source_time_base_num_(0),
+      source_time_base_den_(0),
+      source_origin_ms_(AV_NOPTS_VALUE),
+      segment_rotation_pending_(false),
+      segment_pts_origin_(0),
+      segment_origin_ms_(0),
+      segment_audio_origin_(0),
+      last_segment_flush_ms_(0),
+      audio_codec_context_(nullptr),
+      audio_stream_(nullptr),
+      audio_fifo_(nullptr),
+      audio_frame_(nullptr),
+      audio_packet_(nullptr),
+      audio_ring_(nullptr),
+      audio_position_(0),
+      audio_drift_average_(0),
       recording_start_time_(0),
       recording_paused_time_(0),
       total_paused_duration_(0),
       last_recorded_frame_time_(0),
       recording_target_framerate_(30),
-      recording_frame_number_(0)
+      recording_frame_number_(0),
+      encoder_running_(false),
+      frames_encoded_(0),
+      frames_dropped_(0),
+      frames_duplicated_(0),
+      frames_skipped_(0),
+      variable_frame_rate_(false),
+      last_queued_frame_time_(0),
+      audio_samples_padded_(0),
+      audio_samples_dropped_(0),
+      last_encoded_pts_(AV_NOPTS_VALUE),
+      recording_frame_converted_(false)
 {
 }
 
@@ -67,8 +223,14 @@ FFmpegRecorder::~FFmpegRecorder()
     CleanupRecording();
 }
 
+qint64 FFmpegRecorder::ClockMs()
+{
+    return AudioCaptureTap::now() / 1000000;
+}
+
 bool FFmpegRecorder::StartRecording(const QString& output_path, const QString& format, 
-                                    int video_bitrate, const QSize& resolution, int framerate)
+                                    int video_bitrate, const QSize& resolution, int framerate,
+                                    const AVStream* source_stream)
 {
     QMutexLocker locker(&mutex_);
     
@@ -85,19 +247,38 @@ bool FFmpegRecorder::StartRecording(const QString& output_path, const QString& f
     
     qCDebug(log_ffmpeg_backend) << "Starting recording to:" << output_path << "format:" << format;
     
-    if (!InitializeRecording(resolution, framerate)) {
+    if (!InitializeRecording(resolution, framerate, source_stream)) {
+        CleanupRecording();
+        CloseSegment();
         return false;
     }
     
     recording_active_ = true;
     recording_paused_ = false;
-    recording_start_time_ = QDateTime::currentMSecsSinceEpoch();
+    recording_start_time_ = ClockMs();
     recording_paused_time_ = 0;
     total_paused_duration_ = 0;
     last_recorded_frame_time_ = 0;
     recording_frame_number_ = 0;
+    last_passthrough_pts_ = AV_NOPTS_VALUE;
+    last_passthrough_size_ = -1;
+    source_origin_ms_ = AV_NOPTS_VALUE;
+    segment_rotation_pending_ = false;
+    segment_pts_origin_ = 0;
+    segment_origin_ms_ = 0;
+    segment_audio_origin_ = 0;
+    last_segment_flush_ms_ = QDateTime::currentMSecsSinceEpoch();
+    audio_position_ = 0;
+    audio_drift_average_ = 0;
+    
+    // Passthrough needs the thread only to encode the audio
+    if (!passthrough_ || audio_codec_context_) {
+        StartEncoderThread();
+    }
     
-    qCInfo(log_ffmpeg_backend) << "Recording started successfully";
+    qCInfo(log_ffmpeg_backend) << "Recording started successfully"
+                               << (passthrough_ ? "(MJPEG passthrough)" : "")
+                               << (audio_codec_context_ ? "with audio" : "without audio");
     return true;
 }
 
@@ -105,11 +286,30 @@ bool FFmpegRecorder::StopRecording()
 {
     qCDebug(log_ffmpeg_backend) << "Stopping recording";
     
-    // First, mark recording as inactive to prevent new frames from being processed
+    if (!IsRecording()) {
+        qCDebug(log_ffmpeg_backend) << "Recording is not active";
+        return false;
+    }
+    
+    // Variable frame rate: repeat the last frame at the stop time, so an
+    // idle tail is not cut off at the last change
+    {
+        QMutexLocker queue_locker(&queue_mutex_);
+        const qint64 now = ClockMs();
+        if (encoder_running_ && variable_frame_rate_ && !passthrough_ && last_queued_frame_time_ > 0
+            && now - last_queued_frame_time_ >= 1000 / qMax(1, recording_target_framerate_)) {
+            encode_queue_.push_back(PendingFrame{QImage(), now, false});
+            queue_not_empty_.wakeOne();
+        }
+    }
+    
+    // Let the encoder write out what is already queued while the recording
+    // is still marked active, then stop accepting frames
+    StopEncoderThread(true);
+    
     {
         QMutexLocker locker(&mutex_);
         if (!recording_active_) {
-            qCDebug(log_ffmpeg_backend) << "Recording is not active";
             return false;
         }
         recording_active_ = false;
@@ -123,6 +323,7 @@ bool FFmpegRecorder::StopRecording()
         QMutexLocker locker(&mutex_);
         FinalizeRecording();
         CleanupRecording();
+        CloseSegment();
     }
     
     qCInfo(log_ffmpeg_backend) << "Recording stopped successfully";
@@ -139,7 +340,7 @@ void FFmpegRecorder::PauseRecording()
     }
     
     recording_paused_ = true;
-    recording_paused_time_ = QDateTime::currentMSecsSinceEpoch();
+    recording_paused_time_ = ClockMs();
     
     qCDebug(log_ffmpeg_backend) << "Recording paused";
 }
@@ -154,7 +355,7 @@ void FFmpegRecorder::ResumeRecording()
     }
     
     if (recording_paused_time_ > 0) {
-        total_paused_duration_ += QDateTime::currentMSecsSinceEpoch() - recording_paused_time_;
+        total_paused_duration_ += ClockMs() - recording_paused_time_;
     }
     
     recording_paused_ = false;
@@ -166,9 +367,12 @@ void FFmpegRecorder::ResumeRecording()
 bool FFmpegRecorder::ForceStopRecording()
 {
     qCDebug(log_ffmpeg_backend) << "Force stopping recording";
+    StopEncoderThread(false);
     recording_active_ = false;
     recording_paused_ = false;
+    QMutexLocker locker(&mutex_);
     CleanupRecording();
+    CloseSegment();
     return true;
 }
 
@@ -184,6 +388,12 @@ bool FFmpegRecorder::IsPaused() const
     return recording_active_ && recording_paused_;
 }
 
+bool FFmpegRecorder::IsPassthrough() const
+{
+    QMutexLocker locker(&mutex_);
+    return recording_active_ && passthrough_;
+}
+
 QString FFmpegRecorder::GetCurrentRecordingPath() const
 {
     QMutexLocker locker(&mutex_);
@@ -198,7 +408,7 @@ qint64 FFmpegRecorder::GetRecordingDuration() const
         return 0;
     }
     
-    qint64 current_time = QDateTime::currentMSecsSinceEpoch();
+    qint64 current_time = ClockMs();
     qint64 total_duration = current_time - recording_start_time_ - total_paused_duration_;
     
     if (recording_paused_ && recording_paused_time_ > 0) {
@@ -218,13 +428,176 @@ qint64 FFmpegRecorder::GetRecordingFileSize() const
     return file_info.size();
 }
 
-bool FFmpegRecorder::WriteFrame(const QImage& image)
+bool FFmpegRecorder::WriteFrame(const QImage& image, bool changed)
 {
     // Quick check without lock
-    if (!recording_active_ || recording_paused_ || image.isNull()) {
+    if (!recording_active_ || recording_paused_ || passthrough_ || image.isNull()) {
         return false;
     }
     
+    const qint64 capture_time = ClockMs();
+    {
+        QMutexLocker queue_locker(&queue_mutex_);
+        if (!encoder_running_) {
+            return false;
+        }
+        
+        // Variable frame rate: the previous frame stays on screen until the
+        // next one's timestamp, so an unchanged frame is only a keepalive
+        if (variable_frame_rate_ && !changed && last_queued_frame_time_ > 0
+            && capture_time - last_queued_frame_time_ < kVfrKeepaliveMs) {
+            ++frames_skipped_;
+            return true;
+        }
+        
+        // Drop-oldest: the newest frame is the one closest to what is on screen
+        if (static_cast<int>(encode_queue_.size()) >= kEncodeQueueDepth) {
+            // A dropped change must still reach the encoder with the frame after it
+            if (encode_queue_.front().changed) {
+                if (encode_queue_.size() > 1) {
+                    encode_queue_[1].changed = true;
+                } else {
+                    changed = true;
+                }
+            }
+            encode_queue_.pop_front();
+            if (++frames_dropped_ % 30 == 1) {
+                qCDebug(log_ffmpeg_backend) << "Encoder falling behind - dropped" << frames_dropped_
+                                           << "queued recording frames so far";
+            }
+        }
+        
+        // Shares the pooled buffer; no pixel copy on the capture path
+        encode_queue_.push_back(PendingFrame{image, capture_time, changed});
+        last_queued_frame_time_ = capture_time;
+        queue_not_empty_.wakeOne();
+    }
+    
+    // Count the frame as written for ShouldWriteFrame() pacing
+    QMutexLocker locker(&mutex_);
+    recording_frame_number_++;
+    return true;
+}
+
+RecordingStats FFmpegRecorder::GetRecordingStats() const
+{
+    QMutexLocker queue_locker(&queue_mutex_);
+    RecordingStats stats;
+    stats.queue_length = static_cast<int>(encode_queue_.size());
+    stats.queue_capacity = kEncodeQueueDepth;
+    stats.frames_encoded = frames_encoded_;
+    stats.frames_dropped = frames_dropped_;
+    stats.frames_duplicated = frames_duplicated_;
+    stats.frames_skipped = frames_skipped_;
+    stats.has_audio = audio_codec_context_ != nullptr;
+    stats.audio_samples_padded = audio_samples_padded_;
+    stats.audio_samples_dropped = audio_samples_dropped_;
+    return stats;
+}
+
+void FFmpegRecorder::StartEncoderThread()
+{
+    StopEncoderThread(false);
+    
+    {
+        QMutexLocker queue_locker(&queue_mutex_);
+        encode_queue_.clear();
+        encoder_running_ = true;
+        frames_encoded_ = 0;
+        frames_dropped_ = 0;
+        frames_duplicated_ = 0;
+        frames_skipped_ = 0;
+        variable_frame_rate_ = recording_config_.variable_frame_rate;
+        last_queued_frame_time_ = 0;
+        audio_samples_padded_ = 0;
+        audio_samples_dropped_ = 0;
+    }
+    last_encoded_pts_ = AV_NOPTS_VALUE;
+    recording_frame_converted_ = false;
+    
+    encoder_thread_.reset(QThread::create([this]() { EncoderLoop(); }));
+    encoder_thread_->setObjectName("FFmpegRecorderEncoder");
+    encoder_thread_->start();
+}
+
+void FFmpegRecorder::StopEncoderThread(bool drain)
+{
+    {
+        QMutexLocker queue_locker(&queue_mutex_);
+        encoder_running_ = false;
+        if (!drain) {
+            encode_queue_.clear();
+        }
+        queue_not_empty_.wakeAll();
+    }
+    
+    if (encoder_thread_) {
+        encoder_thread_->wait();
+        encoder_thread_.reset();
+        qCDebug(log_ffmpeg_backend) << "Encoder thread stopped - encoded:" << frames_encoded_
+                                   << "dropped:" << frames_dropped_
+                                   << "duplicated:" << frames_duplicated_
+                                   << "skipped:" << frames_skipped_;
+    }
+}
+
+void FFmpegRecorder::EncoderLoop()
+{
+    for (;;) {
+        // Audio arrives whether or not the screen changes; wake up for it
+        DrainAudio();
+        
+        PendingFrame pending;
+        {
+            QMutexLocker queue_locker(&queue_mutex_);
+            while (encoder_running_ && encode_queue_.empty()) {
+                if (audio_ring_) {
+                    queue_not_empty_.wait(&queue_mutex_, kAudioPollMs);
+                    break;
+                }
+                queue_not_empty_.wait(&queue_mutex_);
+            }
+            if (encode_queue_.empty()) {
+                if (encoder_running_) {
+                    continue;  // Audio poll
+                }
+                queue_locker.unlock();
+                DrainAudio();
+                return;  // Stopped and drained
+            }
+            pending = std::move(encode_queue_.front());
+            encode_queue_.pop_front();
+        }
+        
+        if (EncodeFrame(pending.image, pending.capture_time_ms, pending.changed)) {
+            QMutexLocker queue_locker(&queue_mutex_);
+            ++frames_encoded_;
+        }
+    }
+}
+
+bool FFmpegRecorder::EncodeFrame(const QImage& image, qint64 capture_time_ms, bool changed)
+{
+    // Runs on the encoder thread only; sws_context_ and recording_frame_ are
+    // not touched elsewhere until the thread has been joined.
+    
+    // Static screen: recording_frame_ already holds this picture in the
+    // encoder's pixel format, so send it again with the new timestamp
+    if (!changed && recording_frame_converted_) {
+        {
+            QMutexLocker locker(&mutex_);
+            if (!recording_active_ || recording_paused_ || !recording_frame_) {
+                return false;
+            }
+        }
+        if (!WriteFrameToFile(AV_FRAME_RAW(recording_frame_), capture_time_ms)) {
+            return false;
+        }
+        QMutexLocker queue_locker(&queue_mutex_);
+        ++frames_duplicated_;
+        return true;
+    }
+    
     // Convert image to RGB888 format if needed
     QImage sourceImage = image;
     if (image.format() != QImage::Format_RGB888) {
@@ -236,13 +609,11 @@ bool FFmpegRecorder::WriteFrame(const QImage& image)
     
     // Debug logging for recording frame processing
     static int recording_debug_count = 0;
-    qint64 current_time = QDateTime::currentMSecsSinceEpoch();
     if (++recording_debug_count <= 10 || recording_debug_count % 30 == 0) {
         QMutexLocker locker(&mutex_);
-        qCDebug(log_ffmpeg_backend) << "Writing recording frame" << recording_debug_count 
+        qCDebug(log_ffmpeg_backend) << "Encoding recording frame" << recording_debug_count 
                                    << "- image size:" << sourceImage.size()
-                                   << "recording frame size:" << AV_FRAME_RAW(recording_frame_)->width << "x" << AV_FRAME_RAW(recording_frame_)->height
-                                   << "frame interval:" << (current_time - last_recorded_frame_time_) << "ms";
+                                   << "recording frame size:" << AV_FRAME_RAW(recording_frame_)->width << "x" << AV_FRAME_RAW(recording_frame_)->height;
     }
     
     bool can_write_frame = false;
@@ -266,11 +637,107 @@ bool FFmpegRecorder::WriteFrame(const QImage& image)
     if (scale_result != sourceImage.height()) {
         qCWarning(log_ffmpeg_backend) << "sws_scale conversion warning: converted" << scale_result << "lines, expected" << sourceImage.height();
     }
+    recording_frame_converted_ = scale_result > 0;
     
     // Write frame to file
-    return WriteFrameToFile(AV_FRAME_RAW(recording_frame_));
+    return WriteFrameToFile(AV_FRAME_RAW(recording_frame_), capture_time_ms);
+}
+
+bool FFmpegRecorder::WritePacket(const AVPacket* packet)
+{
+    QMutexLocker locker(&mutex_);
+    
+    if (!recording_active_ || recording_paused_ || !passthrough_ || !packet || packet->size <= 0
+        || !format_context_ || !video_stream_ || !recording_packet_) {
+        return false;
+    }
+    
+    // Rebase onto the recording timeline: device timestamps start at an
+    // arbitrary value, and time spent paused must not leave a gap in the file.
+    const qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+    qint64 wall_elapsed_ms = ClockMs() - recording_start_time_ - total_paused_duration_;
+    const int64_t elapsed_ms = PassthroughElapsedMs(packet, wall_elapsed_ms);
+    
+    // Variable frame rate: the camera encodes an unchanged picture to the
+    // same bytes, so a repeated packet is only muxed as a keepalive
+    if (recording_config_.variable_frame_rate) {
+        const uint64_t hash = FFmpegFrameDiff::HashTile(packet->data, packet->size, packet->size, 1);
+        if (packet->size == last_passthrough_size_ && hash == last_passthrough_hash_
+            && elapsed_ms - last_passthrough_write_ms_ < kVfrKeepaliveMs) {
+            QMutexLocker queue_locker(&queue_mutex_);
+            ++frames_skipped_;
+            return true;
+        }
+        last_passthrough_hash_ = hash;
+        last_passthrough_size_ = packet->size;
+        last_passthrough_write_ms_ = elapsed_ms;
+    }
+    
+    // Every MJPEG frame is a keyframe, so any packet can start a segment
+    if (segmenter_ && segmenter_->shouldRotate(now_ms, format_context_->pb ? avio_tell(format_context_->pb) : 0)) {
+        if (!RotateSegment(now_ms)) {
+            return false;
+        }
+        segment_origin_ms_ = elapsed_ms;
+        if (audio_codec_context_) {
+            segment_audio_origin_ = av_rescale(elapsed_ms, audio_codec_context_->sample_rate, 1000);
+        }
+    }
+    
+    int64_t pts = av_rescale_q(elapsed_ms - segment_origin_ms_,
+                               AVRational{1, 1000}, video_stream_->time_base);
+    if (last_passthrough_pts_ != AV_NOPTS_VALUE && pts <= last_passthrough_pts_) {
+        pts = last_passthrough_pts_ + 1;  // Muxers require strictly increasing timestamps
+    }
+    last_passthrough_pts_ = pts;
+    
+    AVPacket* out = AV_PACKET_RAW(recording_packet_);
+    int ret = av_packet_ref(out, packet);
+    if (ret < 0) {
+        qCWarning(log_ffmpeg_backend) << "Failed to reference packet for passthrough recording";
+        return false;
+    }
+    
+    out->pts = pts;
+    out->dts = pts;
+    out->duration = av_rescale_q(1, AVRational{1, recording_target_framerate_}, video_stream_->time_base);
+    out->pos = -1;
+    out->stream_index = video_stream_->index;
+    out->flags |= AV_PKT_FLAG_KEY;  // Every MJPEG frame is intra-coded
+    
+    recording_frame_number_++;
+    
+    // The muxer takes over the packet reference
+    ret = WriteSegmentPacket(out);
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        qCWarning(log_ffmpeg_backend) << "Error writing passthrough packet:" << QString::fromUtf8(errbuf);
+        av_packet_unref(out);
+        return false;
+    }
+    
+    return true;
 }
 
+int64_t FFmpegRecorder::PassthroughElapsedMs(const AVPacket* packet, qint64 wall_elapsed_ms)
+{
+    if (packet->pts == AV_NOPTS_VALUE || source_time_base_den_ <= 0) {
+        return wall_elapsed_ms;
+    }
+    
+    // Prefer the device timestamp: it records when the frame was captured,
+    // not when the decode path got round to handing it over.
+    int64_t source_ms = av_rescale_q(packet->pts,
+                                     AVRational{source_time_base_num_, source_time_base_den_},
+                                     AVRational{1, 1000});
+    const qint64 max_drift_ms = audio_stream_ ? kMaxSourceClockDriftWithAudioMs : kMaxSourceClockDriftMs;
+    if (source_origin_ms_ == AV_NOPTS_VALUE
+        || qAbs(source_ms - source_origin_ms_ - wall_elapsed_ms) > max_drift_ms) {
+        source_origin_ms_ = source_ms - wall_elapsed_ms;
+    }
+    return source_ms - source_origin_ms_;
+}
 
 bool FFmpegRecorder::ShouldWriteFrame(qint64 current_time_ms)
 {
@@ -280,6 +747,17 @@ bool FFmpegRecorder::ShouldWriteFrame(qint64 current_time_ms)
         return false;
     }
     
+    // Variable frame rate: only cap the rate. Unchanged frames are skipped
+    // by WriteFrame, so a frame count behind schedule is not a backlog.
+    if (recording_config_.variable_frame_rate) {
+        const qint64 interval_ms = 1000 / qMax(1, recording_target_framerate_);
+        if (last_recorded_frame_time_ > 0 && current_time_ms - last_recorded_frame_time_ < interval_ms * 3 / 4) {
+            return false;
+        }
+        last_recorded_frame_time_ = current_time_ms;
+        return true;
+    }
+    
     // Calculate expected frame number based on actual elapsed recording time
     qint64 elapsed_ms = current_time_ms - recording_start_time_ - total_paused_duration_;
     int64_t expected_frame_number = (elapsed_ms * recording_target_framerate_) / 1000;
@@ -336,6 +814,21 @@ void FFmpegRecorder::TakeImage(const QString& file_path, const QImage& image)
     }
 }
 
+void FFmpegRecorder::TakeImage(const QString& file_path, const QByteArray& jpeg_data)
+{
+    if (jpeg_data.isEmpty()) {
+        qCWarning(log_ffmpeg_backend) << "No JPEG data available for image capture";
+        return;
+    }
+    
+    QFile file(file_path);
+    if (file.open(QIODevice::WriteOnly) && file.write(jpeg_data) == jpeg_data.size()) {
+        qCDebug(log_ffmpeg_backend) << "Image saved to:" << file_path << "(camera JPEG, no re-encode)";
+    } else {
+        qCWarning(log_ffmpeg_backend) << "Failed to save image to:" << file_path;
+    }
+}
+
 void FFmpegRecorder::TakeAreaImage(const QString& file_path, const QImage& image, const QRect& capture_area)
 {
     if (image.isNull()) {
@@ -351,11 +844,59 @@ void FFmpegRecorder::TakeAreaImage(const QString& file_path, const QImage& image
     }
 }
 
-bool FFmpegRecorder::InitializeRecording(const QSize& resolution, int framerate)
+bool FFmpegRecorder::InitializeRecording(const QSize& resolution, int framerate, const AVStream* source_stream)
 {
     // Clean up any existing recording context
     CleanupRecording();
+    segmenter_.reset();
+    
+    QString path = recording_config_.output_path;
+    const SegmentPolicy policy = SegmentPolicyFromConfig();
+    if (policy.isSegmented()) {
+        segmenter_ = std::make_unique<RecordingSegmenter>();
+        QString error;
+        if (!segmenter_->begin(path, policy, &error)) {
+            qCWarning(log_ffmpeg_backend) << "Cannot start segmented recording:" << error;
+            segmenter_.reset();
+            return false;
+        }
+        path = segmenter_->openSegment(QDateTime::currentMSecsSinceEpoch());
+        qCInfo(log_ffmpeg_backend) << "Segmented recording, index:" << segmenter_->indexPath();
+    }
+    recording_output_path_ = path;
+    
+    if (!AllocateOutputContext(path)) {
+        return false;
+    }
+    
+    passthrough_ = CanPassthrough(source_stream);
+    if (passthrough_) {
+        if (!ConfigurePassthroughStream(source_stream, framerate)) {
+            return false;
+        }
+    } else {
+        qCDebug(log_ffmpeg_backend) << "Configuring encoder with resolution:" << resolution << "framerate:" << framerate;
+        
+        if (!ConfigureEncoder(resolution, framerate)) {
+            return false;
+        }
+    }
+    
+    // Optional: without it the recording is video only
+    if (!ConfigureAudioEncoder()) {
+        CleanupAudio();
+    }
     
+    if (!OpenOutput(path)) {
+        return false;
+    }
+    
+    qCDebug(log_ffmpeg_backend) << "Recording initialized successfully";
+    return true;
+}
+
+bool FFmpegRecorder::AllocateOutputContext(const QString& path)
+{
     // Allocate output format context
     const char* format_name = nullptr;
     if (recording_config_.format == "avi") {
@@ -370,27 +911,31 @@ bool FFmpegRecorder::InitializeRecording(const QSize& resolution, int framerate)
     
     // Try to allocate output context
     int ret = avformat_alloc_output_context2(&format_context_, nullptr, format_name, 
-                                             recording_config_.output_path.toUtf8().data());
+                                             path.toUtf8().data());
     if (ret < 0 || !format_context_) {
         // Try auto-detection from filename if format name failed
         qCWarning(log_ffmpeg_backend) << "Failed with format" << format_name << ", trying auto-detection from filename";
         ret = avformat_alloc_output_context2(&format_context_, nullptr, nullptr, 
-                                             recording_config_.output_path.toUtf8().data());
+                                             path.toUtf8().data());
         if (ret < 0 || !format_context_) {
             qCWarning(log_ffmpeg_backend) << "Failed to allocate output context for recording";
             return false;
         }
     }
-    
-    qCDebug(log_ffmpeg_backend) << "Configuring encoder with resolution:" << resolution << "framerate:" << framerate;
-    
-    if (!ConfigureEncoder(resolution, framerate)) {
-        return false;
-    }
-    
+    return true;
+}
+
+bool FFmpegRecorder::OpenOutput(const QString& path)
+{
     // Open output file
     if (!(format_context_->oformat->flags & AVFMT_NOFILE)) {
-        ret = avio_open(&format_context_->pb, recording_config_.output_path.toUtf8().data(), AVIO_FLAG_WRITE);
+        // Keep the space the segmenter reserved instead of truncating it away
+        AVDictionary* io_options = nullptr;
+        if (segmenter_) {
+            av_dict_set(&io_options, "truncate", "0", 0);
+        }
+        int ret = avio_open2(&format_context_->pb, path.toUtf8().data(), AVIO_FLAG_WRITE, nullptr, &io_options);
+        av_dict_free(&io_options);
         if (ret < 0) {
             char errbuf[AV_ERROR_MAX_STRING_SIZE];
             av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
@@ -399,16 +944,183 @@ bool FFmpegRecorder::InitializeRecording(const QSize& resolution, int framerate)
         }
     }
     
+    // Segments must stay readable up to the last flush: fragmented MP4/MOV
+    // (no moov at the end to lose) and one-second Matroska clusters
+    AVDictionary* mux_options = nullptr;
+    if (segmenter_) {
+        const QString muxer = QString::fromUtf8(format_context_->oformat->name);
+        if (muxer.contains("mp4") || muxer.contains("mov")) {
+            av_dict_set(&mux_options, "movflags", "+empty_moov+default_base_moof", 0);
+            av_dict_set(&mux_options, "frag_duration", "1000000", 0);
+        } else if (muxer.contains("matroska")) {
+            av_dict_set(&mux_options, "cluster_time_limit", "1000", 0);
+        }
+    }
+    
     // Write file header
-    ret = avformat_write_header(format_context_, nullptr);
+    int ret = avformat_write_header(format_context_, &mux_options);
+    av_dict_free(&mux_options);
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
         av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
         qCWarning(log_ffmpeg_backend) << "Failed to write header:" << QString::fromUtf8(errbuf);
         return false;
     }
+    return true;
+}
+
+SegmentPolicy FFmpegRecorder::SegmentPolicyFromConfig() const
+{
+    SegmentPolicy policy;
+    policy.segmentDurationMs = qMax(0, recording_config_.segment_duration_sec) * 1000LL;
+    policy.segmentSizeBytes = qMax<qint64>(0, recording_config_.segment_size_bytes);
+    policy.retentionMs = qMax(0, recording_config_.retention_hours) * 3600LL * 1000;
+    
+    // Reserve what one segment is expected to take so the file grows
+    // sequentially; passthrough bitrate is unknown, so this is a floor there
+    qint64 expected = policy.segmentSizeBytes;
+    if (expected <= 0 && policy.segmentDurationMs > 0) {
+        expected = static_cast<qint64>(recording_config_.video_bitrate) / 8 * (policy.segmentDurationMs / 1000);
+    }
+    policy.preallocateBytes = qBound<qint64>(0, expected, kMaxSegmentPreallocation);
+    return policy;
+}
+
+bool FFmpegRecorder::RotateSegment(qint64 now_ms)
+{
+    // Called with mutex_ held. The next file gets the same stream as this one.
+    AVCodecParameters* params = avcodec_parameters_alloc();
+    if (!params || avcodec_parameters_copy(params, video_stream_->codecpar) < 0) {
+        avcodec_parameters_free(&params);
+        qCWarning(log_ffmpeg_backend) << "Failed to keep stream parameters for the next segment";
+        return false;
+    }
+    const AVRational time_base = codec_context_ ? codec_context_->time_base
+                                                : AVRational{1, recording_target_framerate_};
+    AVCodecParameters* audio_params = nullptr;
+    if (audio_stream_) {
+        audio_params = avcodec_parameters_alloc();
+        if (!audio_params || avcodec_parameters_copy(audio_params, audio_stream_->codecpar) < 0) {
+            avcodec_parameters_free(&params);
+            avcodec_parameters_free(&audio_params);
+            qCWarning(log_ffmpeg_backend) << "Failed to keep audio parameters for the next segment";
+            return false;
+        }
+    }
     
-    qCDebug(log_ffmpeg_backend) << "Recording initialized successfully";
+    int ret = av_write_trailer(format_context_);
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        qCWarning(log_ffmpeg_backend) << "Error writing segment trailer:" << QString::fromUtf8(errbuf);
+    }
+    CloseOutput();
+    
+    // Closes the finished segment in the index and applies retention
+    const QString path = segmenter_->openSegment(now_ms);
+    const bool opened = AllocateOutputContext(path) && AddVideoStream(params, time_base)
+        && (!audio_params || AddAudioStream(audio_params)) && OpenOutput(path);
+    avcodec_parameters_free(&params);
+    avcodec_parameters_free(&audio_params);
+    if (!opened) {
+        qCWarning(log_ffmpeg_backend) << "Failed to open next recording segment" << path;
+        CloseOutput();
+        return false;
+    }
+    
+    recording_output_path_ = path;
+    last_passthrough_pts_ = AV_NOPTS_VALUE;
+    last_segment_flush_ms_ = now_ms;
+    qCInfo(log_ffmpeg_backend) << "Recording continues in segment" << path;
+    return true;
+}
+
+void FFmpegRecorder::CloseSegment()
+{
+    // Called once the file is closed, so the index records its final size
+    if (segmenter_) {
+        segmenter_->closeSegment(QDateTime::currentMSecsSinceEpoch());
+        segmenter_.reset();
+    }
+}
+
+int FFmpegRecorder::WriteSegmentPacket(AVPacket* packet)
+{
+    int ret = av_interleaved_write_frame(format_context_, packet);
+    if (ret < 0 || !segmenter_) {
+        return ret;
+    }
+    
+    // Push buffered muxer output to disk; a null packet closes the current
+    // fragment or cluster in formats that support it
+    const qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+    if (now_ms - last_segment_flush_ms_ >= kSegmentFlushIntervalMs) {
+        last_segment_flush_ms_ = now_ms;
+        av_write_frame(format_context_, nullptr);
+        if (format_context_->pb) {
+            avio_flush(format_context_->pb);
+        }
+    }
+    return ret;
+}
+
+bool FFmpegRecorder::CanPassthrough(const AVStream* source_stream) const
+{
+    if (!recording_config_.allow_passthrough || !source_stream || !source_stream->codecpar
+        || source_stream->codecpar->codec_id != AV_CODEC_ID_MJPEG || !format_context_) {
+        return false;
+    }
+    
+    // Any other codec choice means the user wants a re-encode
+    const QString codec = recording_config_.video_codec.toLower();
+    if (!codec.isEmpty() && codec != "mjpeg") {
+        return false;
+    }
+    
+    return avformat_query_codec(format_context_->oformat, AV_CODEC_ID_MJPEG, FF_COMPLIANCE_NORMAL) == 1;
+}
+
+bool FFmpegRecorder::ConfigurePassthroughStream(const AVStream* source_stream, int framerate)
+{
+    // AVI derives its frame rate from the time base; MKV/MOV rewrite it in
+    // avformat_write_header and WritePacket rescales into whatever they chose.
+    recording_target_framerate_ = framerate > 0 ? framerate : 30;
+    if (!AddVideoStream(source_stream->codecpar, AVRational{1, recording_target_framerate_})) {
+        return false;
+    }
+    
+    source_time_base_num_ = source_stream->time_base.num;
+    source_time_base_den_ = source_stream->time_base.den;
+    
+    // Packets are referenced into this shell before being handed to the muxer
+    recording_packet_ = make_av_packet();
+    if (!recording_packet_) {
+        qCWarning(log_ffmpeg_backend) << "Failed to allocate recording packet";
+        return false;
+    }
+    
+    qCInfo(log_ffmpeg_backend) << "MJPEG passthrough recording at native resolution"
+                               << video_stream_->codecpar->width << "x" << video_stream_->codecpar->height
+                               << "@" << recording_target_framerate_ << "fps";
+    return true;
+}
+
+bool FFmpegRecorder::AddVideoStream(const AVCodecParameters* params, AVRational time_base)
+{
+    video_stream_ = avformat_new_stream(format_context_, nullptr);
+    if (!video_stream_) {
+        qCWarning(log_ffmpeg_backend) << "Failed to create video stream";
+        return false;
+    }
+    
+    int ret = avcodec_parameters_copy(video_stream_->codecpar, params);
+    if (ret < 0) {
+        qCWarning(log_ffmpeg_backend) << "Failed to copy video stream parameters";
+        return false;
+    }
+    video_stream_->codecpar->codec_tag = 0;  // Let the muxer pick its own tag (MJPG)
+    video_stream_->time_base = time_base;
+    video_stream_->avg_frame_rate = {recording_target_framerate_, 1};
     return true;
 }
 
@@ -486,6 +1198,7 @@ bool FFmpegRecorder::ConfigureEncoder(const QSize& resolution, int framerate)
         av_opt_set_int(codec_context_->priv_data, "crf", recording_config_.video_quality, 0);
         av_opt_set(codec_context_->priv_data, "preset", "ultrafast", 0);
         av_opt_set(codec_context_->priv_data, "tune", "zerolatency", 0);
+        av_opt_set_int(codec_context_->priv_data, "forced-idr", 1, 0);  // Segments start on an IDR frame
         
         codec_context_->rc_max_rate = recording_config_.video_bitrate;
         codec_context_->rc_buffer_size = recording_config_.video_bitrate * 2;
@@ -562,7 +1275,7 @@ bool FFmpegRecorder::ConfigureEncoder(const QSize& resolution, int framerate)
     return true;
 }
 
-bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame)
+bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame, qint64 capture_time_ms)
 {
     QMutexLocker locker(&mutex_);
     
@@ -572,14 +1285,27 @@ bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame)
         return false;
     }
     
-    // Calculate PTS based on actual elapsed time for proper A/V synchronization
-    qint64 current_time = QDateTime::currentMSecsSinceEpoch();
-    qint64 elapsed_ms = current_time - recording_start_time_ - total_paused_duration_;
+    // Calculate PTS from when the frame was captured (not when the encoder got
+    // to it) for proper A/V synchronization
+    qint64 elapsed_ms = capture_time_ms - recording_start_time_ - total_paused_duration_;
     
     // Convert elapsed milliseconds to PTS using the codec's time base
     int64_t pts = av_rescale_q(elapsed_ms, AVRational{1, 1000}, codec_context_->time_base);
+    if (last_encoded_pts_ != AV_NOPTS_VALUE && pts <= last_encoded_pts_) {
+        pts = last_encoded_pts_ + 1;  // Encoders reject non-increasing timestamps
+    }
+    last_encoded_pts_ = pts;
     frame->pts = pts;
     
+    // A segment is due: request a keyframe, the file switches when it comes out
+    const qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+    const bool request_keyframe = segmenter_ && !segment_rotation_pending_
+        && segmenter_->shouldRotate(now_ms, format_context_->pb ? avio_tell(format_context_->pb) : 0);
+    if (request_keyframe) {
+        segment_rotation_pending_ = true;
+        frame->pict_type = AV_PICTURE_TYPE_I;
+    }
+    
     // Debug logging for first few frames
     static int debug_frame_count = 0;
     if (++debug_frame_count <= 5 || debug_frame_count % 100 == 0) {
@@ -589,10 +1315,11 @@ bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame)
                                    << "time_base" << codec_context_->time_base.num << "/" << codec_context_->time_base.den;
     }
     
-    recording_frame_number_++;
-    
     // Send frame to encoder
     int ret = avcodec_send_frame(codec_context_, frame);
+    if (request_keyframe) {
+        frame->pict_type = AV_PICTURE_TYPE_NONE;  // recording_frame_ is reused for the next frame
+    }
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
         av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
@@ -619,12 +1346,8 @@ bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame)
             return false;
         }
         
-        // Scale packet timestamp
-        av_packet_rescale_ts(AV_PACKET_RAW(recording_packet_), codec_context_->time_base, video_stream_->time_base);
-        AV_PACKET_RAW(recording_packet_)->stream_index = video_stream_->index;
-        
         // Write packet to output file
-        ret = av_interleaved_write_frame(format_context_, AV_PACKET_RAW(recording_packet_));
+        ret = WriteEncodedPacket(AV_PACKET_RAW(recording_packet_));
         if (ret < 0) {
             char errbuf[AV_ERROR_MAX_STRING_SIZE];
             av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
@@ -639,9 +1362,360 @@ bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame)
     return true;
 }
 
+int FFmpegRecorder::WriteEncodedPacket(AVPacket* packet)
+{
+    if (segment_rotation_pending_ && recording_active_ && (packet->flags & AV_PKT_FLAG_KEY)) {
+        segment_rotation_pending_ = false;
+        if (!RotateSegment(QDateTime::currentMSecsSinceEpoch())) {
+            return AVERROR(EIO);
+        }
+        segment_pts_origin_ = packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+        if (audio_codec_context_) {
+            segment_audio_origin_ = av_rescale_q(segment_pts_origin_, codec_context_->time_base,
+                                                 audio_codec_context_->time_base);
+        }
+    }
+    
+    // Each segment starts at zero; the encoder's own clock keeps running
+    if (packet->pts != AV_NOPTS_VALUE) {
+        packet->pts -= segment_pts_origin_;
+    }
+    if (packet->dts != AV_NOPTS_VALUE) {
+        packet->dts -= segment_pts_origin_;
+    }
+    
+    // Scale packet timestamp
+    av_packet_rescale_ts(packet, codec_context_->time_base, video_stream_->time_base);
+    packet->stream_index = video_stream_->index;
+    return WriteSegmentPacket(packet);
+}
+
+bool FFmpegRecorder::ConfigureAudioEncoder()
+{
+    audio_capture_format_ = AudioCaptureTap::instance().format();
+    if (!recording_config_.record_audio) {
+        return false;
+    }
+    if (!audio_capture_format_.isValid()) {
+        qCInfo(log_ffmpeg_backend) << "No audio is being captured - recording video only";
+        return false;
+    }
+    
+    // The requested codec if this container takes it, else AAC, else Opus
+    QStringList candidates{recording_config_.audio_codec.toLower(), "aac", "opus"};
+    candidates.removeDuplicates();
+    for (const QString& name : candidates) {
+        const AVCodecID codec_id = AudioCodecId(name);
+        if (codec_id == AV_CODEC_ID_NONE
+            || avformat_query_codec(format_context_->oformat, codec_id, FF_COMPLIANCE_NORMAL) != 1) {
+            continue;
+        }
+        const AVCodec* codec = codec_id == AV_CODEC_ID_OPUS ? avcodec_find_encoder_by_name("libopus") : nullptr;
+        if (!codec) {
+            codec = avcodec_find_encoder(codec_id);
+        }
+        if (codec && OpenAudioEncoder(codec)) {
+            break;
+        }
+    }
+    if (!audio_codec_context_) {
+        qCWarning(log_ffmpeg_backend) << "No usable audio encoder for" << recording_config_.format
+                                      << "- recording video only";
+        return false;
+    }
+    
+    audio_fifo_ = av_audio_fifo_alloc(audio_codec_context_->sample_fmt, audio_capture_format_.channels,
+                                      audio_capture_format_.sampleRate);
+    audio_frame_ = av_frame_alloc();
+    audio_packet_ = av_packet_alloc();
+    if (!audio_fifo_ || !audio_frame_ || !audio_packet_) {
+        qCWarning(log_ffmpeg_backend) << "Failed to allocate audio buffers";
+        return false;
+    }
+    audio_frame_->format = audio_codec_context_->sample_fmt;
+    audio_frame_->sample_rate = audio_codec_context_->sample_rate;
+    audio_frame_->nb_samples = audio_codec_context_->frame_size > 0 ? audio_codec_context_->frame_size
+                                                                    : kDefaultAudioFrameSize;
+    if (av_channel_layout_copy(&audio_frame_->ch_layout, &audio_codec_context_->ch_layout) < 0
+        || av_frame_get_buffer(audio_frame_, 0) < 0) {
+        qCWarning(log_ffmpeg_backend) << "Failed to allocate audio frame";
+        return false;
+    }
+    
+    AVCodecParameters* params = avcodec_parameters_alloc();
+    const bool added = params && avcodec_parameters_from_context(params, audio_codec_context_) >= 0
+        && AddAudioStream(params);
+    avcodec_parameters_free(&params);
+    if (!added) {
+        return false;
+    }
+    
+    // Buffer from now on; what was captured before the recording clock
+    // starts is trimmed by the first resync
+    audio_ring_ = AudioCaptureTap::instance().attach(kAudioRingBytes);
+    
+    qCInfo(log_ffmpeg_backend) << "Recording audio:" << audio_codec_context_->codec->name
+                               << audio_codec_context_->sample_rate << "Hz"
+                               << audio_capture_format_.channels << "ch"
+                               << av_get_sample_fmt_name(audio_codec_context_->sample_fmt);
+    return true;
+}
+
+bool FFmpegRecorder::OpenAudioEncoder(const AVCodec* codec)
+{
+    const AVSampleFormat sample_format = PickSampleFormat(codec);
+    if (sample_format == AV_SAMPLE_FMT_NONE) {
+        return false;
+    }
+    
+    AVCodecContext* context = avcodec_alloc_context3(codec);
+    if (!context) {
+        return false;
+    }
+    context->sample_fmt = sample_format;
+    context->sample_rate = audio_capture_format_.sampleRate;
+    av_channel_layout_default(&context->ch_layout, audio_capture_format_.channels);
+    context->bit_rate = recording_config_.audio_bitrate > 0 ? recording_config_.audio_bitrate : 128000;
+    context->time_base = {1, audio_capture_format_.sampleRate};
+    if (codec->capabilities & AV_CODEC_CAP_EXPERIMENTAL) {
+        context->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
+    }
+    if (format_context_->oformat->flags & AVFMT_GLOBALHEADER) {
+        context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    
+    int ret = avcodec_open2(context, codec, nullptr);
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        qCDebug(log_ffmpeg_backend) << "Audio encoder" << codec->name << "unavailable:" << QString::fromUtf8(errbuf);
+        avcodec_free_context(&context);
+        return false;
+    }
+    audio_codec_context_ = context;
+    return true;
+}
+
+bool FFmpegRecorder::AddAudioStream(const AVCodecParameters* params)
+{
+    audio_stream_ = avformat_new_stream(format_context_, nullptr);
+    if (!audio_stream_ || avcodec_parameters_copy(audio_stream_->codecpar, params) < 0) {
+        qCWarning(log_ffmpeg_backend) << "Failed to create audio stream";
+        return false;
+    }
+    audio_stream_->codecpar->codec_tag = 0;
+    audio_stream_->time_base = AVRational{1, params->sample_rate};
+    return true;
+}
+
+void FFmpegRecorder::DrainAudio()
+{
+    // Encoder thread only
+    if (!audio_ring_) {
+        return;
+    }
+    
+    QByteArray pcm;
+    qint64 capture_ns = 0;
+    while (audio_ring_->pop(&pcm, &capture_ns)) {
+        QMutexLocker locker(&mutex_);
+        if (!recording_active_ || !audio_codec_context_) {
+            return;
+        }
+        if (recording_paused_) {
+            continue;  // Nothing is recorded while paused
+        }
+        const qint64 origin_ns = (recording_start_time_ + total_paused_duration_) * 1000000;
+        QueueAudioChunk(pcm, capture_ns - origin_ns);
+        if (!EncodeAudioFrames(false)) {
+            return;
+        }
+    }
+}
+
+void FFmpegRecorder::QueueAudioChunk(const QByteArray& pcm, qint64 elapsed_ns)
+{
+    // Called with mutex_ held
+    const int frame_bytes = audio_capture_format_.bytesPerFrame();
+    const int channels = audio_capture_format_.channels;
+    const int rate = audio_codec_context_->sample_rate;
+    const int64_t samples = frame_bytes > 0 ? pcm.size() / frame_bytes : 0;
+    if (samples <= 0) {
+        return;
+    }
+    
+    // The chunk's timestamp is when its last sample was read, so it belongs
+    // `samples` before that on the recording timeline
+    const int64_t expected = av_rescale(elapsed_ns, rate, 1000000000) - samples;
+    const int64_t drift = expected - audio_position_;  // > 0: audio is behind the clock
+    const int64_t hard_limit = av_rescale(kAudioHardResyncMs, rate, 1000);
+    
+    int64_t pad = 0;
+    int64_t skip = 0;
+    bool hold = false;  // Pad by repeating the first sample rather than with silence
+    if (audio_position_ == 0 || qAbs(drift) > hard_limit) {
+        if (drift > 0) {
+            pad = qMin(drift, av_rescale(kMaxAudioPadMs, rate, 1000));
+        } else {
+            skip = qMin(-drift, samples);
+        }
+        audio_drift_average_ = 0;
+    } else {
+        // Read timing jitters by a buffer or so; only the trend is corrected
+        audio_drift_average_ += (drift - audio_drift_average_) / 16;
+        if (qAbs(audio_drift_average_) > av_rescale(kAudioSoftResyncMs, rate, 1000)) {
+            const int64_t step = qMax<int64_t>(1, samples / kAudioCorrectionShare);
+            if (audio_drift_average_ > 0) {
+                pad = qMin(audio_drift_average_, step);
+                hold = true;
+            } else {
+                skip = qMin(-audio_drift_average_, step);
+            }
+            audio_drift_average_ += skip - pad;
+        }
+    }
+    if (pad > 0 || skip > 0) {
+        QMutexLocker queue_locker(&queue_mutex_);
+        audio_samples_padded_ += pad;
+        audio_samples_dropped_ += skip;
+    }
+    
+    const int64_t kept = samples - skip;
+    const int64_t total = pad + kept;
+    if (total <= 0) {
+        return;
+    }
+    
+    // Convert to the encoder's sample format into a reused buffer
+    const AVSampleFormat format = audio_codec_context_->sample_fmt;
+    const int buffer_size = av_samples_get_buffer_size(nullptr, channels, static_cast<int>(total), format, 1);
+    if (buffer_size <= 0) {
+        return;
+    }
+    if (audio_convert_buffer_.size() < static_cast<size_t>(buffer_size)) {
+        audio_convert_buffer_.resize(buffer_size);
+    }
+    uint8_t* planes[AV_NUM_DATA_POINTERS] = {};
+    av_samples_fill_arrays(planes, nullptr, audio_convert_buffer_.data(), channels,
+                           static_cast<int>(total), format, 1);
+    
+    const char* data = pcm.constData();
+    const AudioCaptureFormat::SampleFormat source_format = audio_capture_format_.sampleFormat;
+    for (int64_t frame = 0; frame < total; ++frame) {
+        const int64_t source_frame = frame < pad ? skip : skip + frame - pad;
+        for (int channel = 0; channel < channels; ++channel) {
+            const float value = frame < pad && !hold
+                ? 0.0f
+                : CaptureSample(data, source_format, source_frame * channels + channel);
+            StoreSample(planes, format, channels, frame, channel, value);
+        }
+    }
+    
+    if (av_audio_fifo_write(audio_fifo_, reinterpret_cast<void**>(planes), static_cast<int>(total)) < total) {
+        qCWarning(log_ffmpeg_backend) << "Failed to queue audio samples";
+        return;
+    }
+    audio_position_ += total;
+}
+
+bool FFmpegRecorder::EncodeAudioFrames(bool flush)
+{
+    // Called with mutex_ held
+    const int frame_size = audio_frame_->nb_samples;
+    const bool small_last_frame = audio_codec_context_->codec->capabilities
+        & (AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_VARIABLE_FRAME_SIZE);
+    
+    auto receive_packets = [this]() -> bool {
+        for (;;) {
+            int ret = avcodec_receive_packet(audio_codec_context_, audio_packet_);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                return true;
+            }
+            if (ret >= 0) {
+                ret = WriteAudioPacket(audio_packet_);
+                av_packet_unref(audio_packet_);
+            }
+            if (ret < 0) {
+                char errbuf[AV_ERROR_MAX_STRING_SIZE];
+                av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+                qCWarning(log_ffmpeg_backend) << "Error writing audio:" << QString::fromUtf8(errbuf);
+                return false;
+            }
+        }
+    };
+    
+    for (;;) {
+        const int queued = av_audio_fifo_size(audio_fifo_);
+        const int count = qMin(queued, frame_size);
+        if (count <= 0 || (count < frame_size && !(flush && small_last_frame))) {
+            break;
+        }
+        if (av_frame_make_writable(audio_frame_) < 0) {
+            return false;
+        }
+        // The oldest queued sample sits `queued` before the write position
+        audio_frame_->pts = audio_position_ - queued;
+        audio_frame_->nb_samples = count;
+        av_audio_fifo_read(audio_fifo_, reinterpret_cast<void**>(audio_frame_->data), count);
+        const int ret = avcodec_send_frame(audio_codec_context_, audio_frame_);
+        audio_frame_->nb_samples = frame_size;
+        if (ret < 0 || !receive_packets()) {
+            return false;
+        }
+    }
+    
+    if (flush) {
+        av_audio_fifo_reset(audio_fifo_);
+        if (avcodec_send_frame(audio_codec_context_, nullptr) >= 0) {
+            return receive_packets();
+        }
+    }
+    return true;
+}
+
+int FFmpegRecorder::WriteAudioPacket(AVPacket* packet)
+{
+    // Called with mutex_ held
+    if (!format_context_ || !audio_stream_) {
+        return 0;
+    }
+    
+    // Same per-segment origin as the video. Encoder priming starts slightly
+    // below zero; anything further back belongs to the previous segment.
+    if (packet->pts != AV_NOPTS_VALUE) {
+        packet->pts -= segment_audio_origin_;
+        if (packet->pts < -audio_codec_context_->initial_padding) {
+            return 0;
+        }
+    }
+    if (packet->dts != AV_NOPTS_VALUE) {
+        packet->dts -= segment_audio_origin_;
+    }
+    
+    av_packet_rescale_ts(packet, audio_codec_context_->time_base, audio_stream_->time_base);
+    packet->stream_index = audio_stream_->index;
+    return WriteSegmentPacket(packet);
+}
+
+void FFmpegRecorder::CleanupAudio()
+{
+    if (audio_ring_) {
+        AudioCaptureTap::instance().detach();
+        audio_ring_ = nullptr;
+    }
+    if (audio_fifo_) {
+        av_audio_fifo_free(audio_fifo_);
+        audio_fifo_ = nullptr;
+    }
+    av_frame_free(&audio_frame_);
+    av_packet_free(&audio_packet_);
+    avcodec_free_context(&audio_codec_context_);
+    audio_stream_ = nullptr;
+}
+
 void FFmpegRecorder::FinalizeRecording()
 {
-    if (!format_context_ || !codec_context_) {
+    if (!format_context_ || (!codec_context_ && !passthrough_)) {
         qCDebug(log_ffmpeg_backend) << "Recording context already cleaned up, skipping finalization";
         return;
     }
@@ -670,15 +1744,18 @@ void FFmpegRecorder::FinalizeRecording()
                 
                 // Scale packet timestamp and write to file
                 if (video_stream_ && format_context_) {
-                    av_packet_rescale_ts(AV_PACKET_RAW(recording_packet_), codec_context_->time_base, video_stream_->time_base);
-                    AV_PACKET_RAW(recording_packet_)->stream_index = video_stream_->index;
-                    av_interleaved_write_frame(format_context_, AV_PACKET_RAW(recording_packet_));
+                    WriteEncodedPacket(AV_PACKET_RAW(recording_packet_));
                 }
                 av_packet_unref(AV_PACKET_RAW(recording_packet_));
             }
         }
     }
     
+    // Encode what is left of the audio, including a short last frame
+    if (audio_codec_context_ && format_context_) {
+        EncodeAudioFrames(true);
+    }
+    
     // Write trailer
     if (format_context_) {
         int ret = av_write_trailer(format_context_);
@@ -711,6 +1788,15 @@ void FFmpegRecorder::CleanupRecording()
         avcodec_free_context(&codec_context_);
     }
     
+    CleanupAudio();
+    CloseOutput();
+    passthrough_ = false;
+    
+    qCDebug(log_ffmpeg_backend) << "Recording cleanup completed";
+}
+
+void FFmpegRecorder::CloseOutput()
+{
     if (format_context_) {
         if (!(format_context_->oformat->flags & AVFMT_NOFILE)) {
             avio_closep(&format_context_->pb);
@@ -720,6 +1806,5 @@ void FFmpegRecorder::CleanupRecording()
     }
     
     video_stream_ = nullptr;
-    
-    qCDebug(log_ffmpeg_backend) << "Recording cleanup completed";
-}
\ No newline at end of file
+    audio_stream_ = nullptr;
+}
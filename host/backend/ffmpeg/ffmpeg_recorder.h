@@ -26,10 +26,15 @@
 #include <QString>
 #include <QSize>
 #include <QMutex>
+#include <QWaitCondition>
 #include <memory>
+#include <deque>
+#include <vector>
 #include <QImage>
 #include <QRect>
 
+class QThread;
+
 // Forward declarations for FFmpeg types
 extern "C" {
 struct AVFormatContext;
@@ -38,10 +43,16 @@ struct AVStream;
 struct SwsContext;
 struct AVFrame;
 struct AVPacket;
+struct AVCodecParameters;
+struct AVRational;
+struct AVAudioFifo;
+struct AVCodec;
 }
 
 // FFmpeg unique_ptr helpers
 #include "ffmpegutils.h"
+#include "../../recordingsegmenter.h"
+#include "../../audiocapturetap.h"
 
 // RecordingConfig definition
 struct RecordingConfig {
@@ -51,6 +62,27 @@ struct RecordingConfig {
     int video_bitrate = 2000000;
     int video_quality = 23;
     bool use_hardware_acceleration = false;
+    bool allow_passthrough = true;  // Mux captured MJPEG packets as-is when codec and container allow
+    int segment_duration_sec = 0;   // Start a new file this often; 0 writes a single file
+    qint64 segment_size_bytes = 0;  // ...or once the current file reaches this size
+    int retention_hours = 0;        // Delete segments older than this; 0 keeps all
+    bool record_audio = true;       // Add the captured target audio when the audio thread is running
+    QString audio_codec = "aac";    // aac, opus, mp3, flac or pcm; falls back to AAC, then Opus
+    int audio_bitrate = 128000;
+    bool variable_frame_rate = false;  // Encode only changed frames, plus a keepalive while idle
+};
+
+// Live encoder statistics
+struct RecordingStats {
+    int queue_length = 0;        // Frames waiting for the encoder thread
+    int queue_capacity = 0;
+    qint64 frames_encoded = 0;
+    qint64 frames_dropped = 0;   // Oldest queued frames discarded because the encoder fell behind
+    qint64 frames_duplicated = 0;  // Encoded frames that reused the previous conversion (static screen)
+    qint64 frames_skipped = 0;     // Unchanged frames left out in variable frame rate mode
+    bool has_audio = false;
+    qint64 audio_samples_padded = 0;   // Inserted to keep audio on the recording clock
+    qint64 audio_samples_dropped = 0;  // Removed for the same reason
 };
 
 /**
@@ -59,16 +91,60 @@ struct RecordingConfig {
  * This class encapsulates all video recording logic extracted from FFmpegBackendHandler.
  * It manages FFmpeg recording contexts, encoding, and file writing.
  * Follows Google C++ style guide with lowercase_with_underscores_ naming.
+ *
+ * When the capture stream is MJPEG, the configured codec is MJPEG and the
+ * container can carry it (AVI, MKV, MOV), the recorder runs in passthrough
+ * mode: captured packets are muxed unchanged via WritePacket() with
+ * timestamps rebased to the recording clock, so nothing is decoded, scaled
+ * or re-encoded and the file keeps the native capture resolution.
+ *
+ * Otherwise WriteFrame() only queues the (pooled, implicitly shared) image;
+ * colour conversion and encoding run on a dedicated encoder thread. The
+ * queue is bounded and drops its oldest frame when full, so a slow encoder
+ * costs recorded frames rather than live-view frame rate. A frame the caller
+ * marks unchanged repeats the previously converted encoder frame, skipping
+ * both colour conversions.
+ *
+ * In variable frame rate mode an unchanged frame is not queued at all (or,
+ * in passthrough, a packet identical to the previous one is not muxed);
+ * the next frame written simply carries a later timestamp. While the
+ * screen stays idle one repeat goes out every kVfrKeepaliveMs, as a
+ * near-empty P-frame for inter codecs, so players keep a sensible duration
+ * and segments still rotate. AVI stores the gaps as empty skip chunks;
+ * MKV and MP4 keep the timestamps as they are. ShouldWriteFrame() then
+ * only caps the rate instead of catching up on skipped frames.
+ *
+ * With a segment duration or size configured the recording is split into
+ * numbered files (see RecordingSegmenter). MP4/MOV are written fragmented
+ * and MKV with short clusters, and the muxer is flushed about once a second,
+ * so a crash loses at most the last second of the current segment. The
+ * encoder is asked for a keyframe when a segment is due and the new file
+ * starts on it; in passthrough every frame is a keyframe.
+ *
+ * If the audio thread is capturing when recording starts, its PCM is read
+ * from AudioCaptureTap, encoded (AAC by default) on the encoder thread and
+ * interleaved with the video. Both tracks are timed on ClockMs(): each
+ * audio chunk's capture time gives the position it belongs at, and the
+ * sample count is kept within a few milliseconds of it by inserting or
+ * dropping a few samples at a time, or by a jump after a gap, so the sound
+ * card's clock cannot drift away from the picture over long recordings.
  */
 class FFmpegRecorder
 {
 public:
+    static constexpr int kEncodeQueueDepth = 4;
+    static constexpr qint64 kVfrKeepaliveMs = 1000;
+
     FFmpegRecorder();
     ~FFmpegRecorder();
+    
+    // Monotonic clock, in ms, that frame pacing and both tracks' timestamps run on
+    static qint64 ClockMs();
 
     // Recording control
     bool StartRecording(const QString& output_path, const QString& format, int video_bitrate, 
-                       const QSize& resolution, int framerate);
+                       const QSize& resolution, int framerate,
+                       const AVStream* source_stream = nullptr);
     bool StopRecording();
     void PauseRecording();
     void ResumeRecording();
@@ -77,13 +153,16 @@ public:
     // Recording state
     bool IsRecording() const;
     bool IsPaused() const;
+    bool IsPassthrough() const;
     QString GetCurrentRecordingPath() const;
     qint64 GetRecordingDuration() const;
     qint64 GetRecordingFileSize() const;
     
     // Frame writing
-    bool WriteFrame(const QImage& image);  // Thread-safe overload
-    bool ShouldWriteFrame(qint64 current_time_ms);
+    // Thread-safe overload. changed = false: same content as the previous frame written
+    bool WriteFrame(const QImage& image, bool changed = true);
+    bool WritePacket(const AVPacket* packet);  // Passthrough mode only
+    bool ShouldWriteFrame(qint64 current_time_ms);  // current_time_ms from ClockMs()
     
     // Configuration
     void SetRecordingConfig(const RecordingConfig& config);
@@ -92,22 +171,59 @@ public:
     // Advanced features
     bool SupportsAdvancedRecording() const;
     bool SupportsRecordingStats() const;
+    RecordingStats GetRecordingStats() const;
     
     // Image capture
     void TakeImage(const QString& file_path, const QImage& image);  // Thread-safe overload
+    void TakeImage(const QString& file_path, const QByteArray& jpeg_data);  // Writes an encoded JPEG as-is
     void TakeAreaImage(const QString& file_path, const QImage& image, const QRect& capture_area);  // Thread-safe overload
 
 private:
     // Initialization and cleanup
-    bool InitializeRecording(const QSize& resolution, int framerate);
+    bool InitializeRecording(const QSize& resolution, int framerate, const AVStream* source_stream);
+    bool AllocateOutputContext(const QString& path);
+    bool OpenOutput(const QString& path);
+    void CloseOutput();
     void CleanupRecording();
     void FinalizeRecording();
     
+    // Segmented recording
+    SegmentPolicy SegmentPolicyFromConfig() const;
+    bool RotateSegment(qint64 now_ms);
+    void CloseSegment();
+    int WriteSegmentPacket(AVPacket* packet);
+    
     // Encoder configuration
     bool ConfigureEncoder(const QSize& resolution, int framerate);
+    bool CanPassthrough(const AVStream* source_stream) const;
+    bool ConfigurePassthroughStream(const AVStream* source_stream, int framerate);
+    bool AddVideoStream(const AVCodecParameters* params, AVRational time_base);
+    int64_t PassthroughElapsedMs(const AVPacket* packet, qint64 wall_elapsed_ms);
     
     // Frame writing
-    bool WriteFrameToFile(AVFrame* frame);
+    bool WriteFrameToFile(AVFrame* frame, qint64 capture_time_ms);
+    int WriteEncodedPacket(AVPacket* packet);
+    
+    // Audio track
+    bool ConfigureAudioEncoder();
+    bool OpenAudioEncoder(const AVCodec* codec);
+    bool AddAudioStream(const AVCodecParameters* params);
+    void DrainAudio();
+    void QueueAudioChunk(const QByteArray& pcm, qint64 elapsed_ns);
+    bool EncodeAudioFrames(bool flush);
+    int WriteAudioPacket(AVPacket* packet);
+    void CleanupAudio();
+    
+    // Encoder thread
+    struct PendingFrame {
+        QImage image;
+        qint64 capture_time_ms = 0;
+        bool changed = true;
+    };
+    void StartEncoderThread();
+    void StopEncoderThread(bool drain);
+    void EncoderLoop();
+    bool EncodeFrame(const QImage& image, qint64 capture_time_ms, bool changed);
     
     // Recording contexts
     AVFormatContext* format_context_;
@@ -126,10 +242,38 @@ private:
     // Recording state
     bool recording_active_;
     bool recording_paused_;
-    QString recording_output_path_;
+    bool passthrough_;
+    int64_t last_passthrough_pts_;
+    uint64_t last_passthrough_hash_;     // Variable frame rate: previous muxed packet
+    int last_passthrough_size_;
+    int64_t last_passthrough_write_ms_;
+    int source_time_base_num_;     // Capture stream time base (passthrough)
+    int source_time_base_den_;
+    int64_t source_origin_ms_;     // Device clock value at recording time zero
+    QString recording_output_path_;  // Current segment when segmented
     RecordingConfig recording_config_;
     
-    // Timing information
+    // Segmented recording (guarded by mutex_)
+    std::unique_ptr<RecordingSegmenter> segmenter_;
+    bool segment_rotation_pending_;  // Keyframe requested, switch files on it
+    int64_t segment_pts_origin_;     // Encoder ticks where the current segment starts
+    int64_t segment_origin_ms_;      // Passthrough: recording ms where the current segment starts
+    int64_t segment_audio_origin_;   // Audio samples where the current segment starts
+    qint64 last_segment_flush_ms_;
+    
+    // Audio track. Encoded on the encoder thread with mutex_ held.
+    AVCodecContext* audio_codec_context_;
+    AVStream* audio_stream_;
+    AVAudioFifo* audio_fifo_;          // Converted samples waiting for a full encoder frame
+    AVFrame* audio_frame_;
+    AVPacket* audio_packet_;
+    AudioRingBuffer* audio_ring_;      // Owned by AudioCaptureTap while attached
+    AudioCaptureFormat audio_capture_format_;
+    int64_t audio_position_;           // Samples placed on the recording timeline so far
+    int64_t audio_drift_average_;      // Smoothed capture-clock minus sample-count position
+    std::vector<uint8_t> audio_convert_buffer_;
+    
+    // Timing information (ClockMs)
     qint64 recording_start_time_;
     qint64 recording_paused_time_;
     qint64 total_paused_duration_;
@@ -141,6 +285,23 @@ private:
     
     // Thread safety
     mutable QMutex mutex_;
+    
+    // Encode queue (guarded by queue_mutex_)
+    std::unique_ptr<QThread> encoder_thread_;
+    mutable QMutex queue_mutex_;
+    QWaitCondition queue_not_empty_;
+    std::deque<PendingFrame> encode_queue_;
+    bool encoder_running_;
+    qint64 frames_encoded_;
+    qint64 frames_dropped_;
+    qint64 frames_duplicated_;
+    qint64 frames_skipped_;
+    bool variable_frame_rate_;
+    qint64 last_queued_frame_time_;  // ClockMs of the newest frame handed to the encoder
+    qint64 audio_samples_padded_;
+    qint64 audio_samples_dropped_;
+    int64_t last_encoded_pts_;     // Encoder thread only
+    bool recording_frame_converted_;  // Encoder thread only: recording_frame_ holds a converted frame
 };
 
 #endif // FFMPEG_RECORDER_H
\ No newline at end of file
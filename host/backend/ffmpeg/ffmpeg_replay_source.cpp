@@ -0,0 +1,308 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+
+#include "ffmpeg_replay_source.h"
+#include <QStringList>
+#include <cstring>
+
+#ifdef HAVE_FFMPEG
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QThread>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+#endif
+
+namespace {
+
+// A replay that falls this far behind (a stall, a debugger stop) picks up
+// from where it is rather than bursting through the backlog
+constexpr qint64 kMaxLagNs = 1000000000LL;
+
+// A timestamp jump forward larger than this is a discontinuity, not a wait
+constexpr qint64 kMaxLeadNs = 5000000000LL;
+
+constexpr double kDefaultInterval = 1.0 / 30.0;
+
+#ifdef HAVE_FFMPEG
+// Longest single sleep while waiting for a packet, so a stop request is
+// noticed promptly
+constexpr unsigned long kMaxSleepUs = 10000;
+
+qint64 MonotonicNs() {
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed();
+}
+#endif
+
+}  // namespace
+
+bool FFmpegReplaySource::IsReplayPath(const QString& device_path) {
+    return device_path.startsWith(QLatin1String(kScheme), Qt::CaseInsensitive);
+}
+
+QString FFmpegReplaySource::OverridePath() {
+    const QString value = QString::fromLocal8Bit(qgetenv("OPENTERFACE_REPLAY")).trimmed();
+    if (value.isEmpty() || IsReplayPath(value)) {
+        return value;
+    }
+    return QLatin1String(kScheme) + value;
+}
+
+bool FFmpegReplaySource::ParseSpec(const QString& spec, Options* options, QString* error) {
+    QString body = spec.trimmed();
+    if (IsReplayPath(body)) {
+        body = body.mid(static_cast<int>(std::strlen(kScheme)));
+    }
+
+    auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    Options parsed;
+    const int query = body.lastIndexOf('?');
+    parsed.path = query >= 0 ? body.left(query) : body;
+    if (parsed.path.isEmpty()) {
+        return fail(QStringLiteral("Replay path is empty"));
+    }
+
+    if (query >= 0) {
+        const QStringList items = body.mid(query + 1).split('&', Qt::SkipEmptyParts);
+        for (const QString& item : items) {
+            const int eq = item.indexOf('=');
+            const QString key = item.left(eq).trimmed().toLower();
+            const QString value = eq >= 0 ? item.mid(eq + 1).trimmed() : QString();
+            bool ok = false;
+            if (key == QLatin1String("speed")) {
+                parsed.speed = value.toDouble(&ok);
+                if (!ok || parsed.speed < 0.0) {
+                    return fail(QStringLiteral("Invalid replay speed: %1").arg(value));
+                }
+            } else if (key == QLatin1String("loop")) {
+                if (value == QLatin1String("1") || value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) {
+                    parsed.loop = true;
+                } else if (value == QLatin1String("0") || value.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0) {
+                    parsed.loop = false;
+                } else {
+                    return fail(QStringLiteral("Invalid replay loop flag: %1").arg(value));
+                }
+            } else if (key == QLatin1String("fps")) {
+                parsed.framerate = value.toInt(&ok);
+                if (!ok || parsed.framerate <= 0) {
+                    return fail(QStringLiteral("Invalid replay frame rate: %1").arg(value));
+                }
+            } else {
+                return fail(QStringLiteral("Unknown replay option: %1").arg(key));
+            }
+        }
+    }
+
+    *options = parsed;
+    return true;
+}
+
+FFmpegReplaySource::FFmpegReplaySource()
+    : FFmpegReplaySource(Options()) {
+}
+
+FFmpegReplaySource::FFmpegReplaySource(const Options& options)
+    : options_(options)
+    , first_pts_(-1.0)
+    , last_pts_(-1.0)
+    , last_interval_(options.framerate > 0 ? 1.0 / options.framerate : kDefaultInterval)
+    , loop_offset_(0.0)
+    , origin_pts_(0.0)
+    , origin_ns_(0)
+    , has_origin_(false)
+    , packets_read_(0)
+    , loop_count_(0) {
+}
+
+qint64 FFmpegReplaySource::DueTime(double pts_seconds, qint64 now_ns) {
+    if (pts_seconds < 0.0) {
+        // No timestamp: one step after the previous packet
+        pts_seconds = last_pts_ >= 0.0 ? last_pts_ + last_interval_ : qMax(first_pts_, 0.0);
+    }
+    if (first_pts_ < 0.0) {
+        first_pts_ = pts_seconds;
+    }
+    if (last_pts_ >= 0.0 && pts_seconds > last_pts_) {
+        last_interval_ = pts_seconds - last_pts_;
+    }
+    last_pts_ = pts_seconds;
+
+    const double stream_time = pts_seconds + loop_offset_;
+    if (!has_origin_ || options_.speed <= 0.0) {
+        origin_pts_ = stream_time;
+        origin_ns_ = now_ns;
+        has_origin_ = true;
+        return now_ns;
+    }
+
+    const qint64 due = origin_ns_ + static_cast<qint64>((stream_time - origin_pts_) / options_.speed * 1e9);
+    if (now_ns - due > kMaxLagNs || due - now_ns > kMaxLeadNs) {
+        origin_pts_ = stream_time;
+        origin_ns_ = now_ns;
+        return now_ns;
+    }
+    return due;
+}
+
+void FFmpegReplaySource::OnRewind() {
+    // The first packet of the next pass lands one frame after the last one
+    if (first_pts_ >= 0.0 && last_pts_ >= 0.0) {
+        loop_offset_ += last_pts_ - first_pts_ + last_interval_;
+    }
+    last_pts_ = -1.0;
+    loop_count_++;
+}
+
+void FFmpegReplaySource::ResetClock() {
+    has_origin_ = false;
+}
+
+#ifdef HAVE_FFMPEG
+AVFormatContext* FFmpegReplaySource::OpenInput(int framerate, const AVIOInterruptCB& interrupt) {
+    AVFormatContext* format_context = avformat_alloc_context();
+    if (!format_context) {
+        qCCritical(log_ffmpeg_backend) << "Replay: failed to allocate format context";
+        return nullptr;
+    }
+    format_context->interrupt_callback = interrupt;
+
+    // Video files are probed; JPEG frames go through the image2 demuxer,
+    // which needs to be told the rate to stamp them at
+    const int frame_rate = options_.framerate > 0 ? options_.framerate : (framerate > 0 ? framerate : 30);
+    const AVInputFormat* input_format = nullptr;
+    AVDictionary* input_options = nullptr;
+    QString url = options_.path;
+    if (QFileInfo(url).isDir()) {
+        // Glob patterns need FFmpeg built with glob support (not Windows);
+        // a printf-style pattern such as frames/%05d.jpg works everywhere
+        input_format = av_find_input_format("image2");
+        url = QDir(url).filePath(QStringLiteral("*.jpg"));
+        av_dict_set(&input_options, "pattern_type", "glob", 0);
+        av_dict_set(&input_options, "framerate", QByteArray::number(frame_rate).constData(), 0);
+    } else if (url.contains('%')) {
+        input_format = av_find_input_format("image2");
+        av_dict_set(&input_options, "framerate", QByteArray::number(frame_rate).constData(), 0);
+    }
+
+    int ret = avformat_open_input(&format_context, url.toUtf8().constData(), input_format, &input_options);
+    av_dict_free(&input_options);
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        qCWarning(log_ffmpeg_backend) << "Replay: failed to open" << url << ":" << QString::fromUtf8(errbuf);
+        return nullptr;
+    }
+
+    // A file can afford the full probe the live path deliberately skips
+    ret = avformat_find_stream_info(format_context, nullptr);
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        qCWarning(log_ffmpeg_backend) << "Replay: failed to find stream info:" << QString::fromUtf8(errbuf);
+        avformat_close_input(&format_context);
+        return nullptr;
+    }
+
+    first_pts_ = -1.0;
+    last_pts_ = -1.0;
+    last_interval_ = 1.0 / frame_rate;
+    loop_offset_ = 0.0;
+    packets_read_ = 0;
+    loop_count_ = 0;
+    ResetClock();
+
+    qCInfo(log_ffmpeg_backend) << "Replay source opened:" << url
+                               << "format" << format_context->iformat->name
+                               << "duration" << (format_context->duration != AV_NOPTS_VALUE
+                                                     ? format_context->duration / 1000 : -1) << "ms"
+                               << "speed" << options_.speed << "loop" << options_.loop;
+    return format_context;
+}
+
+int FFmpegReplaySource::ReadPacket(AVFormatContext* format_context, AVPacket* packet, int video_stream_index,
+                                   const volatile bool* interrupt) {
+    auto interrupted = [interrupt]() {
+        return (interrupt && *interrupt) || QThread::currentThread()->isInterruptionRequested();
+    };
+
+    for (;;) {
+        if (interrupted()) {
+            return AVERROR_EXIT;
+        }
+
+        int ret = av_read_frame(format_context, packet);
+        if (ret == AVERROR_EOF && options_.loop && packets_read_ > 0) {
+            const int64_t start = format_context->start_time != AV_NOPTS_VALUE ? format_context->start_time : 0;
+            if (av_seek_frame(format_context, -1, start, AVSEEK_FLAG_BACKWARD) < 0) {
+                qCWarning(log_ffmpeg_backend) << "Replay: rewind failed, ending the stream";
+                return AVERROR_EOF;
+            }
+            OnRewind();
+            qCDebug(log_ffmpeg_backend) << "Replay: rewound after" << packets_read_ << "packets, loop" << loop_count_;
+            continue;
+        }
+        if (ret < 0) {
+            return ret;
+        }
+        if (packet->stream_index != video_stream_index) {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        const AVStream* stream = format_context->streams[video_stream_index];
+        const int64_t timestamp = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+        const double pts = timestamp != AV_NOPTS_VALUE ? qMax(0.0, timestamp * av_q2d(stream->time_base)) : -1.0;
+
+        const qint64 due = DueTime(pts, MonotonicNs());
+        for (qint64 remaining = due - MonotonicNs(); remaining > 0; remaining = due - MonotonicNs()) {
+            if (interrupted()) {
+                av_packet_unref(packet);
+                return AVERROR_EXIT;
+            }
+            QThread::usleep(qMin<unsigned long>(static_cast<unsigned long>(remaining / 1000) + 1, kMaxSleepUs));
+        }
+
+        packets_read_++;
+        return 0;
+    }
+}
+#endif // HAVE_FFMPEG
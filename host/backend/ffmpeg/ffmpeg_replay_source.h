@@ -0,0 +1,115 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+
+#ifndef FFMPEG_REPLAY_SOURCE_H
+#define FFMPEG_REPLAY_SOURCE_H
+
+#include <QString>
+#include <QtGlobal>
+
+#ifdef HAVE_FFMPEG
+struct AVFormatContext;
+struct AVPacket;
+struct AVIOInterruptCB;
+#endif
+
+/**
+ * @brief File-backed stand-in for a capture device
+ *
+ * Lets the FFmpeg backend run without the capture hardware by streaming a
+ * recorded video file (MJPEG AVI/MKV or anything else FFmpeg demuxes) or a
+ * directory of JPEG frames in place of /dev/videoN or a DirectShow device.
+ * A replay is selected with a device path of the form
+ *
+ *     replay:<file or directory>[?speed=<factor>&loop=<0|1>&fps=<rate>]
+ *
+ * or, for any device, with the OPENTERFACE_REPLAY environment variable
+ * holding the same text (the "replay:" prefix is optional there).
+ *
+ * Packets are handed out at their recorded cadence: each one is held back
+ * until its timestamp, scaled by the speed factor, is due on the wall clock.
+ * speed=0 disables pacing so decode throughput can be measured. At the end
+ * of the file the source rewinds and the timestamps carry on, so a looped
+ * replay looks like one continuous capture.
+ */
+class FFmpegReplaySource {
+public:
+    struct Options {
+        QString path;         // Video file, JPEG directory or image2 pattern
+        double speed = 1.0;   // Cadence multiplier; 0 = as fast as possible
+        bool loop = true;     // Rewind at the end instead of ending the stream
+        int framerate = 0;    // Rate for JPEG frames; 0 = the requested rate
+    };
+
+    static constexpr const char* kScheme = "replay:";
+
+    static bool IsReplayPath(const QString& device_path);
+
+    // Replay path from OPENTERFACE_REPLAY, or empty when it is not set
+    static QString OverridePath();
+
+    // Parses a replay: path; returns false with error set if it is malformed
+    static bool ParseSpec(const QString& spec, Options* options, QString* error = nullptr);
+
+    FFmpegReplaySource();
+    explicit FFmpegReplaySource(const Options& options);
+
+    const Options& GetOptions() const { return options_; }
+
+    // Pacing. now_ns and the result are on the same monotonic clock; a
+    // negative pts_seconds means the packet carried no timestamp.
+    qint64 DueTime(double pts_seconds, qint64 now_ns);
+    void OnRewind();      // Next packet continues after the last one
+    void ResetClock();    // Next packet becomes the new time origin
+
+    qint64 GetPacketsRead() const { return packets_read_; }
+    int GetLoopCount() const { return loop_count_; }
+
+#ifdef HAVE_FFMPEG
+    // Opens the file with the stream info already probed; nullptr on failure
+    AVFormatContext* OpenInput(int framerate, const AVIOInterruptCB& interrupt);
+
+    // Reads the next packet of video_stream_index, waiting until it is due.
+    // Returns 0 or an AVERROR; AVERROR_EOF only when not looping, AVERROR_EXIT
+    // when *interrupt was raised during the wait.
+    int ReadPacket(AVFormatContext* format_context, AVPacket* packet, int video_stream_index,
+                   const volatile bool* interrupt);
+#endif
+
+private:
+    Options options_;
+
+    double first_pts_;       // First timestamp of the file, seconds
+    double last_pts_;        // Latest raw timestamp, seconds
+    double last_interval_;   // Latest timestamp step, seconds
+    double loop_offset_;     // Added to raw timestamps after each rewind
+    double origin_pts_;      // Stream time pinned to origin_ns_
+    qint64 origin_ns_;
+    bool has_origin_;
+
+    qint64 packets_read_;
+    int loop_count_;
+};
+
+#endif // FFMPEG_REPLAY_SOURCE_H
@@ -0,0 +1,476 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+#include "ffmpeg_restart_decoder.h"
+#include <QLoggingCategory>
+#include <QDebug>
+#include <QThread>
+#include <cstring>
+#include <mutex>
+#include <numeric>
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+namespace {
+
+constexpr uint8_t kMarkerSOI = 0xD8;
+constexpr uint8_t kMarkerEOI = 0xD9;
+constexpr uint8_t kMarkerSOS = 0xDA;
+constexpr uint8_t kMarkerDRI = 0xDD;
+constexpr uint8_t kMarkerRST0 = 0xD0;
+constexpr uint8_t kMarkerRST7 = 0xD7;
+
+enum Outcome { kOutcomeNone, kOutcomeSplit, kOutcomeWhole };
+
+int ReadU16(const uint8_t* p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+bool IsStartOfFrame(uint8_t marker)
+{
+    // C4 (DHT), C8 (JPG) and CC (DAC) share the range but are not frames
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+} // namespace
+
+bool FFmpegRestartDecoder::ParseLayout(const uint8_t* data, int size, Layout* layout)
+{
+    if (!data || size < 4 || data[0] != 0xFF || data[1] != kMarkerSOI) {
+        return false;
+    }
+
+    Layout parsed;
+    int components = 0;
+    int pos = 2;
+    while (parsed.scan_offset == 0) {
+        if (pos >= size || data[pos] != 0xFF) {
+            return false;
+        }
+        while (pos < size && data[pos] == 0xFF) {
+            ++pos;   // Fill bytes
+        }
+        if (pos + 3 > size) {
+            return false;
+        }
+        const uint8_t marker = data[pos++];
+        if (marker == kMarkerEOI || (marker >= kMarkerRST0 && marker <= kMarkerRST7)) {
+            return false;
+        }
+        const int length = ReadU16(data + pos);
+        if (length < 2 || pos + length > size) {
+            return false;
+        }
+        const uint8_t* payload = data + pos + 2;
+        const int payload_size = length - 2;
+
+        if (IsStartOfFrame(marker)) {
+            // Progressive, lossless, hierarchical and arithmetic-coded frames
+            // do not restart independently per band
+            if (marker > 0xC1 || payload_size < 6) {
+                return false;
+            }
+            parsed.height = ReadU16(payload + 1);
+            parsed.width = ReadU16(payload + 3);
+            parsed.height_offset = pos + 3;
+            components = payload[5];
+            if (components < 1 || payload_size < 6 + 3 * components) {
+                return false;
+            }
+            int h_max = 1;
+            int v_max = 1;
+            for (int c = 0; c < components; ++c) {
+                const uint8_t sampling = payload[6 + 3 * c + 1];
+                h_max = qMax(h_max, sampling >> 4);
+                v_max = qMax(v_max, sampling & 0x0F);
+            }
+            // A single-component scan is not interleaved: its MCU is one block
+            parsed.mcu_width = components == 1 ? 8 : 8 * h_max;
+            parsed.mcu_height = components == 1 ? 8 : 8 * v_max;
+        } else if (marker == kMarkerDRI) {
+            if (payload_size < 2) {
+                return false;
+            }
+            parsed.restart_interval = ReadU16(payload);
+        } else if (marker == kMarkerSOS) {
+            // One interleaved scan must carry every component
+            if (components == 0 || payload_size < 1 || payload[0] != components) {
+                return false;
+            }
+            parsed.scan_offset = pos + length;
+        }
+        pos += length;
+    }
+
+    // Height 0 defers it to a DNL marker after the scan
+    if (parsed.width <= 0 || parsed.height <= 0 || parsed.restart_interval <= 0) {
+        return false;
+    }
+    parsed.mcus_per_row = (parsed.width + parsed.mcu_width - 1) / parsed.mcu_width;
+    parsed.mcu_rows = (parsed.height + parsed.mcu_height - 1) / parsed.mcu_height;
+    const qint64 total_mcus = static_cast<qint64>(parsed.mcus_per_row) * parsed.mcu_rows;
+    const qint64 expected_intervals = (total_mcus + parsed.restart_interval - 1) / parsed.restart_interval;
+    parsed.interval_begin.reserve(static_cast<size_t>(expected_intervals));
+    parsed.interval_end.reserve(static_cast<size_t>(expected_intervals));
+
+    // Walk the entropy-coded data: FF00 is a stuffed byte, FFD0-FFD7 ends an
+    // interval, FFD9 ends the frame and anything else is a second scan or a
+    // marker we do not split around
+    int begin = parsed.scan_offset;
+    pos = begin;
+    for (;;) {
+        const void* hit = pos < size ? std::memchr(data + pos, 0xFF, static_cast<size_t>(size - pos)) : nullptr;
+        if (!hit) {
+            return false;   // Truncated: no EOI
+        }
+        const int marker_pos = static_cast<int>(static_cast<const uint8_t*>(hit) - data);
+        int code_pos = marker_pos + 1;
+        while (code_pos < size && data[code_pos] == 0xFF) {
+            ++code_pos;
+        }
+        if (code_pos >= size) {
+            return false;
+        }
+        const uint8_t code = data[code_pos];
+        if (code == 0x00) {
+            pos = code_pos + 1;
+            continue;
+        }
+        if (code >= kMarkerRST0 && code <= kMarkerRST7) {
+            parsed.interval_begin.push_back(begin);
+            parsed.interval_end.push_back(marker_pos);
+            if (static_cast<qint64>(parsed.interval_begin.size()) >= expected_intervals) {
+                return false;   // More intervals than the picture has MCUs for
+            }
+            begin = code_pos + 1;
+            pos = begin;
+            continue;
+        }
+        if (code == kMarkerEOI) {
+            parsed.interval_begin.push_back(begin);
+            parsed.interval_end.push_back(marker_pos);
+            break;
+        }
+        return false;
+    }
+
+    if (static_cast<qint64>(parsed.interval_begin.size()) != expected_intervals) {
+        return false;
+    }
+    *layout = std::move(parsed);
+    return true;
+}
+
+std::vector<FFmpegRestartDecoder::Strip> FFmpegRestartDecoder::PlanStrips(const Layout& layout, int max_strips)
+{
+    std::vector<Strip> strips;
+    if (max_strips < 2 || layout.restart_interval <= 0 || layout.mcus_per_row <= 0 || layout.mcu_rows <= 0) {
+        return strips;
+    }
+
+    // Smallest band of whole MCU rows that also ends on an interval boundary
+    const qint64 band_mcus = std::lcm(static_cast<qint64>(layout.restart_interval),
+                                      static_cast<qint64>(layout.mcus_per_row));
+    const int band_rows = static_cast<int>(band_mcus / layout.mcus_per_row);
+    const int bands = (layout.mcu_rows + band_rows - 1) / band_rows;
+    const int strip_count = qMin(max_strips, bands);
+    if (strip_count < 2) {
+        return strips;
+    }
+
+    const int total_intervals = static_cast<int>(layout.interval_begin.size());
+    strips.reserve(strip_count);
+    for (int s = 0; s < strip_count; ++s) {
+        const int first_row = (bands * s / strip_count) * band_rows;
+        const int end_row = qMin((bands * (s + 1) / strip_count) * band_rows, layout.mcu_rows);
+
+        Strip strip;
+        strip.first_interval = static_cast<int>(static_cast<qint64>(first_row) * layout.mcus_per_row
+                                                / layout.restart_interval);
+        const int end_interval = s == strip_count - 1
+            ? total_intervals
+            : static_cast<int>(static_cast<qint64>(end_row) * layout.mcus_per_row / layout.restart_interval);
+        strip.interval_count = end_interval - strip.first_interval;
+        strip.top = first_row * layout.mcu_height;
+        strip.height = qMin(end_row * layout.mcu_height, layout.height) - strip.top;
+        strips.push_back(strip);
+    }
+    return strips;
+}
+
+void FFmpegRestartDecoder::BuildStripJpeg(const uint8_t* data, const Layout& layout, const Strip& strip,
+                                          std::vector<uint8_t>* out)
+{
+    size_t entropy_size = 0;
+    for (int i = strip.first_interval; i < strip.first_interval + strip.interval_count; ++i) {
+        entropy_size += static_cast<size_t>(layout.interval_end[i] - layout.interval_begin[i]) + 2;
+    }
+
+    out->clear();
+    out->reserve(static_cast<size_t>(layout.scan_offset) + entropy_size + 2);
+    out->insert(out->end(), data, data + layout.scan_offset);
+    (*out)[layout.height_offset] = static_cast<uint8_t>(strip.height >> 8);
+    (*out)[layout.height_offset + 1] = static_cast<uint8_t>(strip.height & 0xFF);
+
+    // The decoder checks that restart markers count up from RST0
+    for (int k = 0; k < strip.interval_count; ++k) {
+        const int i = strip.first_interval + k;
+        if (k > 0) {
+            out->push_back(0xFF);
+            out->push_back(static_cast<uint8_t>(kMarkerRST0 + ((k - 1) & 7)));
+        }
+        out->insert(out->end(), data + layout.interval_begin[i], data + layout.interval_end[i]);
+    }
+    out->push_back(0xFF);
+    out->push_back(kMarkerEOI);
+}
+
+int FFmpegRestartDecoder::ResolveThreadCount(int requested)
+{
+    if (requested > 0) {
+        return qMin(requested, kMaxThreads);
+    }
+
+    // Half the cores: the decode pipeline and the GUI need the rest, and the
+    // wins flatten out once a 4K strip decodes well inside a frame interval
+    const int cores = QThread::idealThreadCount();
+    return cores < 4 ? 1 : qMin(cores / 2, 4);
+}
+
+FFmpegRestartDecoder::FFmpegRestartDecoder()
+    : thread_count_(1)
+    , stopping_(false)
+#ifdef HAVE_LIBJPEG_TURBO
+    , job_(nullptr)
+#endif
+    , generation_(0)
+    , active_workers_(0)
+    , frames_split_(0)
+    , frames_whole_(0)
+    , last_outcome_(kOutcomeNone)
+{
+}
+
+FFmpegRestartDecoder::~FFmpegRestartDecoder()
+{
+    StopWorkers();
+}
+
+void FFmpegRestartDecoder::SetThreadCount(int threads)
+{
+    threads = qBound(1, threads, kMaxThreads);
+    if (threads == GetThreadCount()) {
+        return;
+    }
+
+    // No frame may be in flight while the pool changes
+    std::lock_guard<QMutex> busy(busy_mutex_);
+    StopWorkers();
+
+    QMutexLocker locker(&mutex_);
+    thread_count_ = threads;
+    stopping_ = false;
+#ifdef HAVE_LIBJPEG_TURBO
+    // The decoding thread takes strips too, so it needs one worker fewer
+    for (int i = 0; i < threads - 1; ++i) {
+        std::unique_ptr<QThread> worker(QThread::create([this]() { WorkerLoop(); }));
+        worker->setObjectName(QString("FFmpegStripWorker-%1").arg(i));
+        worker->start();
+        workers_.push_back(std::move(worker));
+    }
+#endif
+    last_outcome_ = kOutcomeNone;
+
+    qCInfo(log_ffmpeg_backend) << "Restart-marker strip decoding"
+                               << (threads > 1 ? QString("uses %1 threads").arg(threads) : QString("is off"));
+}
+
+int FFmpegRestartDecoder::GetThreadCount() const
+{
+    QMutexLocker locker(&mutex_);
+    return thread_count_;
+}
+
+FFmpegRestartDecoder::Stats FFmpegRestartDecoder::GetStats() const
+{
+    Stats stats;
+    stats.frames_split = frames_split_.load();
+    stats.frames_whole = frames_whole_.load();
+    return stats;
+}
+
+void FFmpegRestartDecoder::StopWorkers()
+{
+    std::vector<std::unique_ptr<QThread>> workers;
+    {
+        QMutexLocker locker(&mutex_);
+        stopping_ = true;
+        workers.swap(workers_);
+        work_available_.wakeAll();
+    }
+    for (auto& worker : workers) {
+        worker->wait();
+    }
+}
+
+#ifdef HAVE_LIBJPEG_TURBO
+bool FFmpegRestartDecoder::Decode(const uint8_t* data, int size, int denominator, uint8_t* dst, int pitch,
+                                  int pixel_format, tjhandle handle)
+{
+    if (!data || size <= 0 || !dst || !handle || GetThreadCount() < 2) {
+        return false;
+    }
+    if (denominator != 1 && denominator != 2 && denominator != 4 && denominator != 8) {
+        return false;
+    }
+
+    int width = 0;
+    int height = 0;
+    int subsamp = 0;
+    int colorspace = 0;
+    if (tjDecompressHeader3(handle, data, static_cast<unsigned long>(size), &width, &height, &subsamp, &colorspace) < 0
+        || static_cast<qint64>(width) * height < kMinParallelPixels) {
+        return false;
+    }
+
+    // Another frame has the workers: this one decodes whole rather than queue
+    std::unique_lock<QMutex> busy(busy_mutex_, std::try_to_lock);
+    if (!busy.owns_lock()) {
+        return false;
+    }
+
+    Layout layout;
+    std::vector<Strip> strips;
+    if (ParseLayout(data, size, &layout) && layout.width % denominator == 0 && layout.height % denominator == 0) {
+        strips = PlanStrips(layout, GetThreadCount());
+    }
+    if (strips.size() < 2) {
+        frames_whole_++;
+        if (last_outcome_.exchange(kOutcomeWhole) != kOutcomeWhole) {
+            qCInfo(log_ffmpeg_backend) << "MJPEG" << width << "x" << height
+                                       << "frames have no usable restart markers - decoding whole frames";
+        }
+        return false;
+    }
+
+    Job job;
+    job.data = data;
+    job.layout = &layout;
+    job.strips = &strips;
+    job.denominator = denominator;
+    job.dst = dst;
+    job.pitch = pitch;
+    job.pixel_format = pixel_format;
+    {
+        QMutexLocker locker(&mutex_);
+        job_ = &job;
+        ++generation_;
+        work_available_.wakeAll();
+    }
+
+    RunStrips(&job, handle);
+
+    {
+        QMutexLocker locker(&mutex_);
+        job_ = nullptr;
+        while (active_workers_ > 0) {
+            job_finished_.wait(&mutex_);
+        }
+    }
+
+    if (job.failed) {
+        return false;
+    }
+    frames_split_++;
+    if (last_outcome_.exchange(kOutcomeSplit) != kOutcomeSplit) {
+        qCInfo(log_ffmpeg_backend) << "MJPEG" << width << "x" << height << "frames decode as" << strips.size()
+                                   << "restart-marker strips (interval" << layout.restart_interval << "MCUs)";
+    }
+    return true;
+}
+
+void FFmpegRestartDecoder::RunStrips(Job* job, tjhandle handle)
+{
+    // Fast upsampling keeps every output row inside its own strip: fancy
+    // 4:2:0 upsampling would blend chroma across the seams
+    const int flags = TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE;
+    thread_local std::vector<uint8_t> strip_jpeg;
+
+    const int strip_count = static_cast<int>(job->strips->size());
+    for (;;) {
+        const int index = job->next_strip.fetch_add(1);
+        if (index >= strip_count || job->failed) {
+            return;
+        }
+        const Strip& strip = (*job->strips)[index];
+        BuildStripJpeg(job->data, *job->layout, strip, &strip_jpeg);
+
+        const int d = job->denominator;
+        uint8_t* rows = job->dst + static_cast<size_t>(strip.top / d) * job->pitch;
+        if (tjDecompress2(handle, strip_jpeg.data(), static_cast<unsigned long>(strip_jpeg.size()), rows,
+                          job->layout->width / d, job->pitch, strip.height / d, job->pixel_format, flags) < 0) {
+            qCDebug(log_ffmpeg_backend) << "Strip" << index << "decode failed:" << tjGetErrorStr();
+            job->failed = true;
+            return;
+        }
+    }
+}
+
+void FFmpegRestartDecoder::WorkerLoop()
+{
+    tjhandle handle = tjInitDecompress();
+    if (!handle) {
+        qCWarning(log_ffmpeg_backend) << "Failed to initialize TurboJPEG handle for strip worker";
+    }
+
+    QMutexLocker locker(&mutex_);
+    qint64 seen_generation = generation_;
+    for (;;) {
+        while (!stopping_ && (!job_ || generation_ == seen_generation)) {
+            work_available_.wait(&mutex_);
+        }
+        if (stopping_) {
+            break;
+        }
+        seen_generation = generation_;
+        Job* job = job_;
+        ++active_workers_;
+        locker.unlock();
+
+        if (handle) {
+            RunStrips(job, handle);
+        }
+
+        locker.relock();
+        if (--active_workers_ == 0) {
+            job_finished_.wakeAll();
+        }
+    }
+    locker.unlock();
+
+    if (handle) {
+        tjDestroy(handle);
+    }
+}
+#endif // HAVE_LIBJPEG_TURBO
@@ -0,0 +1,166 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+
+#ifndef FFMPEG_RESTART_DECODER_H
+#define FFMPEG_RESTART_DECODER_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#ifdef HAVE_LIBJPEG_TURBO
+#include <turbojpeg.h>
+#endif
+
+class QThread;
+
+/**
+ * @brief Intra-frame parallel MJPEG decoding on restart-marker boundaries
+ *
+ * A 4K MJPEG frame takes longer than a 30 fps frame interval to decompress
+ * on one core of a mid-range CPU, and the decode pipeline only spreads work
+ * across frames, not within one. When the encoder emits restart markers
+ * (the MS2130S does), the entropy-coded scan restarts its DC prediction at
+ * every RSTn, so a run of restart intervals covering whole MCU rows is an
+ * independent horizontal strip of the picture.
+ *
+ * Decode() cuts the scan into such strips, rewraps each one as a standalone
+ * JPEG (the frame headers with the strip height, renumbered markers) and
+ * decodes them concurrently on a small worker pool plus the calling thread,
+ * each straight into its rows of one shared output buffer. Frames without
+ * restart markers, or whose intervals do not line up with MCU rows, are
+ * left to the caller's whole-frame decode.
+ */
+class FFmpegRestartDecoder {
+public:
+    static constexpr int kMaxThreads = 8;
+
+    // Below this a single decompress already fits a frame interval
+    static constexpr qint64 kMinParallelPixels = 2560LL * 1440;
+
+    // Where the scan of a baseline JPEG restarts
+    struct Layout {
+        int width = 0;
+        int height = 0;
+        int mcu_width = 0;           // MCU size in pixels
+        int mcu_height = 0;
+        int mcus_per_row = 0;
+        int mcu_rows = 0;
+        int restart_interval = 0;    // MCUs per interval, from DRI
+        int height_offset = 0;       // Offset of the frame height in SOF
+        int scan_offset = 0;         // First byte of entropy-coded data
+        std::vector<int> interval_begin;   // Entropy data of each interval,
+        std::vector<int> interval_end;     // RSTn and fill bytes excluded
+    };
+
+    // A horizontal band of whole MCU rows made of whole restart intervals
+    struct Strip {
+        int first_interval = 0;
+        int interval_count = 0;
+        int top = 0;                 // Pixel rows
+        int height = 0;
+    };
+
+    struct Stats {
+        qint64 frames_split = 0;     // Decoded as parallel strips
+        qint64 frames_whole = 0;     // Left to the whole-frame decode
+    };
+
+    // Parses the headers and locates every restart interval. False for
+    // anything but a single-scan baseline JPEG with a restart interval.
+    static bool ParseLayout(const uint8_t* data, int size, Layout* layout);
+
+    // Splits the frame into at most max_strips strips of near-equal height;
+    // fewer than two strips means the frame cannot be split
+    static std::vector<Strip> PlanStrips(const Layout& layout, int max_strips);
+
+    // Standalone JPEG of one strip, written to out (its capacity is reused)
+    static void BuildStripJpeg(const uint8_t* data, const Layout& layout, const Strip& strip,
+                               std::vector<uint8_t>* out);
+
+    // Threads including the caller; 0 = pick from the CPU count, 1 = off
+    static int ResolveThreadCount(int requested);
+
+    FFmpegRestartDecoder();
+    ~FFmpegRestartDecoder();
+
+    FFmpegRestartDecoder(const FFmpegRestartDecoder&) = delete;
+    FFmpegRestartDecoder& operator=(const FFmpegRestartDecoder&) = delete;
+
+    // Starts or stops workers; takes a resolved count (see ResolveThreadCount)
+    void SetThreadCount(int threads);
+    int GetThreadCount() const;
+
+    Stats GetStats() const;
+
+#ifdef HAVE_LIBJPEG_TURBO
+    // Decodes data into dst, which is the native size scaled by 1/denominator
+    // (1, 2, 4 or 8) in pixel_format. Returns false without touching dst when
+    // the frame is too small or cannot be split, or when another frame holds
+    // the workers; false after a failed strip leaves dst partly written.
+    // handle is the caller's own decompressor.
+    bool Decode(const uint8_t* data, int size, int denominator, uint8_t* dst, int pitch,
+                int pixel_format, tjhandle handle);
+#endif
+
+private:
+#ifdef HAVE_LIBJPEG_TURBO
+    struct Job {
+        const uint8_t* data = nullptr;
+        const Layout* layout = nullptr;
+        const std::vector<Strip>* strips = nullptr;
+        int denominator = 1;
+        uint8_t* dst = nullptr;
+        int pitch = 0;
+        int pixel_format = 0;
+        std::atomic<int> next_strip{0};
+        std::atomic<bool> failed{false};
+    };
+
+    static void RunStrips(Job* job, tjhandle handle);
+    void WorkerLoop();
+#endif
+    void StopWorkers();
+
+    QMutex busy_mutex_;                  // Held by the frame being decoded
+    mutable QMutex mutex_;
+    QWaitCondition work_available_;
+    QWaitCondition job_finished_;
+    std::vector<std::unique_ptr<QThread>> workers_;
+    int thread_count_;
+    bool stopping_;
+#ifdef HAVE_LIBJPEG_TURBO
+    Job* job_;                           // Guarded by mutex_
+#endif
+    qint64 generation_;                  // Bumped for every published job
+    int active_workers_;                 // Workers inside RunStrips()
+
+    std::atomic<qint64> frames_split_;
+    std::atomic<qint64> frames_whole_;
+    std::atomic<int> last_outcome_;      // For logging changes only
+};
+
+#endif // FFMPEG_RESTART_DECODER_H
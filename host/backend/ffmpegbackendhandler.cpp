@@ -21,12 +21,17 @@
 */
 
 #include "ffmpegbackendhandler.h"
+#include "../framebus.h"
+#include "../framelatency.h"
+#include "../presentationqueue.h"
+#include "../frametiming.h"
 #include "../../ui/videopane.h"
 #include "global.h"
 #include "ui/globalsetting.h"
 #include "device/DeviceManager.h"
 #include "device/HotplugMonitor.h"
 #include "device/DeviceInfo.h"
+#include "serial/SerialPortManager.h"
 
 #include <QThread>
 #include <QDebug>
@@ -41,6 +46,7 @@
 #include <QFileInfo>
 #include <QMediaDevices>
 #include <QCameraDevice>
+#include <QtConcurrent/QtConcurrent>
 
 // FFmpeg includes
 extern "C" {
@@ -58,6 +64,7 @@ extern "C" {
 #endif
 
 #include "log/opflogging.h"
+#include "log/startuptrace.h"
 
 OPF_LOGGING_CATEGORY(log_ffmpeg_backend, "opf.backend.ffmpeg")
 
@@ -70,6 +77,9 @@ OPF_LOGGING_CATEGORY(log_ffmpeg_backend, "opf.backend.ffmpeg")
 #include "ffmpeg/ffmpeg_device_validator.h"
 #include "ffmpeg/ffmpeg_hotplug_handler.h"
 #include "ffmpeg/ffmpeg_capture_manager.h"
+#include "ffmpeg/ffmpeg_decode_pipeline.h"
+#include "ffmpeg/ffmpeg_frame_diff.h"
+#include "ffmpeg/ffmpeg_capability_cache.h"
 
 FFmpegBackendHandler::FFmpegBackendHandler(QObject *parent)
     : MultimediaBackendHandler(parent),
@@ -82,6 +92,12 @@ FFmpegBackendHandler::FFmpegBackendHandler(QObject *parent)
     m_deviceValidator(std::make_unique<FFmpegDeviceValidator>()),
     m_hotplugHandler(nullptr),  // Created after validator
     m_captureManager(nullptr),  // Created after dependencies
+    m_decodePipeline(std::make_unique<FFmpegDecodePipeline>()),
+    m_frameDiff(std::make_unique<FFmpegFrameDiff>()),
+    m_frameDiffResetPending(false),
+    m_recorderSubscription(0),
+    m_recorderContentSequence(0),
+    m_firstFramePending(false),
     m_packet(nullptr),
     m_captureRunning(false),
     m_videoStreamIndex(-1),
@@ -90,6 +106,7 @@ FFmpegBackendHandler::FFmpegBackendHandler(QObject *parent)
     m_graphicsVideoItem(nullptr),
     m_videoPane(nullptr),
     m_frameCount(0),
+    m_lastGovernorLevel(-1),
     m_lastFrameTime(0),
     m_targetFrameIntervalMs(0),
     m_lastFrameDisplayTime(0),
@@ -102,8 +119,6 @@ FFmpegBackendHandler::FFmpegBackendHandler(QObject *parent)
     m_ptsFrameCount(0),
     m_lastForceDisplayTime(0)
 {
-    // Initialize backpressure counter (shared with lambda captures in QueuedConnection slots)
-    m_pendingFrameCount = std::make_shared<std::atomic<int>>(0);
     // m_videoOutputConnection is default-constructed (invalid/disconnected)
     m_config = getDefaultConfig();
     m_preferredHwAccel = GlobalSetting::instance().getHardwareAcceleration();
@@ -207,12 +222,47 @@ FFmpegBackendHandler::FFmpegBackendHandler(QObject *parent)
                 emit fpsChanged(static_cast<double>(targetFps));
             }
         }
+
+        // Per-stage latency of the pipelined decoder over the same window
+        if (m_decodePipeline && m_decodePipeline->IsRunning()) {
+            FFmpegDecodePipeline::LatencyStats stats = m_decodePipeline->TakeLatencyStats();
+            qCDebug(log_ffmpeg_backend) << QString("Decode pipeline - frames: %1, queue wait: %2 ms, decode: %3 ms, "
+                                                   "reorder: %4 ms, total avg/max: %5/%6 ms, queue drops: %7, decode failures: %8")
+                .arg(stats.frames_delivered)
+                .arg(stats.avg_queue_wait_ms, 0, 'f', 2)
+                .arg(stats.avg_decode_ms, 0, 'f', 2)
+                .arg(stats.avg_reorder_wait_ms, 0, 'f', 2)
+                .arg(stats.avg_total_ms, 0, 'f', 2)
+                .arg(stats.max_total_ms, 0, 'f', 2)
+                .arg(stats.queue_drops)
+                .arg(stats.decode_failures);
+        }
+
+        // Share of frames the tile diff found identical to the previous one
+        if (m_frameDiff->GetFrameCount() > 0) {
+            qCDebug(log_ffmpeg_backend) << QString("Static frames: %1% of %2 (%3 tile hash)")
+                .arg(m_frameDiff->GetStaticFrameRatio() * 100.0, 0, 'f', 1)
+                .arg(m_frameDiff->GetFrameCount())
+                .arg(QString::fromLatin1(FFmpegFrameDiff::IsaName()));
+        }
+
+        // Frames the display replaced before a refresh came round to them
+        if (m_presentationQueue) {
+            PresentationQueue::Stats presentation = m_presentationQueue->takeStats();
+            if (presentation.submitted > 0) {
+                qCDebug(log_ffmpeg_backend) << QString("Presentation - submitted: %1, presented: %2, never shown: %3")
+                    .arg(presentation.submitted)
+                    .arg(presentation.presented)
+                    .arg(presentation.superseded);
+            }
+        }
     });
 }
 
 FFmpegBackendHandler::~FFmpegBackendHandler()
 {
     // Stop recording first if active
+    unsubscribeRecorder();
     if (m_recorder && m_recorder->IsRecording()) {
         m_recorder->StopRecording();
     }
@@ -514,6 +564,7 @@ bool FFmpegBackendHandler::startDirectCapture(const QString& devicePath, const Q
     m_ptsFrameCount = 0;
     m_lastForceDisplayTime = 0;
     m_frameCount = 0;
+    m_frameDiffResetPending = true;  // The first frame of a capture is always shown in full
     
     // Apply scaling quality setting to frame processor
     if (m_frameProcessor) {
@@ -521,11 +572,47 @@ bool FFmpegBackendHandler::startDirectCapture(const QString& devicePath, const Q
         m_frameProcessor->SetScalingQuality(scalingQuality);
         m_frameProcessor->StartCapture();
         qCDebug(log_ffmpeg_backend) << "Applied scaling quality:" << scalingQuality;
+        
+        // The governor trades display resolution for frame rate, which only
+        // weak hosts need: automatic turns it on for ARM, starting one step
+        // down so it climbs back if the host keeps up
+        const bool armHost = SerialPortManager::isArmArchitecture();
+        int budgetMs = GlobalSetting::instance().getDecodeLatencyBudget();
+        if (budgetMs < 0) {
+            budgetMs = armHost ? 25 : 0;
+        }
+        FFmpegDecodeGovernor::Config governorConfig;
+        governorConfig.budget_ms = budgetMs;
+        governorConfig.start_level = armHost ? 1 : 0;
+        m_frameProcessor->ConfigureDecodeGovernor(governorConfig);
+        m_lastGovernorLevel = -1;
+        
+        // 4K MJPEG with restart markers decodes each frame on several cores
+        m_frameProcessor->ConfigureStripDecode(GlobalSetting::instance().getStripDecodeThreads());
     }
     
+    // A device seen before opens with its cached format; the clock measures
+    // time to first frame either way
+    m_capabilityKey = capabilityCacheKey();
+    m_deviceManager->SetCapabilityKey(m_capabilityKey);
+    m_captureStartTimer.start();
+    m_firstFramePending = true;
+    
     // Delegate to capture manager
     if (m_captureManager && m_captureManager->StartCapture(devicePath, resolution, framerate)) {
         m_captureRunning = true;
+        FrameLatencyTracker::instance().setSource(QStringLiteral("FFmpeg"));
+        FrameTimingRecorder::instance().setSource(QStringLiteral("FFmpeg"));
+
+        // Size the decode buffer pool for the resolution actually negotiated
+        if (m_frameProcessor) {
+            m_frameProcessor->ConfigureFramePool(m_captureManager->GetCurrentResolution());
+        }
+
+        // Move MJPEG decoding off the capture thread when the codec allows it
+        startDecodePipeline();
+        
+        revalidateCapabilities(devicePath);
         
         // Notify hotplug handler that capture is running
         if (m_hotplugHandler) {
@@ -568,6 +655,11 @@ void FFmpegBackendHandler::stopDirectCapture()
             m_hotplugHandler->SetCaptureRunning(false);
         }
 
+        // Join decode workers before the capture manager frees the codec context
+        if (m_decodePipeline) {
+            m_decodePipeline->Stop();
+        }
+
         // Delegate to capture manager
         if (m_captureManager) {
             m_captureManager->StopCapture();
@@ -584,6 +676,9 @@ void FFmpegBackendHandler::stopDirectCapture()
         qCWarning(log_ffmpeg_backend) << "Capture thread did not stop within timeout - may cause device conflict";
     }
 
+    // No stale frames for bus consumers once the device is gone
+    FrameBus::instance().clear();
+
     // Platform-specific settling delay before opening new device
 #ifdef Q_OS_LINUX
     QThread::msleep(100);  // Linux needs extra time for /dev/video* release
@@ -740,14 +835,73 @@ void FFmpegBackendHandler::processFrame()
     //     and shows a stale frame, giving a ~10 fps stuttering appearance during
     //     catch-up while the ring buffer is being consumed.
     //
-    // The ShouldDropFrame() gate inside ProcessPacketToImage() already provides correct
+    // The ShouldDropFrame() gate in the frame processor already provides correct
     // rate-limiting (drops a frame if < 8.33 ms since the last one was shown, ≈120 fps
     // cap).  That is all the rate control we need for a real-time KVM stream.
     qint64 currentSystemTime = QDateTime::currentMSecsSinceEpoch();
 
-    // Check if recording is active
-    bool isRecording = m_recorder && m_recorder->IsRecording() && !m_recorder->IsPaused();
+    // Passthrough recording muxes the compressed packet as-is, before any
+    // decoding, so it neither depends on nor slows down the display path.
+    bool isPassthroughRecording = m_recorder && m_recorder->IsPassthrough();
+    if (isPassthroughRecording && !m_recorder->IsPaused()
+        && m_recorder->ShouldWriteFrame(FFmpegRecorder::ClockMs())) {
+        if (m_recorder->WritePacket(packet)) {
+            static int passthroughFrameCount = 0;
+            if (++passthroughFrameCount % 30 == 0) {
+                emit recordingDurationChanged(m_recorder->GetRecordingDuration());
+            }
+        }
+    }
+
+    // Check if a re-encoding recording is active (it needs the recording frame-drop threshold)
+    bool isRecording = !isPassthroughRecording && m_recorder && m_recorder->IsRecording() && !m_recorder->IsPaused();
+    
+    // Region decoding carries hidden areas over from earlier frames and the
+    // governor trades away resolution; an encoded recording must see every
+    // pixel of every frame.
+    m_frameProcessor->SetDecodeRegionEnabled(!isRecording);
+    m_frameProcessor->SetGovernorDownscaleEnabled(!isRecording);
+    
+    QSize targetSize = computeDecodeTargetSize();
+
+    // Pipelined path: this thread only gates and queues the packet; decode
+    // workers hand finished frames to deliverDecodedFrame() in capture order.
+    if (m_decodePipeline && m_decodePipeline->IsRunning()) {
+        if (!m_frameProcessor->ShouldDropFrame(isRecording)) {
+            m_decodePipeline->Submit(packet, targetSize, m_captureManager->GetPacketReadTime(),
+                                     currentSystemTime);
+        }
+        av_packet_unref(packet);
+        return;
+    }
+
+    // QImage is thread-safe and can be passed across thread boundaries efficiently
+    const qint64 decodeStartNs = FrameTimingRecorder::now();
+    FFmpegFrameProcessor::DecodedFrame frame =
+        m_frameProcessor->ProcessPacket(packet, codecContext, isRecording, targetSize);
+    
+    if (!frame.IsNull()) {
+        FrameTimingRecorder::instance().recordDecode(FrameTimingRecorder::now() - decodeStartNs);
+        deliverDecodedFrame(frame.image, frame.IsRegionComposite(), currentSystemTime,
+                            m_captureManager->GetPacketReadTime(),
+                            FrameLatencyTracker::now());
+    } else {
+        // Only warn for decode failures on packets with actual data
+        if (packet->size > 0) {
+            qCWarning(log_ffmpeg_backend) << "Failed to decode frame - pixmap is null";
+            qCWarning(log_ffmpeg_backend) << "Frame decode failure details:";
+            qCWarning(log_ffmpeg_backend) << "  - Packet size:" << packet->size;
+            qCWarning(log_ffmpeg_backend) << "  - Codec ID:" << (codecContext ? codecContext->codec_id : -1);
+            qCWarning(log_ffmpeg_backend) << "  - Stream index:" << packet->stream_index;
+        }
+    }
     
+    // Clean up packet
+    av_packet_unref(packet);
+}
+
+QSize FFmpegBackendHandler::computeDecodeTargetSize() const
+{
     // Get viewport size from VideoPane if available
     QSize viewportSize;
     if (m_videoPane) {
@@ -786,9 +940,17 @@ void FFmpegBackendHandler::processFrame()
                 targetSize.setHeight(qMin(targetSize.height(), sourceSize.height()));
             }
 
-            // Cap the requested decode size to a reasonable upper bound for performance.
-            targetSize.setWidth(qMin(targetSize.width(), maxViewportSize.width()));
-            targetSize.setHeight(qMin(targetSize.height(), maxViewportSize.height()));
+            // With region decoding only the visible part is decoded, so zoomed
+            // views get native detail; otherwise (recording, no TurboJPEG)
+            // cap the whole-frame decode to a reasonable upper bound for
+            // performance.
+            AVCodecContext* codecContext = m_deviceManager ? m_deviceManager->GetCodecContext() : nullptr;
+            if (sourceSize.isValid() && m_frameProcessor && m_frameProcessor->SupportsRegionDecode(codecContext)) {
+                targetSize = sourceSize;
+            } else {
+                targetSize.setWidth(qMin(targetSize.width(), maxViewportSize.width()));
+                targetSize.setHeight(qMin(targetSize.height(), maxViewportSize.height()));
+            }
 
             if (!targetSize.isValid()) {
                 targetSize = viewportSize;
@@ -797,79 +959,236 @@ void FFmpegBackendHandler::processFrame()
             qCDebug(log_ffmpeg_backend) << "FFmpeg direct decode target with zoom:" << zoomFactor
                                         << "viewport:" << viewportSize
                                         << "target:" << targetSize
-                                        << "source:" << (m_frameProcessor ? m_frameProcessor->GetLatestOriginalFrame().size() : QSize());
+                                        << "source:" << (m_frameProcessor ? m_frameProcessor->GetLatestOriginalFrame(false).size() : QSize());
         }
     }
 
-    // QImage is thread-safe and can be passed across thread boundaries efficiently
-    QImage image = m_frameProcessor->ProcessPacketToImage(packet, codecContext, isRecording, targetSize);
+    return targetSize;
+}
+
+void FFmpegBackendHandler::deliverDecodedFrame(const QImage& image, bool regionComposite,
+                                               qint64 captureTime, qint64 readNs, qint64 decodedNs)
+{
+    // Called on the capture thread (synchronous decode) or on a decode worker
+    // (pipelined decode); in both cases never concurrently with itself.
+    m_frameCount++;
+
+    if (m_firstFramePending.exchange(false, std::memory_order_acq_rel)) {
+        const qint64 elapsedMs = m_captureStartTimer.elapsed();
+        const bool warm = m_deviceManager->WasWarmStart();
+        StartupTrace::instance().instant("first frame decoded", "camera");
+        qCInfo(log_ffmpeg_backend) << "Time to first frame:" << elapsedMs << "ms"
+                                   << (warm ? "(warm capability cache)" : "(cold capability cache)");
+        if (!m_deviceManager->GetReplaySource()) {
+            const QString key = m_capabilityKey;
+            (void)QtConcurrent::run([key, warm, elapsedMs]() {  // Keeps the file write off this thread
+                FFmpegCapabilityCache::Instance().RecordFirstFrame(key, warm, elapsedMs);
+            });
+        }
+    }
+
+    // A static desktop produces identical frames: find out which tiles (if
+    // any) changed so every consumer below can skip the work for the rest
+    if (m_frameDiffResetPending.exchange(false, std::memory_order_acq_rel)) {
+        m_frameDiff->Reset();
+        m_undisplayedDirty = QRegion();
+    }
+    const FFmpegFrameDiff::Result diff = m_frameDiff->Compare(image);
+    if (diff.changed) {
+        m_undisplayedDirty += diff.dirty;
+    }
+
+    // Screenshots, the TCP server and MCP read this frame from the bus rather
+    // than from the backend, sharing the decode done here; a re-encoding
+    // recording is fed from its bus subscription while this call publishes.
+    // The frame was just published by the processor, and deliveries never
+    // overlap. A region decode is only partly current, so the bus keeps the
+    // last full frame (recordings turn region decoding off).
+    if (!regionComposite) {
+        QSize mjpegSize;
+        QByteArray mjpeg = m_frameProcessor->GetLatestMjpegFrame(&mjpegSize);
+        QImage original = m_frameProcessor->GetLatestOriginalFrame(false);
+        FrameBus::instance().publish(original.isNull() ? image : original, captureTime, mjpeg, mjpegSize,
+                                     diff.changed);
+    }
+    m_lastFrameDisplayTime = captureTime;
+    m_lastForceDisplayTime = captureTime;  // Update force display timer
+    
+    // Surface decode governor level changes (logged by the governor itself)
+    const FFmpegDecodeGovernor& governor = m_frameProcessor->GetDecodeGovernor();
+    const int governorLevel = governor.IsEnabled() ? governor.GetLevelIndex() : -2;
+    if (governorLevel != m_lastGovernorLevel) {
+        m_lastGovernorLevel = governorLevel;
+        emit decodeStateChanged(governor.IsEnabled() ? governor.Describe() : QString());
+    }
+    
+    // Log first few frames for debugging
+    if (m_frameCount <= 5 || m_frameCount % 1000 == 1) {
+        qCDebug(log_ffmpeg_backend) << "Processed frame" << m_frameCount << "size:" << image.size();
+    }
+    
+    // Hand the frame to the UI. The video output connection is direct and
+    // drops it into the VideoPane's presentation queue, which keeps only the
+    // latest frame and presents it on the next display refresh, so at most
+    // one frame per output is ever held for the GUI however fast we decode.
+    // Frames showing nothing the display has not already received are not
+    // emitted.
+    if (m_captureRunning && !m_undisplayedDirty.isEmpty()) {
+        if (m_frameCount <= 5) {
+            qCDebug(log_ffmpeg_backend) << "Emitting frameReadyImage signal for frame" << m_frameCount;
+        }
+        // VideoPane stamps the later stages under the same image key
+        FrameLatencyTracker& latency = FrameLatencyTracker::instance();
+        if (latency.isEnabled()) {
+            const quint64 key = image.cacheKey();
+            latency.stamp(key, FrameLatencyTracker::Read, readNs);
+            latency.stamp(key, FrameLatencyTracker::Decoded, decodedNs);
+            latency.stamp(key, FrameLatencyTracker::Emitted);
+        }
+        const QRegion dirty = m_undisplayedDirty;
+        m_undisplayedDirty = QRegion();
+        emit frameReadyImage(image, dirty);
+    }
     
-    // Clean up packet
-    av_packet_unref(packet);
+    // Reduce success logging frequency for performance
+    if (m_frameCount % 1000 == 1) {
+        qCDebug(log_ffmpeg_backend) << "frameReady signal emitted successfully for frame" << m_frameCount;
+    }
     
-    if (!image.isNull()) {
-        m_frameCount++;
-        m_lastFrameDisplayTime = currentSystemTime;
-        m_lastForceDisplayTime = currentSystemTime;  // Update force display timer
-        
-        // Log first few frames for debugging
-        if (m_frameCount <= 5 || m_frameCount % 1000 == 1) {
-            qCDebug(log_ffmpeg_backend) << "Processed frame" << m_frameCount << "size:" << image.size();
-        }
-        
-        // Emit QImage to UI (QueuedConnection ensures thread safety).
-        // BACKPRESSURE: Only queue a new frame when fewer than 2 frames are already
-        // waiting in the GUI event loop.  Without this limit each unconsumed frame
-        // holds its own ~8 MB buffer in the queue, rapidly exhausting RAM and
-        // triggering "QImage: out of memory" warnings at high frame rates.
-        if (m_captureRunning) {
-            if (m_frameCount <= 5) {
-                qCDebug(log_ffmpeg_backend) << "Emitting frameReadyImage signal for frame" << m_frameCount;
-            }
-            // Atomically increment; if the previous value was < 2 we may emit,
-            // otherwise the GUI is still catching up - drop this frame.
-            if (m_pendingFrameCount->fetch_add(1, std::memory_order_acq_rel) < 2) {
-                emit frameReadyImage(image);
-            } else {
-                // GUI thread is backlogged – undo the increment and drop the frame
-                m_pendingFrameCount->fetch_sub(1, std::memory_order_release);
-            }
+    // REMOVED: QCoreApplication::processEvents() - this was causing excessive CPU usage
+    // Let Qt's event loop handle frame processing naturally
+}
+
+void FFmpegBackendHandler::subscribeRecorder()
+{
+    unsubscribeRecorder();
+    m_recorderContentSequence = 0;
+    // Runs synchronously on the publishing thread, right after the bus has
+    // the frame, so the recorder sees every frame the bus does
+    m_recorderSubscription = FrameBus::instance().subscribe(FrameRequest(), nullptr,
+        [this](const VideoFrameHandle& frame, const QImage&) { writeRecordingFrame(frame); });
+}
+
+void FFmpegBackendHandler::unsubscribeRecorder()
+{
+    if (m_recorderSubscription != 0) {
+        FrameBus::instance().unsubscribe(m_recorderSubscription);
+        m_recorderSubscription = 0;
+    }
+}
+
+void FFmpegBackendHandler::writeRecordingFrame(const VideoFrameHandle& frame)
+{
+    // Passthrough recordings were already written from the raw packet
+    if (!m_recorder || !m_recorder->IsRecording() || m_recorder->IsPaused() || m_recorder->IsPassthrough()) {
+        return;
+    }
+
+    // FRAME RATE CONTROL: Only write frames at the target recording framerate
+    if (!m_recorder->ShouldWriteFrame(FFmpegRecorder::ClockMs())) {
+        return;
+    }
+
+    // Queues the shared image for the encoder thread; never waits on
+    // encoding. An unchanged frame re-sends the last converted one.
+    const bool changed = frame->contentSequence() != m_recorderContentSequence;
+    if (m_recorder->WriteFrame(frame->image(), changed)) {
+        m_recorderContentSequence = frame->contentSequence();
+        // Update recording duration periodically
+        static int recordingFrameCount = 0;
+        if (++recordingFrameCount % 30 == 0) { // Every 30 frames (~1 second at 30fps)
+            emit recordingDurationChanged(m_recorder->GetRecordingDuration());
         }
-        
-        // Write frame to recording file if recording is active
-        if (m_recorder && m_recorder->IsRecording() && !m_recorder->IsPaused()) {
-            // FRAME RATE CONTROL: Only write frames at the target recording framerate
-            qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-            
-            if (m_recorder->ShouldWriteFrame(currentTime)) {
-                // Pass QImage directly to recorder (worker thread safe)
-                if (m_recorder->WriteFrame(image)) {
-                    // Update recording duration periodically
-                    static int recordingFrameCount = 0;
-                    if (++recordingFrameCount % 30 == 0) { // Every 30 frames (~1 second at 30fps)
-                        emit recordingDurationChanged(m_recorder->GetRecordingDuration());
-                    }
-                }
+    }
+}
+
+void FFmpegBackendHandler::startDecodePipeline()
+{
+    if (!m_decodePipeline || !m_frameProcessor || !m_deviceManager) {
+        return;
+    }
+
+    AVCodecContext* codecContext = m_deviceManager->GetCodecContext();
+    if (!m_frameProcessor->SupportsParallelDecode(codecContext)) {
+        qCDebug(log_ffmpeg_backend) << "Codec not suitable for pipelined decode - decoding on capture thread";
+        return;
+    }
+
+    FFmpegDecodePipeline::Config config;
+    config.worker_count = GlobalSetting::instance().getDecodeWorkerCount();
+    config.queue_depth = GlobalSetting::instance().getDecodeQueueDepth();
+
+    FFmpegFrameProcessor* processor = m_frameProcessor.get();
+    FFmpegDeviceManager* deviceManager = m_deviceManager.get();
+    bool started = m_decodePipeline->Start(
+        config,
+        [processor, deviceManager](AVPacket* packet, const QSize& targetSize) {
+            FFmpegFrameProcessor::DecodedFrame frame =
+                processor->DecodePacket(packet, deviceManager->GetCodecContext(), targetSize);
+            frame.decoded_ns = FrameLatencyTracker::now();
+            return frame;
+        },
+        [this](const FFmpegFrameProcessor::DecodedFrame& frame, const FFmpegDecodePipeline::FrameTiming& timing) {
+            // Worker-side stamps: decode alone, and the wait for a free worker
+            FrameTimingRecorder::instance().recordQueueWait(timing.queue_wait_us * 1000);
+            FrameTimingRecorder::instance().recordDecode(timing.decode_us * 1000);
+            FFmpegFrameProcessor::DecodedFrame published = frame;
+            if (m_frameProcessor->PublishFrame(&published)) {
+                deliverDecodedFrame(published.image, published.IsRegionComposite(), timing.capture_time_ms,
+                                    timing.read_ns, published.decoded_ns);
             }
+        });
+
+    if (started) {
+        // Each worker and each reorder slot can hold a pooled frame
+        m_frameProcessor->ConfigureFramePool(m_captureManager->GetCurrentResolution(),
+                                             m_decodePipeline->GetWorkerCount() + config.queue_depth);
+    }
+}
+
+QString FFmpegBackendHandler::capabilityCacheKey() const
+{
+    QString portChain = m_currentDevicePortChain;
+    if (portChain.isEmpty()) {
+        portChain = GlobalSetting::instance().getOpenterfacePortChain();
+    }
+
+    // Already-discovered devices only: a fresh USB scan here would cost more
+    // than the cache saves
+    DeviceManager& deviceManager = DeviceManager::getInstance();
+    QList<DeviceInfo> candidates{deviceManager.getCurrentSelectedDevice()};
+    candidates += deviceManager.getCurrentDevices();
+    DeviceInfo device;
+    for (const DeviceInfo& candidate : candidates) {
+        if ((!portChain.isEmpty() && candidate.portChain == portChain)
+            || (!m_currentDevice.isEmpty() && candidate.cameraDevicePath == m_currentDevice)) {
+            device = candidate;
+            break;
         }
-        
-        // Reduce success logging frequency for performance
-        if (m_frameCount % 1000 == 1) {
-            qCDebug(log_ffmpeg_backend) << "frameReady signal emitted successfully for frame" << m_frameCount;
+    }
+
+    return FFmpegCapabilityCache::MakeKey(device.vid, device.pid, portChain);
+}
+
+void FFmpegBackendHandler::revalidateCapabilities(const QString& devicePath)
+{
+    if (m_capabilityKey.isEmpty() || m_deviceManager->GetReplaySource()) {
+        return;
+    }
+
+    // Enumerating takes a few hundred ioctls; do it once capture is already
+    // running so it never delays the first frame
+    const QString key = m_capabilityKey;
+    (void)QtConcurrent::run([key, devicePath]() {
+        const QList<FFmpegCapabilityCache::Mode> modes = FFmpegCapabilityCache::EnumerateModes(devicePath);
+        if (modes.isEmpty()) {
+            return;
         }
-        
-        // REMOVED: QCoreApplication::processEvents() - this was causing excessive CPU usage
-        // Let Qt's event loop handle frame processing naturally
-    } else {
-        // Only warn for decode failures on packets with actual data
-        if (packet->size > 0) {
-            qCWarning(log_ffmpeg_backend) << "Failed to decode frame - pixmap is null";
-            qCWarning(log_ffmpeg_backend) << "Frame decode failure details:";
-            qCWarning(log_ffmpeg_backend) << "  - Packet size:" << packet->size;
-            qCWarning(log_ffmpeg_backend) << "  - Codec ID:" << (codecContext ? codecContext->codec_id : -1);
-            qCWarning(log_ffmpeg_backend) << "  - Stream index:" << packet->stream_index;
+        if (FFmpegCapabilityCache::Instance().UpdateModes(key, modes)) {
+            qCInfo(log_ffmpeg_backend) << "Capability cache: device" << devicePath << "advertises"
+                                       << modes.size() << "modes (changed since last run)";
         }
-    }
+    });
 }
 
 void FFmpegBackendHandler::setVideoOutput(QGraphicsVideoItem* videoItem)
@@ -882,9 +1201,12 @@ void FFmpegBackendHandler::setVideoOutput(QGraphicsVideoItem* videoItem)
     disconnect(m_videoOutputConnection);
     m_videoOutputConnection = QMetaObject::Connection{};
     
-    // Reset backpressure counter: any in-flight queued events from the old
-    // connection will never decrement now, so start fresh.
-    m_pendingFrameCount->store(0, std::memory_order_release);
+    // A frame waiting for the old output is not for the new one
+    if (m_presentationQueue) {
+        m_presentationQueue->clear();
+        m_presentationQueue.reset();
+    }
+    m_frameDiffResetPending = true;  // The new output has seen no frame yet
     
     m_graphicsVideoItem = videoItem;
     m_videoPane = nullptr;
@@ -905,19 +1227,18 @@ void FFmpegBackendHandler::setVideoOutput(QGraphicsVideoItem* videoItem)
         
         if (parentVideoPane) {
             qCDebug(log_ffmpeg_backend) << "Found parent VideoPane, connecting frameReadyImage";
-            // QPointer guards ensure the lambda is safe if either object is destroyed
-            // while a frame is still queued in the event loop.
-            QPointer<VideoPane> parentPtr(parentVideoPane);
-            QPointer<QGraphicsVideoItem> itemPtr(videoItem);
-            auto pendingCount = m_pendingFrameCount;
+            // The pane presents into the item on its next refresh. The lambda
+            // runs on the capture thread and only touches the queue, which
+            // outlives the pane if a frame is in flight while it is destroyed.
+            parentVideoPane->setPresentationItem(videoItem);
+            m_presentationQueue = parentVideoPane->presentationQueue();
+            std::shared_ptr<PresentationQueue> queue = m_presentationQueue;
             m_videoOutputConnection = connect(this, &FFmpegBackendHandler::frameReadyImage,
-                    parentVideoPane, [pendingCount, parentPtr, itemPtr](const QImage& image) {
-                        pendingCount->fetch_sub(1, std::memory_order_release);
-                        if (!parentPtr) return;
-                        QGraphicsVideoItem* item = itemPtr.data();
-                        if (!item) return;
-                        parentPtr->updateGraphicsVideoItemFromImage(item, image);
-                    }, Qt::QueuedConnection);
+                    parentVideoPane, [queue](const QImage& image, const QRegion& dirty) {
+                        if (queue->submit(image, dirty)) {
+                            FrameTimingRecorder::instance().recordDrop(FrameTimingRecorder::DisplaySuperseded);
+                        }
+                    }, Qt::DirectConnection);
         } else {
             qCWarning(log_ffmpeg_backend) << "Could not find parent VideoPane for QGraphicsVideoItem";
             // Fallback: just emit frameReadyImage, UI must connect manually
@@ -935,9 +1256,12 @@ void FFmpegBackendHandler::setVideoOutput(VideoPane* videoPane)
     disconnect(m_videoOutputConnection);
     m_videoOutputConnection = QMetaObject::Connection{};
     
-    // Reset backpressure counter: any in-flight queued events from the old
-    // connection will never decrement now, so start fresh.
-    m_pendingFrameCount->store(0, std::memory_order_release);
+    // A frame waiting for the old output is not for the new one
+    if (m_presentationQueue) {
+        m_presentationQueue->clear();
+        m_presentationQueue.reset();
+    }
+    m_frameDiffResetPending = true;  // The new output has seen no frame yet
     
     m_videoPane = videoPane;
     m_graphicsVideoItem = nullptr;
@@ -945,26 +1269,46 @@ void FFmpegBackendHandler::setVideoOutput(VideoPane* videoPane)
     if (videoPane) {
         qCDebug(log_ffmpeg_backend) << "VideoPane set for FFmpeg direct rendering";
         
-        // Connect with a QPointer-guarded lambda so the slot is safe if VideoPane
-        // is destroyed while a frame is still queued.  The lambda also releases
-        // one backpressure slot so the capture thread can emit the next frame.
-        QPointer<VideoPane> panePtr(videoPane);
-        auto pendingCount = m_pendingFrameCount;
+        // Frames go into the pane's presentation queue straight from the
+        // capture thread; the pane takes the newest one when its window is
+        // about to refresh. The queue outlives the pane if a frame is in
+        // flight while it is destroyed.
+        videoPane->setPresentationItem(nullptr);
+        m_presentationQueue = videoPane->presentationQueue();
+        std::shared_ptr<PresentationQueue> queue = m_presentationQueue;
         m_videoOutputConnection = connect(this, &FFmpegBackendHandler::frameReadyImage,
-                videoPane, [pendingCount, panePtr](const QImage& image) {
-                    pendingCount->fetch_sub(1, std::memory_order_release);
-                    if (!panePtr) return;
-                    panePtr->updateVideoFrameFromImage(image);
-                }, Qt::QueuedConnection);
+                videoPane, [queue](const QImage& image, const QRegion& dirty) {
+                    if (queue->submit(image, dirty)) {
+                        FrameTimingRecorder::instance().recordDrop(FrameTimingRecorder::DisplaySuperseded);
+                    }
+                }, Qt::DirectConnection);
         
         // Connect viewport size changes to update frame scaling
         connect(videoPane, &VideoPane::viewportSizeChanged,
                 this, [this](const QSize& size) {
                     qCDebug(log_ffmpeg_backend) << "Viewport size changed to:" << size;
-                    // The next frame will automatically use the new viewport size in processFrame
+                    // The next frame will automatically use the new viewport size in processFrame.
+                    // The pane may have pre-scaled the last one for the old size, so send
+                    // it again even if the desktop is static.
+                    m_frameDiffResetPending = true;
                 });
         
-        qCDebug(log_ffmpeg_backend) << "Connected frameReadyImage signal to VideoPane::updateVideoFrameFromImage with QueuedConnection";
+        // A cleared (black) pane needs the current picture back at once
+        connect(videoPane, &VideoPane::frameCleared,
+                this, [this]() { m_frameDiffResetPending = true; });
+        
+        // Zoomed views only need the visible part of the frame decoded
+        connect(videoPane, &VideoPane::visibleSourceRectChanged,
+                this, [this](const QRectF& rect) {
+                    if (m_frameProcessor) {
+                        m_frameProcessor->SetDecodeRegion(rect);
+                    }
+                });
+        if (m_frameProcessor) {
+            m_frameProcessor->SetDecodeRegion(videoPane->visibleSourceRect());
+        }
+        
+        qCDebug(log_ffmpeg_backend) << "Connected frameReadyImage signal to the VideoPane presentation queue";
         
         // Enable direct FFmpeg mode in the VideoPane
         videoPane->enableDirectFFmpegMode(true);
@@ -1169,9 +1513,24 @@ bool FFmpegBackendHandler::startRecording(const QString& outputPath, const QStri
     QSize resolution = m_currentResolution.isValid() ? m_currentResolution : QSize(1920, 1080);
     int framerate = m_currentFramerate > 0 ? m_currentFramerate : 30;
     
-    bool success = m_recorder->StartRecording(outputPath, format, videoBitrate, resolution, framerate);
+    // The capture stream lets the recorder mux MJPEG packets without re-encoding
+    const AVStream* sourceStream = nullptr;
+    AVFormatContext* formatContext = m_deviceManager ? m_deviceManager->GetFormatContext() : nullptr;
+    int streamIndex = m_deviceManager ? m_deviceManager->GetVideoStreamIndex() : -1;
+    if (formatContext && streamIndex >= 0 && streamIndex < static_cast<int>(formatContext->nb_streams)) {
+        sourceStream = formatContext->streams[streamIndex];
+    }
+    
+    bool success = m_recorder->StartRecording(outputPath, format, videoBitrate, resolution, framerate, sourceStream);
     
     if (success) {
+        // Frames waiting in the encode queue keep their pooled buffers
+        if (!m_recorder->IsPassthrough()) {
+            if (m_frameProcessor) {
+                m_frameProcessor->SetFramePoolReserve(FFmpegRecorder::kEncodeQueueDepth);
+            }
+            subscribeRecorder();
+        }
         m_recordingActive = true;
         emit recordingStarted(outputPath);
     } else {
@@ -1187,9 +1546,13 @@ bool FFmpegBackendHandler::stopRecording()
         return false;
     }
     
+    unsubscribeRecorder();
     bool success = m_recorder->StopRecording();
     
     if (success) {
+        if (m_frameProcessor) {
+            m_frameProcessor->SetFramePoolReserve(0);
+        }
         m_recordingActive = false;
         emit recordingStopped();
     }
@@ -1274,9 +1637,13 @@ bool FFmpegBackendHandler::forceStopRecording()
         return false;
     }
     
+    unsubscribeRecorder();
     bool success = m_recorder->ForceStopRecording();
     
     if (success) {
+        if (m_frameProcessor) {
+            m_frameProcessor->SetFramePoolReserve(0);
+        }
         m_recordingActive = false;
         emit recordingStopped();
     }
@@ -1294,6 +1661,11 @@ bool FFmpegBackendHandler::supportsRecordingStats() const
     return m_recorder ? m_recorder->SupportsRecordingStats() : false;
 }
 
+RecordingStats FFmpegBackendHandler::getRecordingStats() const
+{
+    return m_recorder ? m_recorder->GetRecordingStats() : RecordingStats();
+}
+
 qint64 FFmpegBackendHandler::getRecordingFileSize() const
 {
     return m_recorder ? m_recorder->GetRecordingFileSize() : 0;
@@ -1314,6 +1686,14 @@ void FFmpegBackendHandler::takeImage(const QString& filePath)
         return;
     }
     
+    // An MJPEG source already has the frame as a native-size JPEG (the decoded
+    // image may be DCT-downscaled); saving it is a file write, not an encode.
+    QByteArray jpeg = m_frameProcessor->GetLatestMjpegFrame();
+    if (!jpeg.isEmpty()) {
+        m_recorder->TakeImage(filePath, jpeg);
+        return;
+    }
+    
     QImage originalImage = m_frameProcessor->GetLatestOriginalFrame();
     if (originalImage.isNull()) {
         qCWarning(log_ffmpeg_backend) << "No original frame available for image capture";
@@ -29,14 +29,17 @@
 #include <QLoggingCategory>
 Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QRegion>
 #include <memory>
 #include <atomic>
 
 // Forward declarations for Qt types
 class QGraphicsVideoItem;
 class VideoPane;
+class PresentationQueue;
 class HotplugMonitor;
 struct DeviceInfo;
 struct DeviceChangeEvent;
@@ -56,6 +59,7 @@ class FFmpegFrameProcessor;
 // Forward declare FFmpegRecorder class
 class FFmpegRecorder;
 struct RecordingConfig; // Defined in ffmpeg_recorder.h
+struct RecordingStats;  // Defined in ffmpeg_recorder.h
 
 // Forward declare FFmpegDeviceValidator class
 class FFmpegDeviceValidator;
@@ -66,6 +70,15 @@ class FFmpegHotplugHandler;
 // Forward declare FFmpegCaptureManager class
 class FFmpegCaptureManager;
 
+// Forward declare FFmpegDecodePipeline class
+class FFmpegDecodePipeline;
+
+// Forward declare FFmpegFrameDiff class
+class FFmpegFrameDiff;
+
+// Forward declare VideoFrame class (defined in framebus.h)
+class VideoFrame;
+
 // Forward declarations for FFmpeg types (conditional compilation)
 #ifdef HAVE_FFMPEG
 extern "C" {
@@ -152,6 +165,7 @@ public:
     
     // Recording statistics
     bool supportsRecordingStats() const;
+    RecordingStats getRecordingStats() const;  // Encoder queue occupancy and drops
     qint64 getRecordingFileSize() const;
     
     void setRecordingConfig(const RecordingConfig& config);
@@ -192,7 +206,10 @@ public:
 
 signals:
     void frameReady(const QImage& frame);
-    void frameReadyImage(const QImage& frame);  // Thread-safe QImage signal for better performance
+    // Thread-safe QImage signal for better performance. dirty is the area that
+    // changed since the previous emission (empty = whole frame); frames
+    // identical to the previous one are not emitted at all.
+    void frameReadyImage(const QImage& frame, const QRegion& dirty = QRegion());
     void captureError(const QString& error);
     void deviceConnectionChanged(const QString& devicePath, bool connected);
     void deviceActivated(const QString& devicePath);
@@ -232,6 +249,19 @@ private:
     };
     bool getMaxCameraCapability(const QString& devicePath, CameraCapability& capability);
     
+    // Frame hand-off helpers shared by the synchronous and pipelined decode paths
+    QSize computeDecodeTargetSize() const;
+    // regionComposite: image is a region decode over older content (DecodedFrame::IsRegionComposite())
+    void deliverDecodedFrame(const QImage& image, bool regionComposite, qint64 captureTime,
+                             qint64 readNs, qint64 decodedNs);
+    void startDecodePipeline();
+    // A re-encoding recording takes its frames from the FrameBus
+    void subscribeRecorder();
+    void unsubscribeRecorder();
+    void writeRecordingFrame(const std::shared_ptr<const VideoFrame>& frame);
+    QString capabilityCacheKey() const;
+    void revalidateCapabilities(const QString& devicePath);
+    
     // Interrupt handling for FFmpeg operations
     volatile bool m_interruptRequested;
     qint64 m_operationStartTime;
@@ -262,6 +292,23 @@ private:
     // Capture management - managed by dedicated class
     std::unique_ptr<FFmpegCaptureManager> m_captureManager;
     
+    // Multi-threaded MJPEG decode stage (idle when the codec cannot be decoded in parallel)
+    std::unique_ptr<FFmpegDecodePipeline> m_decodePipeline;
+    
+    // Tile-hash change detection on delivered frames (delivery thread only)
+    std::unique_ptr<FFmpegFrameDiff> m_frameDiff;
+    std::atomic<bool> m_frameDiffResetPending;  // Set by any thread, applied on the next delivery
+    QRegion m_undisplayedDirty;     // Changes in frames dropped by display backpressure
+    
+    // FrameBus subscription feeding a re-encoding recording (0 when none)
+    int m_recorderSubscription;
+    quint64 m_recorderContentSequence;  // Content of the last frame given to the recorder
+    
+    // Capture capability cache and cold/warm time to first frame
+    QString m_capabilityKey;
+    QElapsedTimer m_captureStartTimer;
+    std::atomic<bool> m_firstFramePending;
+    
     // Packet handling
 #ifdef HAVE_FFMPEG
     AvPacketPtr m_packet;
@@ -299,10 +346,10 @@ private:
     QString m_lastError;
     
 
-    // Frame backpressure: limits the number of QImage copies queued in the GUI event
-    // loop via QueuedConnection, preventing unbounded memory growth and OOM conditions
-    // when the capture thread produces frames faster than the GUI thread consumes them.
-    std::shared_ptr<std::atomic<int>> m_pendingFrameCount;
+    // Latest-frame slot of the current video output, presented at the display's
+    // refresh rate. Replaces queueing every frame into the GUI event loop, so
+    // memory stays bounded whatever the capture rate.
+    std::shared_ptr<PresentationQueue> m_presentationQueue;
 
     // Thread safety
     mutable QMutex m_mutex;
@@ -311,6 +358,7 @@ private:
     // Performance monitoring
     QTimer* m_performanceTimer;
     int m_frameCount;
+    int m_lastGovernorLevel;   // Last decode governor level reported to the UI
     qint64 m_lastFrameTime;
     
     // Frame rate control and timestamp synchronization
@@ -12,8 +12,12 @@ using namespace Openterface::GStreamer;
 QString PipelineBuilder::buildFlexiblePipeline(const QString& device, const QSize& resolution, int framerate, const QString& videoSink, const QSize& widgetSize)
 {
     // Keep the same structure as old generatePipelineString to preserve recording/tee names
-    QString sourceElement = "v4l2src device=%DEVICE% do-timestamp=true";
-    QString decoderElement = "image/jpeg,width=%WIDTH%,height=%HEIGHT%,framerate=%FRAMERATE%/1 ! jpegdec";
+    QString sourceElement = "v4l2src name=video-source device=%DEVICE% do-timestamp=true";
+    // The jpeg tee sits in front of the decoder so that a recording branch can take the
+    // compressed frames; only the display path below it pays for jpegdec
+    QString decoderElement = "image/jpeg,width=%WIDTH%,height=%HEIGHT%,framerate=%FRAMERATE%/1 ! "
+                             "tee name=%JPEG_TEE% allow-not-linked=true ! "
+                             "jpegdec name=video-decoder";
 
     // Calculate the output size for videoscale: output EXACTLY the display size with
     // black borders (letterbox/pillarbox) to fill the screen. This is critical on
@@ -43,6 +47,7 @@ QString PipelineBuilder::buildFlexiblePipeline(const QString& device, const QSiz
     pipelineStr.replace("%HEIGHT%", QString::number(resolution.height()));
     pipelineStr.replace("%FRAMERATE%", QString::number(framerate));
     pipelineStr.replace("%SCALE_CAPS%", scaleCaps);
+    pipelineStr.replace("%JPEG_TEE%", QLatin1String(kJpegTeeName));
 
     return pipelineStr;
 }
@@ -50,7 +55,7 @@ QString PipelineBuilder::buildFlexiblePipeline(const QString& device, const QSiz
 QString PipelineBuilder::buildVideotestMjpegFallback(const QSize& resolution, int framerate, const QString& videoSink)
 {
     QString tmpl(
-        "videotestsrc pattern=0 is-live=true ! "
+        "videotestsrc name=video-source pattern=0 is-live=true ! "
         "video/x-raw,width=%WIDTH%,height=%HEIGHT%,framerate=%FRAMERATE%/1 ! "
         "videoconvert ! "
         "tee name=t ! queue name=display-queue max-size-buffers=5 leaky=downstream ! %SINK% name=videosink sync=false "
@@ -66,9 +71,10 @@ QString PipelineBuilder::buildVideotestMjpegFallback(const QSize& resolution, in
 QString PipelineBuilder::buildV4l2JpegFallback(const QString& device, const QSize& resolution, int framerate, const QString& videoSink)
 {
     QString tmpl(
-        "v4l2src device=%DEVICE% ! "
+        "v4l2src name=video-source device=%DEVICE% ! "
         "image/jpeg,width=%WIDTH%,height=%HEIGHT%,framerate=%FRAMERATE%/1 ! "
-        "jpegdec ! "
+        "tee name=%JPEG_TEE% allow-not-linked=true ! "
+        "jpegdec name=video-decoder ! "
         "videoconvert ! "
         "tee name=t ! queue name=display-queue max-size-buffers=5 leaky=downstream ! %SINK% name=videosink sync=false "
         "t. ! valve name=recording-valve drop=true ! queue name=recording-queue max-size-buffers=10 leaky=upstream ! identity name=recording-ready");
@@ -78,13 +84,14 @@ QString PipelineBuilder::buildV4l2JpegFallback(const QString& device, const QSiz
     tmpl.replace("%HEIGHT%", QString::number(resolution.height()));
     tmpl.replace("%FRAMERATE%", QString::number(framerate));
     tmpl.replace("%SINK%", videoSink);
+    tmpl.replace("%JPEG_TEE%", QLatin1String(kJpegTeeName));
     return tmpl;
 }
 
 QString PipelineBuilder::buildV4l2RawFallback(const QString& device, const QSize& resolution, int framerate, const QString& videoSink)
 {
     QString tmpl(
-        "v4l2src device=%DEVICE% ! "
+        "v4l2src name=video-source device=%DEVICE% ! "
         "video/x-raw,width=%WIDTH%,height=%HEIGHT%,framerate=%FRAMERATE%/1 ! "
         "videoconvert ! "
         "tee name=t ! queue name=display-queue max-size-buffers=5 leaky=downstream ! %SINK% name=videosink sync=false "
@@ -114,7 +121,7 @@ QString PipelineBuilder::buildMinimalPipeline()
 QString PipelineBuilder::buildConservativeTestPipeline(const QString& videoSink)
 {
     QString tmpl(
-        "videotestsrc pattern=0 is-live=true ! "
+        "videotestsrc name=video-source pattern=0 is-live=true ! "
         "video/x-raw,width=640,height=480,framerate=15/1 ! "
         "videoconvert ! "
         "tee name=t ! queue name=display-queue max-size-buffers=5 leaky=downstream ! %SINK% name=videosink sync=false "
@@ -123,3 +130,16 @@ QString PipelineBuilder::buildConservativeTestPipeline(const QString& videoSink)
     tmpl.replace("%SINK%", videoSink);
     return tmpl;
 }
+
+QString PipelineBuilder::jpegPassthroughMuxer(const QString& codec, const QString& format)
+{
+    const QString c = codec.toLower();
+    if (c != "mjpeg" && c != "jpeg") {
+        return QString();
+    }
+
+    const QString f = format.toLower();
+    if (f == "mkv") return QStringLiteral("matroskamux");
+    if (f == "avi") return QStringLiteral("avimux");
+    return QString();
+}
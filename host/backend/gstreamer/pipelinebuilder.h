@@ -11,6 +11,11 @@ namespace GStreamer {
 class PipelineBuilder
 {
 public:
+    // Name of the tee that MJPEG pipelines place in front of jpegdec. Its buffers are
+    // the camera's original image/jpeg frames, so recording can mux them without a
+    // decode/encode round trip. Decoded frames are still teed at "t" after videoconvert.
+    static constexpr const char* kJpegTeeName = "jpeg-tee";
+
     // Flexible pipeline - recording-enabled template using v4l2src + jpegdec and scaling
     // widgetSize: optional target display size; if provided and valid, videoscale output
     // is constrained to fit the widget so video isn't clipped on small screens
@@ -27,6 +32,11 @@ public:
 
     // Final conservative fallback pipeline
     static QString buildConservativeTestPipeline(const QString& videoSink);
+
+    // Muxer that stores compressed JPEG frames from the jpeg tee as they are, for the
+    // given recording codec and container. Empty when the codec asks for a re-encode
+    // ("x264enc", ...) or the container cannot hold image/jpeg (mp4).
+    static QString jpegPassthroughMuxer(const QString& codec, const QString& format);
 };
 
 } // namespace GStreamer
@@ -1,14 +1,27 @@
 #include "recordingmanager.h"
+#include "pipelinebuilder.h"
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QLoggingCategory>
 #include <QThread>
+#include <atomic>
 #ifdef HAVE_GSTREAMER
 #include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+#include <gst/video/video.h>
 #endif
 
 #include "log/opflogging.h"
 OPF_LOGGING_CATEGORY(log_gst_recording, "opf.backend.gstreamer.recording")
 
+// How long stopRecording waits for a muxer to write its trailer
+static constexpr int kFinalizeTimeoutMs = 2000;
+// Raw frames allowed to wait for the frame-based encoder before new ones are dropped
+static constexpr quint64 kEncoderBacklogFrames = 8;
+static constexpr quint64 kEncoderBacklogFallbackBytes = 8ull * 1920 * 1080 * 4;
+// Fragment length of segmented MP4/MOV files, so a crash loses at most this much
+static constexpr guint kSegmentFragmentMs = 1000;
+
 RecordingManager::RecordingManager(QObject* parent)
     : QObject(parent), m_mainPipeline(nullptr),
       m_recordingPipeline(nullptr), m_recordingTee(nullptr), m_recordingValve(nullptr),
@@ -26,6 +39,7 @@ RecordingManager::~RecordingManager()
     // Clean up any active recording branch
     removeRecordingBranch();
 #endif
+    endSegments();
 }
 
 bool RecordingManager::startRecording(GstElement* mainPipeline, const QString& outputPath, const QString& format, int videoBitrate)
@@ -65,16 +79,46 @@ bool RecordingManager::startRecording(GstElement* mainPipeline, const QString& o
         return false;
     }
 
+    if (!beginSegments(outputPath)) {
+        emit recordingError(QString("Cannot start segmented recording in %1").arg(outputDir.absolutePath()));
+        return false;
+    }
+
 #ifdef HAVE_GSTREAMER
+    // An MJPEG recording into a container that can hold image/jpeg stores the camera's
+    // own frames; everything else is decoded and re-encoded from the "t" tee
+    const QString passthroughMuxer = Openterface::GStreamer::PipelineBuilder::jpegPassthroughMuxer(m_recordingCodec, format);
+    bool branchReady = false;
+    if (!passthroughMuxer.isEmpty()) {
+        branchReady = createJpegPassthroughBranch(outputPath, passthroughMuxer);
+        if (!branchReady) {
+            qCWarning(log_gst_recording) << "JPEG passthrough recording not available, re-encoding decoded frames";
+            removeRecordingBranch();
+        }
+    }
+
+    // Of the re-encoding paths only the in-process encoder ends in a real muxer
+    // that can be split, so it goes first when segments are wanted
+    if (!branchReady && m_segmenter) {
+        branchReady = initializeFrameBasedRecording(outputPath, format, videoBitrate);
+        if (!branchReady) {
+            qCWarning(log_gst_recording) << "Segmented recording not available, writing a single file";
+            removeRecordingBranch();
+            endSegments();
+        }
+    }
+
     // Prefer valve-based recording when possible. If that fails, try separate branch or frame-based fallbacks.
-    if (!createRecordingBranch(outputPath, format, videoBitrate)) {
+    if (!branchReady && !createRecordingBranch(outputPath, format, videoBitrate)) {
         qCWarning(log_gst_recording) << "Valve-based recording not available, attempting separate branch or frame-based fallback";
         // Try adding a separate branch (encoder+filesink) first
         if (!createSeparateRecordingPipeline(outputPath, format, videoBitrate)) {
-            qCWarning(log_gst_recording) << "Separate pipeline approach failed, attempting frame-based appsink+ffmpeg fallback";
-            if (!initializeFrameBasedRecording(format)) {
+            qCWarning(log_gst_recording) << "Separate pipeline approach failed, attempting frame-based appsink+encoder fallback";
+            if (!initializeFrameBasedRecording(outputPath, format, videoBitrate)) {
                 QString error = QString("Failed to initialize any recording pipeline for format %1").arg(format);
                 qCCritical(log_gst_recording) << error;
+                removeRecordingBranch();
+                endSegments();
                 emit recordingError(error);
                 return false;
             }
@@ -227,153 +271,422 @@ bool RecordingManager::createSeparateRecordingPipeline(const QString& outputPath
     return true;
 }
 
-bool RecordingManager::initializeFrameBasedRecording(const QString& format)
+bool RecordingManager::createJpegPassthroughBranch(const QString& outputPath, const QString& muxerName)
 {
-    qCDebug(log_gst_recording) << "RecordingManager::initializeFrameBasedRecording format" << format;
+    qCDebug(log_gst_recording) << "RecordingManager::createJpegPassthroughBranch to" << outputPath << "muxer" << muxerName;
 
     if (!m_mainPipeline) {
-        qCCritical(log_gst_recording) << "Main pipeline not set for frame-based recording";
+        qCCritical(log_gst_recording) << "Main pipeline is null - cannot create passthrough recording branch";
         return false;
     }
 
-    // Clean up any previous recording process
-    if (m_recordingProcess) {
-        m_recordingProcess->terminate();
-        if (!m_recordingProcess->waitForFinished(3000)) m_recordingProcess->kill();
-        delete m_recordingProcess;
-        m_recordingProcess = nullptr;
+    using Openterface::GStreamer::PipelineBuilder;
+    GstElement* jpegTee = gst_bin_get_by_name(GST_BIN(m_mainPipeline), PipelineBuilder::kJpegTeeName);
+    if (!jpegTee) {
+        // Raw and test-source pipelines have no compressed stream to tap
+        qCDebug(log_gst_recording) << "Pipeline has no" << PipelineBuilder::kJpegTeeName << "- passthrough unavailable";
+        return false;
     }
+    if (m_recordingTee) {
+        gst_object_unref(m_recordingTee);
+    }
+    m_recordingTee = jpegTee;
+
+    m_recordingQueue = gst_element_factory_make("queue", "recording-queue");
+    m_recordingMuxer = gst_element_factory_make(muxerName.toUtf8().constData(), "recording-muxer");
+    m_recordingFileSink = gst_element_factory_make("filesink", "recording-filesink");
+    if (!m_recordingQueue || !m_recordingMuxer || !m_recordingFileSink) {
+        qCWarning(log_gst_recording) << "Failed to create passthrough recording elements (muxer" << muxerName << ")";
+        if (m_recordingQueue) gst_object_unref(m_recordingQueue);
+        if (m_recordingMuxer) gst_object_unref(m_recordingMuxer);
+        if (m_recordingFileSink) gst_object_unref(m_recordingFileSink);
+        m_recordingQueue = nullptr;
+        m_recordingMuxer = nullptr;
+        m_recordingFileSink = nullptr;
+        return false;
+    }
+
+    // Compressed frames are ~10x smaller than decoded ones, so a deeper queue is cheap
+    // and rides out disk stalls without touching the display path
+    g_object_set(m_recordingQueue,
+                 "max-size-buffers", 60,
+                 "max-size-bytes", 0,
+                 "max-size-time", (guint64)(2 * GST_SECOND),
+                 "leaky", 2,
+                 "silent", TRUE,
+                 NULL);
+    g_object_set(m_recordingFileSink, "location", outputPath.toUtf8().constData(), "async", FALSE, NULL);
+
+    // Take references so removeRecordingBranch can unref after gst_bin_remove
+    gst_object_ref(m_recordingQueue);
+    gst_object_ref(m_recordingMuxer);
+    gst_object_ref(m_recordingFileSink);
+    if (m_segmenter) {
+        // Every JPEG frame is a keyframe, so splitmuxsink can cut anywhere
+        m_recordingSplitMux = createSegmentingSink(m_recordingMuxer, m_recordingFileSink, false);
+        if (!m_recordingSplitMux) {
+            return false;
+        }
+        gst_object_ref(m_recordingSplitMux);
+        gst_bin_add_many(GST_BIN(m_mainPipeline), m_recordingQueue, m_recordingSplitMux, NULL);
+    } else {
+        gst_bin_add_many(GST_BIN(m_mainPipeline), m_recordingQueue, m_recordingMuxer, m_recordingFileSink, NULL);
+    }
+
+    const bool linked = m_recordingSplitMux
+        ? gst_element_link(m_recordingQueue, m_recordingSplitMux)
+        : gst_element_link_many(m_recordingQueue, m_recordingMuxer, m_recordingFileSink, NULL);
+    if (!linked) {
+        qCWarning(log_gst_recording) << "Failed to link passthrough recording elements";
+        return false;
+    }
+
+    m_recordingTeeSrcPad = gst_element_request_pad_simple(m_recordingTee, "src_%u");
+    GstPad* queueSinkPad = gst_element_get_static_pad(m_recordingQueue, "sink");
+    if (!m_recordingTeeSrcPad || !queueSinkPad) {
+        qCWarning(log_gst_recording) << "Failed to obtain pads for passthrough recording branch";
+        if (queueSinkPad) gst_object_unref(queueSinkPad);
+        return false;
+    }
+
+    // Bring the branch up before it is linked so the first buffer finds it ready.
+    // splitmuxsink manages the states of its muxer and sink itself.
+    if (m_recordingSplitMux) {
+        gst_element_sync_state_with_parent(m_recordingSplitMux);
+    } else {
+        gst_element_sync_state_with_parent(m_recordingFileSink);
+        gst_element_sync_state_with_parent(m_recordingMuxer);
+    }
+    gst_element_sync_state_with_parent(m_recordingQueue);
+
+    GstPadLinkReturn linkResult = gst_pad_link(m_recordingTeeSrcPad, queueSinkPad);
+    gst_object_unref(queueSinkPad);
+    if (linkResult != GST_PAD_LINK_OK) {
+        qCWarning(log_gst_recording) << "Failed to link jpeg tee to recording queue:" << linkResult;
+        return false;
+    }
+
+    qCInfo(log_gst_recording) << "Recording compressed JPEG frames via" << muxerName << "to" << outputPath;
+    return true;
+}
+
+GstElement* RecordingManager::createSegmentingSink(GstElement* muxer, GstElement* fileSink, bool requestKeyframes)
+{
+    if (!m_segmenter) {
+        return nullptr;
+    }
+    GstElement* splitMux = gst_element_factory_make("splitmuxsink", "recording-splitmux");
+    if (!splitMux) {
+        qCWarning(log_gst_recording) << "splitmuxsink not available - cannot segment the recording";
+        return nullptr;
+    }
+
+    // Keyframe requests only work with a time limit; a size limit cuts at the
+    // encoder's own keyframes
+    const SegmentPolicy policy = m_segmenter->policy();
+    g_object_set(splitMux,
+                 "muxer", muxer,
+                 "sink", fileSink,
+                 "max-size-time", (guint64)(policy.segmentDurationMs * GST_MSECOND),
+                 "max-size-bytes", (guint64)policy.segmentSizeBytes,
+                 "send-keyframe-requests", (gboolean)(requestKeyframes && policy.segmentSizeBytes == 0),
+                 NULL);
+
+    // Runs on the streaming thread after the previous file has been closed
+    g_signal_connect(splitMux, "format-location-full", G_CALLBACK(+[](GstElement*, guint, GstSample*, gpointer userData) -> gchar* {
+        const QString path = static_cast<RecordingSegmenter*>(userData)->openSegment(QDateTime::currentMSecsSinceEpoch());
+        qCInfo(log_gst_recording) << "Recording segment" << path;
+        return path.isEmpty() ? nullptr : g_strdup(path.toUtf8().constData());
+    }), m_segmenter.get());
+
+    qCInfo(log_gst_recording) << "Segmented recording, index:" << m_segmenter->indexPath();
+    return splitMux;
+}
+
+void RecordingManager::finalizeRecordingBranch()
+{
+    if (!m_recordingQueue || !m_recordingMuxer || !m_recordingFileSink) {
+        return;
+    }
+
+    GstPad* queueSinkPad = gst_element_get_static_pad(m_recordingQueue, "sink");
+    GstPad* fileSinkPad = gst_element_get_static_pad(m_recordingFileSink, "sink");
+    if (!queueSinkPad || !fileSinkPad) {
+        if (queueSinkPad) gst_object_unref(queueSinkPad);
+        if (fileSinkPad) gst_object_unref(fileSinkPad);
+        return;
+    }
+
+    std::atomic<bool> eosReached{false};
+    gulong probeId = gst_pad_add_probe(fileSinkPad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+        +[](GstPad*, GstPadProbeInfo* info, gpointer userData) -> GstPadProbeReturn {
+            if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) == GST_EVENT_EOS) {
+                static_cast<std::atomic<bool>*>(userData)->store(true);
+            }
+            return GST_PAD_PROBE_OK;
+        }, &eosReached, nullptr);
+
+    // The tee pad is already unlinked, so this EOS only travels down the recording branch
+    if (gst_pad_send_event(queueSinkPad, gst_event_new_eos())) {
+        QElapsedTimer waited;
+        waited.start();
+        while (!eosReached.load() && waited.elapsed() < kFinalizeTimeoutMs) {
+            QThread::msleep(10);
+        }
+        if (!eosReached.load()) {
+            qCWarning(log_gst_recording) << "Recording muxer did not finish within" << kFinalizeTimeoutMs << "ms";
+        }
+    }
+
+    gst_pad_remove_probe(fileSinkPad, probeId);
+    gst_object_unref(queueSinkPad);
+    gst_object_unref(fileSinkPad);
+}
+
+bool RecordingManager::initializeFrameBasedRecording(const QString& outputPath, const QString& format, int videoBitrate)
+{
+    qCDebug(log_gst_recording) << "RecordingManager::initializeFrameBasedRecording to" << outputPath << "format" << format;
+
+    if (!m_mainPipeline) {
+        qCCritical(log_gst_recording) << "Main pipeline not set for frame-based recording";
+        return false;
+    }
+
+    // Clean up any previous encoder
+    stopFrameEncoder();
 
-    // Find tee
     GstElement* tee = gst_bin_get_by_name(GST_BIN(m_mainPipeline), "t");
     if (!tee) {
         qCCritical(log_gst_recording) << "Could not find tee element 't' for frame-based recording";
         return false;
     }
 
-    GstElement* queue = gst_element_factory_make("queue", "recording-queue");
-    GstElement* videoconvert = gst_element_factory_make("videoconvert", "recording-convert");
-    GstElement* appsink = gst_element_factory_make("appsink", "recording-appsink");
-
-    if (!queue || !appsink) {
-        qCCritical(log_gst_recording) << "Failed to create queue or appsink for frame-based recording";
-        if (queue) gst_object_unref(queue);
-        if (videoconvert) gst_object_unref(videoconvert);
-        if (appsink) gst_object_unref(appsink);
+    // Record exactly what the display branch negotiated. If the tee has not negotiated
+    // yet, the caps are taken from the first sample instead.
+    GstCaps* liveCaps = nullptr;
+    if (GstPad* teeSinkPad = gst_element_get_static_pad(tee, "sink")) {
+        liveCaps = gst_pad_get_current_caps(teeSinkPad);
+        gst_object_unref(teeSinkPad);
+    }
+    const bool encoderReady = createFrameEncoder(outputPath, format, videoBitrate, liveCaps);
+    if (liveCaps) gst_caps_unref(liveCaps);
+    if (!encoderReady) {
         gst_object_unref(tee);
         return false;
     }
 
-    // Try to determine resolution and framerate from pipeline - fallback to sensible defaults
-    int width = 1280, height = 720, framerate = 30;
-    // (Attempt to infer from pads / caps is possible but can be brittle; keep defaults to remain robust)
+    if (m_recordingTee) {
+        gst_object_unref(m_recordingTee);
+    }
+    m_recordingTee = tee;
+
+    m_recordingQueue = gst_element_factory_make("queue", "recording-queue");
+    m_recordingAppSink = gst_element_factory_make("appsink", "recording-appsink");
+    if (!m_recordingQueue || !m_recordingAppSink) {
+        qCCritical(log_gst_recording) << "Failed to create queue or appsink for frame-based recording";
+        if (m_recordingQueue) gst_object_unref(m_recordingQueue);
+        if (m_recordingAppSink) gst_object_unref(m_recordingAppSink);
+        m_recordingQueue = nullptr;
+        m_recordingAppSink = nullptr;
+        stopFrameEncoder();
+        return false;
+    }
 
-    GstCaps* caps = gst_caps_new_simple("video/x-raw",
-                                        "format", G_TYPE_STRING, "RGB",
-                                        "width", G_TYPE_INT, width,
-                                        "height", G_TYPE_INT, height,
-                                        "framerate", GST_TYPE_FRACTION, framerate, 1,
-                                        NULL);
+    // The appsink callback only hands buffers over, so a short queue is enough; when it
+    // does fill up the overrun is counted rather than stalling the display branch
+    g_object_set(m_recordingQueue,
+                 "max-size-buffers", 4,
+                 "max-size-bytes", 0,
+                 "max-size-time", (guint64)0,
+                 "leaky", 2,
+                 "silent", FALSE,
+                 NULL);
+    g_signal_connect(m_recordingQueue, "overrun", G_CALLBACK(+[](GstElement*, gpointer userData) {
+        static_cast<RecordingManager*>(userData)->m_queueOverruns.fetch_add(1, std::memory_order_relaxed);
+    }), this);
 
-    g_object_set(appsink,
-                 "caps", caps,
+    g_object_set(m_recordingAppSink,
                  "emit-signals", TRUE,
                  "sync", FALSE,
                  "drop", TRUE,
-                 "max-buffers", 5,
+                 "max-buffers", 2,
                  NULL);
-
-    gst_caps_unref(caps);
-
-    // Keep appsink reference
-    m_recordingAppSink = appsink;
-
-    // Connect appsink new-sample -> onNewRecordingSample
-    g_signal_connect(appsink, "new-sample", G_CALLBACK(+[](GstAppSink* sink, gpointer user_data) -> GstFlowReturn {
-        RecordingManager* mgr = static_cast<RecordingManager*>(user_data);
-        return mgr->onNewRecordingSample(sink);
+    g_signal_connect(m_recordingAppSink, "new-sample", G_CALLBACK(+[](GstAppSink* sink, gpointer userData) -> GstFlowReturn {
+        return static_cast<RecordingManager*>(userData)->onNewRecordingSample(sink);
     }), this);
 
-    // Add elements to main pipeline and link
-    if (videoconvert) {
-        gst_bin_add_many(GST_BIN(m_mainPipeline), queue, videoconvert, appsink, NULL);
-    } else {
-        gst_bin_add_many(GST_BIN(m_mainPipeline), queue, appsink, NULL);
+    // Take references so removeRecordingBranch can unref after gst_bin_remove
+    gst_object_ref(m_recordingQueue);
+    gst_object_ref(m_recordingAppSink);
+    gst_bin_add_many(GST_BIN(m_mainPipeline), m_recordingQueue, m_recordingAppSink, NULL);
+
+    if (!gst_element_link(m_recordingQueue, m_recordingAppSink)) {
+        qCCritical(log_gst_recording) << "Failed to link recording queue to appsink";
+        return false;
     }
 
-    GstPad* teeSrcPad = gst_element_request_pad_simple(tee, "src_%u");
-    GstPad* queueSinkPad = gst_element_get_static_pad(queue, "sink");
-    if (!teeSrcPad || !queueSinkPad) {
+    m_recordingTeeSrcPad = gst_element_request_pad_simple(m_recordingTee, "src_%u");
+    GstPad* queueSinkPad = gst_element_get_static_pad(m_recordingQueue, "sink");
+    if (!m_recordingTeeSrcPad || !queueSinkPad) {
         qCCritical(log_gst_recording) << "Failed to get pads for frame-based recording";
-        gst_object_unref(tee);
+        if (queueSinkPad) gst_object_unref(queueSinkPad);
         return false;
     }
 
-    if (gst_pad_link(teeSrcPad, queueSinkPad) != GST_PAD_LINK_OK) {
-        qCCritical(log_gst_recording) << "Failed to link tee to recording branch for appsink";
-        gst_object_unref(teeSrcPad);
-        gst_object_unref(queueSinkPad);
-        gst_object_unref(tee);
+    gst_element_sync_state_with_parent(m_recordingAppSink);
+    gst_element_sync_state_with_parent(m_recordingQueue);
+
+    GstPadLinkReturn linkResult = gst_pad_link(m_recordingTeeSrcPad, queueSinkPad);
+    gst_object_unref(queueSinkPad);
+    if (linkResult != GST_PAD_LINK_OK) {
+        qCCritical(log_gst_recording) << "Failed to link tee to recording branch for appsink:" << linkResult;
         return false;
     }
 
-    gst_object_unref(teeSrcPad);
-    gst_object_unref(queueSinkPad);
-    gst_object_unref(tee);
+    if (!m_encoderMonitorTimer) {
+        m_encoderMonitorTimer = new QTimer(this);
+        m_encoderMonitorTimer->setInterval(1000);
+        connect(m_encoderMonitorTimer, &QTimer::timeout, this, &RecordingManager::pollFrameEncoder);
+    }
+    m_encoderMonitorTimer->start();
 
-    if (videoconvert) {
-        if (!gst_element_link_many(queue, videoconvert, appsink, NULL)) {
-            qCCritical(log_gst_recording) << "Failed to link recording chain (with videoconvert)";
-            return false;
-        }
+    qCInfo(log_gst_recording) << "Initialized in-process appsink recording";
+    return true;
+}
+
+bool RecordingManager::createFrameEncoder(const QString& outputPath, const QString& format, int videoBitrate, GstCaps* liveCaps)
+{
+    const QString f = format.toLower();
+    const QString codec = m_recordingCodec.toLower();
+    // x264enc/x265enc take kbit/s
+    const int bitrateKbps = qMax(1, videoBitrate / 1000);
+
+    QString encoder;
+    QString muxer;
+    if (f == "mp4" || f == "mkv" || f == "mov") {
+        encoder = codec == "x265enc"
+            ? QString("x265enc bitrate=%1 speed-preset=veryfast").arg(bitrateKbps)
+            : QString("x264enc bitrate=%1 speed-preset=veryfast").arg(bitrateKbps);
+        muxer = f == "mp4" ? "mp4mux" : (f == "mkv" ? "matroskamux" : "qtmux");
     } else {
-        if (!gst_element_link(queue, appsink)) {
-            qCCritical(log_gst_recording) << "Failed to link recording chain (direct)";
-            return false;
-        }
+        encoder = "jpegenc quality=85";
+        muxer = f == "avi" ? "avimux" : QString();
     }
 
-    // Sync with parent
-    gst_element_sync_state_with_parent(queue);
-    if (videoconvert) gst_element_sync_state_with_parent(videoconvert);
-    gst_element_sync_state_with_parent(appsink);
-
-    // Now start an FFmpeg process to read raw RGB from appsink and write to file
-    m_recordingProcess = new QProcess(this);
-    connect(m_recordingProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &RecordingManager::handleRecordingProcessFinished);
-    connect(m_recordingProcess, &QProcess::errorOccurred, this, &RecordingManager::handleRecordingProcessError);
+    // Segmented: splitmuxsink is attached behind the encoder once the rest is parsed
+    const bool segmented = m_segmenter && !muxer.isEmpty();
+    if (m_segmenter && muxer.isEmpty()) {
+        qCWarning(log_gst_recording) << "Format" << format << "has no container to split - writing a single file";
+    }
 
-    QStringList args;
-    args << "-f" << "rawvideo";
-    args << "-pix_fmt" << "rgb24";
-    args << "-s" << QString("%1x%2").arg(width).arg(height);
-    args << "-r" << QString::number(framerate);
-    args << "-i" << "-"; // input from stdin
+    QString description = "appsrc name=recording-src is-live=true format=time block=false emit-signals=false ! "
+                          "videoconvert ! " + encoder + " name=recording-encoder";
+    if (!segmented) {
+        description += " ! ";
+        if (!muxer.isEmpty()) {
+            description += muxer + " ! ";
+        }
+        description += "filesink name=recording-filesink sync=false async=false";
+    }
 
-    if (format.toLower() == "avi") {
-        args << "-c:v" << "mjpeg" << "-q:v" << "2";
-    } else if (format.toLower() == "mp4") {
-        args << "-c:v" << "libx264" << "-preset" << "fast" << "-crf" << "23";
-    } else {
-        args << "-c:v" << "mjpeg" << "-q:v" << "2";
+    GError* error = nullptr;
+    m_encoderPipeline = gst_parse_launch(description.toUtf8().constData(), &error);
+    if (!m_encoderPipeline || error) {
+        qCWarning(log_gst_recording) << "Failed to create encoder pipeline" << description << ":" << (error ? error->message : "unknown error");
+        if (error) g_error_free(error);
+        if (m_encoderPipeline) gst_object_unref(m_encoderPipeline);
+        m_encoderPipeline = nullptr;
+        return false;
     }
 
-    args << "-y" << m_recordingOutputPath;
+    if (segmented) {
+        GstElement* muxerElement = gst_element_factory_make(muxer.toUtf8().constData(), "recording-muxer");
+        GstElement* fileSink = gst_element_factory_make("filesink", "recording-filesink");
+        if (muxerElement && g_object_class_find_property(G_OBJECT_GET_CLASS(muxerElement), "fragment-duration")) {
+            // Fragmented MP4/MOV: nothing left to write at the end, so a crash keeps the file playable
+            g_object_set(muxerElement, "fragment-duration", kSegmentFragmentMs, NULL);
+        }
+        if (fileSink) {
+            g_object_set(fileSink, "sync", FALSE, "async", FALSE, NULL);
+        }
+        GstElement* splitMux = muxerElement && fileSink ? createSegmentingSink(muxerElement, fileSink, true) : nullptr;
+        GstElement* encoderElement = gst_bin_get_by_name(GST_BIN(m_encoderPipeline), "recording-encoder");
+        bool linked = false;
+        if (!splitMux) {
+            if (muxerElement) gst_object_unref(muxerElement);
+            if (fileSink) gst_object_unref(fileSink);
+        } else if (!encoderElement) {
+            gst_object_unref(splitMux);   // Takes muxer and sink with it
+        } else {
+            gst_bin_add(GST_BIN(m_encoderPipeline), splitMux);
+            linked = gst_element_link(encoderElement, splitMux);
+        }
+        if (encoderElement) gst_object_unref(encoderElement);
+        if (!linked) {
+            qCWarning(log_gst_recording) << "Failed to attach splitmuxsink to the recording encoder";
+            gst_object_unref(m_encoderPipeline);
+            m_encoderPipeline = nullptr;
+            return false;
+        }
+    } else if (GstElement* fileSink = gst_bin_get_by_name(GST_BIN(m_encoderPipeline), "recording-filesink")) {
+        g_object_set(fileSink, "location", outputPath.toUtf8().constData(), NULL);
+        gst_object_unref(fileSink);
+    }
+    m_recordingAppSrc = gst_bin_get_by_name(GST_BIN(m_encoderPipeline), "recording-src");
+
+    m_framesReceived = 0;
+    m_framesPushed = 0;
+    m_framesDropped = 0;
+    m_queueOverruns = 0;
+    m_lastReportedDrops = 0;
+    m_ptsBase = GST_CLOCK_TIME_NONE;
+    m_nextPts = 0;
+    m_ptsRebasePending = false;
+    m_frameRecordingPaused = false;
+    if (liveCaps) {
+        applyEncoderCaps(liveCaps);
+    }
 
-    qCDebug(log_gst_recording) << "Starting FFmpeg with args:" << args.join(' ');
-    m_recordingProcess->start("ffmpeg", args);
-    if (!m_recordingProcess->waitForStarted(5000)) {
-        qCCritical(log_gst_recording) << "Failed to start FFmpeg process:" << m_recordingProcess->errorString();
-        delete m_recordingProcess;
-        m_recordingProcess = nullptr;
+    if (gst_element_set_state(m_encoderPipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        qCWarning(log_gst_recording) << "Encoder pipeline refused to start:" << description;
+        stopFrameEncoder();
         return false;
     }
 
-    qCInfo(log_gst_recording) << "Initialized appsink-based recording";
+    qCDebug(log_gst_recording) << "Encoder pipeline:" << description;
     return true;
 }
 
-#ifdef HAVE_GSTREAMER
+void RecordingManager::applyEncoderCaps(GstCaps* caps)
+{
+    if (!m_recordingAppSrc || !caps) {
+        return;
+    }
+
+    if (m_appSrcCaps) gst_caps_unref(m_appSrcCaps);
+    m_appSrcCaps = gst_caps_ref(caps);
+    gst_app_src_set_caps(GST_APP_SRC(m_recordingAppSrc), caps);
+
+    // Allow a fixed number of frames in front of the encoder; beyond that frames are
+    // dropped here so the backlog, and the memory it pins, stays bounded
+    GstVideoInfo info;
+    quint64 frameBytes = 0;
+    if (gst_video_info_from_caps(&info, caps)) {
+        frameBytes = GST_VIDEO_INFO_SIZE(&info);
+    }
+    const quint64 limit = frameBytes > 0 ? frameBytes * kEncoderBacklogFrames : kEncoderBacklogFallbackBytes;
+    g_object_set(m_recordingAppSrc, "max-bytes", (guint64)limit, NULL);
+    m_backlogLimitBytes = limit;
+
+    gchar* capsString = gst_caps_to_string(caps);
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_negotiatedCaps = QString::fromUtf8(capsString);
+    }
+    qCInfo(log_gst_recording) << "Recording caps negotiated with the live pipeline:" << capsString;
+    g_free(capsString);
+}
+
 GstFlowReturn RecordingManager::onNewRecordingSample(GstAppSink* sink)
 {
     if (!sink) return GST_FLOW_OK;
@@ -381,29 +694,103 @@ GstFlowReturn RecordingManager::onNewRecordingSample(GstAppSink* sink)
     GstSample* sample = gst_app_sink_pull_sample(sink);
     if (!sample) return GST_FLOW_OK;
 
+    m_framesReceived.fetch_add(1, std::memory_order_relaxed);
     GstBuffer* buffer = gst_sample_get_buffer(sample);
-    if (!buffer) {
+    if (!buffer || !m_recordingAppSrc || m_frameRecordingPaused.load(std::memory_order_relaxed)) {
+        gst_sample_unref(sample);
+        return GST_FLOW_OK;
+    }
+
+    GstCaps* caps = gst_sample_get_caps(sample);
+    if (caps && (!m_appSrcCaps || !gst_caps_is_equal(caps, m_appSrcCaps))) {
+        applyEncoderCaps(caps);
+    }
+
+    GstAppSrc* appSrc = GST_APP_SRC(m_recordingAppSrc);
+    const quint64 backlogLimit = m_backlogLimitBytes.load(std::memory_order_relaxed);
+    if (backlogLimit > 0 && gst_app_src_get_current_level_bytes(appSrc) >= backlogLimit) {
+        m_framesDropped.fetch_add(1, std::memory_order_relaxed);
         gst_sample_unref(sample);
         return GST_FLOW_OK;
     }
 
-    GstMapInfo map;
-    if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
-        if (m_recordingProcess && m_recordingProcess->state() == QProcess::Running) {
-            qint64 written = m_recordingProcess->write(reinterpret_cast<const char*>(map.data), static_cast<qint64>(map.size));
-            Q_UNUSED(written);
+    // The buffer is shared with the display branch, so retiming it needs a writable
+    // handle; that copies the metadata only and keeps referencing the same memory
+    GstBuffer* out = gst_buffer_make_writable(gst_buffer_ref(buffer));
+    const GstClockTime pts = GST_BUFFER_PTS(out);
+    if (GST_CLOCK_TIME_IS_VALID(pts)) {
+        // Start at zero, and after a pause continue right after the last frame written
+        if (!GST_CLOCK_TIME_IS_VALID(m_ptsBase) || m_ptsRebasePending.exchange(false)) {
+            m_ptsBase = pts >= m_nextPts ? pts - m_nextPts : 0;
         }
-        gst_buffer_unmap(buffer, &map);
+        const GstClockTime outPts = pts >= m_ptsBase ? pts - m_ptsBase : 0;
+        GST_BUFFER_PTS(out) = outPts;
+        GST_BUFFER_DTS(out) = GST_CLOCK_TIME_NONE;
+        m_nextPts = outPts + (GST_BUFFER_DURATION_IS_VALID(out) ? GST_BUFFER_DURATION(out) : 0);
+    }
+
+    // gst_app_src_push_buffer takes ownership of out
+    if (gst_app_src_push_buffer(appSrc, out) == GST_FLOW_OK) {
+        m_framesPushed.fetch_add(1, std::memory_order_relaxed);
+        ++m_recordingFrameNumber;
+    } else {
+        m_framesDropped.fetch_add(1, std::memory_order_relaxed);
     }
 
     gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
 
-    // Basic frame counting / throttling if needed
-    ++m_recordingFrameNumber;
+void RecordingManager::stopFrameEncoder()
+{
+    if (m_encoderMonitorTimer) {
+        m_encoderMonitorTimer->stop();
+    }
+    if (!m_encoderPipeline) {
+        return;
+    }
 
-    return GST_FLOW_OK;
+    // Drain the encoder so the muxer writes its index/trailer
+    if (m_recordingAppSrc) {
+        gst_app_src_end_of_stream(GST_APP_SRC(m_recordingAppSrc));
+        GstBus* bus = gst_element_get_bus(m_encoderPipeline);
+        GstMessage* message = gst_bus_timed_pop_filtered(bus, kFinalizeTimeoutMs * GST_MSECOND,
+                                                         GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+        if (!message) {
+            qCWarning(log_gst_recording) << "Encoder did not finish within" << kFinalizeTimeoutMs << "ms";
+        } else {
+            if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR) {
+                GError* error = nullptr;
+                gst_message_parse_error(message, &error, nullptr);
+                qCWarning(log_gst_recording) << "Encoder failed while finishing:" << (error ? error->message : "unknown error");
+                if (error) g_error_free(error);
+            }
+            gst_message_unref(message);
+        }
+        gst_object_unref(bus);
+    }
+
+    const GstRecordingStats stats = getRecordingStats();
+    qCInfo(log_gst_recording) << "Frame-based recording finished:" << stats.framesPushed << "frames encoded,"
+                              << stats.framesDropped << "dropped at the encoder," << stats.queueOverruns << "queue overruns";
+
+    gst_element_set_state(m_encoderPipeline, GST_STATE_NULL);
+    if (m_recordingAppSrc) {
+        gst_object_unref(m_recordingAppSrc);
+        m_recordingAppSrc = nullptr;
+    }
+    gst_object_unref(m_encoderPipeline);
+    m_encoderPipeline = nullptr;
+    if (m_appSrcCaps) {
+        gst_caps_unref(m_appSrcCaps);
+        m_appSrcCaps = nullptr;
+    }
+    m_backlogLimitBytes = 0;
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_negotiatedCaps.clear();
+    }
 }
-#endif
 
 bool RecordingManager::initializeDirectFilesinkRecording(const QString& outputPath, const QString& format)
 {
@@ -504,54 +891,35 @@ bool RecordingManager::initializeDirectFilesinkRecording(const QString& outputPa
     return true;
 }
 
-void RecordingManager::handleRecordingProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void RecordingManager::pollFrameEncoder()
 {
-    Q_UNUSED(exitStatus)
-    qCDebug(log_gst_recording) << "RecordingManager: recording process finished with code" << exitCode;
-    if (exitCode != 0) {
-        emit recordingError(QString("Recording process finished with error code: %1").arg(exitCode));
+    if (!m_encoderPipeline) {
+        return;
     }
 
-    if (m_recordingProcess) {
-        m_recordingProcess->deleteLater();
-        m_recordingProcess = nullptr;
+    GstBus* bus = gst_element_get_bus(m_encoderPipeline);
+    while (GstMessage* message = gst_bus_pop_filtered(bus, GstMessageType(GST_MESSAGE_ERROR | GST_MESSAGE_WARNING))) {
+        GError* error = nullptr;
+        if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR) {
+            gst_message_parse_error(message, &error, nullptr);
+            const QString text = QString("Recording encoder error: %1").arg(error ? error->message : "unknown error");
+            qCCritical(log_gst_recording) << text;
+            emit recordingError(text);
+        } else {
+            gst_message_parse_warning(message, &error, nullptr);
+            qCWarning(log_gst_recording) << "Recording encoder warning:" << (error ? error->message : "unknown warning");
+        }
+        if (error) g_error_free(error);
+        gst_message_unref(message);
     }
-
-    m_recordingActive = false;
-    emit recordingStopped();
-}
-
-void RecordingManager::handleRecordingProcessError(QProcess::ProcessError error)
-{
-    QString errorString;
-    switch (error) {
-        case QProcess::FailedToStart:
-            errorString = "Failed to start recording process";
-            break;
-        case QProcess::Crashed:
-            errorString = "Recording process crashed";
-            break;
-        case QProcess::Timedout:
-            errorString = "Recording process timed out";
-            break;
-        case QProcess::WriteError:
-            errorString = "Write error in recording process";
-            break;
-        case QProcess::ReadError:
-            errorString = "Read error in recording process";
-            break;
-        default:
-            errorString = "Unknown recording process error";
-            break;
-    }
-
-    qCCritical(log_gst_recording) << "Recording process error:" << errorString;
-    emit recordingError(errorString);
-
-    m_recordingActive = false;
-    if (m_recordingProcess) {
-        m_recordingProcess->deleteLater();
-        m_recordingProcess = nullptr;
+    gst_object_unref(bus);
+
+    // Report the encoder falling behind once per interval, not once per frame
+    const GstRecordingStats stats = getRecordingStats();
+    if (stats.framesDropped > m_lastReportedDrops) {
+        qCWarning(log_gst_recording) << "Recording encoder falling behind:" << stats.framesDropped - m_lastReportedDrops
+                                     << "frames dropped, backlog" << stats.backlogBytes << "/" << stats.backlogLimitBytes << "bytes";
+        m_lastReportedDrops = stats.framesDropped;
     }
 }
 
@@ -571,6 +939,8 @@ bool RecordingManager::stopRecording()
 #else
     // Nothing to do for external process recording in this manager
 #endif
+    // The last segment's file is closed now, so its final size goes into the index
+    endSegments();
 
     m_recordingActive = false;
     m_recordingPaused = false;
@@ -595,6 +965,7 @@ void RecordingManager::pauseRecording()
         qCDebug(log_gst_recording) << "Recording valve closed for pause";
     }
 #endif
+    m_frameRecordingPaused = true;
 
     m_recordingPaused = true;
     m_recordingPausedTime = QDateTime::currentMSecsSinceEpoch();
@@ -615,6 +986,8 @@ void RecordingManager::resumeRecording()
         qCDebug(log_gst_recording) << "Recording valve opened for resume";
     }
 #endif
+    m_ptsRebasePending = true;
+    m_frameRecordingPaused = false;
 
     if (m_recordingPausedTime > 0) {
         m_totalPausedDuration += QDateTime::currentMSecsSinceEpoch() - m_recordingPausedTime;
@@ -648,11 +1021,64 @@ qint64 RecordingManager::getRecordingDuration() const
 
 void RecordingManager::setRecordingConfig(const QString& codec, const QString& format, int bitrate)
 {
-    Q_UNUSED(codec)
-    Q_UNUSED(format)
+    m_recordingCodec = codec;
+    m_recordingFormat = format;
     m_recordingVideoBitrate = bitrate;
 }
 
+void RecordingManager::setSegmentPolicy(const SegmentPolicy& policy)
+{
+    m_segmentPolicy = policy;
+    // filesink truncates on open, which would release the reservation again
+    m_segmentPolicy.preallocateBytes = 0;
+}
+
+bool RecordingManager::beginSegments(const QString& outputPath)
+{
+    m_segmenter.reset();
+    if (!m_segmentPolicy.isSegmented()) {
+        return true;
+    }
+    m_segmenter = std::make_unique<RecordingSegmenter>();
+    QString error;
+    if (!m_segmenter->begin(outputPath, m_segmentPolicy, &error)) {
+        qCWarning(log_gst_recording) << "Cannot start segmented recording:" << error;
+        m_segmenter.reset();
+        return false;
+    }
+    return true;
+}
+
+void RecordingManager::endSegments()
+{
+    if (m_segmenter) {
+        m_segmenter->closeSegment(QDateTime::currentMSecsSinceEpoch());
+        m_segmenter.reset();
+    }
+}
+
+GstRecordingStats RecordingManager::getRecordingStats() const
+{
+    GstRecordingStats stats;
+#ifdef HAVE_GSTREAMER
+    if (!m_encoderPipeline) {
+        return stats;
+    }
+    stats.active = true;
+    stats.framesReceived = m_framesReceived.load(std::memory_order_relaxed);
+    stats.framesPushed = m_framesPushed.load(std::memory_order_relaxed);
+    stats.framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+    stats.queueOverruns = m_queueOverruns.load(std::memory_order_relaxed);
+    stats.backlogLimitBytes = m_backlogLimitBytes.load(std::memory_order_relaxed);
+    if (m_recordingAppSrc) {
+        stats.backlogBytes = gst_app_src_get_current_level_bytes(GST_APP_SRC(m_recordingAppSrc));
+    }
+    QMutexLocker locker(&m_statsMutex);
+    stats.caps = m_negotiatedCaps;
+#endif
+    return stats;
+}
+
 bool RecordingManager::createRecordingBranch(const QString& outputPath, const QString& /*format*/, int /*videoBitrate*/)
 {
 #ifdef HAVE_GSTREAMER
@@ -789,14 +1215,35 @@ void RecordingManager::removeRecordingBranch()
         m_recordingTeeSrcPad = nullptr;
     }
 
+    finalizeRecordingBranch();
+
     // Safely set elements to NULL state and remove
+    if (m_recordingSplitMux) {
+        gst_element_set_state(m_recordingSplitMux, GST_STATE_NULL);
+        gst_bin_remove(GST_BIN(m_mainPipeline), m_recordingSplitMux);
+        gst_object_unref(m_recordingSplitMux);
+        m_recordingSplitMux = nullptr;
+    }
+
+    // Muxer and sink are children of splitmuxsink when segmenting; drop only our references then
     if (m_recordingFileSink) {
         gst_element_set_state(m_recordingFileSink, GST_STATE_NULL);
-        gst_bin_remove(GST_BIN(m_mainPipeline), m_recordingFileSink);
+        if (GST_OBJECT_PARENT(m_recordingFileSink) == GST_OBJECT(m_mainPipeline)) {
+            gst_bin_remove(GST_BIN(m_mainPipeline), m_recordingFileSink);
+        }
         gst_object_unref(m_recordingFileSink);
         m_recordingFileSink = nullptr;
     }
 
+    if (m_recordingMuxer) {
+        gst_element_set_state(m_recordingMuxer, GST_STATE_NULL);
+        if (GST_OBJECT_PARENT(m_recordingMuxer) == GST_OBJECT(m_mainPipeline)) {
+            gst_bin_remove(GST_BIN(m_mainPipeline), m_recordingMuxer);
+        }
+        gst_object_unref(m_recordingMuxer);
+        m_recordingMuxer = nullptr;
+    }
+
     if (m_recordingEncoder) {
         gst_element_set_state(m_recordingEncoder, GST_STATE_NULL);
         gst_bin_remove(GST_BIN(m_mainPipeline), m_recordingEncoder);
@@ -804,6 +1251,13 @@ void RecordingManager::removeRecordingBranch()
         m_recordingEncoder = nullptr;
     }
 
+    if (m_recordingAppSink) {
+        gst_element_set_state(m_recordingAppSink, GST_STATE_NULL);
+        gst_bin_remove(GST_BIN(m_mainPipeline), m_recordingAppSink);
+        gst_object_unref(m_recordingAppSink);
+        m_recordingAppSink = nullptr;
+    }
+
     if (m_recordingQueue) {
         gst_element_set_state(m_recordingQueue, GST_STATE_NULL);
         gst_bin_remove(GST_BIN(m_mainPipeline), m_recordingQueue);
@@ -811,6 +1265,9 @@ void RecordingManager::removeRecordingBranch()
         m_recordingQueue = nullptr;
     }
 
+    // Nothing pushes into the encoder any more; let it drain
+    stopFrameEncoder();
+
     // Keep tee reference for reuse (if pipeline remains)
 
     qCDebug(log_gst_recording) << "Recording branch removed";
@@ -7,15 +7,31 @@
 #include <QObject>
 #include <QTimer>
 #include <QDateTime>
-#include <QProcess>
 #include <QFileInfo>
 #include <QDir>
+#include <QMutex>
+#include <atomic>
+#include <memory>
+
+#include "../../recordingsegmenter.h"
 
 #ifdef HAVE_GSTREAMER
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
 #endif
 
+// Counters for the appsink -> in-process encoder recording path
+struct GstRecordingStats {
+    bool active = false;             // Frame-based recording is running
+    QString caps;                    // Caps negotiated with the live pipeline
+    quint64 framesReceived = 0;      // Samples pulled from the recording appsink
+    quint64 framesPushed = 0;        // Handed to the encoder without copying
+    quint64 framesDropped = 0;       // Refused because the encoder backlog was full
+    quint64 queueOverruns = 0;       // recording-queue in the live pipeline overflowed
+    quint64 backlogBytes = 0;        // Waiting in front of the encoder
+    quint64 backlogLimitBytes = 0;
+};
+
 class RecordingManager : public QObject
 {
     Q_OBJECT
@@ -36,9 +52,15 @@ public:
 
     // Configure recording behavior
     void setRecordingConfig(const QString& codec, const QString& format, int bitrate);
+    // Splits JPEG passthrough and in-process encoder recordings into segments
+    // via splitmuxsink; the other branches always write a single file
+    void setSegmentPolicy(const SegmentPolicy& policy);
+
+    // Back-pressure and drop counters of frame-based recording; inactive otherwise
+    GstRecordingStats getRecordingStats() const;
 
 #ifdef HAVE_GSTREAMER
-    // Appsink callback used for frame-based recording (appsink -> ffmpeg)
+    // Appsink callback used for frame-based recording (appsink -> in-process encoder)
     GstFlowReturn onNewRecordingSample(GstAppSink* sink);
     // Exposed helpers that create separate recording branches (available only if GStreamer present)
     bool createSeparateRecordingPipeline(const QString& outputPath, const QString& format, int videoBitrate);
@@ -52,9 +74,8 @@ signals:
     void recordingResumed();
     void recordingError(const QString& error);
 
-public slots:
-    void handleRecordingProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void handleRecordingProcessError(QProcess::ProcessError error);
+private slots:
+    void pollFrameEncoder();
 
 private:
     // Internal state
@@ -86,12 +107,47 @@ private:
 
     // Helpers
     bool initializeValveBasedRecording(const QString& format);
-    bool initializeFrameBasedRecording(const QString& format);
+#ifdef HAVE_GSTREAMER
+    // Records the camera's compressed JPEG frames from the pre-decode tee without re-encoding
+    bool createJpegPassthroughBranch(const QString& outputPath, const QString& muxerName);
+    // Pushes EOS through a muxed branch so the container gets its index/trailer
+    void finalizeRecordingBranch();
+#endif
+    bool initializeFrameBasedRecording(const QString& outputPath, const QString& format, int videoBitrate);
     // Fallbacks and helpers for recording branch creation (internal)
-    // FFmpeg process and appsink integration for frame-based recording
-    QProcess* m_recordingProcess = nullptr;
-    QTimer* m_frameCaptureTimer = nullptr;
+#ifdef HAVE_GSTREAMER
+    // Frame-based recording: the appsink hands buffers to an appsrc that feeds an
+    // encoder pipeline of its own, so encoding never runs on the live streaming thread
+    bool createFrameEncoder(const QString& outputPath, const QString& format, int videoBitrate, GstCaps* liveCaps);
+    // splitmuxsink around muxer and fileSink that names each file through m_segmenter
+    GstElement* createSegmentingSink(GstElement* muxer, GstElement* fileSink, bool requestKeyframes);
+    void applyEncoderCaps(GstCaps* caps);
+    void stopFrameEncoder();
+
+    GstElement* m_encoderPipeline = nullptr;
+    GstElement* m_recordingAppSrc = nullptr;
+    GstCaps* m_appSrcCaps = nullptr;           // Streaming thread once linked
+    GstClockTime m_ptsBase = GST_CLOCK_TIME_NONE;
+    GstClockTime m_nextPts = 0;
+    GstElement* m_recordingSplitMux = nullptr;
+#endif
+    SegmentPolicy m_segmentPolicy;
+    std::unique_ptr<RecordingSegmenter> m_segmenter;   // Set while a segmented recording runs
+    bool beginSegments(const QString& outputPath);
+    void endSegments();
+    QTimer* m_encoderMonitorTimer = nullptr;
+    std::atomic<bool> m_frameRecordingPaused{false};
+    std::atomic<bool> m_ptsRebasePending{false};
+    std::atomic<quint64> m_framesReceived{0};
+    std::atomic<quint64> m_framesPushed{0};
+    std::atomic<quint64> m_framesDropped{0};
+    std::atomic<quint64> m_queueOverruns{0};
+    std::atomic<quint64> m_backlogLimitBytes{0};
+    quint64 m_lastReportedDrops = 0;
+    mutable QMutex m_statsMutex;
+    QString m_negotiatedCaps;
     QString m_recordingFormat;
+    QString m_recordingCodec;
     bool createRecordingBranch(const QString& outputPath, const QString& format, int videoBitrate);
     void removeRecordingBranch();
     QString computeAdjustedOutputPath(const QString& outputPath, bool directMJPEG);
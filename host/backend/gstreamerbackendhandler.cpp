@@ -61,7 +61,10 @@
 #include "gstreamer/externalgstrunner.h"
 #include "gstreamer/recordingmanager.h"
 
+#include "../framelatency.h"
+
 #include "log/opflogging.h"
+#include "log/startuptrace.h"
 
 // logging category for this translation unit
 OPF_LOGGING_CATEGORY(log_gstreamer_backend, "opf.backend.gstreamer")
@@ -117,6 +120,28 @@ GstPadProbeReturn GStreamerBackendHandler::gstreamer_frame_probe_cb(GstPad* pad,
     }
     return GST_PAD_PROBE_OK;
 }
+
+// Pad probe stamping a frame latency stage; user_data carries the stage
+GstPadProbeReturn GStreamerBackendHandler::gstreamer_latency_probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+    FrameLatencyTracker& latency = FrameLatencyTracker::instance();
+    if (!latency.isEnabled() || !(info->type & GST_PAD_PROBE_TYPE_BUFFER)) return GST_PAD_PROBE_OK;
+
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!buffer || !GST_BUFFER_PTS_IS_VALID(buffer)) return GST_PAD_PROBE_OK;
+
+    // The PTS passes through decode, convert and scale unchanged, so it
+    // identifies the frame at every stage (+1: a PTS of 0 is a real frame)
+    const quint64 key = GST_BUFFER_PTS(buffer) + 1;
+    const auto stage = static_cast<FrameLatencyTracker::Stage>(GPOINTER_TO_INT(user_data));
+    latency.stamp(key, stage);
+    if (stage == FrameLatencyTracker::Received) {
+        // The sink draws outside Qt; handing it the buffer is the last point we can observe
+        latency.finish(key);
+    }
+    return GST_PAD_PROBE_OK;
+}
 #endif
 
 GStreamerBackendHandler::GStreamerBackendHandler(QObject *parent)
@@ -554,6 +579,7 @@ bool GStreamerBackendHandler::startDirectPipeline()
 
 bool GStreamerBackendHandler::startGStreamerPipeline()
 {
+    OPF_STARTUP_SPAN("GStreamerBackendHandler::startGStreamerPipeline", "camera");
     qCDebug(log_gstreamer_backend) << "Starting GStreamer pipeline";
 #ifdef HAVE_GSTREAMER
     // Build a list of candidate sinks and attempt to start the pipeline using each
@@ -1958,6 +1984,9 @@ void GStreamerBackendHandler::attachFrameProbe()
 {
     if (!m_pipeline) return;
 
+    // Latency probes sit on their own pads and do not depend on the FPS probe
+    attachLatencyProbes();
+
     // Ensure we don't attach twice
     if (m_frameProbePad && m_frameProbeId) return;
 
@@ -2007,6 +2036,7 @@ void GStreamerBackendHandler::attachFrameProbe()
 
 void GStreamerBackendHandler::detachFrameProbe()
 {
+    detachLatencyProbes();
     if (!m_frameProbePad) return;
     if (m_frameProbeId) {
         gst_pad_remove_probe(m_frameProbePad, m_frameProbeId);
@@ -2016,6 +2046,45 @@ void GStreamerBackendHandler::detachFrameProbe()
     m_frameProbePad = nullptr;
     qCDebug(log_gstreamer_backend) << "detachFrameProbe: pad probe removed";
 }
+
+void GStreamerBackendHandler::attachLatencyProbe(const char* elementName, const char* padName, int stage)
+{
+    GstElement* element = gst_bin_get_by_name(GST_BIN(m_pipeline), elementName);
+    if (!element) return;  // Not every pipeline variant has every stage
+    GstPad* pad = gst_element_get_static_pad(element, padName);
+    gst_object_unref(element);
+    if (!pad) return;
+
+    const gulong id = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER,
+                                        (GstPadProbeCallback)GStreamerBackendHandler::gstreamer_latency_probe_cb,
+                                        GINT_TO_POINTER(stage), nullptr);
+    if (id == 0) {
+        gst_object_unref(pad);
+        return;
+    }
+    m_latencyProbes.append(LatencyProbe{pad, id});  // Keeps the pad reference
+}
+
+void GStreamerBackendHandler::attachLatencyProbes()
+{
+    if (!m_pipeline || !m_latencyProbes.isEmpty()) return;
+
+    FrameLatencyTracker::instance().setSource(QStringLiteral("GStreamer"));
+    attachLatencyProbe("video-source", "src", FrameLatencyTracker::Read);
+    attachLatencyProbe("video-decoder", "src", FrameLatencyTracker::Decoded);
+    attachLatencyProbe("display-queue", "sink", FrameLatencyTracker::Emitted);
+    attachLatencyProbe("videosink", "sink", FrameLatencyTracker::Received);
+    qCDebug(log_gstreamer_backend) << "attachLatencyProbes:" << m_latencyProbes.size() << "latency probes added";
+}
+
+void GStreamerBackendHandler::detachLatencyProbes()
+{
+    for (const LatencyProbe& probe : m_latencyProbes) {
+        gst_pad_remove_probe(probe.pad, probe.id);
+        gst_object_unref(probe.pad);
+    }
+    m_latencyProbes.clear();
+}
 #endif
 
 // No-op fallback if HAVE_GSTREAMER is not defined
@@ -2023,6 +2092,9 @@ void GStreamerBackendHandler::detachFrameProbe()
 void GStreamerBackendHandler::incrementFrameCount()
 {
     m_frameCount.fetch_add(1, std::memory_order_relaxed);
+    if (StartupTrace::isEnabled()) {
+        StartupTrace::instance().markFirstFrame("GStreamer sink");   // The sink renders it directly
+    }
 }
 #else
 void GStreamerBackendHandler::incrementFrameCount() { Q_UNUSED(this); }
@@ -2096,6 +2168,12 @@ void GStreamerBackendHandler::setRecordingConfig(const RecordingConfig& config)
     // Pass minimal fields to the recording manager; RecordingConfig is maintained here for API compatibility
     if (m_recordingManager) {
         m_recordingManager->setRecordingConfig(config.videoCodec, config.format, config.videoBitrate);
+
+        SegmentPolicy policy;
+        policy.segmentDurationMs = qMax(0, config.segmentDurationSec) * 1000LL;
+        policy.segmentSizeBytes = qMax<qint64>(0, config.segmentSizeBytes);
+        policy.retentionMs = qMax(0, config.retentionHours) * 3600LL * 1000;
+        m_recordingManager->setSegmentPolicy(policy);
     }
 }
 
@@ -2227,6 +2305,11 @@ bool GStreamerBackendHandler::supportsRecordingStats() const
     return true; // GStreamer backend supports recording statistics
 }
 
+GstRecordingStats GStreamerBackendHandler::getRecordingStats() const
+{
+    return m_recordingManager ? m_recordingManager->getRecordingStats() : GstRecordingStats();
+}
+
 qint64 GStreamerBackendHandler::getRecordingFileSize() const
 {
 #ifdef HAVE_GSTREAMER
@@ -2241,19 +2324,19 @@ qint64 GStreamerBackendHandler::getRecordingFileSize() const
 #endif
 }
 
-void GStreamerBackendHandler::takeImage(const QString& filePath)
+QImage GStreamerBackendHandler::grabFrame()
 {
 #ifdef HAVE_GSTREAMER
     if (!m_pipeline || !m_pipelineRunning) {
         qCWarning(log_gstreamer_backend) << "Pipeline is not running";
-        return;
+        return QImage();
     }
     
     // Create capture appsink if it doesn't exist
     if (!m_captureAppSink) {
         if (!createCaptureAppSink()) {
             qCWarning(log_gstreamer_backend) << "Failed to create capture appsink";
-            return;
+            return QImage();
         }
     }
     
@@ -2261,7 +2344,7 @@ void GStreamerBackendHandler::takeImage(const QString& filePath)
     GstSample* sample = getLatestSampleFromPipeline();
     if (!sample) {
         qCWarning(log_gstreamer_backend) << "Failed to get sample from pipeline";
-        return;
+        return QImage();
     }
     
     // Convert GStreamer sample to QImage
@@ -2270,6 +2353,18 @@ void GStreamerBackendHandler::takeImage(const QString& filePath)
     
     if (image.isNull()) {
         qCWarning(log_gstreamer_backend) << "Failed to convert GStreamer sample to QImage";
+    }
+    return image;
+#else
+    qCWarning(log_gstreamer_backend) << "GStreamer not compiled in";
+    return QImage();
+#endif
+}
+
+void GStreamerBackendHandler::takeImage(const QString& filePath)
+{
+    QImage image = grabFrame();
+    if (image.isNull()) {
         return;
     }
     
@@ -2280,40 +2375,12 @@ void GStreamerBackendHandler::takeImage(const QString& filePath)
     }
     
     qCDebug(log_gstreamer_backend) << "Image captured and saved to" << filePath;
-#else
-    qCWarning(log_gstreamer_backend) << "GStreamer not compiled in";
-#endif
 }
 
 void GStreamerBackendHandler::takeAreaImage(const QString& filePath, const QRect& captureArea)
 {
-#ifdef HAVE_GSTREAMER
-    if (!m_pipeline || !m_pipelineRunning) {
-        qCWarning(log_gstreamer_backend) << "Pipeline is not running";
-        return;
-    }
-    
-    // Create capture appsink if it doesn't exist
-    if (!m_captureAppSink) {
-        if (!createCaptureAppSink()) {
-            qCWarning(log_gstreamer_backend) << "Failed to create capture appsink";
-            return;
-        }
-    }
-    
-    // Get the latest sample from the pipeline
-    GstSample* sample = getLatestSampleFromPipeline();
-    if (!sample) {
-        qCWarning(log_gstreamer_backend) << "Failed to get sample from pipeline";
-        return;
-    }
-    
-    // Convert GStreamer sample to QImage
-    QImage fullImage = gstSampleToQImage(sample);
-    gst_sample_unref(sample);
-    
+    QImage fullImage = grabFrame();
     if (fullImage.isNull()) {
-        qCWarning(log_gstreamer_backend) << "Failed to convert GStreamer sample to QImage";
         return;
     }
     
@@ -2331,9 +2398,6 @@ void GStreamerBackendHandler::takeAreaImage(const QString& filePath, const QRect
     }
     
     qCDebug(log_gstreamer_backend) << "Area image captured and saved to" << filePath;
-#else
-    qCWarning(log_gstreamer_backend) << "GStreamer not compiled in";
-#endif
 }
 
 #ifdef HAVE_GSTREAMER
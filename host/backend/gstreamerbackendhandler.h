@@ -24,6 +24,7 @@
 #define GSTREAMERBACKENDHANDLER_H
 
 #include "../multimediabackend.h"
+#include "gstreamer/recordingmanager.h"
 #include <QProcess>
 #include <QWidget>
 #include <QEvent>
@@ -110,10 +111,13 @@ public:
     struct RecordingConfig {
         QString outputPath;
         QString format = "mp4";          // mp4, avi, mov, mkv
-        QString videoCodec = "x264enc";  // x264enc, x265enc, vp8enc, vp9enc
+        QString videoCodec = "x264enc";  // x264enc, x265enc, vp8enc, vp9enc; mjpeg muxes camera JPEG as-is (avi/mkv)
         int videoBitrate = 2000000;      // 2 Mbps default
         int videoQuality = 23;           // Quality setting
         bool useHardwareAcceleration = false;
+        int segmentDurationSec = 0;      // New file this often; 0 writes a single file
+        qint64 segmentSizeBytes = 0;     // ...or once the current file reaches this size
+        int retentionHours = 0;          // Delete segments older than this; 0 keeps all
     };
 
     // Video recording methods
@@ -127,6 +131,7 @@ public:
     qint64 getRecordingDuration() const override;
     
     // Image capture methods
+    QImage grabFrame();  // Latest frame in memory; null when the pipeline is not running
     void takeImage(const QString& filePath);
     void takeAreaImage(const QString& filePath, const QRect& captureArea);
     
@@ -139,6 +144,7 @@ public:
     
     // Recording statistics
     bool supportsRecordingStats() const;
+    GstRecordingStats getRecordingStats() const;  // Frame-based recording back-pressure and drops
     qint64 getRecordingFileSize() const;
     
     void setRecordingConfig(const RecordingConfig& config);
@@ -318,6 +324,17 @@ private:
     guint m_frameProbeId{0};
     // GstPad probe callback (static so it can be passed to C API without instance)
     static GstPadProbeReturn gstreamer_frame_probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+
+    // Frame latency probes, one per observable FrameLatencyTracker stage
+    struct LatencyProbe {
+        GstPad* pad;
+        gulong id;
+    };
+    QList<LatencyProbe> m_latencyProbes;
+    static GstPadProbeReturn gstreamer_latency_probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    void attachLatencyProbe(const char* elementName, const char* padName, int stage);
+    void attachLatencyProbes();
+    void detachLatencyProbes();
 #endif
 
     // Add helpers to manage frame probe
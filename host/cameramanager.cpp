@@ -25,6 +25,7 @@
 #include <QRegularExpression>
 #include <QDateTime>
 #include "global.h"
+#include "log/startuptrace.h"
 #include "../ui/globalsetting.h"
 #include "../device/DeviceManager.h"
 #include "../device/HotplugMonitor.h"
@@ -98,12 +99,33 @@ bool CameraManager::isMediaFoundationBackend() const
 }
 #endif
 
-QImage CameraManager::getLatestOriginalFrame() const
+VideoFrameHandle CameraManager::getLatestFrame() const
 {
-    if (FFmpegBackendHandler* ffmpeg = getFFmpegBackend()) {
-        return ffmpeg->getLatestOriginalFrame();
+#ifndef Q_OS_WIN
+    // GStreamer renders straight into its sink and publishes nothing per
+    // frame, so grab one sample on demand and share it through the bus. A
+    // sample showing what the bus already holds is not a new frame: hand
+    // back the frame on the bus so its sequence stays put.
+    if (GStreamerBackendHandler* gstreamer = getGStreamerBackend()) {
+        QImage frame = gstreamer->grabFrame();
+        if (frame.isNull()) {
+            return VideoFrameHandle();
+        }
+        VideoFrameHandle latest = FrameBus::instance().latestFrame();
+        if (latest && latest->image() == frame) {
+            return latest;
+        }
+        return FrameBus::instance().publish(frame, QDateTime::currentMSecsSinceEpoch());
     }
-    return QImage();
+#endif
+    // The FFmpeg backend publishes every decoded frame
+    return FrameBus::instance().latestFrame();
+}
+
+QImage CameraManager::getLatestOriginalFrame() const
+{
+    VideoFrameHandle frame = getLatestFrame();
+    return frame ? frame->image() : QImage();
 }
 
 FFmpegBackendHandler* CameraManager::getFFmpegBackend() const
@@ -169,6 +191,8 @@ void CameraManager::initializeBackendHandler()
             // Connect fpsChanged signal from backend to CameraManager
             connect(m_backendHandler.get(), &MultimediaBackendHandler::fpsChanged,
                     this, &CameraManager::fpsChanged);
+            connect(m_backendHandler.get(), &MultimediaBackendHandler::decodeStateChanged,
+                    this, &CameraManager::decodeStateChanged);
             
             // Connect FFmpeg-specific signals if this is an FFmpeg backend
             if (auto ffmpegHandler = qobject_cast<FFmpegBackendHandler*>(m_backendHandler.get())) {
@@ -293,6 +317,7 @@ void CameraManager::setVideoOutput(QGraphicsVideoItem* videoOutput)
 
 void CameraManager::startCamera()
 {
+    OPF_STARTUP_SPAN("CameraManager::startCamera", "camera");
     qCDebug(log_ui_camera) << "Starting camera with multimedia backend";
     
     try {
@@ -828,6 +853,7 @@ QCameraDevice CameraManager::getCurrentCameraDevice() const
 
 bool CameraManager::switchToCameraDevice(const QCameraDevice &cameraDevice, const QString& portChain)
 {
+    OPF_STARTUP_SPAN("CameraManager::switchToCameraDevice", "camera");
     if (!isCameraDeviceValid(cameraDevice)) {
         qCWarning(log_ui_camera) << "Cannot switch to invalid camera device:" << cameraDevice.description();
         return false;
@@ -1391,7 +1417,7 @@ bool CameraManager::initializeCameraWithVideoOutput(QGraphicsVideoItem* videoOut
 
 bool CameraManager::initializeCameraWithVideoOutput(VideoPane* videoPane, bool startCapture)
 {
-    
+    OPF_STARTUP_SPAN("CameraManager::initializeCameraWithVideoOutput", "camera");
     if (!videoPane) {
         qCWarning(log_ui_camera) << "Cannot initialize camera with null VideoPane";
         return false;
@@ -11,6 +11,7 @@
 #include <QSize>
 #include <QVideoFrameFormat>
 #include "host/multimediabackend.h"
+#include "host/framebus.h"
 #include "../device/DeviceInfo.h"
 #include <QLoggingCategory>
 
@@ -71,6 +72,10 @@ public:
     GStreamerBackendHandler* getGStreamerBackend() const;
     MultimediaBackendHandler* getBackendHandler() const;
 
+    // Latest frame as published on the FrameBus (see host/framebus.h); null
+    // when no frame is available. Carries the camera JPEG for MJPEG sources.
+    VideoFrameHandle getLatestFrame() const;
+
     // Returns the latest camera frame at native (unscaled) resolution.
     QImage getLatestOriginalFrame() const;
     
@@ -137,6 +142,7 @@ signals:
     void availableCameraDevicesChanged(int deviceCount);
     void newDeviceAutoConnected(const QCameraDevice& device, const QString& portChain);
     void fpsChanged(double fps);
+    void decodeStateChanged(const QString& state);
     
 public slots:
     // Note: Automatic device coordination slots have been removed
@@ -0,0 +1,285 @@
+#include "framebus.h"
+#include <QMutexLocker>
+#include <QMetaObject>
+#include <QBuffer>
+#include <QLoggingCategory>
+
+#include "log/opflogging.h"
+OPF_LOGGING_CATEGORY(log_frame_bus, "opf.host.framebus")
+
+// Conversions are cheap to keep for one frame but there is no reason to grow
+// without bound if a caller asks for many different sizes.
+static constexpr int kMaxCachedVariants = 4;
+
+VideoFrame::VideoFrame(quint64 sequence, qint64 captureTimeMs, const QImage& image,
+                       const QByteArray& mjpeg, const QSize& mjpegSize, quint64 contentSequence)
+    : m_sequence(sequence)
+    , m_contentSequence(contentSequence > 0 ? contentSequence : sequence)
+    , m_captureTimeMs(captureTimeMs)
+    , m_image(image)
+    , m_mjpeg(mjpeg)
+    , m_mjpegSize(mjpeg.isEmpty() ? QSize() : (mjpegSize.isValid() ? mjpegSize : image.size()))
+{
+}
+
+QByteArray VideoFrame::jpeg() const
+{
+    if (hasMjpeg()) {
+        return m_mjpeg;  // Already a JPEG: serving it is a reference, not an encode
+    }
+    if (m_image.isNull()) {
+        return QByteArray();
+    }
+
+    QMutexLocker locker(&m_cacheMutex);
+    if (m_encodedJpeg.isEmpty()) {
+        QBuffer buffer(&m_encodedJpeg);
+        buffer.open(QIODevice::WriteOnly);
+        if (!m_image.save(&buffer, "JPEG", 90)) {
+            m_encodedJpeg.clear();
+        }
+    }
+    return m_encodedJpeg;
+}
+
+QImage VideoFrame::image(const QSize& size, QImage::Format format) const
+{
+    if (m_image.isNull()) {
+        return QImage();
+    }
+
+    const QImage::Format targetFormat = (format == QImage::Format_Invalid) ? m_image.format() : format;
+    QSize targetSize = m_image.size();
+    if (!size.isEmpty() && (size.width() < targetSize.width() || size.height() < targetSize.height())) {
+        targetSize = targetSize.scaled(size, Qt::KeepAspectRatio);  // Fit, never upscale
+    }
+
+    if (targetSize == m_image.size() && targetFormat == m_image.format()) {
+        return m_image;
+    }
+
+    // Hold the lock across the conversion: a second consumer asking for the
+    // same variant waits for it rather than converting the frame again.
+    QMutexLocker locker(&m_cacheMutex);
+    for (const Variant& variant : m_variants) {
+        if (variant.size == targetSize && variant.format == targetFormat) {
+            return variant.image;
+        }
+    }
+
+    QImage converted = m_image;
+    if (targetSize != converted.size()) {
+        converted = converted.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    if (converted.format() != targetFormat) {
+        converted = converted.convertToFormat(targetFormat);
+    }
+
+    if (static_cast<int>(m_variants.size()) >= kMaxCachedVariants) {
+        m_variants.erase(m_variants.begin());
+    }
+    m_variants.push_back(Variant{targetSize, targetFormat, converted});
+    return converted;
+}
+
+int VideoFrame::cachedVariantCount() const
+{
+    QMutexLocker locker(&m_cacheMutex);
+    return static_cast<int>(m_variants.size());
+}
+
+FrameBus& FrameBus::instance()
+{
+    static FrameBus bus;
+    return bus;
+}
+
+FrameBus::FrameBus(QObject* parent)
+    : QObject(parent)
+    , m_nextSubscriberId(1)
+    , m_nextSequence(1)
+    , m_staticFrames(0)
+{
+}
+
+VideoFrameHandle FrameBus::publish(const QImage& image, qint64 captureTimeMs,
+                                   const QByteArray& mjpeg, const QSize& mjpegSize,
+                                   bool contentChanged)
+{
+    if (image.isNull()) {
+        return VideoFrameHandle();
+    }
+
+    VideoFrameHandle frame;
+    std::vector<std::shared_ptr<Subscriber>> due;
+    {
+        QMutexLocker locker(&m_mutex);
+        // Identical content only carries over from a frame still on the bus
+        quint64 contentSequence = 0;
+        if (!contentChanged && m_latest && m_latest->size() == image.size()) {
+            contentSequence = m_latest->contentSequence();
+            m_staticFrames++;
+        }
+        frame = std::make_shared<const VideoFrame>(m_nextSequence++, captureTimeMs, image,
+                                                   mjpeg, mjpegSize, contentSequence);
+        m_latest = frame;
+
+        for (const auto& subscriber : m_subscribers) {
+            if (subscriber->request.maxFps > 0 && subscriber->lastDeliveryMs >= 0) {
+                const qint64 interval = 1000 / subscriber->request.maxFps;
+                if (captureTimeMs - subscriber->lastDeliveryMs < interval) {
+                    continue;
+                }
+            }
+            subscriber->lastDeliveryMs = captureTimeMs;
+            due.push_back(subscriber);
+        }
+    }
+
+    for (const auto& subscriber : due) {
+        dispatch(subscriber, frame);
+    }
+
+    emit framePublished(frame->sequence());
+    return frame;
+}
+
+void FrameBus::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_latest.reset();
+}
+
+VideoFrameHandle FrameBus::latestFrame() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_latest;
+}
+
+QImage FrameBus::latestImage(const QSize& size, QImage::Format format) const
+{
+    VideoFrameHandle frame = latestFrame();
+    return frame ? frame->image(size, format) : QImage();
+}
+
+int FrameBus::subscribe(const FrameRequest& request, QObject* receiver, FrameCallback callback)
+{
+    if (!callback) {
+        return 0;
+    }
+
+    auto subscriber = std::make_shared<Subscriber>();
+    subscriber->request = request;
+    subscriber->receiver = receiver;
+    subscriber->hasReceiver = (receiver != nullptr);
+    subscriber->callback = std::move(callback);
+
+    int id;
+    {
+        QMutexLocker locker(&m_mutex);
+        id = m_nextSubscriberId++;
+        subscriber->id = id;
+        m_subscribers.insert(id, subscriber);
+    }
+
+    if (receiver) {
+        connect(receiver, &QObject::destroyed, this, [this, id]() { unsubscribe(id); },
+                Qt::DirectConnection);
+    }
+
+    qCDebug(log_frame_bus) << "Subscriber" << id << "added, size:" << request.size
+                           << "format:" << request.format << "max fps:" << request.maxFps;
+    return id;
+}
+
+void FrameBus::unsubscribe(int id)
+{
+    std::shared_ptr<Subscriber> subscriber;
+    {
+        QMutexLocker locker(&m_mutex);
+        subscriber = m_subscribers.take(id);
+    }
+    if (subscriber) {
+        // A delivery already queued to the receiver finds the mailbox empty
+        QMutexLocker mailbox(&subscriber->mailboxMutex);
+        subscriber->pending.reset();
+        subscriber->callback = nullptr;
+        qCDebug(log_frame_bus) << "Subscriber" << id << "removed";
+    }
+}
+
+int FrameBus::subscriberCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_subscribers.size();
+}
+
+quint64 FrameBus::publishedFrameCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_nextSequence - 1;
+}
+
+quint64 FrameBus::staticFrameCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_staticFrames;
+}
+
+double FrameBus::staticFrameRatio() const
+{
+    QMutexLocker locker(&m_mutex);
+    const quint64 published = m_nextSequence - 1;
+    return published > 0 ? static_cast<double>(m_staticFrames) / published : 0.0;
+}
+
+void FrameBus::dispatch(const std::shared_ptr<Subscriber>& subscriber, const VideoFrameHandle& frame)
+{
+    if (!subscriber->hasReceiver) {
+        FrameCallback callback;
+        {
+            QMutexLocker mailbox(&subscriber->mailboxMutex);
+            callback = subscriber->callback;
+        }
+        if (callback) {
+            callback(frame, frame->image(subscriber->request));
+        }
+        return;
+    }
+
+    QObject* receiver = subscriber->receiver.data();
+    if (!receiver) {
+        return;
+    }
+
+    {
+        QMutexLocker mailbox(&subscriber->mailboxMutex);
+        subscriber->pending = frame;
+        if (subscriber->deliveryQueued) {
+            return;  // The queued delivery will pick up this newer frame
+        }
+        subscriber->deliveryQueued = true;
+    }
+
+    QMetaObject::invokeMethod(receiver, [subscriber]() { deliverPending(subscriber); },
+                              Qt::QueuedConnection);
+}
+
+void FrameBus::deliverPending(const std::shared_ptr<Subscriber>& subscriber)
+{
+    VideoFrameHandle frame;
+    FrameCallback callback;
+    {
+        QMutexLocker mailbox(&subscriber->mailboxMutex);
+        subscriber->deliveryQueued = false;
+        frame = std::move(subscriber->pending);
+        subscriber->pending.reset();
+        callback = subscriber->callback;
+    }
+
+    // Conversion happens here, in the receiver's thread, and lands in the
+    // frame's cache for any other subscriber with the same request.
+    if (frame && callback) {
+        callback(frame, frame->image(subscriber->request));
+    }
+}
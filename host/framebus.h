@@ -0,0 +1,180 @@
+#ifndef FRAMEBUS_H
+#define FRAMEBUS_H
+
+#include <QObject>
+#include <QImage>
+#include <QByteArray>
+#include <QMutex>
+#include <QSize>
+#include <QHash>
+#include <QPointer>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// What a subscriber wants to receive from the FrameBus.
+//   size    - bounding box, aspect ratio preserved, never upscaled; invalid = native size
+//   format  - pixel format; Format_Invalid = the decoder's native format
+//   maxFps  - delivery rate cap; 0 = every published frame
+struct FrameRequest {
+    QSize size;
+    QImage::Format format = QImage::Format_Invalid;
+    int maxFps = 0;
+};
+
+// One decoded capture frame, shared read-only between all consumers.
+//
+// The native image and the optional compressed source (the MJPEG packet the
+// image was decoded from) never change after publishing. Scaled or converted
+// variants are produced on first request and cached on the frame, so any
+// number of consumers asking for the same size/format share one conversion.
+class VideoFrame
+{
+public:
+    VideoFrame(quint64 sequence, qint64 captureTimeMs, const QImage& image,
+               const QByteArray& mjpeg = QByteArray(), const QSize& mjpegSize = QSize(),
+               quint64 contentSequence = 0);
+
+    quint64 sequence() const { return m_sequence; }
+    qint64 captureTimeMs() const { return m_captureTimeMs; }
+
+    // Sequence of the first frame in the run of identical frames this one
+    // belongs to; equal to sequence() when the content changed with it
+    quint64 contentSequence() const { return m_contentSequence; }
+
+    // True when frame `sequence` showed exactly what this frame shows, so a
+    // client that already has it needs nothing new
+    bool unchangedSince(quint64 sequence) const
+    {
+        return sequence >= m_contentSequence && sequence <= m_sequence;
+    }
+    QSize size() const { return m_image.size(); }
+
+    // Native-resolution decoded image (implicitly shared, no pixel copy)
+    QImage image() const { return m_image; }
+
+    // Source MJPEG bytes, empty when the publisher had none (e.g. raw formats).
+    // Always a standalone JPEG at the camera's native size, which can be larger
+    // than image() when the decoder used DCT downscaling.
+    bool hasMjpeg() const { return !m_mjpeg.isEmpty(); }
+    QByteArray mjpeg() const { return m_mjpeg; }
+    QSize mjpegSize() const { return m_mjpegSize; }
+
+    // Native-size JPEG of this frame: the camera's own bytes when available,
+    // otherwise image() encoded once at quality 90 and cached.
+    QByteArray jpeg() const;
+    QSize jpegSize() const { return hasMjpeg() ? m_mjpegSize : m_image.size(); }
+
+    // Image fitted into size and converted to format; thread-safe and cached.
+    QImage image(const QSize& size, QImage::Format format) const;
+    QImage image(const FrameRequest& request) const { return image(request.size, request.format); }
+
+    int cachedVariantCount() const;
+
+private:
+    struct Variant {
+        QSize size;
+        QImage::Format format;
+        QImage image;
+    };
+
+    const quint64 m_sequence;
+    const quint64 m_contentSequence;
+    const qint64 m_captureTimeMs;
+    const QImage m_image;
+    const QByteArray m_mjpeg;
+    const QSize m_mjpegSize;
+
+    mutable QMutex m_cacheMutex;
+    mutable std::vector<Variant> m_variants;
+    mutable QByteArray m_encodedJpeg;
+};
+
+using VideoFrameHandle = std::shared_ptr<const VideoFrame>;
+
+// Process-wide fan-out point for decoded capture frames.
+//
+// Video backends decode each frame once and publish it here; display-side
+// extras, screenshots, the TCP server and the MCP tools read from the bus
+// instead of asking the backend (or re-running a capture) themselves, and a
+// re-encoding recording subscribes to it. The display keeps its direct
+// hand-off: it needs per-frame dirty regions and region-decode composites,
+// which the bus does not carry.
+//
+// Two ways to consume:
+//   - pull: latestFrame() / latestImage() for on-demand requests;
+//   - push: subscribe() with a FrameRequest. Deliveries to a receiver are
+//     latest-wins: while one is still queued in the receiver's event loop a
+//     newer frame replaces it instead of queueing behind it, so a slow
+//     consumer never holds more than one frame or delays the others.
+class FrameBus : public QObject
+{
+    Q_OBJECT
+
+public:
+    using FrameCallback = std::function<void(const VideoFrameHandle& frame, const QImage& image)>;
+
+    static FrameBus& instance();
+
+    // Publishes a new frame (any thread). mjpeg may be empty.
+    // contentChanged = false marks a frame the publisher found identical to
+    // the previous one; it then inherits that frame's contentSequence().
+    VideoFrameHandle publish(const QImage& image, qint64 captureTimeMs,
+                             const QByteArray& mjpeg = QByteArray(),
+                             const QSize& mjpegSize = QSize(),
+                             bool contentChanged = true);
+
+    // Drops the latest frame, e.g. when capture stops or the device changes
+    void clear();
+
+    VideoFrameHandle latestFrame() const;
+    QImage latestImage(const QSize& size = QSize(),
+                       QImage::Format format = QImage::Format_Invalid) const;
+
+    // Registers a push consumer. With a receiver the callback runs in the
+    // receiver's thread and the subscription ends when it is destroyed;
+    // without one it runs synchronously on the publishing thread.
+    // Returns a subscription id for unsubscribe().
+    int subscribe(const FrameRequest& request, QObject* receiver, FrameCallback callback);
+    void unsubscribe(int id);
+    int subscriberCount() const;
+
+    quint64 publishedFrameCount() const;
+
+    // Frames published as identical to their predecessor, and their share
+    // of all published frames
+    quint64 staticFrameCount() const;
+    double staticFrameRatio() const;
+
+signals:
+    // Emitted on the publishing thread; cheap enough to connect queued
+    void framePublished(quint64 sequence);
+
+private:
+    explicit FrameBus(QObject* parent = nullptr);
+
+    struct Subscriber {
+        int id = 0;
+        FrameRequest request;
+        QPointer<QObject> receiver;
+        bool hasReceiver = false;
+        FrameCallback callback;
+        qint64 lastDeliveryMs = -1;
+
+        QMutex mailboxMutex;
+        VideoFrameHandle pending;   // Newest frame not yet handed to the receiver
+        bool deliveryQueued = false;
+    };
+
+    void dispatch(const std::shared_ptr<Subscriber>& subscriber, const VideoFrameHandle& frame);
+    static void deliverPending(const std::shared_ptr<Subscriber>& subscriber);
+
+    mutable QMutex m_mutex;
+    VideoFrameHandle m_latest;
+    QHash<int, std::shared_ptr<Subscriber>> m_subscribers;
+    int m_nextSubscriberId;
+    quint64 m_nextSequence;
+    quint64 m_staticFrames;
+};
+
+#endif // FRAMEBUS_H
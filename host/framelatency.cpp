@@ -0,0 +1,366 @@
+#include "framelatency.h"
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <QtMath>
+#include <algorithm>
+
+#include "log/opflogging.h"
+OPF_LOGGING_CATEGORY(log_frame_latency, "opf.host.framelatency")
+
+// Frames that never complete (dropped by backpressure, superseded before a
+// paint) are evicted oldest-first once this many are in flight.
+static constexpr int kMaxPendingFrames = 32;
+
+// Histogram layout: 50 us buckets up to 50 ms, 1 ms buckets up to 1 s, then
+// a single overflow bucket.
+static constexpr qint64 kFineBucketUs = 50;
+static constexpr int kFineBuckets = 1000;
+static constexpr qint64 kFineRangeUs = kFineBucketUs * kFineBuckets;
+static constexpr qint64 kCoarseBucketUs = 1000;
+static constexpr int kCoarseBuckets = 950;
+static constexpr int kBucketCount = kFineBuckets + kCoarseBuckets + 1;
+
+FrameLatencyTracker::Histogram::Histogram()
+    : buckets(kBucketCount, 0)
+{
+}
+
+void FrameLatencyTracker::Histogram::add(qint64 ns)
+{
+    ns = qMax<qint64>(0, ns);
+    const qint64 us = ns / 1000;
+    int index;
+    if (us < kFineRangeUs) {
+        index = static_cast<int>(us / kFineBucketUs);
+    } else {
+        index = kFineBuckets + static_cast<int>(qMin<qint64>((us - kFineRangeUs) / kCoarseBucketUs, kCoarseBuckets));
+    }
+    buckets[index]++;
+    count++;
+    totalNs += ns;
+    maxNs = qMax(maxNs, ns);
+}
+
+double FrameLatencyTracker::Histogram::percentileMs(double fraction) const
+{
+    if (count == 0) {
+        return 0.0;
+    }
+
+    const quint64 rank = qMax<quint64>(1, static_cast<quint64>(qCeil(fraction * count)));
+    const double maxMs = maxNs / 1e6;
+    quint64 seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i];
+        if (seen < rank) {
+            continue;
+        }
+        // Report the bucket midpoint, never more than the largest sample
+        double midMs;
+        if (i < kFineBuckets) {
+            midMs = (i + 0.5) * kFineBucketUs / 1000.0;
+        } else if (i < kFineBuckets + kCoarseBuckets) {
+            midMs = (kFineRangeUs + (i - kFineBuckets + 0.5) * kCoarseBucketUs) / 1000.0;
+        } else {
+            midMs = maxMs;
+        }
+        return qMin(midMs, maxMs);
+    }
+    return maxMs;
+}
+
+void FrameLatencyTracker::Histogram::clear()
+{
+    std::fill(buckets.begin(), buckets.end(), 0);
+    count = 0;
+    totalNs = 0;
+    maxNs = 0;
+}
+
+FrameLatencyTracker& FrameLatencyTracker::instance()
+{
+    static FrameLatencyTracker tracker;
+    return tracker;
+}
+
+FrameLatencyTracker::FrameLatencyTracker(QObject* parent)
+    : QObject(parent)
+    , m_enabled(false)
+    , m_framesCompleted(0)
+    , m_framesDropped(0)
+{
+}
+
+qint64 FrameLatencyTracker::now()
+{
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed();
+}
+
+QString FrameLatencyTracker::stageName(Stage stage)
+{
+    switch (stage) {
+    case Read:     return QStringLiteral("read");
+    case Decoded:  return QStringLiteral("decoded");
+    case Emitted:  return QStringLiteral("emitted");
+    case Received: return QStringLiteral("received");
+    case Painted:  return QStringLiteral("painted");
+    default:       return QString();
+    }
+}
+
+QString FrameLatencyTracker::intervalName(Interval interval)
+{
+    switch (interval) {
+    case DecodeInterval:   return QStringLiteral("decode");
+    case DeliveryInterval: return QStringLiteral("delivery");
+    case QueueInterval:    return QStringLiteral("queue");
+    case PresentInterval:  return QStringLiteral("present");
+    case TotalInterval:    return QStringLiteral("total");
+    default:               return QString();
+    }
+}
+
+void FrameLatencyTracker::setEnabled(bool enabled)
+{
+    if (m_enabled.exchange(enabled) == enabled) {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending.clear();  // Half-stamped frames would only show up as drops
+    }
+    qCInfo(log_frame_latency) << "Frame latency tracking" << (enabled ? "enabled" : "disabled");
+    emit enabledChanged(enabled);
+}
+
+void FrameLatencyTracker::setSource(const QString& source)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_source == source) {
+        return;
+    }
+    m_source = source;
+    resetLocked();
+    qCDebug(log_frame_latency) << "Latency source set to" << source;
+}
+
+QString FrameLatencyTracker::source() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_source;
+}
+
+void FrameLatencyTracker::stamp(quint64 key, Stage stage, qint64 timestampNs)
+{
+    if (!isEnabled() || key == 0 || stage < 0 || stage >= StageCount) {
+        return;
+    }
+    if (timestampNs < 0) {
+        timestampNs = now();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_pending.find(key);
+    if (it == m_pending.end()) {
+        if (m_pending.size() >= kMaxPendingFrames) {
+            evictOldestLocked();
+        }
+        Pending pending;
+        std::fill(std::begin(pending.stamps), std::end(pending.stamps), -1);
+        pending.firstNs = timestampNs;
+        it = m_pending.insert(key, pending);
+    }
+    it->stamps[stage] = timestampNs;
+    it->firstNs = qMin(it->firstNs, timestampNs);
+
+    if (stage == Painted) {
+        completeLocked(key);
+    }
+}
+
+void FrameLatencyTracker::finish(quint64 key)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    completeLocked(key);
+}
+
+void FrameLatencyTracker::completeLocked(quint64 key)
+{
+    auto it = m_pending.find(key);
+    if (it == m_pending.end()) {
+        return;
+    }
+    const Pending pending = it.value();
+    m_pending.erase(it);
+
+    qint64 first = -1;
+    qint64 previous = -1;
+    int stamped = 0;
+    for (int stage = 0; stage < StageCount; ++stage) {
+        const qint64 t = pending.stamps[stage];
+        if (t < 0) {
+            continue;
+        }
+        if (previous >= 0) {
+            // Interval n ends at stage n + 1; Read has none of its own
+            m_histograms[stage - 1].add(t - previous);
+        } else {
+            first = t;
+        }
+        previous = t;
+        ++stamped;
+    }
+
+    if (stamped < 2) {
+        return;  // Nothing was measured
+    }
+    m_histograms[TotalInterval].add(previous - first);
+    m_framesCompleted++;
+}
+
+void FrameLatencyTracker::evictOldestLocked()
+{
+    auto oldest = m_pending.begin();
+    for (auto it = m_pending.begin(); it != m_pending.end(); ++it) {
+        if (it->firstNs < oldest->firstNs) {
+            oldest = it;
+        }
+    }
+    if (oldest != m_pending.end()) {
+        m_pending.erase(oldest);
+        m_framesDropped++;
+    }
+}
+
+void FrameLatencyTracker::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    resetLocked();
+}
+
+void FrameLatencyTracker::resetLocked()
+{
+    m_pending.clear();
+    for (Histogram& histogram : m_histograms) {
+        histogram.clear();
+    }
+    m_framesCompleted = 0;
+    m_framesDropped = 0;
+}
+
+FrameLatencyTracker::Report FrameLatencyTracker::report() const
+{
+    QMutexLocker locker(&m_mutex);
+    Report result;
+    result.source = m_source;
+    result.framesCompleted = m_framesCompleted;
+    result.framesDropped = m_framesDropped;
+    for (int i = 0; i < IntervalCount; ++i) {
+        const Histogram& histogram = m_histograms[i];
+        IntervalStats stats;
+        stats.name = intervalName(static_cast<Interval>(i));
+        stats.count = histogram.count;
+        if (histogram.count > 0) {
+            stats.meanMs = histogram.totalNs / 1e6 / histogram.count;
+            stats.p50Ms = histogram.percentileMs(0.50);
+            stats.p95Ms = histogram.percentileMs(0.95);
+            stats.p99Ms = histogram.percentileMs(0.99);
+            stats.maxMs = histogram.maxNs / 1e6;
+        }
+        result.intervals.append(stats);
+    }
+    return result;
+}
+
+QString FrameLatencyTracker::summary() const
+{
+    const Report snapshot = report();
+
+    QStringList lines;
+    lines << QString("Latency (%1): %2 frames, %3 dropped")
+                 .arg(snapshot.source.isEmpty() ? QStringLiteral("no source") : snapshot.source)
+                 .arg(snapshot.framesCompleted)
+                 .arg(snapshot.framesDropped);
+    lines << QString("%1 %2 %3 %4")
+                 .arg(QStringLiteral("ms"), -9)
+                 .arg(QStringLiteral("p50"), 6)
+                 .arg(QStringLiteral("p95"), 6)
+                 .arg(QStringLiteral("p99"), 6);
+    for (const IntervalStats& stats : snapshot.intervals) {
+        if (stats.count == 0) {
+            continue;  // Stage not observable with this backend
+        }
+        lines << QString("%1 %2 %3 %4")
+                     .arg(stats.name, -9)
+                     .arg(stats.p50Ms, 6, 'f', 1)
+                     .arg(stats.p95Ms, 6, 'f', 1)
+                     .arg(stats.p99Ms, 6, 'f', 1);
+    }
+    return lines.join('\n');
+}
+
+QJsonObject FrameLatencyTracker::toJson() const
+{
+    const Report snapshot = report();
+
+    QJsonArray stages;
+    for (int stage = 0; stage < StageCount; ++stage) {
+        stages.append(stageName(static_cast<Stage>(stage)));
+    }
+
+    QJsonArray intervals;
+    for (const IntervalStats& stats : snapshot.intervals) {
+        QJsonObject interval;
+        interval["name"] = stats.name;
+        interval["count"] = static_cast<qint64>(stats.count);
+        interval["meanMs"] = stats.meanMs;
+        interval["p50Ms"] = stats.p50Ms;
+        interval["p95Ms"] = stats.p95Ms;
+        interval["p99Ms"] = stats.p99Ms;
+        interval["maxMs"] = stats.maxMs;
+        intervals.append(interval);
+    }
+
+    QJsonObject json;
+    json["source"] = snapshot.source;
+    json["exportedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    json["framesCompleted"] = static_cast<qint64>(snapshot.framesCompleted);
+    json["framesDropped"] = static_cast<qint64>(snapshot.framesDropped);
+    json["stages"] = stages;
+    json["intervals"] = intervals;
+    return json;
+}
+
+bool FrameLatencyTracker::exportToFile(const QString& path, QString* error) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    const QByteArray data = QJsonDocument(toJson()).toJson(QJsonDocument::Indented);
+    if (file.write(data) != data.size()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    qCInfo(log_frame_latency) << "Latency report written to" << path;
+    return true;
+}
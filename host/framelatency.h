@@ -0,0 +1,138 @@
+#ifndef FRAMELATENCY_H
+#define FRAMELATENCY_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <vector>
+
+// Motion-to-photon latency of the capture -> display path.
+//
+// Video backends and the VideoPane stamp each frame with a monotonic
+// timestamp as it passes the stages below. Frames are matched by a key the
+// stamping code chooses: QImage::cacheKey() for frames delivered to the
+// VideoPane as images, the buffer PTS inside a GStreamer pipeline. When a
+// frame completes, the time from each stamped stage to the next one and the
+// end-to-end total go into fixed-bucket histograms, so percentiles cover the
+// whole session at constant memory.
+//
+// A stage a backend cannot observe is simply not stamped; its time is
+// charged to the next stage that is. Stamping is a single atomic load while
+// the tracker is disabled (the default).
+class FrameLatencyTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Stage {
+        Read,       // Compressed frame read from the device
+        Decoded,    // Decoded (and converted) to a displayable image
+        Emitted,    // Handed to the display path
+        Received,   // Display path picked it up
+        Painted,    // First paint after it was received
+        StageCount
+    };
+
+    // One histogram per stage, holding the time spent reaching it from the
+    // previous stamped stage, plus the end-to-end total.
+    enum Interval {
+        DecodeInterval,
+        DeliveryInterval,
+        QueueInterval,
+        PresentInterval,
+        TotalInterval,
+        IntervalCount
+    };
+
+    struct IntervalStats {
+        QString name;
+        quint64 count = 0;
+        double meanMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    struct Report {
+        QString source;
+        quint64 framesCompleted = 0;
+        quint64 framesDropped = 0;   // Stamped but evicted before completing
+        QList<IntervalStats> intervals;
+    };
+
+    static FrameLatencyTracker& instance();
+
+    // Monotonic clock shared by every stage, in nanoseconds
+    static qint64 now();
+
+    static QString stageName(Stage stage);
+    static QString intervalName(Interval interval);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    // Names the backend producing the stamps. A different name starts a new
+    // session so numbers from two backends never mix.
+    void setSource(const QString& source);
+    QString source() const;
+
+    // Records that the frame identified by key reached stage (any thread).
+    // timestampNs < 0 means now(). Stamping Painted completes the frame.
+    void stamp(quint64 key, Stage stage, qint64 timestampNs = -1);
+
+    // Completes a frame whose last observable stage comes before Painted,
+    // e.g. one rendered by a sink outside Qt.
+    void finish(quint64 key);
+
+    void reset();
+
+    Report report() const;
+    QString summary() const;   // Multi-line text for on-screen display
+    QJsonObject toJson() const;
+    bool exportToFile(const QString& path, QString* error = nullptr) const;
+
+signals:
+    void enabledChanged(bool enabled);
+
+private:
+    explicit FrameLatencyTracker(QObject* parent = nullptr);
+
+    struct Pending {
+        qint64 stamps[StageCount];
+        qint64 firstNs = 0;
+    };
+
+    // Fine buckets cover the range that matters for interactive video; the
+    // coarse tail keeps stalls measurable without growing the table.
+    struct Histogram {
+        std::vector<quint64> buckets;
+        quint64 count = 0;
+        qint64 totalNs = 0;
+        qint64 maxNs = 0;
+
+        Histogram();
+        void add(qint64 ns);
+        double percentileMs(double fraction) const;
+        void clear();
+    };
+
+    void completeLocked(quint64 key);
+    void evictOldestLocked();
+    void resetLocked();
+
+    std::atomic<bool> m_enabled;
+
+    mutable QMutex m_mutex;
+    QString m_source;
+    QHash<quint64, Pending> m_pending;
+    Histogram m_histograms[IntervalCount];
+    quint64 m_framesCompleted;
+    quint64 m_framesDropped;
+};
+
+#endif // FRAMELATENCY_H
@@ -0,0 +1,408 @@
+#include "frametiming.h"
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <QTextStream>
+#include <QtMath>
+#include <algorithm>
+#include <limits>
+
+#include "log/opflogging.h"
+OPF_LOGGING_CATEGORY(log_frame_timing, "opf.host.frametiming")
+
+// Roughly four events per frame: a bit over a minute of history at 60 fps
+static constexpr size_t kRingCapacity = 16384;
+
+static FrameTimingRecorder::SeriesStats computeStats(std::vector<qint64>& values)
+{
+    FrameTimingRecorder::SeriesStats stats;
+    if (values.empty()) {
+        return stats;
+    }
+    std::sort(values.begin(), values.end());
+
+    const size_t n = values.size();
+    double sum = 0.0;
+    for (qint64 v : values) {
+        sum += v;
+    }
+    const double mean = sum / n;
+    double variance = 0.0;
+    for (qint64 v : values) {
+        variance += (v - mean) * (v - mean);
+    }
+
+    auto percentile = [&values, n](double fraction) {
+        const size_t rank = qMax<size_t>(1, static_cast<size_t>(qCeil(fraction * n)));
+        return values[qMin(rank, n) - 1] / 1e6;
+    };
+
+    stats.count = n;
+    stats.meanMs = mean / 1e6;
+    stats.p50Ms = percentile(0.50);
+    stats.p95Ms = percentile(0.95);
+    stats.p99Ms = percentile(0.99);
+    stats.maxMs = values.back() / 1e6;
+    stats.jitterMs = qSqrt(variance / n) / 1e6;
+    return stats;
+}
+
+static QJsonObject seriesToJson(const FrameTimingRecorder::SeriesStats& stats)
+{
+    QJsonObject json;
+    json["count"] = static_cast<qint64>(stats.count);
+    json["meanMs"] = stats.meanMs;
+    json["p50Ms"] = stats.p50Ms;
+    json["p95Ms"] = stats.p95Ms;
+    json["p99Ms"] = stats.p99Ms;
+    json["maxMs"] = stats.maxMs;
+    json["jitterMs"] = stats.jitterMs;
+    return json;
+}
+
+quint64 FrameTimingRecorder::Snapshot::dropCount() const
+{
+    quint64 total = 0;
+    for (quint64 count : drops) {
+        total += count;
+    }
+    return total;
+}
+
+quint64 FrameTimingRecorder::Snapshot::totalDropCount() const
+{
+    quint64 total = 0;
+    for (quint64 count : totalDrops) {
+        total += count;
+    }
+    return total;
+}
+
+FrameTimingRecorder& FrameTimingRecorder::instance()
+{
+    static FrameTimingRecorder recorder;
+    return recorder;
+}
+
+FrameTimingRecorder::FrameTimingRecorder(QObject* parent)
+    : QObject(parent)
+    , m_ring(kRingCapacity)
+{
+    resetLocked();
+}
+
+qint64 FrameTimingRecorder::now()
+{
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed();
+}
+
+QString FrameTimingRecorder::dropReasonName(DropReason reason)
+{
+    switch (reason) {
+    case LiveEdgeDiscard:   return QStringLiteral("live_edge_discard");
+    case RateLimited:       return QStringLiteral("rate_limited");
+    case DisplaySuperseded: return QStringLiteral("display_superseded");
+    case DecodeQueueFull:   return QStringLiteral("decode_queue_full");
+    default:                return QString();
+    }
+}
+
+QString FrameTimingRecorder::eventKindName(EventKind kind)
+{
+    switch (kind) {
+    case CaptureEvent: return QStringLiteral("capture");
+    case DecodeEvent:  return QStringLiteral("decode");
+    case PresentEvent: return QStringLiteral("present");
+    case DropEvent:    return QStringLiteral("drop");
+    case QueueWaitEvent: return QStringLiteral("queue_wait");
+    default:           return QString();
+    }
+}
+
+void FrameTimingRecorder::setSource(const QString& source)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_source != source) {
+        m_source = source;
+        resetLocked();
+        qCDebug(log_frame_timing) << "Frame timing source set to" << source;
+        return;
+    }
+    m_lastCaptureNs = -1;
+    m_lastPresentNs = -1;
+}
+
+QString FrameTimingRecorder::source() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_source;
+}
+
+void FrameTimingRecorder::recordCapture(qint64 timestampNs)
+{
+    if (timestampNs < 0) {
+        timestampNs = now();
+    }
+    QMutexLocker locker(&m_mutex);
+    m_totalCaptured++;
+    if (m_lastCaptureNs >= 0 && timestampNs >= m_lastCaptureNs) {
+        const qint64 interval = timestampNs - m_lastCaptureNs;
+        m_maxCaptureGapNs = qMax(m_maxCaptureGapNs, interval);
+        appendLocked(CaptureEvent, timestampNs, interval);
+    }
+    m_lastCaptureNs = timestampNs;
+}
+
+void FrameTimingRecorder::recordDecode(qint64 durationNs)
+{
+    if (durationNs < 0) {
+        return;
+    }
+    const qint64 timestampNs = now();
+    QMutexLocker locker(&m_mutex);
+    appendLocked(DecodeEvent, timestampNs, durationNs);
+}
+
+void FrameTimingRecorder::recordQueueWait(qint64 durationNs)
+{
+    if (durationNs < 0) {
+        return;
+    }
+    const qint64 timestampNs = now();
+    QMutexLocker locker(&m_mutex);
+    appendLocked(QueueWaitEvent, timestampNs, durationNs);
+}
+
+void FrameTimingRecorder::recordPresent(qint64 timestampNs)
+{
+    if (timestampNs < 0) {
+        timestampNs = now();
+    }
+    QMutexLocker locker(&m_mutex);
+    m_totalPresented++;
+    if (m_lastPresentNs >= 0 && timestampNs >= m_lastPresentNs) {
+        appendLocked(PresentEvent, timestampNs, timestampNs - m_lastPresentNs);
+    }
+    m_lastPresentNs = timestampNs;
+}
+
+void FrameTimingRecorder::recordDrop(DropReason reason, int count)
+{
+    if (reason < 0 || reason >= DropReasonCount || count <= 0) {
+        return;
+    }
+    const qint64 timestampNs = now();
+    QMutexLocker locker(&m_mutex);
+    m_totalDrops[reason] += count;
+    appendLocked(DropEvent, timestampNs, count, reason);
+}
+
+void FrameTimingRecorder::appendLocked(EventKind kind, qint64 timeNs, qint64 value, DropReason reason)
+{
+    m_ring[m_next] = Event{timeNs, value, static_cast<quint8>(kind), static_cast<quint8>(reason)};
+    m_next = (m_next + 1) % m_ring.size();
+    m_size = qMin(m_size + 1, m_ring.size());
+}
+
+template <typename Fn>
+void FrameTimingRecorder::forEachLocked(Fn fn) const
+{
+    const size_t first = (m_next + m_ring.size() - m_size) % m_ring.size();
+    for (size_t i = 0; i < m_size; ++i) {
+        fn(m_ring[(first + i) % m_ring.size()]);
+    }
+}
+
+void FrameTimingRecorder::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    resetLocked();
+}
+
+void FrameTimingRecorder::resetLocked()
+{
+    m_next = 0;
+    m_size = 0;
+    m_lastCaptureNs = -1;
+    m_lastPresentNs = -1;
+    m_startNs = now();
+    m_totalCaptured = 0;
+    m_totalPresented = 0;
+    std::fill(std::begin(m_totalDrops), std::end(m_totalDrops), 0);
+    m_maxCaptureGapNs = 0;
+}
+
+FrameTimingRecorder::Snapshot FrameTimingRecorder::snapshot(qint64 windowMs) const
+{
+    const qint64 nowNs = now();
+    const qint64 cutoffNs = windowMs > 0 ? nowNs - windowMs * 1000000 : std::numeric_limits<qint64>::min();
+
+    Snapshot result;
+    std::vector<qint64> capture;
+    std::vector<qint64> decode;
+    std::vector<qint64> queueWait;
+    std::vector<qint64> present;
+    {
+        QMutexLocker locker(&m_mutex);
+        result.source = m_source;
+        result.totalCaptured = m_totalCaptured;
+        result.totalPresented = m_totalPresented;
+        std::copy(std::begin(m_totalDrops), std::end(m_totalDrops), std::begin(result.totalDrops));
+        result.maxCaptureGapMs = m_maxCaptureGapNs / 1e6;
+        result.uptimeMs = (nowNs - m_startNs) / 1000000;
+
+        qint64 oldestNs = nowNs;
+        forEachLocked([&](const Event& event) {
+            if (event.timeNs < cutoffNs) {
+                return;
+            }
+            oldestNs = qMin(oldestNs, event.timeNs);
+            switch (event.kind) {
+            case CaptureEvent: capture.push_back(event.value); break;
+            case DecodeEvent:  decode.push_back(event.value); break;
+            case PresentEvent: present.push_back(event.value); break;
+            case DropEvent:    result.drops[event.reason] += event.value; break;
+            case QueueWaitEvent: queueWait.push_back(event.value); break;
+            }
+        });
+        result.windowMs = (nowNs - oldestNs) / 1e6;
+    }
+
+    // Sorting for the percentiles happens outside the lock
+    result.captureInterval = computeStats(capture);
+    result.decodeTime = computeStats(decode);
+    result.queueWait = computeStats(queueWait);
+    result.presentInterval = computeStats(present);
+    return result;
+}
+
+QString FrameTimingRecorder::summary(qint64 windowMs) const
+{
+    const Snapshot s = snapshot(windowMs);
+
+    QStringList lines;
+    lines << QString("Frame timing (%1, last %2 s)")
+                 .arg(s.source.isEmpty() ? QStringLiteral("no source") : s.source)
+                 .arg(s.windowMs / 1000.0, 0, 'f', 0);
+    if (s.captureInterval.count > 0) {
+        lines << QString("Capture interval: %1 ms mean, %2 ms p99, jitter %3 ms")
+                     .arg(s.captureInterval.meanMs, 0, 'f', 1)
+                     .arg(s.captureInterval.p99Ms, 0, 'f', 1)
+                     .arg(s.captureInterval.jitterMs, 0, 'f', 2);
+    }
+    if (s.decodeTime.count > 0) {
+        lines << QString("Decode: %1 ms mean, %2 ms p99")
+                     .arg(s.decodeTime.meanMs, 0, 'f', 1)
+                     .arg(s.decodeTime.p99Ms, 0, 'f', 1);
+    }
+    if (s.queueWait.count > 0) {
+        lines << QString("Decode queue wait: %1 ms mean, %2 ms p99")
+                     .arg(s.queueWait.meanMs, 0, 'f', 1)
+                     .arg(s.queueWait.p99Ms, 0, 'f', 1);
+    }
+    if (s.presentInterval.count > 0) {
+        lines << QString("Present interval: %1 ms mean, jitter %2 ms")
+                     .arg(s.presentInterval.meanMs, 0, 'f', 1)
+                     .arg(s.presentInterval.jitterMs, 0, 'f', 2);
+    }
+    lines << QString("Dropped: %1 live edge, %2 rate limit, %3 never shown, %4 decode queue")
+                 .arg(s.drops[LiveEdgeDiscard])
+                 .arg(s.drops[RateLimited])
+                 .arg(s.drops[DisplaySuperseded])
+                 .arg(s.drops[DecodeQueueFull]);
+    lines << QString("Session: %1 captured, %2 dropped, longest gap %3 ms")
+                 .arg(s.totalCaptured)
+                 .arg(s.totalDropCount())
+                 .arg(s.maxCaptureGapMs, 0, 'f', 1);
+    return lines.join('\n');
+}
+
+QJsonObject FrameTimingRecorder::toJson(qint64 windowMs) const
+{
+    const Snapshot s = snapshot(windowMs);
+
+    QJsonObject drops;
+    QJsonObject totalDrops;
+    for (int reason = 0; reason < DropReasonCount; ++reason) {
+        const QString name = dropReasonName(static_cast<DropReason>(reason));
+        drops[name] = static_cast<qint64>(s.drops[reason]);
+        totalDrops[name] = static_cast<qint64>(s.totalDrops[reason]);
+    }
+
+    QJsonObject window;
+    window["durationMs"] = s.windowMs;
+    window["captureInterval"] = seriesToJson(s.captureInterval);
+    window["decodeTime"] = seriesToJson(s.decodeTime);
+    window["queueWait"] = seriesToJson(s.queueWait);
+    window["presentInterval"] = seriesToJson(s.presentInterval);
+    window["drops"] = drops;
+
+    QJsonObject totals;
+    totals["uptimeMs"] = s.uptimeMs;
+    totals["captured"] = static_cast<qint64>(s.totalCaptured);
+    totals["presented"] = static_cast<qint64>(s.totalPresented);
+    totals["maxCaptureGapMs"] = s.maxCaptureGapMs;
+    totals["drops"] = totalDrops;
+
+    QJsonObject json;
+    json["source"] = s.source;
+    json["exportedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    json["window"] = window;
+    json["totals"] = totals;
+    return json;
+}
+
+QString FrameTimingRecorder::toCsv() const
+{
+    QString csv;
+    QTextStream out(&csv);
+    out << "time_ms,event,value_ms,drop_reason,drop_count\n";
+
+    QMutexLocker locker(&m_mutex);
+    forEachLocked([&](const Event& event) {
+        const QString kind = eventKindName(static_cast<EventKind>(event.kind));
+        const QString timeMs = QString::number((event.timeNs - m_startNs) / 1e6, 'f', 3);
+        if (event.kind == DropEvent) {
+            out << timeMs << ',' << kind << ",,"
+                << dropReasonName(static_cast<DropReason>(event.reason)) << ',' << event.value << '\n';
+        } else {
+            out << timeMs << ',' << kind << ',' << QString::number(event.value / 1e6, 'f', 3) << ",,\n";
+        }
+    });
+    out.flush();
+    return csv;
+}
+
+bool FrameTimingRecorder::exportToFile(const QString& path, QString* error) const
+{
+    const bool csv = QFileInfo(path).suffix().compare(QLatin1String("csv"), Qt::CaseInsensitive) == 0;
+    const QByteArray data = csv ? toCsv().toUtf8()
+                                : QJsonDocument(toJson()).toJson(QJsonDocument::Indented);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    if (file.write(data) != data.size()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    qCInfo(log_frame_timing) << "Frame timing written to" << path;
+    return true;
+}
@@ -0,0 +1,128 @@
+#ifndef FRAMETIMING_H
+#define FRAMETIMING_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <vector>
+
+// Capture health of the video path: how regularly frames arrive, how long
+// they take to decode, why frames were dropped and how evenly they reach
+// the screen.
+//
+// Backends record one event per observation into a fixed-size ring, so the
+// most recent minute or so of raw timings is always available for a window
+// query or an export, at constant memory. Lifetime totals survive the ring
+// wrapping, which is what a long soak run is judged on.
+class FrameTimingRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum DropReason {
+        LiveEdgeDiscard,     // Stale buffered packet skipped to read the newest one
+        RateLimited,         // Dropped by the frame processor's rate gate
+        DisplaySuperseded,   // Decoded but replaced before the display refresh
+        DecodeQueueFull,     // Oldest waiting packet dropped by a full decode queue
+        DropReasonCount
+    };
+
+    enum EventKind {
+        CaptureEvent,   // value: interval since the previous capture
+        DecodeEvent,    // value: decode time on the decoding thread
+        PresentEvent,   // value: interval since the previous present
+        DropEvent,      // value: frames dropped, see reason
+        QueueWaitEvent  // value: time a packet waited for a decode worker
+    };
+
+    struct SeriesStats {
+        quint64 count = 0;
+        double meanMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        double jitterMs = 0.0;   // Standard deviation
+    };
+
+    struct Snapshot {
+        QString source;
+        double windowMs = 0.0;   // Time span the window stats cover
+        SeriesStats captureInterval;
+        SeriesStats decodeTime;
+        SeriesStats queueWait;   // Pipelined decoding only
+        SeriesStats presentInterval;
+        quint64 drops[DropReasonCount] = {};
+        // Since the last reset, independent of the ring
+        quint64 totalCaptured = 0;
+        quint64 totalPresented = 0;
+        quint64 totalDrops[DropReasonCount] = {};
+        double maxCaptureGapMs = 0.0;
+        qint64 uptimeMs = 0;
+
+        quint64 dropCount() const;
+        quint64 totalDropCount() const;
+    };
+
+    static FrameTimingRecorder& instance();
+
+    // Monotonic clock for the record calls, in nanoseconds
+    static qint64 now();
+
+    static QString dropReasonName(DropReason reason);
+    static QString eventKindName(EventKind kind);
+
+    // Names the backend being measured. A new name starts over; the same
+    // name only forgets the last capture and present times, so a pause
+    // between two capture sessions is not counted as a gap.
+    void setSource(const QString& source);
+    QString source() const;
+
+    // Any thread. timestampNs < 0 means now().
+    void recordCapture(qint64 timestampNs = -1);
+    void recordDecode(qint64 durationNs);
+    void recordQueueWait(qint64 durationNs);
+    void recordPresent(qint64 timestampNs = -1);
+    void recordDrop(DropReason reason, int count = 1);
+
+    void reset();
+
+    // Statistics over the events of the last windowMs; 0 = the whole ring
+    Snapshot snapshot(qint64 windowMs = 0) const;
+    QString summary(qint64 windowMs = 0) const;   // Multi-line text for tooltips
+    QJsonObject toJson(qint64 windowMs = 0) const;
+    QString toCsv() const;                         // Raw ring events, oldest first
+
+    // Writes CSV for a .csv path, JSON (statistics of the whole ring) otherwise
+    bool exportToFile(const QString& path, QString* error = nullptr) const;
+
+private:
+    explicit FrameTimingRecorder(QObject* parent = nullptr);
+
+    struct Event {
+        qint64 timeNs;
+        qint64 value;
+        quint8 kind;
+        quint8 reason;
+    };
+
+    void appendLocked(EventKind kind, qint64 timeNs, qint64 value, DropReason reason = LiveEdgeDiscard);
+    void resetLocked();
+    template <typename Fn> void forEachLocked(Fn fn) const;
+
+    mutable QMutex m_mutex;
+    QString m_source;
+    std::vector<Event> m_ring;
+    size_t m_next;
+    size_t m_size;
+    qint64 m_lastCaptureNs;
+    qint64 m_lastPresentNs;
+    qint64 m_startNs;
+    quint64 m_totalCaptured;
+    quint64 m_totalPresented;
+    quint64 m_totalDrops[DropReasonCount];
+    qint64 m_maxCaptureGapNs;
+};
+
+#endif // FRAMETIMING_H
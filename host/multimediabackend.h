@@ -128,6 +128,7 @@ signals:
     void backendWarning(const QString& warning);
     void backendError(const QString& error);
     void fpsChanged(double fps);
+    void decodeStateChanged(const QString& state);  // Adaptive decode level; empty = full quality / not adaptive
     
     // Recording signals
     void recordingStarted(const QString& outputPath);
@@ -0,0 +1,100 @@
+#include "presentationqueue.h"
+#include <QMutexLocker>
+
+// A refresh request can be lost (window hidden or minimised between the
+// request and the next vsync). A frame left pending this long is scheduled
+// again by the next submit rather than being stuck until the window returns.
+static constexpr qint64 kRescheduleAfterMs = 100;
+
+PresentationQueue::PresentationQueue()
+    : m_hasPending(false)
+{
+}
+
+void PresentationQueue::setScheduleCallback(ScheduleCallback callback)
+{
+    QMutexLocker locker(&m_mutex);
+    m_schedule = std::move(callback);
+}
+
+bool PresentationQueue::submit(const QImage& image, const QRegion& dirty)
+{
+    if (image.isNull()) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_stats.submitted++;
+
+    const bool superseded = m_hasPending;
+    bool needsSchedule = !superseded;
+    if (superseded) {
+        m_stats.superseded++;
+        m_pending.dirty = mergeDirty(m_pending, image, dirty);
+        needsSchedule = m_pendingSince.elapsed() >= kRescheduleAfterMs;
+    } else {
+        m_pending.dirty = dirty;
+    }
+    m_pending.image = image;
+    m_hasPending = true;
+
+    // Called under the lock so setScheduleCallback() returning means the old
+    // callback is no longer running and its target may be destroyed.
+    if (needsSchedule) {
+        m_pendingSince.start();
+        if (m_schedule) {
+            m_schedule();
+        }
+    }
+    return superseded;
+}
+
+bool PresentationQueue::take(Frame* frame)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_hasPending) {
+        return false;
+    }
+    *frame = std::move(m_pending);
+    m_pending = Frame();
+    m_hasPending = false;
+    m_stats.presented++;
+    return true;
+}
+
+bool PresentationQueue::hasPending() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hasPending;
+}
+
+void PresentationQueue::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending = Frame();
+    m_hasPending = false;
+}
+
+PresentationQueue::Stats PresentationQueue::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+PresentationQueue::Stats PresentationQueue::takeStats()
+{
+    QMutexLocker locker(&m_mutex);
+    const Stats result = m_stats;
+    m_stats = Stats();
+    return result;
+}
+
+QRegion PresentationQueue::mergeDirty(const Frame& older, const QImage& newer, const QRegion& newerDirty)
+{
+    // Whatever either frame changed must still be repainted; an empty region
+    // or a geometry change already means the whole frame.
+    if (older.dirty.isEmpty() || newerDirty.isEmpty() || older.image.size() != newer.size()) {
+        return QRegion();
+    }
+    return older.dirty.united(newerDirty);
+}
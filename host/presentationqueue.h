@@ -0,0 +1,72 @@
+#ifndef PRESENTATIONQUEUE_H
+#define PRESENTATIONQUEUE_H
+
+#include <QImage>
+#include <QRegion>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <functional>
+
+// Hands decoded frames from a video backend to the display at the display's
+// pace.
+//
+// The queue holds exactly one frame: the latest. A backend submits every
+// decoded frame from its own thread; the display takes whatever is newest
+// when the viewport is ready to refresh. A frame that is replaced before the
+// display took it was decoded but never shown and is counted as superseded,
+// so decode rates above the refresh rate cost no GUI work at all.
+//
+// The schedule callback runs on the submitting thread, with the queue locked,
+// when the slot goes from empty to full, i.e. once per presented frame. Its
+// job is to post a refresh request to the display; it must not call back
+// into the queue.
+class PresentationQueue
+{
+public:
+    struct Frame {
+        QImage image;
+        QRegion dirty;   // Changed area; empty = the whole frame
+    };
+
+    struct Stats {
+        quint64 submitted = 0;
+        quint64 presented = 0;
+        quint64 superseded = 0;   // Decoded but never shown
+    };
+
+    using ScheduleCallback = std::function<void()>;
+
+    PresentationQueue();
+
+    // Replaces the callback; an empty one stops scheduling (e.g. the display
+    // is going away while a backend still holds the queue).
+    void setScheduleCallback(ScheduleCallback callback);
+
+    // Any thread. Replaces a frame that has not been taken yet; returns true
+    // when it did, i.e. that frame will never be shown.
+    bool submit(const QImage& image, const QRegion& dirty = QRegion());
+
+    // Display thread. Moves the pending frame into *frame; false if there is
+    // none. The dirty region covers every frame superseded since the last take.
+    bool take(Frame* frame);
+
+    bool hasPending() const;
+
+    // Drops the pending frame without counting it as superseded
+    void clear();
+
+    Stats stats() const;
+    Stats takeStats();   // Returns the counters and starts new ones
+
+private:
+    static QRegion mergeDirty(const Frame& older, const QImage& newer, const QRegion& newerDirty);
+
+    mutable QMutex m_mutex;
+    ScheduleCallback m_schedule;
+    Frame m_pending;
+    bool m_hasPending;
+    QElapsedTimer m_pendingSince;
+    Stats m_stats;
+};
+
+#endif // PRESENTATIONQUEUE_H
@@ -0,0 +1,283 @@
+#include "recordingsegmenter.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <linux/falloc.h>
+#include <unistd.h>
+#endif
+
+#include "log/opflogging.h"
+OPF_LOGGING_CATEGORY(log_recording_segmenter, "opf.host.recordingsegmenter")
+
+static constexpr int kIndexVersion = 1;
+
+bool RecordingSegmenter::begin(const QString& outputPath, const SegmentPolicy& policy, QString* error)
+{
+    QMutexLocker locker(&m_mutex);
+    const QFileInfo output(outputPath);
+    m_policy = policy;
+    m_directory = output.absolutePath();
+    m_baseName = output.completeBaseName();
+    m_suffix = output.suffix();
+    m_segments.clear();
+    m_nextSequence = 1;
+    m_open = false;
+    m_currentStartMs = 0;
+
+    const QFileInfo directory(m_directory);
+    if (!directory.isDir() || !directory.isWritable()) {
+        if (error) {
+            *error = QStringLiteral("Recording directory is not writable: %1").arg(m_directory);
+        }
+        m_directory.clear();
+        return false;
+    }
+
+    if (loadIndexLocked()) {
+        qCInfo(log_recording_segmenter) << "Continuing segmented recording" << indexPath()
+                                        << "from segment" << m_nextSequence;
+    }
+    return true;
+}
+
+QString RecordingSegmenter::openSegment(qint64 startMs)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_directory.isEmpty()) {
+        return QString();
+    }
+    if (m_open) {
+        closeSegmentLocked(startMs);
+    }
+
+    Segment segment;
+    segment.sequence = m_nextSequence++;
+    segment.fileName = QFileInfo(segmentPathLocked(segment.sequence)).fileName();
+    segment.startMs = startMs;
+    m_segments.append(segment);
+    m_open = true;
+    m_currentStartMs = startMs;
+
+    const QString path = segmentPathLocked(segment.sequence);
+    if (m_policy.preallocateBytes > 0) {
+        preallocate(path, m_policy.preallocateBytes);
+    }
+    applyRetentionLocked(startMs);
+    writeIndexLocked();
+
+    qCDebug(log_recording_segmenter) << "Opened recording segment" << path;
+    return path;
+}
+
+void RecordingSegmenter::closeSegment(qint64 endMs)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_open) {
+        closeSegmentLocked(endMs);
+        writeIndexLocked();
+    }
+}
+
+void RecordingSegmenter::closeSegmentLocked(qint64 endMs)
+{
+    Segment& segment = m_segments.last();
+    const QString path = QDir(m_directory).filePath(segment.fileName);
+    releasePreallocation(path);
+    segment.endMs = qMax(endMs, segment.startMs);
+    segment.bytes = QFileInfo(path).size();
+    m_open = false;
+}
+
+bool RecordingSegmenter::shouldRotate(qint64 nowMs, qint64 bytesWritten) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_open) {
+        return false;
+    }
+    if (m_policy.segmentDurationMs > 0 && nowMs - m_currentStartMs >= m_policy.segmentDurationMs) {
+        return true;
+    }
+    return m_policy.segmentSizeBytes > 0 && bytesWritten >= m_policy.segmentSizeBytes;
+}
+
+void RecordingSegmenter::applyRetention(qint64 nowMs)
+{
+    QMutexLocker locker(&m_mutex);
+    applyRetentionLocked(nowMs);
+    writeIndexLocked();
+}
+
+void RecordingSegmenter::applyRetentionLocked(qint64 nowMs)
+{
+    if (m_policy.retentionMs <= 0) {
+        return;
+    }
+    const qint64 cutoff = nowMs - m_policy.retentionMs;
+    const QDir directory(m_directory);
+
+    // Oldest first; the open segment is never a candidate
+    while (!m_segments.isEmpty()) {
+        const Segment& oldest = m_segments.first();
+        if (oldest.endMs < 0 || oldest.endMs >= cutoff) {
+            break;
+        }
+        const QString path = directory.filePath(oldest.fileName);
+        if (QFile::exists(path) && !QFile::remove(path)) {
+            qCWarning(log_recording_segmenter) << "Cannot remove expired recording segment" << path;
+            break;
+        }
+        qCInfo(log_recording_segmenter) << "Removed expired recording segment" << oldest.fileName;
+        m_segments.removeFirst();
+    }
+}
+
+SegmentPolicy RecordingSegmenter::policy() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_policy;
+}
+
+QString RecordingSegmenter::indexPath() const
+{
+    return QDir(m_directory).filePath(m_baseName + QStringLiteral(".segments.json"));
+}
+
+QString RecordingSegmenter::currentPath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_open ? QDir(m_directory).filePath(m_segments.last().fileName) : QString();
+}
+
+QList<RecordingSegmenter::Segment> RecordingSegmenter::segments() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_segments;
+}
+
+QString RecordingSegmenter::segmentPathLocked(int sequence) const
+{
+    QString name = QStringLiteral("%1-%2").arg(m_baseName).arg(sequence, 5, 10, QLatin1Char('0'));
+    if (!m_suffix.isEmpty()) {
+        name += QLatin1Char('.') + m_suffix;
+    }
+    return QDir(m_directory).filePath(name);
+}
+
+bool RecordingSegmenter::loadIndexLocked()
+{
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    const QDir directory(m_directory);
+    for (const QJsonValue& value : root.value(QStringLiteral("segments")).toArray()) {
+        const QJsonObject entry = value.toObject();
+        Segment segment;
+        segment.fileName = entry.value(QStringLiteral("file")).toString();
+        segment.sequence = entry.value(QStringLiteral("sequence")).toInt();
+        segment.startMs = entry.value(QStringLiteral("startMs")).toInteger();
+        segment.endMs = entry.value(QStringLiteral("endMs")).toInteger(-1);
+        segment.bytes = entry.value(QStringLiteral("bytes")).toInteger();
+        const QString path = directory.filePath(segment.fileName);
+        if (segment.fileName.isEmpty() || !QFile::exists(path)) {
+            continue;
+        }
+        if (segment.endMs < 0) {
+            // Left open by a crash: keep what reached the disk
+            releasePreallocation(path);
+            segment.bytes = QFileInfo(path).size();
+            segment.endMs = qMax(segment.startMs, QFileInfo(path).lastModified().toMSecsSinceEpoch());
+        }
+        m_segments.append(segment);
+        m_nextSequence = qMax(m_nextSequence, segment.sequence + 1);
+    }
+    return !m_segments.isEmpty();
+}
+
+bool RecordingSegmenter::writeIndexLocked() const
+{
+    QJsonArray list;
+    for (const Segment& segment : m_segments) {
+        QJsonObject entry;
+        entry["file"] = segment.fileName;
+        entry["sequence"] = segment.sequence;
+        entry["start"] = QDateTime::fromMSecsSinceEpoch(segment.startMs).toUTC().toString(Qt::ISODateWithMs);
+        entry["startMs"] = segment.startMs;
+        if (segment.endMs >= 0) {
+            entry["endMs"] = segment.endMs;
+            entry["durationMs"] = segment.endMs - segment.startMs;
+            entry["bytes"] = segment.bytes;
+        }
+        entry["complete"] = segment.endMs >= 0;
+        list.append(entry);
+    }
+
+    QJsonObject root;
+    root["version"] = kIndexVersion;
+    root["recording"] = m_suffix.isEmpty() ? m_baseName : m_baseName + QLatin1Char('.') + m_suffix;
+    root["segmentDurationMs"] = m_policy.segmentDurationMs;
+    root["segmentSizeBytes"] = m_policy.segmentSizeBytes;
+    root["retentionMs"] = m_policy.retentionMs;
+    root["segments"] = list;
+
+    // Written beside the old index and renamed over it, so a crash leaves
+    // one or the other
+    QSaveFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(root).toJson(QJsonDocument::Indented)) < 0
+        || !file.commit()) {
+        qCWarning(log_recording_segmenter) << "Cannot write recording index" << indexPath() << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool RecordingSegmenter::preallocate(const QString& path, qint64 bytes)
+{
+#ifdef Q_OS_LINUX
+    const int fd = ::open(QFile::encodeName(path).constData(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    // KEEP_SIZE: the file still reads as empty, and as long as what was
+    // written if the recorder dies
+    const bool reserved = ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, bytes) == 0;
+    ::close(fd);
+    if (!reserved) {
+        qCDebug(log_recording_segmenter) << "Preallocation not supported for" << path;
+    }
+    return reserved;
+#else
+    Q_UNUSED(path)
+    Q_UNUSED(bytes)
+    return false;
+#endif
+}
+
+void RecordingSegmenter::releasePreallocation(const QString& path)
+{
+#ifdef Q_OS_LINUX
+    // Truncating to the current size frees blocks reserved past the end
+    const int fd = ::open(QFile::encodeName(path).constData(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    const off_t size = ::lseek(fd, 0, SEEK_END);
+    if (size >= 0 && ::ftruncate(fd, size) != 0) {
+        qCDebug(log_recording_segmenter) << "Cannot release preallocation of" << path;
+    }
+    ::close(fd);
+#else
+    Q_UNUSED(path)
+#endif
+}
@@ -0,0 +1,93 @@
+#ifndef RECORDINGSEGMENTER_H
+#define RECORDINGSEGMENTER_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// When a long recording starts a new file and which old files it drops.
+struct SegmentPolicy {
+    qint64 segmentDurationMs = 0;   // 0: no time limit per segment
+    qint64 segmentSizeBytes = 0;    // 0: no size limit per segment
+    qint64 retentionMs = 0;         // 0: keep every segment
+    qint64 preallocateBytes = 0;    // Reserved on disk when a segment opens (Linux)
+
+    bool isSegmented() const { return segmentDurationMs > 0 || segmentSizeBytes > 0; }
+};
+
+// Splits one recording into a numbered series of files next to the requested
+// output path, so that a crash or power cut costs at most the tail of the
+// current segment instead of the whole session.
+//
+// For "dir/session.mkv" the segments are "dir/session-00001.mkv",
+// "dir/session-00002.mkv", ... and "dir/session.segments.json" lists them
+// with their wall-clock start times, durations and sizes. The index is
+// rewritten atomically whenever a segment opens or closes, so it is never
+// half-written. Segments whose end is older than the retention window are
+// deleted as new ones open.
+//
+// Starting again on the same output path picks up the existing index:
+// numbering continues and a segment left open by a crash is closed at its
+// current size.
+//
+// The recorder decides when to rotate (shouldRotate) and at which frame;
+// this class only does names, bookkeeping and files. Thread-safe.
+class RecordingSegmenter
+{
+public:
+    struct Segment {
+        QString fileName;        // Relative to the index directory
+        int sequence = 0;
+        qint64 startMs = 0;      // Wall clock, ms since epoch
+        qint64 endMs = -1;       // -1 while open
+        qint64 bytes = 0;
+    };
+
+    // Loads an existing index for outputPath, if any. False when the
+    // directory is not writable.
+    bool begin(const QString& outputPath, const SegmentPolicy& policy, QString* error = nullptr);
+
+    // Closes the open segment (if any) at startMs, opens the next one and
+    // applies retention. Returns the new file's absolute path, or an empty
+    // string if begin() was not called.
+    QString openSegment(qint64 startMs);
+
+    // Marks the open segment complete. Call after the file is closed, so
+    // the recorded size is final and unused preallocation can be released.
+    void closeSegment(qint64 endMs);
+
+    bool shouldRotate(qint64 nowMs, qint64 bytesWritten) const;
+
+    // Deletes complete segments that ended before nowMs - retentionMs
+    void applyRetention(qint64 nowMs);
+
+    SegmentPolicy policy() const;
+    QString indexPath() const;
+    QString currentPath() const;
+    QList<Segment> segments() const;
+
+    // Reserves bytes for path without changing its size, so the file grows
+    // into contiguous space. No-op where unsupported.
+    static bool preallocate(const QString& path, qint64 bytes);
+    // Releases reserved space past the end of a finished file
+    static void releasePreallocation(const QString& path);
+
+private:
+    QString segmentPathLocked(int sequence) const;
+    void closeSegmentLocked(qint64 endMs);
+    void applyRetentionLocked(qint64 nowMs);
+    bool loadIndexLocked();
+    bool writeIndexLocked() const;
+
+    mutable QMutex m_mutex;
+    SegmentPolicy m_policy;
+    QString m_directory;
+    QString m_baseName;
+    QString m_suffix;
+    QList<Segment> m_segments;
+    int m_nextSequence = 1;
+    bool m_open = false;          // Last entry of m_segments is being written
+    qint64 m_currentStartMs = 0;
+};
+
+#endif // RECORDINGSEGMENTER_H
@@ -0,0 +1,277 @@
+#include "startuptrace.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+
+#include "opflogging.h"
+OPF_LOGGING_CATEGORY(log_startup_trace, "opf.log.startuptrace")
+
+// Time left after the first frame for spans that are still open to close
+static constexpr int kFirstFrameTailMs = 2000;
+
+std::atomic<bool> StartupTrace::s_enabled{false};
+
+namespace {
+// Trace thread id of the calling thread, valid for one trace generation
+struct ThreadSlot {
+    quint64 generation = 0;
+    quint32 id = 0;
+};
+thread_local ThreadSlot t_threadSlot;
+}
+
+StartupTrace& StartupTrace::instance()
+{
+    static StartupTrace trace;
+    return trace;
+}
+
+StartupTrace::StartupTrace()
+    : m_firstFrameSeen(false)
+    , m_firstFrameUs(-1)
+    , m_firstFrameSource(nullptr)
+    , m_generation(0)
+    , m_finished(false)
+{
+}
+
+void StartupTrace::start(const QString& outputPath)
+{
+    QMutexLocker locker(&m_mutex);
+    m_events.clear();
+    m_events.reserve(1024);
+    m_threadNames.clear();
+    m_firstFrameSeen.store(false, std::memory_order_relaxed);
+    m_firstFrameUs = -1;
+    m_firstFrameSource = nullptr;
+    ++m_generation;
+    m_finished = false;
+    m_outputPath = outputPath;
+    if (m_outputPath.isEmpty()) {
+        m_outputPath = QDir(QDir::tempPath()).filePath(
+            QStringLiteral("openterface-startup-%1.json")
+                .arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss"))));
+    }
+
+    m_clock.start();
+    m_threadNames.insert(threadIdLocked(), QStringLiteral("main"));
+    s_enabled.store(true, std::memory_order_release);
+    locker.unlock();
+
+    instant("trace start", "startup");
+}
+
+quint32 StartupTrace::threadIdLocked()
+{
+    if (t_threadSlot.generation != m_generation) {
+        t_threadSlot.generation = m_generation;
+        t_threadSlot.id = static_cast<quint32>(m_threadNames.size()) + 1;
+
+        QString name;
+        if (QThread* thread = QThread::currentThread()) {
+            name = thread->objectName();
+        }
+        if (name.isEmpty()) {
+            name = QStringLiteral("thread %1").arg(t_threadSlot.id);
+        }
+        m_threadNames.insert(t_threadSlot.id, name);
+    }
+    return t_threadSlot.id;
+}
+
+void StartupTrace::append(char phase, const char* name, const char* category)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!isEnabled()) {
+        return;   // Finished while the caller was on its way in
+    }
+    m_events.push_back(Event{name, category, m_clock.nsecsElapsed() / 1000, threadIdLocked(), phase});
+}
+
+void StartupTrace::begin(const char* name, const char* category)
+{
+    if (isEnabled()) {
+        append('B', name, category);
+    }
+}
+
+void StartupTrace::end(const char* name, const char* category)
+{
+    if (isEnabled()) {
+        append('E', name, category);
+    }
+}
+
+void StartupTrace::instant(const char* name, const char* category)
+{
+    if (isEnabled()) {
+        append('i', name, category);
+    }
+}
+
+void StartupTrace::markFirstFrame(const char* source)
+{
+    if (!isEnabled() || m_firstFrameSeen.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        m_firstFrameUs = m_clock.nsecsElapsed() / 1000;
+        m_firstFrameSource = source;
+    }
+    instant("first frame", source);
+    qCInfo(log_startup_trace) << "First video frame from" << source << "after"
+                              << firstFrameUs() / 1000 << "ms";
+    finishAfter(kFirstFrameTailMs);
+}
+
+void StartupTrace::finishAfter(int delayMs)
+{
+    QCoreApplication* app = QCoreApplication::instance();
+    if (!app || !isEnabled()) {
+        return;
+    }
+    // Queued so that the timer lives on the application thread, whichever
+    // thread asked
+    QMetaObject::invokeMethod(app, [delayMs]() {
+        QTimer::singleShot(delayMs, QCoreApplication::instance(), []() {
+            StartupTrace::instance().finish();
+        });
+    }, Qt::QueuedConnection);
+}
+
+void StartupTrace::setThreadName(const QString& name)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    m_threadNames.insert(threadIdLocked(), name);
+}
+
+bool StartupTrace::finish(QString* error)
+{
+    QString path;
+    QByteArray json;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_finished || !isEnabled()) {
+            return false;
+        }
+        m_finished = true;
+        s_enabled.store(false, std::memory_order_release);
+        path = m_outputPath;
+    }
+    json = toJson();
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        const QString message = QStringLiteral("Cannot write startup trace %1: %2").arg(path, file.errorString());
+        qCWarning(log_startup_trace).noquote() << message;
+        if (error) {
+            *error = message;
+        }
+        return false;
+    }
+    qCInfo(log_startup_trace) << "Startup trace with" << eventCount() << "events written to" << path;
+    return true;
+}
+
+QByteArray StartupTrace::toJson() const
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray events;
+    QJsonObject process;
+    process["name"] = QStringLiteral("process_name");
+    process["ph"] = QStringLiteral("M");
+    process["pid"] = pid;
+    process["tid"] = 0;
+    process["args"] = QJsonObject{{QStringLiteral("name"), QStringLiteral("Openterface")}};
+    events.append(process);
+
+    for (auto it = m_threadNames.constBegin(); it != m_threadNames.constEnd(); ++it) {
+        QJsonObject thread;
+        thread["name"] = QStringLiteral("thread_name");
+        thread["ph"] = QStringLiteral("M");
+        thread["pid"] = pid;
+        thread["tid"] = static_cast<qint64>(it.key());
+        thread["args"] = QJsonObject{{QStringLiteral("name"), it.value()}};
+        events.append(thread);
+
+        // Keeps the main thread on top and the rest in order of appearance
+        QJsonObject order;
+        order["name"] = QStringLiteral("thread_sort_index");
+        order["ph"] = QStringLiteral("M");
+        order["pid"] = pid;
+        order["tid"] = static_cast<qint64>(it.key());
+        order["args"] = QJsonObject{{QStringLiteral("sort_index"), static_cast<qint64>(it.key())}};
+        events.append(order);
+    }
+
+    for (const Event& event : m_events) {
+        QJsonObject json;
+        json["name"] = QString::fromUtf8(event.name);
+        json["cat"] = QString::fromUtf8(event.category);
+        json["ph"] = QString(QLatin1Char(event.phase));
+        json["ts"] = event.timestampUs;
+        json["pid"] = pid;
+        json["tid"] = static_cast<qint64>(event.thread);
+        if (event.phase == 'i') {
+            json["s"] = QStringLiteral("p");   // Draw across the whole process
+        }
+        events.append(json);
+    }
+
+    QJsonObject other;
+    other["application"] = QCoreApplication::applicationVersion();
+    other["firstFrameMs"] = m_firstFrameUs < 0 ? QJsonValue() : QJsonValue(m_firstFrameUs / 1000.0);
+    if (m_firstFrameSource) {
+        other["firstFrameSource"] = QString::fromUtf8(m_firstFrameSource);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = QStringLiteral("ms");
+    root["otherData"] = other;
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+QString StartupTrace::outputPath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_outputPath;
+}
+
+int StartupTrace::eventCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_events.size());
+}
+
+qint64 StartupTrace::firstFrameUs() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_firstFrameUs;
+}
+
+void StartupTrace::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    s_enabled.store(false, std::memory_order_release);
+    m_events.clear();
+    m_threadNames.clear();
+    m_firstFrameSeen.store(false, std::memory_order_relaxed);
+    m_firstFrameUs = -1;
+    m_firstFrameSource = nullptr;
+    ++m_generation;
+    m_finished = false;
+}
@@ -0,0 +1,127 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <vector>
+
+// Time-to-first-frame profile of application startup.
+//
+// Startup code marks where its steps begin and end (spans) and single
+// moments (instants). Every event records the thread it happened on and the
+// microseconds since tracing started. The events are written as Chrome
+// trace-event JSON, for chrome://tracing or ui.perfetto.dev, shortly after
+// the first video frame arrives.
+//
+// Tracing is off unless started with --profile-startup. While it is off a
+// marker costs one relaxed atomic load: names are string literals stored by
+// pointer and nothing is allocated.
+class StartupTrace
+{
+public:
+    static StartupTrace& instance();
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Starts recording on a fresh clock; the calling thread is named "main".
+    // An empty path writes a timestamped file to the temp directory.
+    void start(const QString& outputPath = QString());
+
+    // name and category must outlive the trace (string literals)
+    void begin(const char* name, const char* category);
+    void end(const char* name, const char* category);
+    void instant(const char* name, const char* category);
+
+    // Records the first video frame, once. The trace is written a little
+    // later so that spans still open at that point can close.
+    void markFirstFrame(const char* source);
+
+    // Writes the trace after delayMs from the application's event loop,
+    // unless it was written before that
+    void finishAfter(int delayMs);
+
+    // Labels the calling thread. Unlabelled threads use the QThread object
+    // name, or a number.
+    void setThreadName(const QString& name);
+
+    // Stops recording and writes the trace. Only the first call writes.
+    bool finish(QString* error = nullptr);
+
+    QByteArray toJson() const;
+    QString outputPath() const;
+    int eventCount() const;
+    qint64 firstFrameUs() const;   // -1 until markFirstFrame
+
+    // Drops every event and stops recording, without writing
+    void reset();
+
+private:
+    StartupTrace();
+
+    struct Event {
+        const char* name;
+        const char* category;
+        qint64 timestampUs;
+        quint32 thread;
+        char phase;   // 'B', 'E' or 'i'
+    };
+
+    void append(char phase, const char* name, const char* category);
+    quint32 threadIdLocked();
+
+    static std::atomic<bool> s_enabled;
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QString m_outputPath;
+    std::vector<Event> m_events;
+    QHash<quint32, QString> m_threadNames;
+    std::atomic<bool> m_firstFrameSeen;
+    qint64 m_firstFrameUs;
+    const char* m_firstFrameSource;
+    quint64 m_generation;   // Invalidates thread ids from before a restart
+    bool m_finished;
+};
+
+// Begin/end pair around the enclosing scope
+class StartupTraceSpan
+{
+public:
+    StartupTraceSpan(const char* name, const char* category)
+        : m_name(name)
+        , m_category(category)
+        , m_active(StartupTrace::isEnabled())
+    {
+        if (m_active) {
+            StartupTrace::instance().begin(m_name, m_category);
+        }
+    }
+
+    ~StartupTraceSpan()
+    {
+        if (m_active) {
+            StartupTrace::instance().end(m_name, m_category);
+        }
+    }
+
+    StartupTraceSpan(const StartupTraceSpan&) = delete;
+    StartupTraceSpan& operator=(const StartupTraceSpan&) = delete;
+
+private:
+    const char* m_name;
+    const char* m_category;
+    bool m_active;
+};
+
+#define OPF_STARTUP_SPAN_JOIN2(a, b) a##b
+#define OPF_STARTUP_SPAN_JOIN(a, b) OPF_STARTUP_SPAN_JOIN2(a, b)
+
+// Usage: OPF_STARTUP_SPAN("KeyboardLayoutManager::loadLayouts", "ui");
+#define OPF_STARTUP_SPAN(name, category) \
+    StartupTraceSpan OPF_STARTUP_SPAN_JOIN(opfStartupSpan_, __LINE__)(name, category)
+
+#endif // STARTUPTRACE_H
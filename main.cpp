@@ -29,6 +29,7 @@
 #include "target/KeyboardLayouts.h"
 #include "ui/languagemanager.h"
 #include "ui/customkey/customkeymanager.h"
+#include "log/startuptrace.h"
 #include <QMetaType>
 #include <QCoreApplication>
 #include <QtPlugin>
@@ -40,6 +41,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QTimer>
+#include <memory>
 #include <cstdio>
 
 // Stdio MCP transport support (headless mode for Claude Code)
@@ -279,6 +281,10 @@ int main(int argc, char *argv[])
             qInfo() << "Override media backend from command line:" << overrideBackend;
         } else if (arg == "--list-backends") {
             listBackends = true;
+        } else if (arg == "--profile-startup" || arg.startsWith("--profile-startup=")) {
+            // Time-to-first-frame trace in Chrome trace JSON; see StartupTrace
+            StartupTrace::instance().start(arg.section('=', 1));
+            qInfo() << "Startup profiling enabled, trace file:" << StartupTrace::instance().outputPath();
         }
     }
 
@@ -311,7 +317,7 @@ int main(int argc, char *argv[])
         // Start VideoHid — required to initialize the video chip (MS2109/MS2130S) HID
         // interface so the HDMI input is routed to the USB capture device. Without this,
         // the capture device produces valid but black frames. GUI mode does the same in
-        // MainWindowInitializer::deferredInitializeCamera().
+        // MainWindowInitializer::startDeferredInitialization().
         fprintf(stderr, "[DEBUG] Starting VideoHid...\n");
         fprintf(stderr, "[DEBUG] Current port chain: '%s'\n",
                 GlobalSetting::instance().getOpenterfacePortChain().toUtf8().constData());
@@ -510,10 +516,18 @@ int main(int argc, char *argv[])
 #endif
         return 0;
     }
-    setupEnv();
+    {
+        OPF_STARTUP_SPAN("setupEnv", "startup");
+        setupEnv();
+    }
     
     qInfo() << "Creating QApplication...";
+    StartupTrace::instance().begin("QApplication", "startup");
     QApplication app(argc, argv);
+    StartupTrace::instance().end("QApplication", "startup");
+
+    // Write the trace even if no video frame ever arrives
+    StartupTrace::instance().finishAfter(60000);
 
     // Register custom types for QVariant
     qRegisterMetaType<QList<KeyStep>>("QList<KeyStep>");
@@ -553,6 +567,7 @@ int main(int argc, char *argv[])
 
     // Create splash screen after environment setup
     // Create splash screen with SVG or fallback image
+    StartupTrace::instance().begin("splash screen", "startup");
     QPixmap pixmap(":/images/openterface-splash.svg");
     if (pixmap.isNull()) {
         // SVG failed to load, create a simple splash screen
@@ -575,9 +590,11 @@ int main(int argc, char *argv[])
     
     // Process events to show splash screen
     app.processEvents();
+    StartupTrace::instance().end("splash screen", "startup");
     
     // Load settings immediately (fast operation)
     qInfo() << "Loading settings...";
+    StartupTrace::instance().begin("load settings", "startup");
     GlobalSetting::instance().loadLogSettings();
     GlobalSetting::instance().loadVideoSettings();
 
@@ -589,6 +606,7 @@ int main(int argc, char *argv[])
 
     applyMediaBackendSetting();
     LogHandler::instance().enableLogStore();
+    StartupTrace::instance().end("load settings", "startup");
     
     // Load keyboard layouts immediately - required for keyboard functionality
     qInfo() << "Loading keyboard layouts...";
@@ -601,76 +619,43 @@ int main(int argc, char *argv[])
     qInfo() << "Creating main window...";
     
     // Create main window and language manager
+    StartupTrace::instance().begin("LanguageManager::initialize", "startup");
     LanguageManager* languageManager = new LanguageManager(&app);
     languageManager->initialize("en");
+    StartupTrace::instance().end("LanguageManager::initialize", "startup");
+    StartupTrace::instance().begin("MainWindow constructor", "startup");
     MainWindow* window = new MainWindow(languageManager);
+    StartupTrace::instance().end("MainWindow constructor", "startup");
     
     // Stop the splash animation and close it
     splash->hideLoadingMessage();
     
     // Show the main window and bring it to top
+    StartupTrace::instance().begin("show main window", "startup");
     window->show();
     window->raise();
     window->activateWindow();
     splash->finish(window);
+    StartupTrace::instance().end("show main window", "startup");
     
     // Clean up splash screen
     splash->deleteLater();
     
     qInfo() << "Main window shown";
     
-    // Defer device menu setup (device enumeration) - improves startup time
-    // Hotplug monitor is already connected, so new devices will be detected
-    QTimer::singleShot(5, window, [window]() {
-        qInfo() << "Setting up device menu...";
-        window->deferredSetupCoordinators();
-        qInfo() << "Device menu setup complete";
-    });
-    
-    // Defer camera, audio, and VideoHid initialization (improves startup time)
-    // This was blocking startup for ~500ms
-    QTimer::singleShot(150, window, [window]() {
-        qInfo() << "Initializing camera and audio...";
-        window->deferredInitializeCamera();
-        qInfo() << "Camera and audio initialization started";
+    // Device enumeration, camera, HID and audio start as a task graph once
+    // the event loop runs, so the window paints first. Hotplug monitor is
+    // already connected, so new devices will be detected meanwhile.
+    QTimer::singleShot(0, window, [window]() {
+        qInfo() << "Starting deferred initialization...";
+        window->startDeferredInitialization();
     });
 
     // Auto-start MCP Server if --mcp-start flag is present
     if (autoStartMcp) {
         // Capture port for the lambda (use 0 to indicate SSE disabled)
         int capturedSsePort = mcpSsePort;
-        // Wait longer for camera initialization to complete before starting MCP server
-        // Camera initialization happens in deferredInitializeCamera (150ms delay)
-        // and may take additional time for device auto-selection and capture start
-        QTimer::singleShot(1500, window, [window, capturedSsePort]() {
-            qInfo() << "Auto-starting MCP Server (--mcp-start)...";
-            
-            // Wait for camera frame to be available (similar to headless mode)
-            const int maxWaitMs = 5000;  // 5 seconds timeout
-            const int pollIntervalMs = 200;
-            int waitedMs = 0;
-            
-            qInfo() << "Waiting for camera frame to be available...";
-            
-            while (waitedMs < maxWaitMs) {
-                // Check if camera has frame
-                if (window->getCameraManager() && 
-                    !window->getCameraManager()->getLatestOriginalFrame().isNull()) {
-                    QImage frame = window->getCameraManager()->getLatestOriginalFrame();
-                    qInfo() << "Camera ready! First frame:" << frame.width() << "x" << frame.height();
-                    break;
-                }
-                
-                QThread::msleep(pollIntervalMs);
-                waitedMs += pollIntervalMs;
-                QCoreApplication::processEvents();
-            }
-            
-            if (waitedMs >= maxWaitMs) {
-                qWarning() << "Timeout waiting for camera frame (" << maxWaitMs << "ms)";
-                qWarning() << "MCP server will start, but capture_screen may return errors initially";
-            }
-            
+        auto startMcp = [window, capturedSsePort]() {
             // Now initialize MCP server
             window->initMcpServer();
 
@@ -688,13 +673,46 @@ int main(int argc, char *argv[])
                 // Default to stdio transport
                 window->toggleMcpServer(true);
             }
+        };
+
+        // Camera initialization and device auto-selection run from the
+        // startup task graph; poll for the first frame with a timer rather
+        // than sleeping, so the GUI thread keeps presenting video meanwhile
+        QTimer::singleShot(1500, window, [window, startMcp]() {
+            qInfo() << "Auto-starting MCP Server (--mcp-start)...";
+            qInfo() << "Waiting for camera frame to be available...";
+
+            static constexpr int maxWaitMs = 5000;  // 5 seconds timeout
+            static constexpr int pollIntervalMs = 200;
+            QTimer* poll = new QTimer(window);
+            poll->setInterval(pollIntervalMs);
+            auto waitedMs = std::make_shared<int>(0);
+            QObject::connect(poll, &QTimer::timeout, window, [window, poll, waitedMs, startMcp]() {
+                // Check if camera has frame
+                QImage frame = window->getCameraManager() ? window->getCameraManager()->getLatestOriginalFrame() : QImage();
+                if (!frame.isNull()) {
+                    qInfo() << "Camera ready! First frame:" << frame.width() << "x" << frame.height();
+                } else if ((*waitedMs += pollIntervalMs) >= maxWaitMs) {
+                    qWarning() << "Timeout waiting for camera frame (" << maxWaitMs << "ms)";
+                    qWarning() << "MCP server will start, but capture_screen may return errors initially";
+                } else {
+                    return;
+                }
+                poll->stop();
+                poll->deleteLater();
+                startMcp();
+            });
+            poll->start();
         });
     }
     
     // Initialize GStreamer before Qt application
     #ifdef HAVE_GSTREAMER
     GError* gst_error = nullptr;
-    if (!gst_init_check(&argc, &argv, &gst_error)) {
+    StartupTrace::instance().begin("gst_init_check", "startup");
+    const bool gstInitialized = gst_init_check(&argc, &argv, &gst_error);
+    StartupTrace::instance().end("gst_init_check", "startup");
+    if (!gstInitialized) {
         if (gst_error) {
             qCritical() << "Failed to initialize GStreamer:" << gst_error->message;
             g_error_free(gst_error);
@@ -731,6 +749,9 @@ int main(int argc, char *argv[])
     
     qInfo() << "Application event loop exited with code:" << result;
     qInfo() << "Beginning final cleanup...";
+
+    // Quit before the first frame or the trace timeout
+    StartupTrace::instance().finish();
     
     // Clean up GStreamer
     #ifdef HAVE_GSTREAMER
@@ -31,17 +31,31 @@ SOURCES += main.cpp \
     host/HostManager.cpp \
     host/audiomanager.cpp \
     host/audiothread.cpp \
+    host/audiocapturetap.cpp \
     host/cameramanager.cpp \
     host/usbcontrol.cpp \
     host/multimediabackend.cpp \
     host/imagecapturer.cpp \
+    host/framebus.cpp \
+    host/framelatency.cpp \
+    host/presentationqueue.cpp \
+    host/frametiming.cpp \
+    host/recordingsegmenter.cpp \
     host/backend/qtmultimediabackendhandler.cpp \
     host/backend/qtbackendhandler.cpp \
     host/backend/ffmpegbackendhandler.cpp \
     host/backend/ffmpeg/capturethread.cpp \
     host/backend/ffmpeg/ffmpeg_hardware_accelerator.cpp \
     host/backend/ffmpeg/ffmpeg_device_manager.cpp \
+    host/backend/ffmpeg/ffmpeg_replay_source.cpp \
     host/backend/ffmpeg/ffmpeg_frame_processor.cpp \
+    host/backend/ffmpeg/ffmpeg_frame_pool.cpp \
+    host/backend/ffmpeg/ffmpeg_decode_governor.cpp \
+    host/backend/ffmpeg/ffmpeg_pixel_converter.cpp \
+    host/backend/ffmpeg/ffmpeg_frame_diff.cpp \
+    host/backend/ffmpeg/ffmpeg_decode_pipeline.cpp \
+    host/backend/ffmpeg/ffmpeg_restart_decoder.cpp \
+    host/backend/ffmpeg/ffmpeg_capability_cache.cpp \
     host/backend/ffmpeg/ffmpeg_amd_detector.cpp \
     host/backend/ffmpeg/ffmpeg_recorder.cpp \
     host/backend/ffmpeg/ffmpeg_device_validator.cpp \
@@ -96,6 +110,7 @@ SOURCES += main.cpp \
     ui/loghandler.cpp \
     ui/mainwindow.cpp \
     ui/videopane.cpp \
+    ui/glvideoitem.cpp \
     ui/languagemanager.cpp \
     ui/screensavermanager.cpp \
     ui/screenscale.cpp \
@@ -126,6 +141,7 @@ SOURCES += main.cpp \
     ui/advance/wchflash/WCHFlashDialog.cpp \
     ui/advance/keyboardmapeditor.cpp \
     ui/initializer/mainwindowinitializer.cpp \
+    ui/initializer/startuptaskgraph.cpp \
     ui/statusbar/statusbarmanager.cpp \
     ui/statusbar/statuswidget.cpp \
     ui/cornerwidget/cornerwidgetmanager.cpp \
@@ -151,7 +167,8 @@ SOURCES += main.cpp \
     ui/customkey/customkeydialog.cpp \
     ui/customkey/virtualkeyboardpage.cpp \
     SysKeyBlocker/SystemKeyBlocker.cpp \
-    log/logcategoryregistry.cpp
+    log/logcategoryregistry.cpp \
+    log/startuptrace.cpp
 
 # Platform-specific backend handlers (exclude on Windows)
 !win32 {
@@ -191,17 +208,31 @@ HEADERS  += \
     host/HostManager.h \
     host/audiomanager.h \
     host/audiothread.h \
+    host/audiocapturetap.h \
     host/cameramanager.h \
     host/usbcontrol.h \
     host/multimediabackend.h \
     host/imagecapturer.h \
+    host/framebus.h \
+    host/framelatency.h \
+    host/presentationqueue.h \
+    host/frametiming.h \
+    host/recordingsegmenter.h \
     host/backend/qtmultimediabackendhandler.h \
     host/backend/qtbackendhandler.h \
     host/backend/ffmpegbackendhandler.h \
     host/backend/ffmpeg/capturethread.h \
     host/backend/ffmpeg/ffmpeg_hardware_accelerator.h \
     host/backend/ffmpeg/ffmpeg_device_manager.h \
+    host/backend/ffmpeg/ffmpeg_replay_source.h \
     host/backend/ffmpeg/ffmpeg_frame_processor.h \
+    host/backend/ffmpeg/ffmpeg_frame_pool.h \
+    host/backend/ffmpeg/ffmpeg_decode_governor.h \
+    host/backend/ffmpeg/ffmpeg_pixel_converter.h \
+    host/backend/ffmpeg/ffmpeg_frame_diff.h \
+    host/backend/ffmpeg/ffmpeg_decode_pipeline.h \
+    host/backend/ffmpeg/ffmpeg_restart_decoder.h \
+    host/backend/ffmpeg/ffmpeg_capability_cache.h \
     host/backend/ffmpeg/ffmpeg_amd_detector.h \
     host/backend/ffmpeg/ffmpeg_recorder.h \
     host/backend/ffmpeg/ffmpeg_device_validator.h \
@@ -263,6 +294,7 @@ HEADERS  += \
     ui/mainwindow.h \
     ui/splashscreen.h \
     ui/videopane.h \
+    ui/glvideoitem.h \
     ui/statusevents.h \
     ui/languagemanager.h \
     ui/screensavermanager.h \
@@ -295,6 +327,7 @@ HEADERS  += \
     ui/advance/wchflash/WCHFlashDialog.h \
     ui/advance/keyboardmapeditor.h \
     ui/initializer/mainwindowinitializer.h \
+    ui/initializer/startuptaskgraph.h \
     ui/statusbar/statusbarmanager.h \
     ui/statusbar/statuswidget.h \
     ui/cornerwidget/cornerwidgetmanager.h \
@@ -320,7 +353,8 @@ HEADERS  += \
     ui/customkey/virtualkeyboardpage.h \
     SysKeyBlocker/SystemKeyBlocker.h \
     log/logcategoryregistry.h \
-    log/opflogging.h
+    log/opflogging.h \
+    log/startuptrace.h
 
 FORMS    += \
     ui/mainwindow.ui \
@@ -54,6 +54,7 @@ static constexpr uint8_t SCANCODE_SCROLLLOCK = 0x47;
 
 
 #include "log/opflogging.h"
+#include "log/startuptrace.h"
 
 // Legacy category kept for other translation units that Q_DECLARE_LOGGING_CATEGORY(log_core_serial).
 // SerialPortManager.cpp itself uses the fine-grained sub-categories below.
@@ -729,6 +730,7 @@ bool SerialPortManager::completeSwitchSerialPort(const DeviceInfo& selectedDevic
  * This method now runs in the worker thread due to QueuedConnection
  */
 void SerialPortManager::onSerialPortConnected(const QString &portName){
+    OPF_STARTUP_SPAN("SerialPortManager::onSerialPortConnected", "serial");
     qCDebug(log_core_serial_conn) << "Serial port connected: " << portName;
     // Also explicitly log during diagnostics
     if (!m_logFilePath.contains("serial_log.txt")) {
@@ -878,6 +880,7 @@ void SerialPortManager::initializeCH32V208Sync(const QString &portName) {
     storeBaudrateIfNeeded(BAUDRATE_HIGHSPEED);
     
     // CH32V208 only supports 115200; ensure the port is opened at 115200 before signalling success
+    OPF_STARTUP_SPAN("CH32V208 open", "serial");
     if (openPort(portName, BAUDRATE_HIGHSPEED)) {
         // Give the port a moment to stabilize
         QThread::msleep(100);
@@ -939,6 +942,8 @@ void SerialPortManager::attemptCH9329Connection(const QString &portName, const Q
     int currentBaud = baudOrder[baudIndex];
     qCDebug(log_core_serial_conn) << "Attempting to open port" << portName << "at baud" << currentBaud << "(cycle" << (cycle + 1) << "of" << maxCycles << ")";
 
+    const char* probeSpan = currentBaud == BAUDRATE_HIGHSPEED ? "CH9329 probe 115200" : "CH9329 probe 9600";
+    StartupTrace::instance().begin(probeSpan, "serial");
     if (openPort(portName, currentBaud)) {
         // Give the port a moment to stabilize
         QThread::msleep(50);
@@ -966,6 +971,7 @@ void SerialPortManager::attemptCH9329Connection(const QString &portName, const Q
                     m_commandCoordinator->setReady(true);
                 }
 
+                StartupTrace::instance().end(probeSpan, "serial");
                 emit serialPortConnectionSuccess(portName);
                 return;
             }
@@ -977,6 +983,7 @@ void SerialPortManager::attemptCH9329Connection(const QString &portName, const Q
         // Small delay before next attempt
         QThread::msleep(100);
     }
+    StartupTrace::instance().end(probeSpan, "serial");
 
     // Try next baudrate
     attemptCH9329Connection(portName, baudOrder, baudIndex + 1, cycle, maxCycles);
@@ -64,6 +64,7 @@
 #define MCP_TOOL_EXECUTE_SCRIPT            "execute_script"
 #define MCP_TOOL_VALIDATE_SCRIPT           "validate_script"
 #define MCP_TOOL_SYSTEM_STATUS             "system_status"
+#define MCP_TOOL_FRAME_TIMING              "frame_timing"
 #define MCP_TOOL_USB_SWITCH                "usb_switch"
 #define MCP_TOOL_FIRMWARE_CHECK            "firmware_check"
 #define MCP_TOOL_FIRMWARE_UPDATE           "firmware_update"
@@ -24,6 +24,8 @@
 #include "mcpProtocol.h"
 #include "host/HostManager.h"
 #include "host/cameramanager.h"
+#include "host/framebus.h"
+#include "host/frametiming.h"
 #include "target/MouseManager.h"
 #include "target/KeyboardManager.h"
 #include "scripts/KeyboardMouse.h"
@@ -238,12 +240,14 @@ QJsonArray McpToolHandler::listTools() const
     {
         QJsonObject tool;
         tool["name"] = MCP_TOOL_CAPTURE_SCREEN;
-        tool["description"] = "Capture the current screen from the target computer via the video input. Returns a JPEG image encoded in base64.";
+        tool["description"] = "Capture the current screen from the target computer via the video input. Returns a JPEG image encoded in base64 "
+                              "and the frame's sequence number; pass that as since_sequence to skip the image while the screen is unchanged.";
 
         QJsonObject schema;
         schema["type"] = "object";
         QJsonObject props;
-        props["quality"] = QJsonObject{{"type", "integer"}, {"description", "JPEG quality (1-100)"}, {"default", 90}, {"minimum", 1}, {"maximum", 100}};
+        props["quality"] = QJsonObject{{"type", "integer"}, {"description", "JPEG quality (1-100). Omit to receive the camera's native JPEG without re-encoding"}, {"default", 90}, {"minimum", 1}, {"maximum", 100}};
+        props["since_sequence"] = QJsonObject{{"type", "integer"}, {"description", "Sequence number of a previous capture. If the screen has not changed since, no image is returned"}, {"minimum", 1}};
         schema["properties"] = props;
         schema["required"] = QJsonArray();
         tool["inputSchema"] = schema;
@@ -311,6 +315,23 @@ QJsonArray McpToolHandler::listTools() const
         tools.append(tool);
     }
 
+    // ---- Video Health ----
+    {
+        QJsonObject tool;
+        tool["name"] = MCP_TOOL_FRAME_TIMING;
+        tool["description"] = "Report video capture health as JSON: capture interval, decode time and display present interval "
+                              "(mean, percentiles, jitter) and dropped frames by reason, for a recent window and for the whole capture session.";
+
+        QJsonObject schema;
+        schema["type"] = "object";
+        QJsonObject props;
+        props["window_seconds"] = QJsonObject{{"type", "number"}, {"description", "Only include the last N seconds in the window statistics. Omit for all recorded history (about one minute)"}, {"minimum", 0}};
+        schema["properties"] = props;
+        schema["required"] = QJsonArray();
+        tool["inputSchema"] = schema;
+        tools.append(tool);
+    }
+
     // ---- Firmware Tools ----
     {
         QJsonObject tool;
@@ -363,6 +384,7 @@ QJsonObject McpToolHandler::callTool(const QString& name, const QJsonObject& arg
     if (name == MCP_TOOL_EXECUTE_SCRIPT)             return toolExecuteScript(arguments);
     if (name == MCP_TOOL_VALIDATE_SCRIPT)             return toolValidateScript(arguments);
     if (name == MCP_TOOL_SYSTEM_STATUS)              return toolSystemStatus(arguments);
+    if (name == MCP_TOOL_FRAME_TIMING)               return toolFrameTiming(arguments);
     if (name == MCP_TOOL_USB_SWITCH)                 return toolUsbSwitch(arguments);
     if (name == MCP_TOOL_FIRMWARE_CHECK)             return toolFirmwareCheck(arguments);
     if (name == MCP_TOOL_FIRMWARE_UPDATE)            return toolFirmwareUpdate(arguments);
@@ -680,29 +702,43 @@ QJsonObject McpToolHandler::toolCaptureScreen(const QJsonObject& args)
         return errorResult("CameraManager not initialized");
     }
 
-    int quality = args.value("quality").toInt(90);
-    quality = qBound(1, quality, 100);
-
-    // Get the current frame
-    QImage frame = m_cameraManager->getLatestOriginalFrame();
-    if (frame.isNull()) {
+    VideoFrameHandle frame = m_cameraManager->getLatestFrame();
+    if (!frame) {
         return errorResult("No frame available from camera");
     }
 
-    // Encode as JPEG
-    QBuffer buffer;
-    buffer.open(QIODevice::WriteOnly);
-    if (!frame.save(&buffer, "JPEG", quality)) {
-        return errorResult("Failed to encode frame as JPEG");
+    // The caller's capture still shows exactly this frame
+    const qint64 since = args.value("since_sequence").toVariant().toLongLong();
+    if (since > 0 && frame->unchangedSince(static_cast<quint64>(since))) {
+        QJsonObject unchanged;
+        unchanged["unchanged"] = true;
+        unchanged["sequence"] = static_cast<qint64>(frame->sequence());
+        return textResult(QJsonDocument(unchanged).toJson(QJsonDocument::Compact));
     }
 
-    QByteArray jpegData = buffer.data();
-    buffer.close();
+    // Without an explicit quality the frame's native JPEG is returned as-is:
+    // for MJPEG sources that is the camera's own image, with no re-encode.
+    QByteArray jpegData;
+    if (!args.contains("quality")) {
+        jpegData = frame->jpeg();
+    } else {
+        int quality = qBound(1, args.value("quality").toInt(90), 100);
+        QBuffer buffer(&jpegData);
+        buffer.open(QIODevice::WriteOnly);
+        if (!frame->image().save(&buffer, "JPEG", quality)) {
+            jpegData.clear();
+        }
+    }
+    if (jpegData.isEmpty()) {
+        return errorResult("Failed to encode frame as JPEG");
+    }
 
     QByteArray base64Data = jpegData.toBase64();
 
     QJsonObject content = McpProtocol::imageContent(base64Data, "image/jpeg");
-    QJsonArray contents{ content };
+    QJsonObject sequence;
+    sequence["sequence"] = static_cast<qint64>(frame->sequence());
+    QJsonArray contents{ content, McpProtocol::textContent(QJsonDocument(sequence).toJson(QJsonDocument::Compact)) };
 
     return McpProtocol::toolResult(contents);
 }
@@ -906,6 +942,10 @@ QJsonObject McpToolHandler::toolSystemStatus(const QJsonObject& args)
             camera["frame_width"]  = lastFrame.width();
             camera["frame_height"] = lastFrame.height();
         }
+        // Share of frames identical to their predecessor (FFmpeg backend)
+        FrameBus& bus = FrameBus::instance();
+        camera["frame_sequence"]     = static_cast<qint64>(bus.publishedFrameCount());
+        camera["static_frame_ratio"] = bus.staticFrameRatio();
     } else {
         camera["active"] = false;
         camera["backend"] = "not_loaded";
@@ -925,6 +965,13 @@ QJsonObject McpToolHandler::toolSystemStatus(const QJsonObject& args)
     return textResult(QJsonDocument(status).toJson(QJsonDocument::Compact));
 }
 
+QJsonObject McpToolHandler::toolFrameTiming(const QJsonObject& args)
+{
+    const double seconds = args.value("window_seconds").toDouble(0.0);
+    const qint64 windowMs = seconds > 0 ? static_cast<qint64>(seconds * 1000) : 0;
+    return textResult(QJsonDocument(FrameTimingRecorder::instance().toJson(windowMs)).toJson(QJsonDocument::Compact));
+}
+
 // ==========================================================================
 // USB Control Tool
 // ==========================================================================
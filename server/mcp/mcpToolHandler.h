@@ -77,6 +77,7 @@ private:
     QJsonObject toolExecuteScript(const QJsonObject& args);
     QJsonObject toolValidateScript(const QJsonObject& args);
     QJsonObject toolSystemStatus(const QJsonObject& args);
+    QJsonObject toolFrameTiming(const QJsonObject& args);
     QJsonObject toolUsbSwitch(const QJsonObject& args);
     QJsonObject toolFirmwareCheck(const QJsonObject& args);
     QJsonObject toolFirmwareUpdate(const QJsonObject& args);
@@ -48,7 +48,7 @@ QByteArray TcpResponse::createImageResponse(const QByteArray& imageData, const Q
     return doc.toJson(QJsonDocument::Compact);
 }
 
-QByteArray TcpResponse::createScreenResponse(const QByteArray& base64Data, int width, int height) {
+QByteArray TcpResponse::createScreenResponse(const QByteArray& base64Data, int width, int height, quint64 sequence) {
     QJsonObject response = buildBaseResponse(TypeScreen, Success);
     
     QJsonObject data;
@@ -58,6 +58,9 @@ QByteArray TcpResponse::createScreenResponse(const QByteArray& base64Data, int w
     data["format"] = "jpeg";
     data["encoding"] = "base64";
     data["content"] = QString::fromLatin1(base64Data);
+    if (sequence > 0) {
+        data["sequence"] = static_cast<qint64>(sequence);
+    }
     
     response["data"] = data;
     
@@ -68,6 +71,19 @@ QByteArray TcpResponse::createScreenResponse(const QByteArray& base64Data, int w
     return doc.toJson(QJsonDocument::Compact);
 }
 
+QByteArray TcpResponse::createScreenUnchangedResponse(quint64 sequence) {
+    QJsonObject response = buildBaseResponse(TypeScreen, Success);
+    
+    QJsonObject data;
+    data["unchanged"] = true;
+    data["sequence"] = static_cast<qint64>(sequence);
+    
+    response["data"] = data;
+    
+    QJsonDocument doc(response);
+    return doc.toJson(QJsonDocument::Compact);
+}
+
 QByteArray TcpResponse::createStatusResponse(const QString& status, const QString& message) {
     QJsonObject response = buildBaseResponse(TypeStatus, Success);
     
@@ -85,6 +101,14 @@ QByteArray TcpResponse::createStatusResponse(const QString& status, const QStrin
     return doc.toJson(QJsonDocument::Compact);
 }
 
+QByteArray TcpResponse::createFrameTimingResponse(const QJsonObject& timing) {
+    QJsonObject response = buildBaseResponse(TypeFrameTiming, Success);
+    response["data"] = timing;
+    
+    QJsonDocument doc(response);
+    return doc.toJson(QJsonDocument::Compact);
+}
+
 QJsonObject TcpResponse::buildBaseResponse(ResponseType type, ResponseStatus status) {
     QJsonObject response;
     response["type"] = responseTypeToString(type);
@@ -100,6 +124,7 @@ QString TcpResponse::responseTypeToString(ResponseType type) {
         case TypeScreen: return "screen";
         case TypeStatus: return "status";
         case TypeError: return "error";
+        case TypeFrameTiming: return "frame_timing";
         case TypeUnknown: return "unknown";
         default: return "unknown";
     }
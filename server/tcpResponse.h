@@ -21,6 +21,7 @@ public:
         TypeScreen,
         TypeStatus,
         TypeError,
+        TypeFrameTiming,
         TypeUnknown
     };
 
@@ -28,8 +29,10 @@ public:
     static QByteArray createSuccessResponse(ResponseType type, const QString& message = "");
     static QByteArray createErrorResponse(const QString& errorMessage);
     static QByteArray createImageResponse(const QByteArray& imageData, const QString& format = "raw", const QString& captureTime = "", const QString& filePath = "");
-    static QByteArray createScreenResponse(const QByteArray& base64Data, int width, int height);
+    static QByteArray createScreenResponse(const QByteArray& base64Data, int width, int height, quint64 sequence = 0);
+    static QByteArray createScreenUnchangedResponse(quint64 sequence);
     static QByteArray createStatusResponse(const QString& status, const QString& message = "");
+    static QByteArray createFrameTimingResponse(const QJsonObject& timing);
     
 private:
     // Helper methods
@@ -11,15 +11,12 @@
 #include <QFileInfoList>
 #include <QDateTime>
 #include "../host/cameramanager.h"
-
-#ifndef Q_OS_WIN
-#include "../host/backend/gstreamerbackendhandler.h"
-#endif
+#include "../host/frametiming.h"
 
 #include "log/opflogging.h"
 OPF_LOGGING_CATEGORY(log_server_tcp, "opf.server.tcp")
 
-TcpServer::TcpServer(QObject *parent) : QTcpServer(parent), currentClient(nullptr), m_cameraManager(nullptr), actionStatus(Finish) {}
+TcpServer::TcpServer(QObject *parent) : QTcpServer(parent), currentClient(nullptr), m_cameraManager(nullptr), m_screenSinceSequence(0), m_frameTimingWindowMs(0), actionStatus(Finish) {}
 
 void TcpServer::startServer(quint16 port) {
     if (this->listen(QHostAddress::Any, port)) {
@@ -72,54 +69,27 @@ QImage TcpServer::getCurrentFrameFromCamera() {
     return m_currentFrame;
 }
 
-#ifndef Q_OS_WIN
-QImage TcpServer::captureFrameFromGStreamer() {
-    if (!m_cameraManager || !m_cameraManager->isGStreamerBackend()) {
-        return QImage();
-    }
-    
-    // GStreamer is only available on non-Windows platforms
-    GStreamerBackendHandler* gstBackend = m_cameraManager->getGStreamerBackend();
-    if (!gstBackend) {
-        qCDebug(log_server_tcp) << "Error: Could not get GStreamer backend";
-        return QImage();
-    }
-    
-    try {
-        // Use the GStreamer backend's takeImage method
-        // Save to a temporary file in the temp directory
-        QString tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation) + "/openterface_gst_frame.jpg";
-        gstBackend->takeImage(tempPath);
-        
-        // Load the image from the temp file
-        QImage image(tempPath);
-        
-        // Delete the temp file
-        QFile::remove(tempPath);
-        
-        if (!image.isNull()) {
-            qCDebug(log_server_tcp) << "Successfully captured frame from GStreamer backend, size:" << image.size();
-        } else {
-            qCDebug(log_server_tcp) << "Failed to load image from GStreamer temp file";
-        }
-        
-        return image;
-    } catch (const std::exception &e) {
-        qCDebug(log_server_tcp) << "Exception while capturing from GStreamer:" << e.what();
-        return QImage();
-    }
-}
-#endif
-
 ActionCommand TcpServer::parseCommand(const QByteArray& data){
     QString command = QString(data).trimmed().toLower();
 
     if (command == "lastimage"){
         return CmdGetLastImage;
-    }else if(command == "gettargetscreen") {
+    }else if(command == "gettargetscreen" || command.startsWith("gettargetscreen ")) {
+        // Optional argument: the sequence of the frame the client already has
+        bool ok = false;
+        m_screenSinceSequence = command.section(' ', 1, 1, QString::SectionSkipEmpty).toULongLong(&ok);
+        if (!ok) {
+            m_screenSinceSequence = 0;
+        }
         return CmdGetTargetScreen;
     }else if(command == "checkstatus") {
         return CheckStatus;
+    }else if(command == "getframetiming" || command.startsWith("getframetiming ")) {
+        // Optional argument: statistics window in seconds
+        bool ok = false;
+        const double seconds = command.section(' ', 1, 1, QString::SectionSkipEmpty).toDouble(&ok);
+        m_frameTimingWindowMs = (ok && seconds > 0) ? static_cast<qint64>(seconds * 1000) : 0;
+        return CmdGetFrameTiming;
     }else{
         scriptStatement = QString::fromUtf8(data);
         return ScriptCommand;
@@ -230,8 +200,6 @@ void TcpServer::sendImageToClient(){
 
 void TcpServer::sendScreenToClient(){
     try {
-        QImage frameToSend;
-        
         if (!m_cameraManager) {
             QByteArray responseData = TcpResponse::createErrorResponse("CameraManager not initialized. Call setCameraManager() first.");
             qCDebug(log_server_tcp) << "Error: CameraManager not set";
@@ -242,39 +210,37 @@ void TcpServer::sendScreenToClient(){
             return;
         }
         
-        if (m_cameraManager->isFFmpegBackend()) {
-            // FFmpeg backend - use the native-resolution original frame so that the
-            // client receives the true camera resolution, not the display-scaled copy.
-            frameToSend = m_cameraManager->getLatestOriginalFrame();
-            if (frameToSend.isNull()) {
-                QByteArray responseData = TcpResponse::createErrorResponse("No frame available from FFmpeg backend. Camera may not be running or no frames captured yet.");
-                qCDebug(log_server_tcp) << "Error: No frame captured yet from FFmpeg backend";
-                if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
-                    currentClient->write(responseData);
-                    currentClient->flush();
-                }
-                return;
+        if (!m_cameraManager->isFFmpegBackend() && !m_cameraManager->isGStreamerBackend()) {
+            QByteArray responseData = TcpResponse::createErrorResponse("Unknown or unsupported backend. Please check your multimedia context setup.");
+            qCDebug(log_server_tcp) << "Error: Unable to determine active backend";
+            if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
+                currentClient->write(responseData);
+                currentClient->flush();
             }
+            return;
         }
-#ifndef Q_OS_WIN
-        else if (m_cameraManager->isGStreamerBackend()) {
-            // GStreamer backend - capture frame directly
-            qCDebug(log_server_tcp) << "Capturing frame from GStreamer backend";
-            frameToSend = captureFrameFromGStreamer();
-            if (frameToSend.isNull()) {
-                QByteArray responseData = TcpResponse::createErrorResponse("Failed to capture frame from GStreamer backend. Check if camera is running.");
-                qCDebug(log_server_tcp) << "Error: GStreamer frame capture returned null";
-                if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
-                    currentClient->write(responseData);
-                    currentClient->flush();
-                }
-                return;
+
+        // Native-resolution frame from the frame bus, so that the client receives
+        // the true camera resolution rather than the display-scaled copy. For
+        // GStreamer this grabs a fresh sample in memory.
+        VideoFrameHandle frame = m_cameraManager->getLatestFrame();
+        if (!frame) {
+            QByteArray responseData = TcpResponse::createErrorResponse(m_cameraManager->isFFmpegBackend()
+                ? "No frame available from FFmpeg backend. Camera may not be running or no frames captured yet."
+                : "Failed to capture frame from GStreamer backend. Check if camera is running.");
+            qCDebug(log_server_tcp) << "Error: No frame available from the frame bus";
+            if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
+                currentClient->write(responseData);
+                currentClient->flush();
             }
+            return;
         }
-#endif
-        else {
-            QByteArray responseData = TcpResponse::createErrorResponse("Unknown or unsupported backend. Please check your multimedia context setup.");
-            qCDebug(log_server_tcp) << "Error: Unable to determine active backend";
+        
+        // The client's frame still shows exactly this: no JPEG, no base64
+        if (m_screenSinceSequence > 0 && frame->unchangedSince(m_screenSinceSequence)) {
+            QByteArray responseData = TcpResponse::createScreenUnchangedResponse(frame->sequence());
+            qCDebug(log_server_tcp) << "Screen unchanged since frame" << m_screenSinceSequence
+                                   << "- current frame" << frame->sequence();
             if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
                 currentClient->write(responseData);
                 currentClient->flush();
@@ -282,33 +248,30 @@ void TcpServer::sendScreenToClient(){
             return;
         }
         
-        // Encode frame as JPEG to memory
-        QBuffer buffer;
-        buffer.open(QIODevice::WriteOnly);
-        
-        if (!frameToSend.save(&buffer, "JPEG", 90)) {
+        // MJPEG sources hand over the camera's own JPEG; others are encoded once per frame
+        QByteArray jpegData = frame->jpeg();
+        if (jpegData.isEmpty()) {
             QByteArray responseData = TcpResponse::createErrorResponse("Failed to encode frame as JPEG. Image may be corrupted.");
             qCDebug(log_server_tcp) << "Error: Failed to encode frame as JPEG";
             if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
                 currentClient->write(responseData);
                 currentClient->flush();
             }
-            buffer.close();
             return;
         }
-        
-        QByteArray jpegData = buffer.data();
-        buffer.close();
+        const QSize frameSize = frame->jpegSize();
         
         // Create base64 encoded response
         QByteArray base64Data = jpegData.toBase64();
-        QByteArray responseData = TcpResponse::createScreenResponse(base64Data, frameToSend.width(), frameToSend.height());
+        QByteArray responseData = TcpResponse::createScreenResponse(base64Data, frameSize.width(), frameSize.height(),
+                                                                    frame->sequence());
         
         if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
             currentClient->write(responseData);
             qCDebug(log_server_tcp) << "Screen data captured - JPEG size:" << jpegData.size() 
                                    << "bytes, Base64 size:" << base64Data.size() 
-                                   << "bytes, Resolution:" << frameToSend.width() << "x" << frameToSend.height();
+                                   << "bytes, Resolution:" << frameSize.width() << "x" << frameSize.height()
+                                   << (frame->hasMjpeg() ? "(camera JPEG)" : "(encoded)");
             currentClient->flush();
         }
     } catch (const std::exception &e) {
@@ -321,6 +284,16 @@ void TcpServer::sendScreenToClient(){
     }
 }
 
+void TcpServer::sendFrameTimingToClient(){
+    QByteArray responseData = TcpResponse::createFrameTimingResponse(
+        FrameTimingRecorder::instance().toJson(m_frameTimingWindowMs));
+    if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
+        currentClient->write(responseData);
+        qCDebug(log_server_tcp) << "Sending frame timing, window:" << m_frameTimingWindowMs << "ms";
+        currentClient->flush();
+    }
+}
+
 void TcpServer::processCommand(ActionCommand cmd){
     QByteArray responseData;
     switch (cmd)
@@ -334,6 +307,9 @@ void TcpServer::processCommand(ActionCommand cmd){
     case CheckStatus:
         correponseClientStauts();
         break;
+    case CmdGetFrameTiming:
+        sendFrameTimingToClient();
+        break;
     default:
         compileScript();
         break;
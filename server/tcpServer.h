@@ -12,15 +12,13 @@
 #include "tcpResponse.h"
 
 class CameraManager;
-#ifndef Q_OS_WIN
-class GStreamerBackendHandler;
-#endif
 
 enum ActionCommand {
     CmdUnknow = -1,
     CmdGetLastImage,
     CmdGetTargetScreen,
     CheckStatus,
+    CmdGetFrameTiming,
     ScriptCommand
 };
 
@@ -56,14 +54,14 @@ private:
     QTcpSocket *currentClient;
     QString lastImgPath;
     CameraManager* m_cameraManager;
+    quint64 m_screenSinceSequence;  // "gettargetscreen <N>": sequence the client already has, 0 = none
+    qint64 m_frameTimingWindowMs;   // "getframetiming <seconds>": statistics window, 0 = all recorded
     QImage m_currentFrame;
     QMutex m_frameMutex;
     ActionCommand parseCommand(const QByteArray& data);
     void sendImageToClient();
     void sendScreenToClient();
-#ifndef Q_OS_WIN
-    QImage captureFrameFromGStreamer();
-#endif
+    void sendFrameTimingToClient();
     void processCommand(ActionCommand cmd);
     Lexer lexer;
     std::vector<Token> tokens;
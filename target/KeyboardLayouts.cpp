@@ -7,6 +7,7 @@
 #include <QJsonArray>
 #include <QKeySequence>
 #include "log/opflogging.h"
+#include "log/startuptrace.h"
 
 OPF_LOGGING_CATEGORY(log_keyboard_layouts, "opf.host.layouts")
 
@@ -241,6 +242,7 @@ KeyboardLayoutManager& KeyboardLayoutManager::getInstance() {
 }
 
 void KeyboardLayoutManager::loadLayouts(const QString& configDir) {
+    OPF_STARTUP_SPAN("KeyboardLayoutManager::loadLayouts", "startup");
     layouts.clear();
     qCDebug(log_keyboard_layouts) << "Loading keyboard layouts from directory:" << configDir;
 
@@ -0,0 +1,717 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "host/backend/ffmpeg/ffmpeg_frame_processor.h"
+#include "host/backend/ffmpeg/ffmpeg_pixel_converter.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+Q_LOGGING_CATEGORY(log_ffmpeg_backend, "opf.backend.ffmpeg")
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+#endif
+
+/**
+ * @brief Decode throughput benchmark for FFmpegFrameProcessor.
+ *
+ * Pushes MJPEG frames through the processor's decode step with each
+ * strategy the capture path can take:
+ *
+ *   turbojpeg_full   TurboJPEG at native size
+ *   turbojpeg_dct2   TurboJPEG with 1/2 DCT scaling (viewport at half size)
+ *   turbojpeg_dct4   TurboJPEG with 1/4 DCT scaling
+ *   turbojpeg_strips TurboJPEG at native size split on restart markers
+ *                    (captured 4K frames; synthetic ones have no markers)
+ *   libavcodec       libavcodec's MJPEG decoder plus the processor's
+ *                    colour conversion (SIMD or swscale by pixel format)
+ *   swscale          the swscale YUV to BGRA conversion alone, on a frame
+ *                    decoded up front
+ *
+ * and reports frames/s, ns per source pixel, heap allocations per frame
+ * (glibc only) and the peak resident set size while the case ran.
+ *
+ * Frames come from a corpus directory of captured .jpg files, or are
+ * synthesised at 720p, 1080p and 4K in 4:2:0, 4:2:2 and 4:4:4. Not
+ * registered with ctest; run it directly and keep the JSON or CSV next to
+ * the commit it was measured on:
+ *
+ *     ./bench_frame_processor --corpus ~/openterface-frames --format json \
+ *         --label "$(git rev-parse --short HEAD)" --output bench.json
+ */
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Allocation counting. Interposing the glibc allocator catches everything on
+// the decode path: operator new, QImage buffers, av_malloc (posix_memalign)
+// and TurboJPEG's own buffers.
+
+#if defined(__GLIBC__)
+#define OPF_BENCH_COUNTS_ALLOCATIONS 1
+
+std::atomic<quint64> g_allocations{0};
+#endif
+
+qint64 AllocationCount() {
+#ifdef OPF_BENCH_COUNTS_ALLOCATIONS
+    return static_cast<qint64>(g_allocations.load(std::memory_order_relaxed));
+#else
+    return -1;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Peak resident set size. Linux can reset the high-water mark, so each case
+// reports its own peak; elsewhere the figure is the process peak so far.
+
+void ResetPeakRss() {
+#ifdef Q_OS_LINUX
+    QFile clearRefs(QStringLiteral("/proc/self/clear_refs"));
+    if (clearRefs.open(QIODevice::WriteOnly)) {
+        clearRefs.write("5");
+    }
+#endif
+}
+
+qint64 PeakRssKb() {
+#if defined(Q_OS_LINUX)
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (status.open(QIODevice::ReadOnly)) {
+        for (const QByteArray& line : status.readAll().split('\n')) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+            }
+        }
+    }
+#endif
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.PeakWorkingSetSize / 1024);
+    }
+    return -1;
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef Q_OS_MACOS
+        return usage.ru_maxrss / 1024;   // Bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Corpus
+
+struct CorpusFrame {
+    QString name;
+    QByteArray jpeg;
+    QSize size;
+    QString subsampling;   // Pixel format libavcodec decodes it to
+};
+
+struct AvCodecContextDeleter {
+    void operator()(AVCodecContext* context) const { avcodec_free_context(&context); }
+};
+using AvCodecContextPtr = std::unique_ptr<AVCodecContext, AvCodecContextDeleter>;
+
+// Single-threaded, like the capture path, so strategies compare per core
+AvCodecContextPtr OpenMjpegDecoder() {
+    const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+    if (!codec) {
+        return nullptr;
+    }
+    AvCodecContextPtr context(avcodec_alloc_context3(codec));
+    if (!context) {
+        return nullptr;
+    }
+    context->thread_count = 1;
+    if (avcodec_open2(context.get(), codec, nullptr) < 0) {
+        return nullptr;
+    }
+    return context;
+}
+
+AvPacketPtr MakePacket(const QByteArray& jpeg) {
+    AvPacketPtr packet = make_av_packet();
+    if (!packet || av_new_packet(packet.get(), jpeg.size()) < 0) {
+        return nullptr;
+    }
+    std::memcpy(packet->data, jpeg.constData(), jpeg.size());
+    return packet;
+}
+
+AvFramePtr DecodeWithAvcodec(AVCodecContext* context, AVPacket* packet) {
+    AvFramePtr frame = make_av_frame();
+    if (!frame || avcodec_send_packet(context, packet) < 0
+        || avcodec_receive_frame(context, frame.get()) < 0) {
+        return nullptr;
+    }
+    return frame;
+}
+
+// Desktop-like content: a gradient wallpaper, a bright window and rows of
+// dark, high-frequency "text", which is what dominates MJPEG entropy coding
+void FillDesktopPattern(AVFrame* frame) {
+    const int width = frame->width;
+    const int height = frame->height;
+    const int row_height = qMax(8, height / 60);
+    for (int y = 0; y < height; ++y) {
+        uint8_t* luma = frame->data[0] + y * frame->linesize[0];
+        const bool in_window_rows = y > height / 6 && y < height * 2 / 3;
+        const bool text_row = (y / row_height) % 2 == 0 && (y % row_height) < row_height * 3 / 4;
+        for (int x = 0; x < width; ++x) {
+            uint8_t value = static_cast<uint8_t>(40 + x * 60 / width + y * 30 / height);
+            if (in_window_rows && x > width / 8 && x < width * 5 / 8) {
+                value = 235;
+                if (text_row && ((x * 7 ^ y * 3) & 8)) {
+                    value = 24;
+                }
+            }
+            luma[x] = value;
+        }
+    }
+
+    const AVPixFmtDescriptor* descriptor = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+    const int chroma_width = AV_CEIL_RSHIFT(width, descriptor->log2_chroma_w);
+    const int chroma_height = AV_CEIL_RSHIFT(height, descriptor->log2_chroma_h);
+    for (int y = 0; y < chroma_height; ++y) {
+        uint8_t* u = frame->data[1] + y * frame->linesize[1];
+        uint8_t* v = frame->data[2] + y * frame->linesize[2];
+        for (int x = 0; x < chroma_width; ++x) {
+            u[x] = static_cast<uint8_t>(108 + x * 40 / chroma_width);
+            v[x] = static_cast<uint8_t>(118 + y * 20 / chroma_height);
+        }
+    }
+}
+
+QByteArray EncodeJpeg(int width, int height, AVPixelFormat format) {
+    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    if (!codec) {
+        return QByteArray();
+    }
+    AvCodecContextPtr context(avcodec_alloc_context3(codec));
+    if (!context) {
+        return QByteArray();
+    }
+    context->width = width;
+    context->height = height;
+    context->pix_fmt = format;
+    context->color_range = AVCOL_RANGE_JPEG;
+    context->time_base = AVRational{1, 30};
+    context->flags |= AV_CODEC_FLAG_QSCALE;
+    context->global_quality = FF_QP2LAMBDA * 3;   // Close to capture-chip quality
+    if (avcodec_open2(context.get(), codec, nullptr) < 0) {
+        return QByteArray();
+    }
+
+    AvFramePtr frame = make_av_frame();
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    if (av_frame_get_buffer(frame.get(), 0) < 0) {
+        return QByteArray();
+    }
+    FillDesktopPattern(frame.get());
+    frame->quality = context->global_quality;
+    frame->pts = 0;
+
+    AvPacketPtr packet = make_av_packet();
+    QByteArray jpeg;
+    if (avcodec_send_frame(context.get(), frame.get()) >= 0
+        && avcodec_send_frame(context.get(), nullptr) >= 0
+        && avcodec_receive_packet(context.get(), packet.get()) >= 0) {
+        jpeg = QByteArray(reinterpret_cast<const char*>(packet->data), packet->size);
+    }
+    return jpeg;
+}
+
+bool Describe(CorpusFrame* frame) {
+    AvCodecContextPtr decoder = OpenMjpegDecoder();
+    AvPacketPtr packet = MakePacket(frame->jpeg);
+    if (!decoder || !packet) {
+        return false;
+    }
+    AvFramePtr decoded = DecodeWithAvcodec(decoder.get(), packet.get());
+    if (!decoded) {
+        return false;
+    }
+    frame->size = QSize(decoded->width, decoded->height);
+    frame->subsampling = QString::fromLatin1(av_get_pix_fmt_name(static_cast<AVPixelFormat>(decoded->format)));
+    return true;
+}
+
+QList<CorpusFrame> LoadCorpus(const QString& directory) {
+    QList<CorpusFrame> frames;
+    const QFileInfoList files = QDir(directory).entryInfoList(
+        {QStringLiteral("*.jpg"), QStringLiteral("*.jpeg"), QStringLiteral("*.mjpeg")}, QDir::Files, QDir::Name);
+    for (const QFileInfo& info : files) {
+        QFile file(info.absoluteFilePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        CorpusFrame frame;
+        frame.name = info.completeBaseName();
+        frame.jpeg = file.readAll();
+        if (Describe(&frame)) {
+            frames.append(frame);
+        } else {
+            qWarning() << "Skipping undecodable corpus file" << info.fileName();
+        }
+    }
+    return frames;
+}
+
+QList<CorpusFrame> SynthesiseCorpus(const QStringList& sizes) {
+    const struct { const char* name; int width; int height; } kSizes[] = {
+        {"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4k", 3840, 2160},
+    };
+    const struct { const char* name; AVPixelFormat format; } kFormats[] = {
+        {"420", AV_PIX_FMT_YUVJ420P}, {"422", AV_PIX_FMT_YUVJ422P}, {"444", AV_PIX_FMT_YUVJ444P},
+    };
+
+    QList<CorpusFrame> frames;
+    for (const auto& size : kSizes) {
+        if (!sizes.contains(QLatin1String(size.name))) {
+            continue;
+        }
+        for (const auto& format : kFormats) {
+            CorpusFrame frame;
+            frame.name = QStringLiteral("%1-%2").arg(size.name, format.name);
+            frame.jpeg = EncodeJpeg(size.width, size.height, format.format);
+            if (frame.jpeg.isEmpty() || !Describe(&frame)) {
+                qWarning() << "MJPEG encoder cannot produce" << frame.name << "- skipped";
+                continue;
+            }
+            frames.append(frame);
+        }
+    }
+    return frames;
+}
+
+// ---------------------------------------------------------------------------
+// Strategies
+
+enum class Strategy { kTurboFull, kTurboDct2, kTurboDct4, kTurboStrips, kAvcodec, kSwscale };
+
+struct StrategyInfo {
+    Strategy strategy;
+    const char* name;
+};
+
+const StrategyInfo kStrategies[] = {
+    {Strategy::kTurboFull, "turbojpeg_full"},
+    {Strategy::kTurboDct2, "turbojpeg_dct2"},
+    {Strategy::kTurboDct4, "turbojpeg_dct4"},
+    {Strategy::kTurboStrips, "turbojpeg_strips"},
+    {Strategy::kAvcodec, "libavcodec"},
+    {Strategy::kSwscale, "swscale"},
+};
+
+struct Settings {
+    int min_frames = 20;
+    qint64 min_time_ns = 500000000LL;
+};
+
+struct Result {
+    QString frame;
+    QString strategy;
+    QSize size;
+    QString subsampling;
+    QSize output;
+    int frames = 0;
+    double fps = 0.0;
+    double ns_per_pixel = 0.0;
+    double allocations_per_frame = -1.0;   // -1: not measured on this platform
+    qint64 peak_rss_kb = -1;
+    QString skipped;                        // Reason, when the case did not run
+};
+
+constexpr int kWarmUpFrames = 3;
+
+// Runs step (which returns the output size, empty on failure) until both the
+// frame and time minimums are met
+void Measure(const std::function<QSize()>& step, const Settings& settings, Result* result) {
+    for (int i = 0; i < kWarmUpFrames; ++i) {
+        result->output = step();
+        if (result->output.isEmpty()) {
+            result->skipped = QStringLiteral("decode failed");
+            return;
+        }
+    }
+
+    ResetPeakRss();
+    const qint64 allocations_before = AllocationCount();
+    QElapsedTimer timer;
+    timer.start();
+    int frames = 0;
+    while (frames < settings.min_frames || timer.nsecsElapsed() < settings.min_time_ns) {
+        if (step().isEmpty()) {
+            result->skipped = QStringLiteral("decode failed");
+            return;
+        }
+        ++frames;
+    }
+    const qint64 elapsed_ns = timer.nsecsElapsed();
+    const qint64 allocations = AllocationCount() - allocations_before;
+
+    const double pixels = static_cast<double>(result->size.width()) * result->size.height();
+    result->frames = frames;
+    result->fps = frames * 1e9 / elapsed_ns;
+    result->ns_per_pixel = elapsed_ns / (frames * pixels);
+    result->allocations_per_frame = allocations_before >= 0 ? static_cast<double>(allocations) / frames : -1.0;
+    result->peak_rss_kb = PeakRssKb();
+}
+
+Result RunProcessor(const CorpusFrame& frame, Strategy strategy, const Settings& settings) {
+    Result result;
+    result.frame = frame.name;
+    result.size = frame.size;
+    result.subsampling = frame.subsampling;
+
+#ifndef HAVE_LIBJPEG_TURBO
+    if (strategy != Strategy::kAvcodec) {
+        result.skipped = QStringLiteral("built without TurboJPEG");
+        return result;
+    }
+#endif
+
+    AvCodecContextPtr decoder = OpenMjpegDecoder();
+    AvPacketPtr packet = MakePacket(frame.jpeg);
+    if (!decoder || !packet) {
+        result.skipped = QStringLiteral("decoder unavailable");
+        return result;
+    }
+
+    // Fixed quality: the governor would otherwise change the strategy mid-run
+    FFmpegFrameProcessor processor;
+    FFmpegDecodeGovernor::Config governor;
+    governor.budget_ms = 0;
+    processor.ConfigureDecodeGovernor(governor);
+    processor.ConfigureFramePool(frame.size);
+    processor.SetTurboJpegEnabled(strategy != Strategy::kAvcodec);
+    if (strategy == Strategy::kTurboStrips) {
+        processor.ConfigureStripDecode(0);
+    }
+
+    QSize target;
+    QSize expected = frame.size;
+    if (strategy == Strategy::kTurboDct2) {
+        target = frame.size / 2;
+        expected = target;
+    } else if (strategy == Strategy::kTurboDct4) {
+        target = frame.size / 4;
+        expected = target;
+    }
+
+    Measure([&]() {
+        return processor.DecodePacket(packet.get(), decoder.get(), target).image.size();
+    }, settings, &result);
+
+    if (result.skipped.isEmpty() && result.output != expected) {
+        result.skipped = QStringLiteral("strategy not taken (got %1x%2)")
+                             .arg(result.output.width()).arg(result.output.height());
+    }
+    if (result.skipped.isEmpty() && strategy == Strategy::kTurboStrips
+        && processor.GetStripDecodeStats().frames_split == 0) {
+        result.skipped = QStringLiteral("no restart-marker strips (frame too small, no markers or one thread)");
+    }
+    return result;
+}
+
+// Same context setup as FFmpegFrameProcessor::UpdateScalingContext() for a
+// native-size conversion
+Result RunSwscale(const CorpusFrame& frame, const Settings& settings) {
+    Result result;
+    result.frame = frame.name;
+    result.size = frame.size;
+    result.subsampling = frame.subsampling;
+
+    AvCodecContextPtr decoder = OpenMjpegDecoder();
+    AvPacketPtr packet = MakePacket(frame.jpeg);
+    AvFramePtr decoded = decoder && packet ? DecodeWithAvcodec(decoder.get(), packet.get()) : nullptr;
+    if (!decoded) {
+        result.skipped = QStringLiteral("decode failed");
+        return result;
+    }
+
+    const int width = decoded->width;
+    const int height = decoded->height;
+    SwsContext* context = sws_getContext(width, height, static_cast<AVPixelFormat>(decoded->format),
+                                         width, height, AV_PIX_FMT_BGRA, SWS_POINT, nullptr, nullptr, nullptr);
+    if (!context) {
+        result.skipped = QStringLiteral("no swscale context");
+        return result;
+    }
+    const int* coefficients = sws_getCoefficients(SWS_CS_ITU709);
+    sws_setColorspaceDetails(context, coefficients, 1, coefficients, 1, 0, 1 << 16, 1 << 16);
+
+    QImage image(width, height, QImage::Format_ARGB32);
+    uint8_t* dst[1] = {image.bits()};
+    const int dst_stride[1] = {static_cast<int>(image.bytesPerLine())};
+
+    Measure([&]() {
+        const int rows = sws_scale(context, decoded->data, decoded->linesize, 0, height, dst, dst_stride);
+        return rows == height ? image.size() : QSize();
+    }, settings, &result);
+
+    sws_freeContext(context);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Output
+
+QJsonObject ToJson(const Result& result) {
+    QJsonObject json;
+    json["frame"] = result.frame;
+    json["strategy"] = result.strategy;
+    json["width"] = result.size.width();
+    json["height"] = result.size.height();
+    json["subsampling"] = result.subsampling;
+    if (!result.skipped.isEmpty()) {
+        json["skipped"] = result.skipped;
+        return json;
+    }
+    json["outputWidth"] = result.output.width();
+    json["outputHeight"] = result.output.height();
+    json["frames"] = result.frames;
+    json["fps"] = result.fps;
+    json["nsPerPixel"] = result.ns_per_pixel;
+    json["allocationsPerFrame"] = result.allocations_per_frame;
+    json["peakRssKb"] = result.peak_rss_kb;
+    return json;
+}
+
+QString ToText(const QList<Result>& results) {
+    QString text;
+    QTextStream out(&text);
+    out << QStringLiteral("%1 %2 %3 %4 %5 %6\n")
+               .arg(QStringLiteral("frame"), -24).arg(QStringLiteral("strategy"), -16)
+               .arg(QStringLiteral("fps"), 10).arg(QStringLiteral("ns/px"), 8)
+               .arg(QStringLiteral("allocs/f"), 9).arg(QStringLiteral("peakRSS MB"), 11);
+    for (const Result& result : results) {
+        const QString frame = QStringLiteral("%1 (%2)").arg(result.frame, result.subsampling);
+        out << QStringLiteral("%1 %2 ").arg(frame, -24).arg(result.strategy, -16);
+        if (!result.skipped.isEmpty()) {
+            out << "skipped: " << result.skipped << '\n';
+            continue;
+        }
+        out << QStringLiteral("%1 %2 %3 %4\n")
+                   .arg(result.fps, 10, 'f', 1)
+                   .arg(result.ns_per_pixel, 8, 'f', 2)
+                   .arg(result.allocations_per_frame >= 0
+                            ? QString::number(result.allocations_per_frame, 'f', 1) : QStringLiteral("n/a"), 9)
+                   .arg(result.peak_rss_kb >= 0
+                            ? QString::number(result.peak_rss_kb / 1024.0, 'f', 1) : QStringLiteral("n/a"), 11);
+    }
+    return text;
+}
+
+QString ToCsv(const QList<Result>& results, const QString& label) {
+    QString csv = QStringLiteral("label,frame,subsampling,width,height,strategy,output_width,output_height,"
+                                 "frames,fps,ns_per_pixel,allocations_per_frame,peak_rss_kb,skipped\n");
+    for (const Result& result : results) {
+        csv += QStringLiteral("%1,%2,%3,%4,%5,%6,").arg(label, result.frame, result.subsampling)
+                   .arg(result.size.width()).arg(result.size.height()).arg(result.strategy);
+        if (!result.skipped.isEmpty()) {
+            csv += QStringLiteral(",,,,,,,%1\n").arg(result.skipped);
+            continue;
+        }
+        csv += QStringLiteral("%1,%2,%3,%4,%5,%6,%7,\n")
+                   .arg(result.output.width()).arg(result.output.height()).arg(result.frames)
+                   .arg(result.fps, 0, 'f', 2).arg(result.ns_per_pixel, 0, 'f', 3)
+                   .arg(result.allocations_per_frame, 0, 'f', 2).arg(result.peak_rss_kb);
+    }
+    return csv;
+}
+
+}  // namespace
+
+#ifdef OPF_BENCH_COUNTS_ALLOCATIONS
+extern "C" {
+void* malloc(size_t size) __THROW {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) __THROW {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) __THROW {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) __THROW {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) __THROW {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("bench_frame_processor"));
+
+    // The decode path logs per frame at debug level
+    QLoggingCategory::setFilterRules(QStringLiteral("opf.*.debug=false\nopf.*.info=false"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("MJPEG decode throughput of FFmpegFrameProcessor"));
+    parser.addHelpOption();
+    const QCommandLineOption corpusOption(QStringLiteral("corpus"),
+        QStringLiteral("Directory of captured .jpg frames (default: synthetic frames)"), QStringLiteral("dir"));
+    const QCommandLineOption sizesOption(QStringLiteral("sizes"),
+        QStringLiteral("Synthetic frame sizes: 720p,1080p,4k"), QStringLiteral("list"),
+        QStringLiteral("720p,1080p,4k"));
+    const QCommandLineOption strategiesOption(QStringLiteral("strategies"),
+        QStringLiteral("Strategies to run (default: all)"), QStringLiteral("list"));
+    const QCommandLineOption minTimeOption(QStringLiteral("min-time"),
+        QStringLiteral("Minimum measured time per case"), QStringLiteral("ms"), QStringLiteral("500"));
+    const QCommandLineOption minFramesOption(QStringLiteral("min-frames"),
+        QStringLiteral("Minimum measured frames per case"), QStringLiteral("n"), QStringLiteral("20"));
+    const QCommandLineOption formatOption(QStringLiteral("format"),
+        QStringLiteral("Output format: text, json or csv"), QStringLiteral("format"), QStringLiteral("text"));
+    const QCommandLineOption outputOption(QStringLiteral("output"),
+        QStringLiteral("Write the results to file instead of stdout"), QStringLiteral("file"));
+    const QCommandLineOption labelOption(QStringLiteral("label"),
+        QStringLiteral("Label stored with the results, e.g. a commit id"), QStringLiteral("text"));
+    parser.addOptions({corpusOption, sizesOption, strategiesOption, minTimeOption, minFramesOption,
+                       formatOption, outputOption, labelOption});
+    parser.process(app);
+
+    Settings settings;
+    settings.min_time_ns = qMax(0LL, parser.value(minTimeOption).toLongLong()) * 1000000LL;
+    settings.min_frames = qMax(1, parser.value(minFramesOption).toInt());
+
+    const QString format = parser.value(formatOption).toLower();
+    if (format != QLatin1String("text") && format != QLatin1String("json") && format != QLatin1String("csv")) {
+        qCritical() << "Unknown output format" << format;
+        return 2;
+    }
+
+    const QStringList wanted = parser.value(strategiesOption).split(',', Qt::SkipEmptyParts);
+    for (const QString& name : wanted) {
+        const bool known = std::any_of(std::begin(kStrategies), std::end(kStrategies),
+                                       [&name](const StrategyInfo& info) { return name == QLatin1String(info.name); });
+        if (!known) {
+            qCritical() << "Unknown strategy" << name;
+            return 2;
+        }
+    }
+
+    const QList<CorpusFrame> corpus = parser.isSet(corpusOption)
+        ? LoadCorpus(parser.value(corpusOption))
+        : SynthesiseCorpus(parser.value(sizesOption).toLower().split(',', Qt::SkipEmptyParts));
+    if (corpus.isEmpty()) {
+        qCritical() << "No frames to benchmark";
+        return 1;
+    }
+
+    QList<Result> results;
+    for (const CorpusFrame& frame : corpus) {
+        for (const StrategyInfo& info : kStrategies) {
+            if (!wanted.isEmpty() && !wanted.contains(QLatin1String(info.name))) {
+                continue;
+            }
+            Result result = info.strategy == Strategy::kSwscale ? RunSwscale(frame, settings)
+                                                                : RunProcessor(frame, info.strategy, settings);
+            result.strategy = QLatin1String(info.name);
+            results.append(result);
+        }
+    }
+
+    const QString label = parser.value(labelOption);
+    QByteArray output;
+    if (format == QLatin1String("json")) {
+        QJsonArray entries;
+        for (const Result& result : results) {
+            entries.append(ToJson(result));
+        }
+        QJsonObject json;
+        json["benchmark"] = QStringLiteral("frame_processor");
+        json["label"] = label;
+        json["avcodec"] = QString::fromLatin1(LIBAVCODEC_IDENT);
+        json["simd"] = QString::fromLatin1(FFmpegPixelConverter::IsaName(FFmpegPixelConverter::Best().isa));
+#ifdef HAVE_LIBJPEG_TURBO
+        json["turbojpeg"] = true;
+#else
+        json["turbojpeg"] = false;
+#endif
+        json["minTimeMs"] = settings.min_time_ns / 1000000;
+        json["minFrames"] = settings.min_frames;
+        json["results"] = entries;
+        output = QJsonDocument(json).toJson(QJsonDocument::Indented);
+    } else if (format == QLatin1String("csv")) {
+        output = ToCsv(results, label).toUtf8();
+    } else {
+        output = ToText(results).toUtf8();
+    }
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(output) != output.size()) {
+            qCritical() << "Cannot write" << file.fileName() << ":" << file.errorString();
+            return 1;
+        }
+        // Keep a readable summary on the terminal
+        if (format != QLatin1String("text")) {
+            QTextStream(stdout) << ToText(results);
+        }
+    } else {
+        QTextStream(stdout) << output;
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <QTest>
+#include <QImage>
+#include <vector>
+#include "host/backend/ffmpeg/ffmpeg_pixel_converter.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+/**
+ * @brief Micro-benchmark: FFmpegPixelConverter against sws_scale.
+ *
+ * Converts one 720p / 1080p / 4K frame of each raw capture format to RGB32
+ * with the best SIMD kernels, the scalar kernels and a cached sws_scale
+ * context (SWS_POINT, no scaling - the cheapest thing swscale can do).
+ * Not registered with ctest; run it directly:
+ *
+ *     ./bench_pixel_converter -median 5
+ */
+class BenchPixelConverter : public QObject {
+    Q_OBJECT
+
+    enum Method { kBest, kScalar, kSwscale };
+
+    struct Planes {
+        std::vector<uint8_t> data[3];
+        int stride[3] = {0, 0, 0};
+    };
+
+    static Planes MakeFrame(AVPixelFormat format, int width, int height) {
+        Planes planes;
+        auto fill = [](std::vector<uint8_t>& plane, int size) {
+            plane.resize(size);
+            for (int i = 0; i < size; ++i) {
+                plane[i] = static_cast<uint8_t>((i * 7) ^ (i >> 5));
+            }
+        };
+        const int chroma_width = (width + 1) / 2;
+        const int chroma_height = (height + 1) / 2;
+        switch (format) {
+        case AV_PIX_FMT_BGR24:
+            planes.stride[0] = width * 3;
+            fill(planes.data[0], planes.stride[0] * height);
+            break;
+        case AV_PIX_FMT_YUYV422:
+            planes.stride[0] = chroma_width * 4;
+            fill(planes.data[0], planes.stride[0] * height);
+            break;
+        case AV_PIX_FMT_NV12:
+            planes.stride[0] = width;
+            planes.stride[1] = chroma_width * 2;
+            fill(planes.data[0], width * height);
+            fill(planes.data[1], planes.stride[1] * chroma_height);
+            break;
+        default:  // YUVJ420P
+            planes.stride[0] = width;
+            planes.stride[1] = planes.stride[2] = chroma_width;
+            fill(planes.data[0], width * height);
+            fill(planes.data[1], chroma_width * chroma_height);
+            fill(planes.data[2], chroma_width * chroma_height);
+            break;
+        }
+        return planes;
+    }
+
+    static void AddRows() {
+        QTest::addColumn<int>("format");
+        QTest::addColumn<int>("width");
+        QTest::addColumn<int>("height");
+        const struct { AVPixelFormat format; const char* name; } formats[] = {
+            {AV_PIX_FMT_BGR24, "bgr24"},
+            {AV_PIX_FMT_YUYV422, "yuyv422"},
+            {AV_PIX_FMT_NV12, "nv12"},
+            {AV_PIX_FMT_YUVJ420P, "yuvj420p"},
+        };
+        const struct { int width; int height; const char* name; } sizes[] = {
+            {1280, 720, "720p"}, {1920, 1080, "1080p"}, {3840, 2160, "4k"},
+        };
+        for (const auto& format : formats) {
+            for (const auto& size : sizes) {
+                QTest::addRow("%s-%s", format.name, size.name)
+                    << static_cast<int>(format.format) << size.width << size.height;
+            }
+        }
+    }
+
+    static void Run(Method method) {
+        QFETCH(int, format);
+        QFETCH(int, width);
+        QFETCH(int, height);
+        const AVPixelFormat pixel_format = static_cast<AVPixelFormat>(format);
+
+        Planes planes = MakeFrame(pixel_format, width, height);
+        QImage image(width, height, QImage::Format_RGB32);
+
+        if (method == kSwscale) {
+            SwsContext* context = sws_getContext(width, height, pixel_format, width, height,
+                                                 AV_PIX_FMT_BGRA, SWS_POINT, nullptr, nullptr, nullptr);
+            QVERIFY(context);
+            const uint8_t* src[4] = {planes.data[0].data(), planes.data[1].data(), planes.data[2].data(), nullptr};
+            const int src_stride[4] = {planes.stride[0], planes.stride[1], planes.stride[2], 0};
+            uint8_t* dst[4] = {image.bits(), nullptr, nullptr, nullptr};
+            const int dst_stride[4] = {static_cast<int>(image.bytesPerLine()), 0, 0, 0};
+            QBENCHMARK {
+                sws_scale(context, src, src_stride, 0, height, dst, dst_stride);
+            }
+            sws_freeContext(context);
+            return;
+        }
+
+        AVFrame* frame = av_frame_alloc();
+        QVERIFY(frame);
+        frame->format = pixel_format;
+        frame->width = width;
+        frame->height = height;
+        for (int i = 0; i < 3; ++i) {
+            frame->data[i] = planes.data[i].empty() ? nullptr : planes.data[i].data();
+            frame->linesize[i] = planes.stride[i];
+        }
+
+        if (method == kBest) {
+            QBENCHMARK {
+                FFmpegPixelConverter::ConvertFrame(frame, &image);
+            }
+        } else {
+            const FFmpegPixelConverter::Kernels& scalar =
+                FFmpegPixelConverter::Get(FFmpegPixelConverter::Isa::kScalar);
+            const FFmpegPixelConverter::Range range = pixel_format == AV_PIX_FMT_YUVJ420P
+                ? FFmpegPixelConverter::Range::kFull : FFmpegPixelConverter::Range::kLimited;
+            uint8_t* out = image.bits();
+            const int out_stride = static_cast<int>(image.bytesPerLine());
+            QBENCHMARK {
+                switch (pixel_format) {
+                case AV_PIX_FMT_BGR24:
+                    scalar.bgr24(frame->data[0], frame->linesize[0], out, out_stride, width, height);
+                    break;
+                case AV_PIX_FMT_YUYV422:
+                    scalar.yuyv422(frame->data[0], frame->linesize[0], out, out_stride, width, height, range);
+                    break;
+                case AV_PIX_FMT_NV12:
+                    scalar.nv12(frame->data[0], frame->linesize[0], frame->data[1], frame->linesize[1],
+                                out, out_stride, width, height, range);
+                    break;
+                default:
+                    scalar.yuv420p(frame->data[0], frame->linesize[0], frame->data[1], frame->linesize[1],
+                                   frame->data[2], frame->linesize[2], out, out_stride, width, height, range);
+                    break;
+                }
+            }
+        }
+
+        // Data pointers belong to the vectors, not to the frame
+        for (int i = 0; i < 3; ++i) {
+            frame->data[i] = nullptr;
+        }
+        av_frame_free(&frame);
+    }
+
+private slots:
+    void initTestCase() {
+        qInfo() << "Best kernels:" << FFmpegPixelConverter::IsaName(FFmpegPixelConverter::Best().isa);
+    }
+
+    void simd_data() { AddRows(); }
+    void simd() { Run(kBest); }
+
+    void scalar_data() { AddRows(); }
+    void scalar() { Run(kScalar); }
+
+    void swscale_data() { AddRows(); }
+    void swscale() { Run(kSwscale); }
+};
+
+QTEST_MAIN(BenchPixelConverter)
+#include "bench_pixel_converter.moc"
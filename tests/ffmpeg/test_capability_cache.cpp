@@ -0,0 +1,170 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include "host/backend/ffmpeg/ffmpeg_capability_cache.h"
+
+Q_LOGGING_CATEGORY(log_ffmpeg_backend, "opf.backend.ffmpeg")
+
+/**
+ * @brief Unit tests for FFmpegCapabilityCache.
+ *
+ * Covers the device key, the JSON round trip through a fresh instance, the
+ * mode matching that decides whether a start can be warm, invalidation, and
+ * that a damaged or outdated file is ignored rather than trusted.
+ */
+class TestCapabilityCache : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir_;
+
+    QString CachePath(const char* name) const {
+        return dir_.filePath(QLatin1String(name));
+    }
+
+    static FFmpegCapabilityCache::Mode MakeMode(const char* format, int width, int height, QList<int> rates) {
+        FFmpegCapabilityCache::Mode mode;
+        mode.pixel_format = QLatin1String(format);
+        mode.resolution = QSize(width, height);
+        mode.framerates = rates;
+        return mode;
+    }
+
+private slots:
+    void initTestCase() {
+        QVERIFY(dir_.isValid());
+    }
+
+    void testMakeKey() {
+        QCOMPARE(FFmpegCapabilityCache::MakeKey("534D", "2109", "1-2.4"),
+                 QStringLiteral("534d:2109|1-2.4"));
+        QCOMPARE(FFmpegCapabilityCache::MakeKey(" 534d", "", "1-2"),
+                 QStringLiteral("534d:unknown|1-2"));
+        QVERIFY(FFmpegCapabilityCache::MakeKey("534d", "2109", "1-2")
+                != FFmpegCapabilityCache::MakeKey("534d", "2109", "1-3"));
+    }
+
+    void testRoundTrip() {
+        const QString path = CachePath("roundtrip.json");
+        const QString key = FFmpegCapabilityCache::MakeKey("534d", "2109", "1-1");
+        {
+            FFmpegCapabilityCache cache(path);
+            cache.RecordOpen(key, "/dev/video2", "mjpeg", QSize(1920, 1080), 60);
+            QVERIFY(cache.UpdateModes(key, {MakeMode("mjpeg", 1920, 1080, {60, 30}),
+                                            MakeMode("yuyv422", 1920, 1080, {5})}));
+            cache.RecordFirstFrame(key, false, 850);
+            cache.RecordFirstFrame(key, true, 120);
+        }
+        QVERIFY(QFile::exists(path));
+
+        FFmpegCapabilityCache reloaded(path);
+        FFmpegCapabilityCache::Entry entry;
+        QVERIFY(reloaded.Lookup(key, &entry));
+        QCOMPARE(entry.device_path, QStringLiteral("/dev/video2"));
+        QCOMPARE(entry.input_format, QStringLiteral("mjpeg"));
+        QCOMPARE(entry.open_resolution, QSize(1920, 1080));
+        QCOMPARE(entry.open_framerate, 60);
+        QCOMPARE(entry.modes.size(), 2);
+        QCOMPARE(entry.modes[0].framerates, QList<int>({60, 30}));
+        QCOMPARE(entry.modes[1].pixel_format, QStringLiteral("yuyv422"));
+        QVERIFY(entry.validated.isValid());
+        QCOMPARE(entry.cold_first_frame_ms, qint64(850));
+        QCOMPARE(entry.warm_first_frame_ms, qint64(120));
+        QVERIFY(reloaded.HasEntryForPath("/dev/video2"));
+        QVERIFY(!reloaded.HasEntryForPath("/dev/video0"));
+
+        // Same modes again: stored, but not reported as a change
+        QVERIFY(!reloaded.UpdateModes(key, entry.modes));
+    }
+
+    void testSupportsWithoutModes() {
+        FFmpegCapabilityCache::Entry entry;
+        entry.input_format = "mjpeg";
+        entry.open_resolution = QSize(1920, 1080);
+        entry.open_framerate = 30;
+
+        QVERIFY(FFmpegCapabilityCache::Supports(entry, QSize(1920, 1080), 30));
+        QVERIFY(FFmpegCapabilityCache::Supports(entry, QSize(1920, 1080), 0));
+        QVERIFY(!FFmpegCapabilityCache::Supports(entry, QSize(1920, 1080), 60));
+        QVERIFY(!FFmpegCapabilityCache::Supports(entry, QSize(1280, 720), 30));
+        QVERIFY(FFmpegCapabilityCache::ChooseFormat(entry, QSize(1280, 720), 30).isEmpty());
+    }
+
+    void testChooseFormatFromModes() {
+        FFmpegCapabilityCache::Entry entry;
+        entry.input_format = "mjpeg";
+        entry.open_resolution = QSize(1920, 1080);
+        entry.open_framerate = 30;
+        entry.modes = {MakeMode("mjpeg", 1920, 1080, {60, 30}),
+                       MakeMode("mjpeg", 1280, 720, {60}),
+                       MakeMode("yuyv422", 640, 480, {30})};
+
+        // Any enumerated mode of the cached format is a warm start
+        QVERIFY(FFmpegCapabilityCache::Supports(entry, QSize(1280, 720), 60));
+        QCOMPARE(FFmpegCapabilityCache::ChooseFormat(entry, QSize(1280, 720), 60), QStringLiteral("mjpeg"));
+
+        // A mode only another format offers switches format
+        QVERIFY(!FFmpegCapabilityCache::Supports(entry, QSize(640, 480), 30));
+        QCOMPARE(FFmpegCapabilityCache::ChooseFormat(entry, QSize(640, 480), 30), QStringLiteral("yuyv422"));
+
+        // A mode nothing offers leaves the choice to probing
+        QVERIFY(!FFmpegCapabilityCache::Supports(entry, QSize(1280, 720), 30));
+        QVERIFY(FFmpegCapabilityCache::ChooseFormat(entry, QSize(3840, 2160), 30).isEmpty());
+    }
+
+    void testInvalidate() {
+        const QString path = CachePath("invalidate.json");
+        const QString key = FFmpegCapabilityCache::MakeKey("534d", "2109", "1-3");
+        FFmpegCapabilityCache cache(path);
+        cache.RecordOpen(key, "/dev/video0", "yuyv422", QSize(1280, 720), 30);
+        QVERIFY(cache.Lookup(key, nullptr));
+
+        cache.Invalidate(key);
+        QVERIFY(!cache.Lookup(key, nullptr));
+        QVERIFY(!FFmpegCapabilityCache(path).Lookup(key, nullptr));
+
+        // Updates to an entry that is gone are ignored
+        QVERIFY(!cache.UpdateModes(key, {MakeMode("mjpeg", 1280, 720, {30})}));
+        cache.RecordFirstFrame(key, true, 10);
+        QVERIFY(!cache.Lookup(key, nullptr));
+    }
+
+    void testEmptyKeyIsNotCached() {
+        const QString path = CachePath("emptykey.json");
+        FFmpegCapabilityCache cache(path);
+        cache.RecordOpen(QString(), "/dev/video0", "mjpeg", QSize(1920, 1080), 30);
+        QVERIFY(!cache.HasEntryForPath("/dev/video0"));
+        QVERIFY(!QFile::exists(path));
+    }
+
+    void testDamagedFileIgnored() {
+        const QString path = CachePath("damaged.json");
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("{\"version\": 1, \"devices\": [");
+        file.close();
+
+        FFmpegCapabilityCache cache(path);
+        QVERIFY(!cache.HasEntryForPath("/dev/video0"));
+
+        // The next write replaces it with a readable file
+        const QString key = FFmpegCapabilityCache::MakeKey("534d", "2109", "1-4");
+        cache.RecordOpen(key, "/dev/video0", "mjpeg", QSize(1920, 1080), 30);
+        QVERIFY(FFmpegCapabilityCache(path).Lookup(key, nullptr));
+    }
+
+    void testOtherVersionIgnored() {
+        const QString path = CachePath("version.json");
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("{\"version\": 999, \"devices\": [{\"key\": \"k\", \"devicePath\": \"/dev/video0\"}]}");
+        file.close();
+
+        FFmpegCapabilityCache cache(path);
+        QVERIFY(!cache.Lookup("k", nullptr));
+        QVERIFY(!cache.HasEntryForPath("/dev/video0"));
+    }
+};
+
+QTEST_MAIN(TestCapabilityCache)
+#include "test_capability_cache.moc"
@@ -0,0 +1,131 @@
+#include <QTest>
+#include <QLoggingCategory>
+#include "host/backend/ffmpeg/ffmpeg_decode_governor.h"
+
+Q_LOGGING_CATEGORY(log_ffmpeg_backend, "opf.backend.ffmpeg")
+
+/**
+ * @brief Unit tests for FFmpegDecodeGovernor.
+ *
+ * Drives the governor with synthetic per-frame decode times and checks that
+ * it steps down on a blown budget, steps up only after sustained headroom,
+ * and backs off when a step up does not hold.
+ */
+class TestDecodeGovernor : public QObject {
+    Q_OBJECT
+
+    static FFmpegDecodeGovernor::Config MakeConfig() {
+        FFmpegDecodeGovernor::Config config;
+        config.budget_ms = 20.0;
+        config.window_frames = 10;
+        config.raise_ratio = 0.5;
+        config.raise_windows = 3;
+        return config;
+    }
+
+    // Feeds whole windows of frames at elapsed_ms; returns how many changed the level
+    static int FeedWindows(FFmpegDecodeGovernor& governor, int windows, double elapsed_ms) {
+        int changes = 0;
+        const int frames = windows * governor.GetConfig().window_frames;
+        for (int i = 0; i < frames; ++i) {
+            changes += governor.RecordFrame(elapsed_ms) ? 1 : 0;
+        }
+        return changes;
+    }
+
+private slots:
+    void testDisabledWithoutBudget() {
+        FFmpegDecodeGovernor::Config config = MakeConfig();
+        config.budget_ms = 0;
+        config.start_level = 3;
+        FFmpegDecodeGovernor governor(config);
+
+        QVERIFY(!governor.IsEnabled());
+        QCOMPARE(governor.GetLevelIndex(), 0);
+        QCOMPARE(FeedWindows(governor, 5, 100.0), 0);
+        QCOMPARE(governor.GetLevelIndex(), 0);
+    }
+
+    void testStepsDownOncePerSlowWindow() {
+        FFmpegDecodeGovernor governor(MakeConfig());
+
+        // A single window is needed before any decision
+        for (int i = 0; i < 9; ++i) {
+            QVERIFY(!governor.RecordFrame(50.0));
+        }
+        QCOMPARE(governor.GetLevelIndex(), 0);
+        QVERIFY(governor.RecordFrame(50.0));
+        QCOMPARE(governor.GetLevelIndex(), 1);
+        QCOMPARE(governor.GetLevel().dct_denominator, 2);
+        QCOMPARE(governor.GetLastAverageMs(), 50.0);
+
+        // Clamped at the last level
+        FeedWindows(governor, FFmpegDecodeGovernor::LevelCount() * 2, 50.0);
+        QCOMPARE(governor.GetLevelIndex(), FFmpegDecodeGovernor::LevelCount() - 1);
+    }
+
+    void testHysteresisBand() {
+        FFmpegDecodeGovernor::Config config = MakeConfig();
+        config.start_level = 2;
+        FFmpegDecodeGovernor governor(config);
+
+        // Between raise threshold (10 ms) and budget (20 ms): hold
+        QCOMPARE(FeedWindows(governor, 10, 15.0), 0);
+        QCOMPARE(governor.GetLevelIndex(), 2);
+
+        // Under the raise threshold: step up only after raise_windows windows
+        QCOMPARE(FeedWindows(governor, 2, 5.0), 0);
+        QCOMPARE(FeedWindows(governor, 1, 5.0), 1);
+        QCOMPARE(governor.GetLevelIndex(), 1);
+
+        // A window in the band resets the streak
+        FeedWindows(governor, 2, 5.0);
+        FeedWindows(governor, 1, 15.0);
+        QCOMPARE(FeedWindows(governor, 2, 5.0), 0);
+        QCOMPARE(governor.GetLevelIndex(), 1);
+    }
+
+    void testFailedRaiseBacksOff() {
+        FFmpegDecodeGovernor::Config config = MakeConfig();
+        config.start_level = 1;
+        FFmpegDecodeGovernor governor(config);
+
+        QCOMPARE(FeedWindows(governor, 3, 5.0), 1);   // Raised to level 0
+        QCOMPARE(governor.GetLevelIndex(), 0);
+        QCOMPARE(FeedWindows(governor, 1, 30.0), 1);  // Did not fit: back to level 1
+        QCOMPARE(governor.GetLevelIndex(), 1);
+
+        // The next raise needs twice as many good windows
+        QCOMPARE(FeedWindows(governor, 5, 5.0), 0);
+        QCOMPARE(FeedWindows(governor, 1, 5.0), 1);
+        QCOMPARE(governor.GetLevelIndex(), 0);
+    }
+
+    void testResetReturnsToStartLevel() {
+        FFmpegDecodeGovernor::Config config = MakeConfig();
+        config.start_level = 1;
+        FFmpegDecodeGovernor governor(config);
+
+        FeedWindows(governor, 3, 50.0);
+        QVERIFY(governor.GetLevelIndex() > 1);
+        governor.Reset();
+        QCOMPARE(governor.GetLevelIndex(), 1);
+    }
+
+    void testDescribe() {
+        QCOMPARE(FFmpegDecodeGovernor::Describe({1, 0}), QString("full"));
+        QCOMPARE(FFmpegDecodeGovernor::Describe({2, 0}), QString("1/2 scale"));
+        QCOMPARE(FFmpegDecodeGovernor::Describe({4, 30}), QString("1/4 scale, 30 fps cap"));
+
+        // Levels only ever get cheaper down the ladder
+        for (int i = 1; i < FFmpegDecodeGovernor::LevelCount(); ++i) {
+            FFmpegDecodeGovernor::Level previous = FFmpegDecodeGovernor::LevelAt(i - 1);
+            FFmpegDecodeGovernor::Level level = FFmpegDecodeGovernor::LevelAt(i);
+            QVERIFY(level.dct_denominator >= previous.dct_denominator);
+            QVERIFY(previous.max_fps == 0 || (level.max_fps > 0 && level.max_fps <= previous.max_fps));
+        }
+    }
+};
+
+QTEST_MAIN(TestDecodeGovernor)
+#include "test_decode_governor.moc"
@@ -0,0 +1,135 @@
+#include <QTest>
+#include <QImage>
+#include <QRandomGenerator>
+#include "host/backend/ffmpeg/ffmpeg_frame_diff.h"
+
+/**
+ * @brief Unit tests for FFmpegFrameDiff.
+ *
+ * Checks that identical frames are reported unchanged, that a change is
+ * located to the tiles it touches (including partial edge tiles and rows
+ * whose width is not a multiple of the SIMD block), and that a resolution
+ * or format change dirties the whole frame.
+ */
+class TestFrameDiff : public QObject {
+    Q_OBJECT
+
+    static QImage MakeNoise(const QSize& size, QImage::Format format, quint32 seed) {
+        QImage image(size, format);
+        QRandomGenerator generator(seed);
+        for (int y = 0; y < image.height(); ++y) {
+            uchar* line = image.scanLine(y);
+            for (qsizetype x = 0; x < image.bytesPerLine(); ++x) {
+                line[x] = static_cast<uchar>(generator.bounded(256));
+            }
+        }
+        return image;
+    }
+
+private slots:
+    void testFirstFrameIsFullyDirty() {
+        FFmpegFrameDiff diff;
+        QImage image = MakeNoise(QSize(200, 100), QImage::Format_RGB32, 1);
+
+        FFmpegFrameDiff::Result result = diff.Compare(image);
+        QVERIFY(result.changed);
+        QCOMPARE(result.total_tiles, 4 * 2);
+        QCOMPARE(result.dirty_tiles, result.total_tiles);
+        QCOMPARE(result.dirty, QRegion(image.rect()));
+    }
+
+    void testIdenticalFrameIsStatic() {
+        FFmpegFrameDiff diff;
+        QImage image = MakeNoise(QSize(1280, 720), QImage::Format_RGB888, 2);
+        diff.Compare(image);
+
+        // A deep copy with the same pixels is not a change
+        FFmpegFrameDiff::Result result = diff.Compare(image.copy());
+        QVERIFY(!result.changed);
+        QCOMPARE(result.dirty_tiles, 0);
+        QVERIFY(result.dirty.isEmpty());
+        QCOMPARE(diff.GetFrameCount(), quint64(2));
+        QCOMPARE(diff.GetStaticFrameCount(), quint64(1));
+        QCOMPARE(diff.GetStaticFrameRatio(), 0.5);
+    }
+
+    void testSinglePixelMarksOneTile() {
+        FFmpegFrameDiff diff;
+        QImage image = MakeNoise(QSize(640, 480), QImage::Format_RGB32, 3);
+        diff.Compare(image);
+
+        QImage next = image.copy();
+        next.setPixel(130, 70, next.pixel(130, 70) ^ 0x00000100u);
+        FFmpegFrameDiff::Result result = diff.Compare(next);
+        QVERIFY(result.changed);
+        QCOMPARE(result.dirty_tiles, 1);
+        QCOMPARE(result.dirty, QRegion(QRect(128, 64, 64, 64)));
+    }
+
+    void testEdgeTilesAreClipped() {
+        // 24-bit rows of 100 pixels end in a partial 16-byte block
+        FFmpegFrameDiff diff;
+        QImage image = MakeNoise(QSize(100, 70), QImage::Format_RGB888, 4);
+        diff.Compare(image);
+
+        QImage next = image.copy();
+        next.scanLine(69)[99 * 3 + 2] ^= 0x01;
+        FFmpegFrameDiff::Result result = diff.Compare(next);
+        QCOMPARE(result.dirty_tiles, 1);
+        QCOMPARE(result.dirty, QRegion(QRect(64, 64, 36, 6)));
+    }
+
+    void testAdjacentTilesMergeIntoRuns() {
+        FFmpegFrameDiff diff;
+        QImage image = MakeNoise(QSize(512, 256), QImage::Format_RGB32, 5);
+        diff.Compare(image);
+
+        QImage next = image.copy();
+        for (int x = 70; x < 250; ++x) {
+            next.setPixel(x, 10, ~next.pixel(x, 10));
+        }
+        FFmpegFrameDiff::Result result = diff.Compare(next);
+        QCOMPARE(result.dirty_tiles, 3);
+        QCOMPARE(result.dirty, QRegion(QRect(64, 0, 192, 64)));
+    }
+
+    void testSwappedBytesAreDetected() {
+        // Same byte sum, different positions
+        FFmpegFrameDiff diff;
+        QImage image(64, 64, QImage::Format_RGB32);
+        image.fill(0);
+        image.setPixel(1, 1, 0x00010203u);
+        diff.Compare(image);
+
+        QImage next(64, 64, QImage::Format_RGB32);
+        next.fill(0);
+        next.setPixel(2, 1, 0x00010203u);
+        QVERIFY(diff.Compare(next).changed);
+    }
+
+    void testSizeOrFormatChangeIsFullyDirty() {
+        FFmpegFrameDiff diff;
+        QImage image = MakeNoise(QSize(256, 256), QImage::Format_RGB32, 6);
+        diff.Compare(image);
+
+        QImage smaller = image.copy(0, 0, 128, 128);
+        FFmpegFrameDiff::Result result = diff.Compare(smaller);
+        QCOMPARE(result.dirty, QRegion(smaller.rect()));
+
+        QImage converted = smaller.convertToFormat(QImage::Format_ARGB32);
+        result = diff.Compare(converted);
+        QVERIFY(result.changed);
+        QCOMPARE(result.dirty_tiles, result.total_tiles);
+    }
+
+    void testResetForgetsPreviousFrame() {
+        FFmpegFrameDiff diff;
+        QImage image = MakeNoise(QSize(128, 128), QImage::Format_RGB32, 7);
+        diff.Compare(image);
+        diff.Reset();
+        QVERIFY(diff.Compare(image).changed);
+    }
+};
+
+QTEST_MAIN(TestFrameDiff)
+#include "test_frame_diff.moc"
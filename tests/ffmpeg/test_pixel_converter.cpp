@@ -0,0 +1,237 @@
+#include <QTest>
+#include <QRandomGenerator>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "host/backend/ffmpeg/ffmpeg_pixel_converter.h"
+
+/**
+ * @brief Unit tests for FFmpegPixelConverter.
+ *
+ * Every SIMD kernel the CPU supports must match the scalar kernel bit for
+ * bit, including the per-row scalar tails at odd widths, and the scalar
+ * kernel must stay within rounding distance of floating-point BT.601.
+ */
+class TestPixelConverter : public QObject {
+    Q_OBJECT
+
+    using Converter = FFmpegPixelConverter;
+
+    // Widths cover empty SIMD bodies, exact multiples and every tail length
+    const std::vector<int> widths_ = {1, 2, 7, 8, 15, 16, 17, 31, 33, 64, 101};
+    const std::vector<int> heights_ = {1, 2, 3, 6};
+
+    static std::vector<uint8_t> RandomBytes(int size) {
+        std::vector<uint8_t> bytes(size);
+        for (uint8_t& byte : bytes) {
+            byte = static_cast<uint8_t>(QRandomGenerator::global()->bounded(256));
+        }
+        return bytes;
+    }
+
+    static bool SameRows(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b,
+                         int stride, int width, int height) {
+        for (int row = 0; row < height; ++row) {
+            if (memcmp(a.data() + row * stride, b.data() + row * stride, width * 4) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static int ReferenceDistance(int y, int u, int v, Converter::Range range, const uint8_t* bgra) {
+        const bool limited = range == Converter::Range::kLimited;
+        const double luma = limited ? (y - 16) * 255.0 / 219.0 : y;
+        const double cb = (u - 128) * (limited ? 255.0 / 224.0 : 1.0);
+        const double cr = (v - 128) * (limited ? 255.0 / 224.0 : 1.0);
+        const double expected[3] = {
+            luma + 1.772 * cb,
+            luma - 0.344136 * cb - 0.714136 * cr,
+            luma + 1.402 * cr,
+        };
+        int distance = 0;
+        for (int i = 0; i < 3; ++i) {
+            const int value = qBound(0, static_cast<int>(std::lround(expected[i])), 255);
+            distance = qMax(distance, qAbs(value - bgra[i]));
+        }
+        return distance;
+    }
+
+    QList<Converter::Isa> simdIsas() const {
+        QList<Converter::Isa> isas;
+        for (Converter::Isa isa : {Converter::Isa::kSse2, Converter::Isa::kAvx2, Converter::Isa::kNeon}) {
+            if (Converter::IsSupported(isa)) {
+                isas.append(isa);
+            }
+        }
+        return isas;
+    }
+
+private slots:
+    void testDispatch() {
+        QVERIFY(Converter::IsSupported(Converter::Isa::kScalar));
+        QVERIFY(Converter::IsSupported(Converter::Best().isa));
+        QCOMPARE(Converter::Get(Converter::Best().isa).isa, Converter::Best().isa);
+        qInfo() << "Best kernels:" << Converter::IsaName(Converter::Best().isa);
+    }
+
+    void testBgr24() {
+        const Converter::Kernels& scalar = Converter::Get(Converter::Isa::kScalar);
+        for (int width : widths_) {
+            for (int height : heights_) {
+                const int src_stride = width * 3 + 5;
+                const int dst_stride = width * 4 + 8;
+                const std::vector<uint8_t> src = RandomBytes(src_stride * height);
+                std::vector<uint8_t> expected(dst_stride * height);
+                scalar.bgr24(src.data(), src_stride, expected.data(), dst_stride, width, height);
+
+                for (int row = 0; row < height; ++row) {
+                    for (int x = 0; x < width; ++x) {
+                        const uint8_t* in = src.data() + row * src_stride + x * 3;
+                        const uint8_t* out = expected.data() + row * dst_stride + x * 4;
+                        QVERIFY(out[0] == in[0] && out[1] == in[1] && out[2] == in[2] && out[3] == 0xFF);
+                    }
+                }
+
+                for (Converter::Isa isa : simdIsas()) {
+                    std::vector<uint8_t> actual(dst_stride * height);
+                    Converter::Get(isa).bgr24(src.data(), src_stride, actual.data(), dst_stride, width, height);
+                    QVERIFY2(SameRows(expected, actual, dst_stride, width, height),
+                             qPrintable(QString("%1 %2x%3").arg(QLatin1String(Converter::IsaName(isa))).arg(width).arg(height)));
+                }
+            }
+        }
+    }
+
+    void testYuv420p() {
+        const Converter::Kernels& scalar = Converter::Get(Converter::Isa::kScalar);
+        for (Converter::Range range : {Converter::Range::kLimited, Converter::Range::kFull}) {
+            for (int width : widths_) {
+                for (int height : heights_) {
+                    const int y_stride = width + 3;
+                    const int c_stride = (width + 1) / 2 + 3;
+                    const int c_height = (height + 1) / 2;
+                    const int dst_stride = width * 4;
+                    const std::vector<uint8_t> y = RandomBytes(y_stride * height);
+                    const std::vector<uint8_t> u = RandomBytes(c_stride * c_height);
+                    const std::vector<uint8_t> v = RandomBytes(c_stride * c_height);
+                    std::vector<uint8_t> expected(dst_stride * height);
+                    scalar.yuv420p(y.data(), y_stride, u.data(), c_stride, v.data(), c_stride,
+                                   expected.data(), dst_stride, width, height, range);
+
+                    for (int row = 0; row < height; ++row) {
+                        for (int x = 0; x < width; ++x) {
+                            const int luma = y[row * y_stride + x];
+                            if (range == Converter::Range::kLimited && luma < 16) {
+                                continue;  // Footroom is clamped to black by design
+                            }
+                            QVERIFY(ReferenceDistance(luma, u[(row / 2) * c_stride + x / 2],
+                                                      v[(row / 2) * c_stride + x / 2], range,
+                                                      expected.data() + row * dst_stride + x * 4) <= 2);
+                        }
+                    }
+
+                    for (Converter::Isa isa : simdIsas()) {
+                        std::vector<uint8_t> actual(dst_stride * height);
+                        Converter::Get(isa).yuv420p(y.data(), y_stride, u.data(), c_stride, v.data(), c_stride,
+                                                    actual.data(), dst_stride, width, height, range);
+                        QVERIFY2(SameRows(expected, actual, dst_stride, width, height),
+                                 qPrintable(QString("%1 %2x%3").arg(QLatin1String(Converter::IsaName(isa))).arg(width).arg(height)));
+                    }
+                }
+            }
+        }
+    }
+
+    void testNv12() {
+        const Converter::Kernels& scalar = Converter::Get(Converter::Isa::kScalar);
+        for (Converter::Range range : {Converter::Range::kLimited, Converter::Range::kFull}) {
+            for (int width : widths_) {
+                for (int height : heights_) {
+                    const int y_stride = width + 1;
+                    const int uv_stride = (width + 1) / 2 * 2 + 4;
+                    const int dst_stride = width * 4 + 4;
+                    const std::vector<uint8_t> y = RandomBytes(y_stride * height);
+                    const std::vector<uint8_t> uv = RandomBytes(uv_stride * ((height + 1) / 2));
+                    std::vector<uint8_t> expected(dst_stride * height);
+                    scalar.nv12(y.data(), y_stride, uv.data(), uv_stride, expected.data(), dst_stride,
+                                width, height, range);
+
+                    // Same samples laid out as planes must give the same pixels
+                    const int c_stride = (width + 1) / 2;
+                    std::vector<uint8_t> u(c_stride * ((height + 1) / 2)), v(u.size());
+                    for (int row = 0; row < (height + 1) / 2; ++row) {
+                        for (int x = 0; x < c_stride; ++x) {
+                            u[row * c_stride + x] = uv[row * uv_stride + x * 2];
+                            v[row * c_stride + x] = uv[row * uv_stride + x * 2 + 1];
+                        }
+                    }
+                    std::vector<uint8_t> planar(dst_stride * height);
+                    scalar.yuv420p(y.data(), y_stride, u.data(), c_stride, v.data(), c_stride,
+                                   planar.data(), dst_stride, width, height, range);
+                    QVERIFY(SameRows(expected, planar, dst_stride, width, height));
+
+                    for (Converter::Isa isa : simdIsas()) {
+                        std::vector<uint8_t> actual(dst_stride * height);
+                        Converter::Get(isa).nv12(y.data(), y_stride, uv.data(), uv_stride, actual.data(),
+                                                 dst_stride, width, height, range);
+                        QVERIFY2(SameRows(expected, actual, dst_stride, width, height),
+                                 qPrintable(QString("%1 %2x%3").arg(QLatin1String(Converter::IsaName(isa))).arg(width).arg(height)));
+                    }
+                }
+            }
+        }
+    }
+
+    void testYuyv422() {
+        const Converter::Kernels& scalar = Converter::Get(Converter::Isa::kScalar);
+        for (Converter::Range range : {Converter::Range::kLimited, Converter::Range::kFull}) {
+            for (int width : widths_) {
+                for (int height : heights_) {
+                    const int src_stride = (width + 1) / 2 * 4 + 6;
+                    const int dst_stride = width * 4;
+                    const std::vector<uint8_t> src = RandomBytes(src_stride * height);
+                    std::vector<uint8_t> expected(dst_stride * height);
+                    scalar.yuyv422(src.data(), src_stride, expected.data(), dst_stride, width, height, range);
+
+                    for (int row = 0; row < height; ++row) {
+                        for (int x = 0; x < width; ++x) {
+                            const uint8_t* pair = src.data() + row * src_stride + (x / 2) * 4;
+                            const int luma = pair[(x & 1) * 2];
+                            if (range == Converter::Range::kLimited && luma < 16) {
+                                continue;
+                            }
+                            QVERIFY(ReferenceDistance(luma, pair[1], pair[3], range,
+                                                      expected.data() + row * dst_stride + x * 4) <= 2);
+                        }
+                    }
+
+                    for (Converter::Isa isa : simdIsas()) {
+                        std::vector<uint8_t> actual(dst_stride * height);
+                        Converter::Get(isa).yuyv422(src.data(), src_stride, actual.data(), dst_stride,
+                                                    width, height, range);
+                        QVERIFY2(SameRows(expected, actual, dst_stride, width, height),
+                                 qPrintable(QString("%1 %2x%3").arg(QLatin1String(Converter::IsaName(isa))).arg(width).arg(height)));
+                    }
+                }
+            }
+        }
+    }
+
+    void testBlackAndWhite() {
+        // Limited-range black/white must land exactly on 0 and 255
+        const Converter::Kernels& kernels = Converter::Best();
+        const uint8_t y[2] = {16, 235};
+        const uint8_t u[1] = {128};
+        const uint8_t v[1] = {128};
+        uint8_t out[8] = {};
+        kernels.yuv420p(y, 2, u, 1, v, 1, out, 8, 2, 1, Converter::Range::kLimited);
+        QCOMPARE(out[0], uint8_t(0));
+        QCOMPARE(out[3], uint8_t(0xFF));
+        QCOMPARE(out[4], uint8_t(255));
+        QCOMPARE(out[6], uint8_t(255));
+    }
+};
+
+QTEST_MAIN(TestPixelConverter)
+#include "test_pixel_converter.moc"
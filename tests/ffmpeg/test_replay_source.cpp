@@ -0,0 +1,147 @@
+#include <QTest>
+#include "host/backend/ffmpeg/ffmpeg_replay_source.h"
+
+/**
+ * @brief Unit tests for FFmpegReplaySource.
+ *
+ * Covers parsing of replay: device paths and the OPENTERFACE_REPLAY override,
+ * and the pacing clock: packets fall due at their recorded spacing scaled by
+ * the speed factor, a rewound loop carries on where the last pass ended, and
+ * a stall or timestamp jump re-anchors the clock instead of bursting.
+ */
+class TestReplaySource : public QObject {
+    Q_OBJECT
+
+    static constexpr qint64 kSecond = 1000000000LL;
+    static constexpr qint64 kStart = 50 * kSecond;   // Arbitrary monotonic origin
+
+    static FFmpegReplaySource MakeSource(double speed) {
+        FFmpegReplaySource::Options options;
+        options.path = QStringLiteral("capture.mkv");
+        options.speed = speed;
+        return FFmpegReplaySource(options);
+    }
+
+    static bool Near(qint64 actual, qint64 expected) {
+        return qAbs(actual - expected) <= 1;
+    }
+
+private slots:
+    void testIsReplayPath() {
+        QVERIFY(FFmpegReplaySource::IsReplayPath(QStringLiteral("replay:/tmp/a.mkv")));
+        QVERIFY(FFmpegReplaySource::IsReplayPath(QStringLiteral("REPLAY:C:/captures/a.avi")));
+        QVERIFY(!FFmpegReplaySource::IsReplayPath(QStringLiteral("/dev/video0")));
+        QVERIFY(!FFmpegReplaySource::IsReplayPath(QStringLiteral("video=Openterface")));
+    }
+
+    void testParseSpec() {
+        FFmpegReplaySource::Options options;
+        QVERIFY(FFmpegReplaySource::ParseSpec(QStringLiteral("replay:/tmp/a.mkv"), &options));
+        QCOMPARE(options.path, QStringLiteral("/tmp/a.mkv"));
+        QCOMPARE(options.speed, 1.0);
+        QVERIFY(options.loop);
+        QCOMPARE(options.framerate, 0);
+
+        QVERIFY(FFmpegReplaySource::ParseSpec(QStringLiteral("replay:/tmp/a.mkv?speed=2.5&loop=0"), &options));
+        QCOMPARE(options.path, QStringLiteral("/tmp/a.mkv"));
+        QCOMPARE(options.speed, 2.5);
+        QVERIFY(!options.loop);
+
+        // The prefix is optional, as in OPENTERFACE_REPLAY
+        QVERIFY(FFmpegReplaySource::ParseSpec(QStringLiteral("/tmp/frames?fps=60&speed=0"), &options));
+        QCOMPARE(options.path, QStringLiteral("/tmp/frames"));
+        QCOMPARE(options.framerate, 60);
+        QCOMPARE(options.speed, 0.0);
+        QVERIFY(options.loop);
+    }
+
+    void testParseSpecRejectsBadInput() {
+        FFmpegReplaySource::Options options;
+        options.path = QStringLiteral("unchanged");
+        QString error;
+
+        QVERIFY(!FFmpegReplaySource::ParseSpec(QStringLiteral("replay:"), &options, &error));
+        QVERIFY(!error.isEmpty());
+        QVERIFY(!FFmpegReplaySource::ParseSpec(QStringLiteral("replay:a.mkv?speed=-1"), &options, &error));
+        QVERIFY(!FFmpegReplaySource::ParseSpec(QStringLiteral("replay:a.mkv?loop=maybe"), &options, &error));
+        QVERIFY(!FFmpegReplaySource::ParseSpec(QStringLiteral("replay:a.mkv?fps=0"), &options, &error));
+        QVERIFY(!FFmpegReplaySource::ParseSpec(QStringLiteral("replay:a.mkv?rate=2"), &options, &error));
+        QVERIFY(error.contains(QStringLiteral("rate")));
+        QCOMPARE(options.path, QStringLiteral("unchanged"));
+    }
+
+    void testOverridePath() {
+        qunsetenv("OPENTERFACE_REPLAY");
+        QVERIFY(FFmpegReplaySource::OverridePath().isEmpty());
+
+        qputenv("OPENTERFACE_REPLAY", "/tmp/a.mkv?speed=4");
+        QCOMPARE(FFmpegReplaySource::OverridePath(), QStringLiteral("replay:/tmp/a.mkv?speed=4"));
+        qputenv("OPENTERFACE_REPLAY", "replay:/tmp/b.mkv");
+        QCOMPARE(FFmpegReplaySource::OverridePath(), QStringLiteral("replay:/tmp/b.mkv"));
+        qunsetenv("OPENTERFACE_REPLAY");
+    }
+
+    void testRecordedCadence() {
+        FFmpegReplaySource source = MakeSource(1.0);
+        // The first packet is due at once, the rest at their recorded spacing
+        // however early they are read
+        QCOMPARE(source.DueTime(10.0, kStart), kStart);
+        QVERIFY(Near(source.DueTime(10.0 + 1.0 / 30, kStart), kStart + kSecond / 30));
+        QVERIFY(Near(source.DueTime(10.0 + 2.0 / 30, kStart + kSecond / 60), kStart + 2 * kSecond / 30));
+    }
+
+    void testSpeedFactor() {
+        FFmpegReplaySource fast = MakeSource(4.0);
+        QCOMPARE(fast.DueTime(0.0, kStart), kStart);
+        QVERIFY(Near(fast.DueTime(0.1, kStart), kStart + kSecond / 40));
+
+        // Unpaced: everything is due as soon as it is read
+        FFmpegReplaySource unpaced = MakeSource(0.0);
+        QCOMPARE(unpaced.DueTime(0.0, kStart), kStart);
+        QCOMPARE(unpaced.DueTime(0.5, kStart + 7), kStart + 7);
+    }
+
+    void testMissingTimestampsFollowLastInterval() {
+        FFmpegReplaySource source = MakeSource(1.0);
+        source.DueTime(0.0, kStart);
+        source.DueTime(0.02, kStart);
+        QVERIFY(Near(source.DueTime(-1.0, kStart), kStart + 2 * kSecond / 50));
+        QVERIFY(Near(source.DueTime(-1.0, kStart), kStart + 3 * kSecond / 50));
+    }
+
+    void testRewindContinuesTimeline() {
+        FFmpegReplaySource source = MakeSource(1.0);
+        for (int i = 0; i < 3; ++i) {
+            source.DueTime(i * 0.1, kStart);
+        }
+        source.OnRewind();
+        QCOMPARE(source.GetLoopCount(), 1);
+
+        // The second pass starts one frame after the first one ended
+        QVERIFY(Near(source.DueTime(0.0, kStart), kStart + 3 * kSecond / 10));
+        QVERIFY(Near(source.DueTime(0.1, kStart), kStart + 4 * kSecond / 10));
+    }
+
+    void testStallReanchors() {
+        FFmpegReplaySource source = MakeSource(1.0);
+        source.DueTime(0.0, kStart);
+
+        // Read two seconds late: shown now, and the cadence resumes from here
+        const qint64 late = kStart + 2 * kSecond;
+        QCOMPARE(source.DueTime(0.1, late), late);
+        QVERIFY(Near(source.DueTime(0.2, late), late + kSecond / 10));
+
+        // A jump far ahead is a discontinuity, not a ten-second wait
+        QCOMPARE(source.DueTime(10.2, late), late);
+    }
+
+    void testResetClock() {
+        FFmpegReplaySource source = MakeSource(1.0);
+        source.DueTime(0.0, kStart);
+        source.ResetClock();
+        QCOMPARE(source.DueTime(0.5, kStart + kSecond), kStart + kSecond);
+    }
+};
+
+QTEST_MAIN(TestReplaySource)
+#include "test_replay_source.moc"
@@ -0,0 +1,293 @@
+#include <QTest>
+#include <QLoggingCategory>
+#include "host/backend/ffmpeg/ffmpeg_restart_decoder.h"
+
+Q_LOGGING_CATEGORY(log_ffmpeg_backend, "opf.backend.ffmpeg")
+
+/**
+ * @brief Unit tests for FFmpegRestartDecoder's stream handling.
+ *
+ * Builds JPEG byte streams by hand (headers plus opaque entropy data) and
+ * checks that restart intervals are found around stuffed and fill bytes,
+ * that unsplittable streams are rejected, that strips always start on an
+ * MCU row and an interval boundary, and that a rewrapped strip is a valid
+ * standalone JPEG: its own height, markers counted from RST0, an EOI.
+ * Decoding itself needs TurboJPEG and is covered by bench_frame_processor.
+ */
+class TestRestartDecoder : public QObject {
+    Q_OBJECT
+
+    struct Spec {
+        int width = 64;
+        int height = 32;
+        int h_sampling = 2;          // Luma sampling; 2x2 gives 16x16 MCUs
+        int v_sampling = 2;
+        int components = 3;
+        int restart_interval = 2;    // 0 = no DRI segment
+        quint8 frame_marker = 0xC0;
+    };
+
+    static void Append16(QByteArray* out, int value) {
+        out->append(static_cast<char>(value >> 8));
+        out->append(static_cast<char>(value & 0xFF));
+    }
+
+    static QByteArray Payload(int index) {
+        // Stuffed FF00 in the middle must not count as a marker
+        QByteArray payload = QByteArray::fromHex("a1b2ff00c3");
+        payload.append(static_cast<char>(index));
+        return payload;
+    }
+
+    static QByteArray MakeJpeg(const Spec& spec, const QList<QByteArray>& intervals) {
+        QByteArray jpeg = QByteArray::fromHex("ffd8");
+        jpeg.append(QByteArray::fromHex("ffe000104a46494600010100000100010000"));   // APP0 JFIF
+
+        jpeg.append(static_cast<char>(0xFF));
+        jpeg.append(static_cast<char>(spec.frame_marker));
+        Append16(&jpeg, 8 + 3 * spec.components);
+        jpeg.append(static_cast<char>(8));
+        Append16(&jpeg, spec.height);
+        Append16(&jpeg, spec.width);
+        jpeg.append(static_cast<char>(spec.components));
+        for (int c = 0; c < spec.components; ++c) {
+            jpeg.append(static_cast<char>(c + 1));
+            jpeg.append(static_cast<char>(c == 0 ? (spec.h_sampling << 4) | spec.v_sampling : 0x11));
+            jpeg.append(static_cast<char>(c == 0 ? 0 : 1));
+        }
+
+        if (spec.restart_interval > 0) {
+            jpeg.append(QByteArray::fromHex("ffdd0004"));
+            Append16(&jpeg, spec.restart_interval);
+        }
+
+        jpeg.append(QByteArray::fromHex("ffda"));
+        Append16(&jpeg, 6 + 2 * spec.components);
+        jpeg.append(static_cast<char>(spec.components));
+        for (int c = 0; c < spec.components; ++c) {
+            jpeg.append(static_cast<char>(c + 1));
+            jpeg.append(static_cast<char>(c == 0 ? 0x00 : 0x11));
+        }
+        jpeg.append(QByteArray::fromHex("003f00"));
+
+        for (int i = 0; i < intervals.size(); ++i) {
+            if (i > 0) {
+                jpeg.append(static_cast<char>(0xFF));
+                jpeg.append(static_cast<char>(0xD0 + ((i - 1) & 7)));
+            }
+            jpeg.append(intervals[i]);
+        }
+        jpeg.append(QByteArray::fromHex("ffd9"));
+        return jpeg;
+    }
+
+    static QList<QByteArray> Payloads(int count) {
+        QList<QByteArray> payloads;
+        for (int i = 0; i < count; ++i) {
+            payloads.append(Payload(i));
+        }
+        return payloads;
+    }
+
+    static bool Parse(const QByteArray& jpeg, FFmpegRestartDecoder::Layout* layout) {
+        return FFmpegRestartDecoder::ParseLayout(reinterpret_cast<const uint8_t*>(jpeg.constData()),
+                                                 jpeg.size(), layout);
+    }
+
+    static QByteArray IntervalBytes(const QByteArray& jpeg, const FFmpegRestartDecoder::Layout& layout, int i) {
+        return jpeg.mid(layout.interval_begin[i], layout.interval_end[i] - layout.interval_begin[i]);
+    }
+
+private slots:
+    void testParseLayout() {
+        // 64x32 in 16x16 MCUs is 4 MCUs by 2 rows; 2 MCUs per interval
+        const QByteArray jpeg = MakeJpeg(Spec(), Payloads(4));
+        FFmpegRestartDecoder::Layout layout;
+        QVERIFY(Parse(jpeg, &layout));
+
+        QCOMPARE(layout.width, 64);
+        QCOMPARE(layout.height, 32);
+        QCOMPARE(layout.mcu_width, 16);
+        QCOMPARE(layout.mcu_height, 16);
+        QCOMPARE(layout.mcus_per_row, 4);
+        QCOMPARE(layout.mcu_rows, 2);
+        QCOMPARE(layout.restart_interval, 2);
+        QCOMPARE(static_cast<quint8>(jpeg[layout.height_offset + 1]), quint8(32));
+        QCOMPARE(static_cast<int>(layout.interval_begin.size()), 4);
+        for (int i = 0; i < 4; ++i) {
+            QCOMPARE(IntervalBytes(jpeg, layout, i), Payload(i));
+        }
+    }
+
+    void testSamplingSetsMcuSize() {
+        Spec spec;
+        spec.h_sampling = 2;
+        spec.v_sampling = 1;               // 4:2:2: 16x8 MCUs, 4 by 4
+        spec.restart_interval = 4;
+        FFmpegRestartDecoder::Layout layout;
+        QVERIFY(Parse(MakeJpeg(spec, Payloads(4)), &layout));
+        QCOMPARE(layout.mcu_width, 16);
+        QCOMPARE(layout.mcu_height, 8);
+        QCOMPARE(layout.mcu_rows, 4);
+
+        // Greyscale scans are not interleaved: one 8x8 block per MCU
+        spec.components = 1;
+        spec.restart_interval = 8;
+        QVERIFY(Parse(MakeJpeg(spec, Payloads(4)), &layout));
+        QCOMPARE(layout.mcu_width, 8);
+        QCOMPARE(layout.mcu_height, 8);
+    }
+
+    void testFillBytesBeforeMarker() {
+        QList<QByteArray> payloads = Payloads(4);
+        payloads[1].append(QByteArray::fromHex("ffff"));   // Padding before RST1
+        const QByteArray jpeg = MakeJpeg(Spec(), payloads);
+        FFmpegRestartDecoder::Layout layout;
+        QVERIFY(Parse(jpeg, &layout));
+        QCOMPARE(static_cast<int>(layout.interval_begin.size()), 4);
+        QCOMPARE(IntervalBytes(jpeg, layout, 1), Payload(1));
+        QCOMPARE(IntervalBytes(jpeg, layout, 2), Payload(2));
+    }
+
+    void testRejectsUnsplittableStreams() {
+        FFmpegRestartDecoder::Layout layout;
+
+        Spec no_restarts;
+        no_restarts.restart_interval = 0;
+        QVERIFY(!Parse(MakeJpeg(no_restarts, Payloads(1)), &layout));
+
+        Spec progressive;
+        progressive.frame_marker = 0xC2;
+        QVERIFY(!Parse(MakeJpeg(progressive, Payloads(4)), &layout));
+
+        // Interval count must match the picture's MCUs
+        QVERIFY(!Parse(MakeJpeg(Spec(), Payloads(3)), &layout));
+        QVERIFY(!Parse(MakeJpeg(Spec(), Payloads(5)), &layout));
+
+        // Truncated before EOI
+        QByteArray truncated = MakeJpeg(Spec(), Payloads(4));
+        truncated.chop(2);
+        QVERIFY(!Parse(truncated, &layout));
+
+        // A second scan (or any other marker) inside the entropy data
+        QList<QByteArray> second_scan = Payloads(4);
+        second_scan[3].append(QByteArray::fromHex("ffda"));
+        QVERIFY(!Parse(MakeJpeg(Spec(), second_scan), &layout));
+
+        QVERIFY(!Parse(QByteArray::fromHex("ffd8ffd9"), &layout));
+        QVERIFY(!Parse(QByteArray("not a jpeg"), &layout));
+    }
+
+    void testPlanStripsOnRowBoundaries() {
+        // 1920x1080 4:2:0: 120 MCUs by 68 rows, one row per interval
+        FFmpegRestartDecoder::Layout layout;
+        layout.width = 1920;
+        layout.height = 1080;
+        layout.mcu_width = 16;
+        layout.mcu_height = 16;
+        layout.mcus_per_row = 120;
+        layout.mcu_rows = 68;
+        layout.restart_interval = 120;
+        layout.interval_begin.assign(68, 0);
+        layout.interval_end.assign(68, 0);
+
+        const auto strips = FFmpegRestartDecoder::PlanStrips(layout, 4);
+        QCOMPARE(static_cast<int>(strips.size()), 4);
+        int next_interval = 0;
+        int next_top = 0;
+        for (const auto& strip : strips) {
+            QCOMPARE(strip.first_interval, next_interval);
+            QCOMPARE(strip.top, next_top);
+            QCOMPARE(strip.top % 16, 0);
+            QCOMPARE(strip.interval_count, 17);
+            next_interval += strip.interval_count;
+            next_top += strip.height;
+        }
+        QCOMPARE(next_interval, 68);
+        QCOMPARE(next_top, 1080);
+        QCOMPARE(strips.back().height, 17 * 16 - 8);   // 1080 is not a multiple of 16
+    }
+
+    void testPlanStripsWithPartialRowIntervals() {
+        // 3 MCUs per interval, 4 per row: strips can only cut every 3 rows
+        FFmpegRestartDecoder::Layout layout;
+        layout.width = 64;
+        layout.height = 160;
+        layout.mcu_width = 16;
+        layout.mcu_height = 16;
+        layout.mcus_per_row = 4;
+        layout.mcu_rows = 10;
+        layout.restart_interval = 3;
+        layout.interval_begin.assign(14, 0);   // ceil(40 / 3)
+        layout.interval_end.assign(14, 0);
+
+        const auto strips = FFmpegRestartDecoder::PlanStrips(layout, 8);
+        QCOMPARE(static_cast<int>(strips.size()), 4);   // Bands of 3, 3, 3 and 1 rows
+        for (const auto& strip : strips) {
+            QCOMPARE((strip.top / 16 * 4) % 3, 0);
+        }
+        QCOMPARE(strips[1].first_interval, 4);
+        QCOMPARE(strips[1].interval_count, 4);
+        QCOMPARE(strips.back().first_interval, 12);
+        QCOMPARE(strips.back().interval_count, 2);
+        QCOMPARE(strips.back().height, 16);
+
+        // A single band cannot be split
+        layout.restart_interval = 40;
+        layout.interval_begin.assign(1, 0);
+        layout.interval_end.assign(1, 0);
+        QVERIFY(FFmpegRestartDecoder::PlanStrips(layout, 8).empty());
+        layout.restart_interval = 4;
+        QVERIFY(FFmpegRestartDecoder::PlanStrips(layout, 1).empty());
+    }
+
+    void testBuildStripJpeg() {
+        // 64x64: four MCU rows of two intervals each
+        Spec spec;
+        spec.height = 64;
+        const QByteArray jpeg = MakeJpeg(spec, Payloads(8));
+        FFmpegRestartDecoder::Layout layout;
+        QVERIFY(Parse(jpeg, &layout));
+        const auto strips = FFmpegRestartDecoder::PlanStrips(layout, 2);
+        QCOMPARE(static_cast<int>(strips.size()), 2);
+
+        std::vector<uint8_t> out;
+        FFmpegRestartDecoder::BuildStripJpeg(reinterpret_cast<const uint8_t*>(jpeg.constData()),
+                                             layout, strips[1], &out);
+        const QByteArray strip(reinterpret_cast<const char*>(out.data()), static_cast<int>(out.size()));
+
+        // Headers are kept with the strip's own height, and it parses as a
+        // complete frame of its own
+        QCOMPARE(strip.left(layout.height_offset), jpeg.left(layout.height_offset));
+        FFmpegRestartDecoder::Layout strip_layout;
+        QVERIFY(Parse(strip, &strip_layout));
+        QCOMPARE(strip_layout.height, 32);
+        QCOMPARE(strip_layout.width, 64);
+        QCOMPARE(static_cast<int>(strip_layout.interval_begin.size()), 4);
+        for (int i = 0; i < 4; ++i) {
+            QCOMPARE(IntervalBytes(strip, strip_layout, i), Payload(4 + i));
+        }
+
+        // Markers restart at RST0 and the strip ends in EOI
+        QCOMPARE(strip.mid(strip_layout.interval_end[0], 2), QByteArray::fromHex("ffd0"));
+        QCOMPARE(strip.mid(strip_layout.interval_end[2], 2), QByteArray::fromHex("ffd2"));
+        QCOMPARE(strip.right(2), QByteArray::fromHex("ffd9"));
+    }
+
+    void testResolveThreadCount() {
+        QCOMPARE(FFmpegRestartDecoder::ResolveThreadCount(3), 3);
+        QCOMPARE(FFmpegRestartDecoder::ResolveThreadCount(100), FFmpegRestartDecoder::kMaxThreads);
+        const int automatic = FFmpegRestartDecoder::ResolveThreadCount(0);
+        QVERIFY(automatic >= 1 && automatic <= 4);
+
+        FFmpegRestartDecoder decoder;
+        QCOMPARE(decoder.GetThreadCount(), 1);
+        decoder.SetThreadCount(3);
+        QCOMPARE(decoder.GetThreadCount(), 3);
+        decoder.SetThreadCount(1);
+        QCOMPARE(decoder.GetThreadCount(), 1);
+    }
+};
+
+QTEST_MAIN(TestRestartDecoder)
+#include "test_restart_decoder.moc"
@@ -0,0 +1,72 @@
+#include <QTest>
+#include "host/backend/gstreamer/pipelinebuilder.h"
+
+using Openterface::GStreamer::PipelineBuilder;
+
+/**
+ * @brief Unit tests for the PipelineBuilder templates.
+ *
+ * Checks that the MJPEG pipelines tee the compressed frames in front of
+ * jpegdec while keeping the decoded "t" tee for display and capture, and
+ * which recording codec/container pairs are muxed without re-encoding.
+ */
+class TestPipelineBuilder : public QObject {
+    Q_OBJECT
+
+private:
+    static QString jpegTee() { return QStringLiteral("tee name=%1 ").arg(PipelineBuilder::kJpegTeeName); }
+
+    static void verifyJpegTeeBeforeDecoder(const QString& pipeline) {
+        const int caps = pipeline.indexOf(QStringLiteral("image/jpeg"));
+        const int tee = pipeline.indexOf(jpegTee());
+        const int decoder = pipeline.indexOf(QStringLiteral("jpegdec"));
+        const int decodedTee = pipeline.indexOf(QStringLiteral("tee name=t "));
+        QVERIFY2(caps >= 0 && tee >= 0 && decoder >= 0 && decodedTee >= 0, qPrintable(pipeline));
+        QVERIFY2(caps < tee && tee < decoder && decoder < decodedTee, qPrintable(pipeline));
+        QVERIFY(!pipeline.contains(QLatin1Char('%')));
+    }
+
+private slots:
+    void testFlexiblePipelineTeesBeforeDecode() {
+        const QString pipeline = PipelineBuilder::buildFlexiblePipeline(
+            QStringLiteral("/dev/video0"), QSize(1920, 1080), 30, QStringLiteral("xvimagesink"), QSize(1280, 720));
+        verifyJpegTeeBeforeDecoder(pipeline);
+        QVERIFY(pipeline.contains(QStringLiteral("width=1920,height=1080,framerate=30/1")));
+        QVERIFY(pipeline.contains(QStringLiteral("name=recording-valve")));
+    }
+
+    void testJpegFallbackTeesBeforeDecode() {
+        verifyJpegTeeBeforeDecoder(PipelineBuilder::buildV4l2JpegFallback(
+            QStringLiteral("/dev/video0"), QSize(1280, 720), 30, QStringLiteral("ximagesink")));
+    }
+
+    void testRawPipelinesHaveNoJpegTee() {
+        QVERIFY(!PipelineBuilder::buildV4l2RawFallback(
+            QStringLiteral("/dev/video0"), QSize(1280, 720), 30, QStringLiteral("ximagesink")).contains(jpegTee()));
+        QVERIFY(!PipelineBuilder::buildVideotestFallback(
+            QSize(1280, 720), 30, QStringLiteral("ximagesink")).contains(jpegTee()));
+    }
+
+    void testPassthroughMuxer_data() {
+        QTest::addColumn<QString>("codec");
+        QTest::addColumn<QString>("format");
+        QTest::addColumn<QString>("muxer");
+
+        QTest::newRow("mjpeg mkv") << "mjpeg" << "mkv" << "matroskamux";
+        QTest::newRow("mjpeg avi") << "mjpeg" << "avi" << "avimux";
+        QTest::newRow("case") << "MJPEG" << "AVI" << "avimux";
+        QTest::newRow("mjpeg mp4") << "mjpeg" << "mp4" << "";
+        QTest::newRow("x264 mkv") << "x264enc" << "mkv" << "";
+        QTest::newRow("empty codec") << "" << "avi" << "";
+    }
+
+    void testPassthroughMuxer() {
+        QFETCH(QString, codec);
+        QFETCH(QString, format);
+        QFETCH(QString, muxer);
+        QCOMPARE(PipelineBuilder::jpegPassthroughMuxer(codec, format), muxer);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestPipelineBuilder)
+#include "test_pipeline_builder.moc"
@@ -0,0 +1,140 @@
+#include <QTest>
+#include <QThread>
+#include <memory>
+#include "host/audiocapturetap.h"
+
+/**
+ * @brief Unit tests for AudioRingBuffer and AudioCaptureTap.
+ *
+ * Pushes chunks through the ring across its wrap point, checks that a chunk
+ * that does not fit is dropped whole, streams numbered bytes from a producer
+ * thread to make sure nothing is reordered or torn, and checks that the tap
+ * only buffers while a ring is attached.
+ */
+class TestAudioCaptureTap : public QObject {
+    Q_OBJECT
+
+private:
+    static QByteArray pattern(int bytes, int seed) {
+        QByteArray data(bytes, Qt::Uninitialized);
+        for (int i = 0; i < bytes; ++i) {
+            data[i] = static_cast<char>((seed + i) & 0xff);
+        }
+        return data;
+    }
+
+private slots:
+    void testCapacityRoundsUp() {
+        AudioRingBuffer ring(3000);
+        QCOMPARE(ring.capacity(), size_t(4096));
+    }
+
+    void testChunksSurviveWrap() {
+        AudioRingBuffer ring(1024);
+        QByteArray data;
+        qint64 captureNs = 0;
+        QVERIFY(!ring.pop(&data, &captureNs));
+
+        // Chunk + header sizes that do not divide the capacity, so
+        // headers and payloads straddle the end of the buffer
+        for (int i = 0; i < 50; ++i) {
+            const QByteArray chunk = pattern(300 + i, i);
+            QVERIFY(ring.push(chunk.constData(), chunk.size(), 1000 + i));
+            QVERIFY(ring.pop(&data, &captureNs));
+            QCOMPARE(data, chunk);
+            QCOMPARE(captureNs, qint64(1000 + i));
+        }
+        QVERIFY(!ring.pop(&data, &captureNs));
+        QCOMPARE(ring.droppedChunks(), quint64(0));
+    }
+
+    void testFullRingDropsWholeChunk() {
+        AudioRingBuffer ring(1024);
+        const QByteArray chunk = pattern(400, 7);
+        QVERIFY(ring.push(chunk.constData(), chunk.size(), 1));
+        QVERIFY(ring.push(chunk.constData(), chunk.size(), 2));
+        QVERIFY(!ring.push(chunk.constData(), chunk.size(), 3));
+        QCOMPARE(ring.droppedChunks(), quint64(1));
+
+        QByteArray data;
+        qint64 captureNs = 0;
+        QVERIFY(ring.pop(&data, &captureNs));
+        QCOMPARE(captureNs, qint64(1));
+        QVERIFY(ring.pop(&data, &captureNs));
+        QCOMPARE(captureNs, qint64(2));
+        QVERIFY(!ring.pop(&data, &captureNs));
+    }
+
+    void testProducerThreadKeepsOrder() {
+        AudioRingBuffer ring(16 * 1024);
+        constexpr int kChunks = 20000;
+
+        std::unique_ptr<QThread> producer(QThread::create([&ring]() {
+            for (int i = 0; i < kChunks; ++i) {
+                const QByteArray chunk = pattern(64 + i % 500, i);
+                while (!ring.push(chunk.constData(), chunk.size(), i)) {
+                    QThread::yieldCurrentThread();
+                }
+            }
+        }));
+        producer->start();
+
+        QByteArray data;
+        qint64 captureNs = 0;
+        int received = 0;
+        while (received < kChunks) {
+            if (!ring.pop(&data, &captureNs)) {
+                QThread::yieldCurrentThread();
+                continue;
+            }
+            QCOMPARE(captureNs, qint64(received));
+            QCOMPARE(data, pattern(64 + received % 500, received));
+            ++received;
+        }
+        producer->wait();
+    }
+
+    void testTapBuffersOnlyWhileAttached() {
+        AudioCaptureTap& tap = AudioCaptureTap::instance();
+        const QByteArray chunk = pattern(256, 1);
+        tap.publish(chunk.constData(), chunk.size());   // Nobody listening
+        QVERIFY(!tap.isAttached());
+
+        AudioRingBuffer* ring = tap.attach(4096);
+        QVERIFY(tap.isAttached());
+        const qint64 before = AudioCaptureTap::now();
+        tap.publish(chunk.constData(), chunk.size());
+        tap.publish(chunk.constData(), chunk.size(), 42);
+
+        QByteArray data;
+        qint64 captureNs = 0;
+        QVERIFY(ring->pop(&data, &captureNs));
+        QCOMPARE(data, chunk);
+        QVERIFY(captureNs >= before);
+        QVERIFY(ring->pop(&data, &captureNs));
+        QCOMPARE(captureNs, qint64(42));
+        QVERIFY(!ring->pop(&data, &captureNs));
+
+        tap.detach();
+        QVERIFY(!tap.isAttached());
+        tap.publish(chunk.constData(), chunk.size());
+    }
+
+    void testFormat() {
+        AudioCaptureFormat format;
+        QVERIFY(!format.isValid());
+        format.sampleRate = 48000;
+        format.channels = 2;
+        format.sampleFormat = AudioCaptureFormat::Int16;
+        QVERIFY(format.isValid());
+        QCOMPARE(format.bytesPerFrame(), 4);
+
+        AudioCaptureTap::instance().setFormat(format);
+        QCOMPARE(AudioCaptureTap::instance().format().sampleRate, 48000);
+        AudioCaptureTap::instance().setFormat(AudioCaptureFormat());
+        QVERIFY(!AudioCaptureTap::instance().format().isValid());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestAudioCaptureTap)
+#include "test_audio_capture_tap.moc"
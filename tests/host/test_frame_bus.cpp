@@ -0,0 +1,170 @@
+#include <QTest>
+#include <QImage>
+#include <QCoreApplication>
+#include "host/framebus.h"
+
+/**
+ * @brief Unit tests for FrameBus and VideoFrame.
+ *
+ * Verifies that conversions are cached per frame and shared between
+ * consumers, that queued subscribers only ever see the newest frame, and
+ * that rate caps and receiver lifetime are honoured. Frames published
+ * as unchanged keep the content sequence of their first copy.
+ */
+class TestFrameBus : public QObject {
+    Q_OBJECT
+
+private:
+    static QImage makeImage(const QSize& size) {
+        QImage image(size, QImage::Format_RGB888);
+        image.fill(Qt::darkCyan);
+        return image;
+    }
+
+private slots:
+    void cleanup() {
+        FrameBus::instance().clear();
+    }
+
+    void testNativeRequestSharesPixels() {
+        QImage source = makeImage(QSize(640, 480));
+        VideoFrame frame(1, 0, source);
+
+        QImage native = frame.image(QSize(), QImage::Format_Invalid);
+        QCOMPARE(native.constBits(), source.constBits());
+        QCOMPARE(frame.cachedVariantCount(), 0);
+
+        // A bounding box larger than the frame does not upscale
+        QCOMPARE(frame.image(QSize(1920, 1080), QImage::Format_Invalid).constBits(), source.constBits());
+    }
+
+    void testConversionIsCachedPerFrame() {
+        VideoFrame frame(1, 0, makeImage(QSize(1920, 1080)));
+
+        QImage first = frame.image(QSize(640, 640), QImage::Format_RGB32);
+        QImage second = frame.image(QSize(640, 640), QImage::Format_RGB32);
+        QCOMPARE(first.size(), QSize(640, 360));
+        QCOMPARE(first.format(), QImage::Format_RGB32);
+        QCOMPARE(second.constBits(), first.constBits());
+        QCOMPARE(frame.cachedVariantCount(), 1);
+
+        frame.image(QSize(320, 320), QImage::Format_RGB32);
+        QCOMPARE(frame.cachedVariantCount(), 2);
+    }
+
+    void testLatestFrameCarriesMjpeg() {
+        const QByteArray jpeg("\xFF\xD8 fake \xFF\xD9");
+        FrameBus::instance().publish(makeImage(QSize(64, 48)), 1000, jpeg);
+
+        VideoFrameHandle latest = FrameBus::instance().latestFrame();
+        QVERIFY(latest);
+        QVERIFY(latest->hasMjpeg());
+        QCOMPARE(latest->mjpeg(), jpeg);
+        QCOMPARE(latest->captureTimeMs(), qint64(1000));
+
+        FrameBus::instance().clear();
+        QVERIFY(!FrameBus::instance().latestFrame());
+        QVERIFY(FrameBus::instance().latestImage().isNull());
+    }
+
+    void testUnchangedFramesShareContentSequence() {
+        FrameBus& bus = FrameBus::instance();
+        const quint64 staticBefore = bus.staticFrameCount();
+
+        VideoFrameHandle first = bus.publish(makeImage(QSize(64, 48)), 0);
+        VideoFrameHandle second = bus.publish(makeImage(QSize(64, 48)), 16, QByteArray(), QSize(), false);
+        VideoFrameHandle third = bus.publish(makeImage(QSize(64, 48)), 33, QByteArray(), QSize(), false);
+        QCOMPARE(first->contentSequence(), first->sequence());
+        QCOMPARE(third->contentSequence(), first->sequence());
+        QVERIFY(third->unchangedSince(first->sequence()));
+        QVERIFY(third->unchangedSince(second->sequence()));
+        QVERIFY(!third->unchangedSince(first->sequence() - 1));
+        QCOMPARE(bus.staticFrameCount(), staticBefore + 2);
+
+        VideoFrameHandle changed = bus.publish(makeImage(QSize(64, 48)), 50);
+        QVERIFY(!changed->unchangedSince(third->sequence()));
+
+        // Nothing to be identical to after a clear or a resolution change
+        bus.clear();
+        VideoFrameHandle afterClear = bus.publish(makeImage(QSize(64, 48)), 66, QByteArray(), QSize(), false);
+        QCOMPARE(afterClear->contentSequence(), afterClear->sequence());
+        VideoFrameHandle resized = bus.publish(makeImage(QSize(32, 24)), 83, QByteArray(), QSize(), false);
+        QCOMPARE(resized->contentSequence(), resized->sequence());
+    }
+
+    void testJpegServesCameraBytes() {
+        const QByteArray jpeg("\xFF\xD8 camera \xFF\xD9");
+        VideoFrame frame(1, 0, makeImage(QSize(960, 540)), jpeg, QSize(1920, 1080));
+
+        // The decoded image may be DCT-downscaled; the camera JPEG is native
+        QCOMPARE(frame.jpeg().constData(), jpeg.constData());
+        QCOMPARE(frame.jpegSize(), QSize(1920, 1080));
+    }
+
+    void testJpegEncodesOnceWithoutMjpeg() {
+        VideoFrame frame(1, 0, makeImage(QSize(320, 240)));
+
+        QByteArray first = frame.jpeg();
+        QVERIFY(first.startsWith("\xFF\xD8"));
+        QCOMPARE(frame.jpeg().constData(), first.constData());
+        QCOMPARE(frame.jpegSize(), QSize(320, 240));
+    }
+
+    void testDirectSubscriberHonoursRateCap() {
+        FrameRequest request;
+        request.maxFps = 10;  // at most one frame per 100 ms
+
+        QList<qint64> delivered;
+        int id = FrameBus::instance().subscribe(request, nullptr,
+            [&delivered](const VideoFrameHandle& frame, const QImage&) {
+                delivered.append(frame->captureTimeMs());
+            });
+
+        for (qint64 t = 0; t < 300; t += 20) {
+            FrameBus::instance().publish(makeImage(QSize(32, 32)), t);
+        }
+        FrameBus::instance().unsubscribe(id);
+
+        QCOMPARE(delivered, (QList<qint64>{0, 100, 200}));
+    }
+
+    void testQueuedSubscriberGetsNewestFrameOnly() {
+        QObject receiver;
+        FrameRequest request;
+        request.size = QSize(16, 16);
+
+        int calls = 0;
+        qint64 lastTime = -1;
+        QSize lastSize;
+        FrameBus::instance().subscribe(request, &receiver,
+            [&](const VideoFrameHandle& frame, const QImage& image) {
+                ++calls;
+                lastTime = frame->captureTimeMs();
+                lastSize = image.size();
+            });
+
+        for (qint64 t = 1; t <= 5; ++t) {
+            FrameBus::instance().publish(makeImage(QSize(64, 32)), t);
+        }
+        QCOMPARE(calls, 0);  // Nothing runs until the receiver's event loop does
+
+        QCoreApplication::processEvents();
+        QCOMPARE(calls, 1);
+        QCOMPARE(lastTime, qint64(5));
+        QCOMPARE(lastSize, QSize(16, 8));
+    }
+
+    void testSubscriptionEndsWithReceiver() {
+        const int before = FrameBus::instance().subscriberCount();
+        {
+            QObject receiver;
+            FrameBus::instance().subscribe(FrameRequest(), &receiver,
+                                           [](const VideoFrameHandle&, const QImage&) {});
+            QCOMPARE(FrameBus::instance().subscriberCount(), before + 1);
+        }
+        QCOMPARE(FrameBus::instance().subscriberCount(), before);
+    }
+};
+
+QTEST_MAIN(TestFrameBus)
+#include "test_frame_bus.moc"
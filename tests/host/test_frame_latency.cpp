@@ -0,0 +1,126 @@
+#include <QTest>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "host/framelatency.h"
+
+/**
+ * @brief Unit tests for FrameLatencyTracker.
+ *
+ * Feeds frames with explicit stage timestamps and checks that per-stage
+ * intervals land in the right histograms, that unobserved stages are charged
+ * to the next observed one, and that frames which never complete are counted
+ * as dropped instead of growing the pending set.
+ */
+class TestFrameLatency : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr qint64 kMs = 1000000;
+
+    static FrameLatencyTracker::IntervalStats interval(FrameLatencyTracker::Interval which) {
+        return FrameLatencyTracker::instance().report().intervals.at(which);
+    }
+
+    static void stampFrame(quint64 key, const QList<qint64>& stampsMs) {
+        FrameLatencyTracker& tracker = FrameLatencyTracker::instance();
+        for (int stage = 0; stage < stampsMs.size(); ++stage) {
+            if (stampsMs[stage] >= 0) {
+                tracker.stamp(key, static_cast<FrameLatencyTracker::Stage>(stage), stampsMs[stage] * kMs);
+            }
+        }
+    }
+
+private slots:
+    void init() {
+        FrameLatencyTracker& tracker = FrameLatencyTracker::instance();
+        tracker.setEnabled(true);
+        tracker.setSource("test");
+        tracker.reset();
+    }
+
+    void testDisabledIgnoresStamps() {
+        FrameLatencyTracker::instance().setEnabled(false);
+        stampFrame(1, {0, 5, 6, 7, 8});
+        FrameLatencyTracker::instance().setEnabled(true);
+        QCOMPARE(FrameLatencyTracker::instance().report().framesCompleted, quint64(0));
+    }
+
+    void testFullFrameFillsEveryInterval() {
+        stampFrame(1, {10, 13, 14, 16, 20});
+
+        const FrameLatencyTracker::Report report = FrameLatencyTracker::instance().report();
+        QCOMPARE(report.framesCompleted, quint64(1));
+        QCOMPARE(int(report.intervals.size()), int(FrameLatencyTracker::IntervalCount));
+        QVERIFY(qAbs(interval(FrameLatencyTracker::DecodeInterval).p50Ms - 3.0) < 0.05);
+        QVERIFY(qAbs(interval(FrameLatencyTracker::DeliveryInterval).p50Ms - 1.0) < 0.05);
+        QVERIFY(qAbs(interval(FrameLatencyTracker::QueueInterval).p50Ms - 2.0) < 0.05);
+        QVERIFY(qAbs(interval(FrameLatencyTracker::PresentInterval).p50Ms - 4.0) < 0.05);
+        QCOMPARE(interval(FrameLatencyTracker::TotalInterval).maxMs, 10.0);
+    }
+
+    void testMissingStageChargedToNext() {
+        // A sink outside Qt: no paint stamp, finished explicitly after Received
+        stampFrame(7, {0, -1, 6, 9});
+        QCOMPARE(FrameLatencyTracker::instance().report().framesCompleted, quint64(0));
+        FrameLatencyTracker::instance().finish(7);
+
+        QCOMPARE(FrameLatencyTracker::instance().report().framesCompleted, quint64(1));
+        QCOMPARE(interval(FrameLatencyTracker::DecodeInterval).count, quint64(0));
+        QCOMPARE(interval(FrameLatencyTracker::DeliveryInterval).maxMs, 6.0);
+        QCOMPARE(interval(FrameLatencyTracker::PresentInterval).count, quint64(0));
+        QCOMPARE(interval(FrameLatencyTracker::TotalInterval).maxMs, 9.0);
+    }
+
+    void testPercentiles() {
+        // Totals of 1..100 ms
+        for (int i = 1; i <= 100; ++i) {
+            stampFrame(i, {0, -1, -1, -1, i});
+        }
+        const FrameLatencyTracker::IntervalStats total = interval(FrameLatencyTracker::TotalInterval);
+        QCOMPARE(total.count, quint64(100));
+        QVERIFY(qAbs(total.p50Ms - 50.0) <= 1.0);
+        QVERIFY(qAbs(total.p95Ms - 95.0) <= 1.0);
+        QVERIFY(qAbs(total.p99Ms - 99.0) <= 1.0);
+        QCOMPARE(total.maxMs, 100.0);
+        QVERIFY(qAbs(total.meanMs - 50.5) < 0.001);
+    }
+
+    void testIncompleteFramesAreEvicted() {
+        for (int i = 1; i <= 40; ++i) {
+            stampFrame(i, {i});
+        }
+        const FrameLatencyTracker::Report report = FrameLatencyTracker::instance().report();
+        QCOMPARE(report.framesCompleted, quint64(0));
+        QCOMPARE(report.framesDropped, quint64(8));
+
+        // The oldest frames were the ones evicted; the newest still complete
+        FrameLatencyTracker::instance().stamp(1, FrameLatencyTracker::Painted, 50 * kMs);
+        FrameLatencyTracker::instance().stamp(40, FrameLatencyTracker::Painted, 50 * kMs);
+        QCOMPARE(FrameLatencyTracker::instance().report().framesCompleted, quint64(1));
+        QCOMPARE(interval(FrameLatencyTracker::TotalInterval).maxMs, 10.0);
+    }
+
+    void testNewSourceStartsNewSession() {
+        stampFrame(1, {0, 1, 2, 3, 4});
+        FrameLatencyTracker::instance().setSource("other");
+        QCOMPARE(FrameLatencyTracker::instance().report().framesCompleted, quint64(0));
+        QCOMPARE(FrameLatencyTracker::instance().source(), QString("other"));
+    }
+
+    void testJsonExport() {
+        stampFrame(1, {0, 2, 3, 4, 5});
+
+        const QJsonObject json = FrameLatencyTracker::instance().toJson();
+        QCOMPARE(json["source"].toString(), QString("test"));
+        QCOMPARE(json["framesCompleted"].toInt(), 1);
+        QCOMPARE(int(json["stages"].toArray().size()), int(FrameLatencyTracker::StageCount));
+
+        const QJsonArray intervals = json["intervals"].toArray();
+        QCOMPARE(int(intervals.size()), int(FrameLatencyTracker::IntervalCount));
+        QCOMPARE(intervals.at(FrameLatencyTracker::TotalInterval).toObject()["name"].toString(), QString("total"));
+        QCOMPARE(intervals.at(FrameLatencyTracker::TotalInterval).toObject()["maxMs"].toDouble(), 5.0);
+    }
+};
+
+QTEST_MAIN(TestFrameLatency)
+#include "test_frame_latency.moc"
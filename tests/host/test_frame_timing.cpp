@@ -0,0 +1,170 @@
+#include <QTest>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QFile>
+#include "host/frametiming.h"
+
+/**
+ * @brief Unit tests for FrameTimingRecorder.
+ *
+ * Feeds captures, decodes, queue waits, presents and drops with explicit timestamps and
+ * checks the interval statistics and jitter, the per-reason drop counts, that
+ * session totals survive the ring wrapping and that a restart of the same
+ * source is not counted as a capture gap.
+ */
+class TestFrameTiming : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr qint64 kMs = 1000000;
+
+    static FrameTimingRecorder& recorder() { return FrameTimingRecorder::instance(); }
+
+private slots:
+    void init() {
+        recorder().setSource(QStringLiteral("test"));
+        recorder().reset();
+    }
+
+    void testCaptureIntervals() {
+        // Steady 16 ms with one 48 ms hitch
+        const qint64 base = FrameTimingRecorder::now();
+        qint64 t = base;
+        for (int i = 0; i < 100; ++i) {
+            recorder().recordCapture(t);
+            t += (i == 50) ? 48 * kMs : 16 * kMs;
+        }
+
+        FrameTimingRecorder::Snapshot s = recorder().snapshot();
+        QCOMPARE(s.totalCaptured, quint64(100));
+        QCOMPARE(s.captureInterval.count, quint64(99));
+        QCOMPARE(s.captureInterval.p50Ms, 16.0);
+        QCOMPARE(s.captureInterval.maxMs, 48.0);
+        QCOMPARE(s.maxCaptureGapMs, 48.0);
+        QVERIFY(s.captureInterval.jitterMs > 0.0);
+        QVERIFY(qAbs(s.captureInterval.meanMs - (98 * 16.0 + 48.0) / 99) < 1e-6);
+    }
+
+    void testSteadyPresentHasNoJitter() {
+        const qint64 base = FrameTimingRecorder::now();
+        for (int i = 0; i < 10; ++i) {
+            recorder().recordPresent(base + i * 8 * kMs);
+        }
+        FrameTimingRecorder::Snapshot s = recorder().snapshot();
+        QCOMPARE(s.totalPresented, quint64(10));
+        QCOMPARE(s.presentInterval.count, quint64(9));
+        QCOMPARE(s.presentInterval.meanMs, 8.0);
+        QCOMPARE(s.presentInterval.jitterMs, 0.0);
+    }
+
+    void testDecodeAndDrops() {
+        recorder().recordDecode(3 * kMs);
+        recorder().recordDecode(5 * kMs);
+        recorder().recordDecode(-1);   // Ignored
+        recorder().recordQueueWait(2 * kMs);
+        recorder().recordQueueWait(-1);   // Ignored
+        recorder().recordDrop(FrameTimingRecorder::LiveEdgeDiscard, 4);
+        recorder().recordDrop(FrameTimingRecorder::RateLimited);
+        recorder().recordDrop(FrameTimingRecorder::DisplaySuperseded);
+        recorder().recordDrop(FrameTimingRecorder::DisplaySuperseded);
+        recorder().recordDrop(FrameTimingRecorder::DisplaySuperseded, 0);   // Ignored
+        recorder().recordDrop(FrameTimingRecorder::DecodeQueueFull);
+
+        FrameTimingRecorder::Snapshot s = recorder().snapshot();
+        QCOMPARE(s.decodeTime.count, quint64(2));
+        QCOMPARE(s.decodeTime.meanMs, 4.0);
+        QCOMPARE(s.queueWait.count, quint64(1));
+        QCOMPARE(s.queueWait.meanMs, 2.0);
+        QCOMPARE(s.drops[FrameTimingRecorder::LiveEdgeDiscard], quint64(4));
+        QCOMPARE(s.drops[FrameTimingRecorder::RateLimited], quint64(1));
+        QCOMPARE(s.drops[FrameTimingRecorder::DisplaySuperseded], quint64(2));
+        QCOMPARE(s.drops[FrameTimingRecorder::DecodeQueueFull], quint64(1));
+        QCOMPARE(s.dropCount(), quint64(8));
+        QCOMPARE(s.totalDropCount(), quint64(8));
+    }
+
+    void testWindowExcludesOldEvents() {
+        const qint64 now = FrameTimingRecorder::now();
+        recorder().recordCapture(now - 5000 * kMs);
+        recorder().recordCapture(now - 4990 * kMs);   // Interval outside a 1 s window
+        recorder().recordCapture(now - 20 * kMs);
+        recorder().recordCapture(now - 4 * kMs);
+
+        QCOMPARE(recorder().snapshot().captureInterval.count, quint64(3));
+        FrameTimingRecorder::Snapshot recent = recorder().snapshot(1000);
+        QCOMPARE(recent.captureInterval.count, quint64(2));
+        QCOMPARE(recent.captureInterval.p50Ms, 16.0);     // The 10 ms interval is out
+        QCOMPARE(recent.captureInterval.maxMs, 4970.0);
+        QCOMPARE(recent.totalCaptured, quint64(4));
+    }
+
+    void testTotalsSurviveRingWrap() {
+        const qint64 base = FrameTimingRecorder::now();
+        constexpr int kFrames = 40000;   // More events than the ring holds
+        for (int i = 0; i < kFrames; ++i) {
+            recorder().recordCapture(base + i * kMs);
+        }
+        FrameTimingRecorder::Snapshot s = recorder().snapshot();
+        QCOMPARE(s.totalCaptured, quint64(kFrames));
+        QVERIFY(s.captureInterval.count < quint64(kFrames - 1));
+        QVERIFY(s.captureInterval.count > 0);
+        QCOMPARE(s.captureInterval.maxMs, 1.0);
+    }
+
+    void testSameSourceRestartIsNotAGap() {
+        const qint64 base = FrameTimingRecorder::now();
+        recorder().recordCapture(base);
+        recorder().recordCapture(base + 16 * kMs);
+        recorder().setSource(QStringLiteral("test"));   // Capture restarted
+        recorder().recordCapture(base + 2000 * kMs);
+
+        FrameTimingRecorder::Snapshot s = recorder().snapshot();
+        QCOMPARE(s.totalCaptured, quint64(3));
+        QCOMPARE(s.maxCaptureGapMs, 16.0);
+
+        // A different source starts over
+        recorder().setSource(QStringLiteral("other"));
+        QCOMPARE(recorder().snapshot().totalCaptured, quint64(0));
+        QCOMPARE(recorder().source(), QStringLiteral("other"));
+    }
+
+    void testJsonAndCsvExport() {
+        const qint64 base = FrameTimingRecorder::now();
+        recorder().recordCapture(base);
+        recorder().recordCapture(base + 16 * kMs);
+        recorder().recordDrop(FrameTimingRecorder::LiveEdgeDiscard, 2);
+
+        QJsonObject json = recorder().toJson();
+        QCOMPARE(json["source"].toString(), QStringLiteral("test"));
+        QJsonObject window = json["window"].toObject();
+        QCOMPARE(window["captureInterval"].toObject()["count"].toInt(), 1);
+        QCOMPARE(window["drops"].toObject()["live_edge_discard"].toInt(), 2);
+        QCOMPARE(json["totals"].toObject()["captured"].toInt(), 2);
+
+        const QStringList lines = recorder().toCsv().split('\n', Qt::SkipEmptyParts);
+        QCOMPARE(lines.size(), 3);
+        QCOMPARE(lines[0], QStringLiteral("time_ms,event,value_ms,drop_reason,drop_count"));
+        QVERIFY(lines[1].contains(QStringLiteral(",capture,16.000,,")));
+        QVERIFY(lines[2].endsWith(QStringLiteral(",drop,,live_edge_discard,2")));
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString csvPath = dir.filePath("timing.csv");
+        const QString jsonPath = dir.filePath("timing.json");
+        QVERIFY(recorder().exportToFile(csvPath));
+        QVERIFY(recorder().exportToFile(jsonPath));
+        QFile csv(csvPath);
+        QVERIFY(csv.open(QIODevice::ReadOnly));
+        QVERIFY(csv.readLine().startsWith("time_ms,"));
+        QFile jsonFile(jsonPath);
+        QVERIFY(jsonFile.open(QIODevice::ReadOnly));
+        QVERIFY(jsonFile.readAll().trimmed().startsWith('{'));
+
+        QString error;
+        QVERIFY(!recorder().exportToFile(dir.filePath("missing/timing.csv"), &error));
+        QVERIFY(!error.isEmpty());
+    }
+};
+
+QTEST_MAIN(TestFrameTiming)
+#include "test_frame_timing.moc"
@@ -0,0 +1,161 @@
+#include <QTest>
+#include <QImage>
+#include <QThread>
+#include <atomic>
+#include "host/presentationqueue.h"
+
+/**
+ * @brief Unit tests for PresentationQueue.
+ *
+ * Checks that only the newest frame is kept, that replaced frames are
+ * counted as never shown and their dirty areas carried forward, and that the
+ * display is asked for a refresh once per pending frame rather than once per
+ * submitted one.
+ */
+class TestPresentationQueue : public QObject {
+    Q_OBJECT
+
+    static QImage MakeFrame(int value, const QSize& size = QSize(64, 32)) {
+        QImage image(size, QImage::Format_RGB32);
+        image.fill(qRgb(value, value, value));
+        return image;
+    }
+
+private slots:
+    void testTakeReturnsLatestFrame() {
+        PresentationQueue queue;
+        PresentationQueue::Frame frame;
+        QVERIFY(!queue.take(&frame));
+
+        QVERIFY(!queue.submit(MakeFrame(1)));
+        QVERIFY(queue.submit(MakeFrame(2)));   // Replaced frame 1
+        QVERIFY(queue.submit(MakeFrame(3)));
+        QVERIFY(queue.hasPending());
+        QVERIFY(queue.take(&frame));
+        QCOMPARE(frame.image.pixel(0, 0), qRgb(3, 3, 3));
+        QVERIFY(!queue.hasPending());
+        QVERIFY(!queue.take(&frame));
+
+        PresentationQueue::Stats stats = queue.stats();
+        QCOMPARE(stats.submitted, quint64(3));
+        QCOMPARE(stats.presented, quint64(1));
+        QCOMPARE(stats.superseded, quint64(2));
+    }
+
+    void testScheduleOncePerPendingFrame() {
+        PresentationQueue queue;
+        int scheduled = 0;
+        queue.setScheduleCallback([&scheduled]() { scheduled++; });
+
+        queue.submit(MakeFrame(1));
+        queue.submit(MakeFrame(2));
+        QCOMPARE(scheduled, 1);
+
+        PresentationQueue::Frame frame;
+        QVERIFY(queue.take(&frame));
+        queue.submit(MakeFrame(3));
+        QCOMPARE(scheduled, 2);
+
+        // Without a callback frames still queue, nothing is scheduled
+        queue.setScheduleCallback(nullptr);
+        QVERIFY(queue.take(&frame));
+        queue.submit(MakeFrame(4));
+        QCOMPARE(scheduled, 2);
+        QVERIFY(queue.hasPending());
+    }
+
+    void testStalePendingFrameIsRescheduled() {
+        // A lost refresh must not leave the newest frame stuck
+        PresentationQueue queue;
+        int scheduled = 0;
+        queue.setScheduleCallback([&scheduled]() { scheduled++; });
+
+        queue.submit(MakeFrame(1));
+        QThread::msleep(150);
+        queue.submit(MakeFrame(2));
+        QCOMPARE(scheduled, 2);
+        queue.submit(MakeFrame(3));
+        QCOMPARE(scheduled, 2);
+    }
+
+    void testDirtyRegionsMerge() {
+        PresentationQueue queue;
+        PresentationQueue::Frame frame;
+
+        queue.submit(MakeFrame(1), QRegion(0, 0, 8, 8));
+        queue.submit(MakeFrame(2), QRegion(16, 16, 8, 8));
+        QVERIFY(queue.take(&frame));
+        QCOMPARE(frame.dirty, QRegion(0, 0, 8, 8).united(QRegion(16, 16, 8, 8)));
+
+        // A full-frame update anywhere in the chain makes the result full
+        queue.submit(MakeFrame(3), QRegion(0, 0, 8, 8));
+        queue.submit(MakeFrame(4));
+        queue.submit(MakeFrame(5), QRegion(16, 16, 8, 8));
+        QVERIFY(queue.take(&frame));
+        QVERIFY(frame.dirty.isEmpty());
+
+        // So does a size change
+        queue.submit(MakeFrame(6), QRegion(0, 0, 8, 8));
+        queue.submit(MakeFrame(7, QSize(32, 32)), QRegion(0, 0, 8, 8));
+        QVERIFY(queue.take(&frame));
+        QVERIFY(frame.dirty.isEmpty());
+    }
+
+    void testClearDropsWithoutCounting() {
+        PresentationQueue queue;
+        queue.submit(MakeFrame(1));
+        queue.clear();
+        QVERIFY(!queue.hasPending());
+        QCOMPARE(queue.stats().superseded, quint64(0));
+
+        queue.submit(MakeFrame(2));
+        QCOMPARE(queue.takeStats().submitted, quint64(2));
+        QCOMPARE(queue.stats().submitted, quint64(0));
+    }
+
+    void testNullImageIgnored() {
+        PresentationQueue queue;
+        queue.submit(QImage());
+        QVERIFY(!queue.hasPending());
+        QCOMPARE(queue.stats().submitted, quint64(0));
+    }
+
+    void testConcurrentSubmitters() {
+        PresentationQueue queue;
+        std::atomic<int> scheduled{0};
+        queue.setScheduleCallback([&scheduled]() { scheduled++; });
+
+        const QImage image = MakeFrame(1);
+        constexpr int kFramesPerThread = 500;
+        QThread* producers[2];
+        for (QThread*& producer : producers) {
+            producer = QThread::create([&queue, &image]() {
+                for (int i = 0; i < kFramesPerThread; ++i) {
+                    queue.submit(image);
+                }
+            });
+            producer->start();
+        }
+
+        int presented = 0;
+        PresentationQueue::Frame frame;
+        while (producers[0]->isRunning() || producers[1]->isRunning() || queue.hasPending()) {
+            if (queue.take(&frame)) {
+                presented++;
+            }
+        }
+        for (QThread* producer : producers) {
+            producer->wait();
+            delete producer;
+        }
+
+        PresentationQueue::Stats stats = queue.stats();
+        QCOMPARE(stats.submitted, quint64(2 * kFramesPerThread));
+        QCOMPARE(stats.presented, quint64(presented));
+        QCOMPARE(stats.presented + stats.superseded, stats.submitted);
+        QVERIFY(scheduled.load() >= presented);
+    }
+};
+
+QTEST_MAIN(TestPresentationQueue)
+#include "test_presentation_queue.moc"
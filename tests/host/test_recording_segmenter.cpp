@@ -0,0 +1,173 @@
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include "host/recordingsegmenter.h"
+
+/**
+ * @brief Unit tests for RecordingSegmenter.
+ *
+ * Opens and closes segments with explicit wall-clock times and checks the
+ * file naming, when a rotation is due, the JSON index, that retention only
+ * deletes complete segments past the window, and that starting again on the
+ * same output continues the numbering and closes a segment left open.
+ */
+class TestRecordingSegmenter : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr qint64 kMinute = 60 * 1000;
+    static constexpr qint64 kStart = 1700000000000;   // Arbitrary wall-clock origin
+
+    static void writeBytes(const QString& path, int bytes) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+        QCOMPARE(file.write(QByteArray(bytes, 'x')), qint64(bytes));
+    }
+
+    static QJsonObject readIndex(const QString& path) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QJsonObject();
+        }
+        return QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    static SegmentPolicy minutePolicy() {
+        SegmentPolicy policy;
+        policy.segmentDurationMs = kMinute;
+        return policy;
+    }
+
+private slots:
+    void testNamingAndIndex() {
+        QTemporaryDir dir;
+        RecordingSegmenter segmenter;
+        QVERIFY(segmenter.begin(dir.filePath("session.mkv"), minutePolicy()));
+
+        const QString first = segmenter.openSegment(kStart);
+        QCOMPARE(first, dir.filePath("session-00001.mkv"));
+        QCOMPARE(segmenter.currentPath(), first);
+        writeBytes(first, 100);
+
+        const QString second = segmenter.openSegment(kStart + kMinute);
+        QCOMPARE(second, dir.filePath("session-00002.mkv"));
+        writeBytes(second, 40);
+        segmenter.closeSegment(kStart + kMinute + 30000);
+        QVERIFY(segmenter.currentPath().isEmpty());
+
+        QCOMPARE(segmenter.indexPath(), dir.filePath("session.segments.json"));
+        const QJsonObject index = readIndex(segmenter.indexPath());
+        QCOMPARE(index.value("recording").toString(), QStringLiteral("session.mkv"));
+        QCOMPARE(index.value("segmentDurationMs").toInteger(), kMinute);
+
+        const QJsonArray segments = index.value("segments").toArray();
+        QCOMPARE(segments.size(), 2);
+        const QJsonObject a = segments.at(0).toObject();
+        const QJsonObject b = segments.at(1).toObject();
+        QCOMPARE(a.value("file").toString(), QStringLiteral("session-00001.mkv"));
+        QCOMPARE(a.value("startMs").toInteger(), kStart);
+        QCOMPARE(a.value("durationMs").toInteger(), kMinute);
+        QCOMPARE(a.value("bytes").toInteger(), qint64(100));
+        QVERIFY(a.value("complete").toBool());
+        QVERIFY(a.value("start").toString().endsWith('Z'));
+        QCOMPARE(b.value("durationMs").toInteger(), qint64(30000));
+        QCOMPARE(b.value("bytes").toInteger(), qint64(40));
+    }
+
+    void testShouldRotate() {
+        QTemporaryDir dir;
+        SegmentPolicy policy = minutePolicy();
+        policy.segmentSizeBytes = 1000;
+        RecordingSegmenter segmenter;
+        QVERIFY(segmenter.begin(dir.filePath("rec.mp4"), policy));
+
+        QVERIFY(!segmenter.shouldRotate(kStart, 0));   // Nothing open yet
+        segmenter.openSegment(kStart);
+        QVERIFY(!segmenter.shouldRotate(kStart + kMinute - 1, 999));
+        QVERIFY(segmenter.shouldRotate(kStart + kMinute, 0));
+        QVERIFY(segmenter.shouldRotate(kStart + 1, 1000));
+
+        segmenter.openSegment(kStart + kMinute);
+        QVERIFY(!segmenter.shouldRotate(kStart + kMinute + 1, 0));
+    }
+
+    void testRetentionKeepsWindow() {
+        QTemporaryDir dir;
+        SegmentPolicy policy = minutePolicy();
+        policy.retentionMs = 3 * kMinute;
+        RecordingSegmenter segmenter;
+        QVERIFY(segmenter.begin(dir.filePath("long.mkv"), policy));
+
+        for (int i = 0; i < 6; ++i) {
+            writeBytes(segmenter.openSegment(kStart + i * kMinute), 10);
+        }
+
+        // At minute 5 the window reaches back to minute 2: only segment 1
+        // ended before it
+        const QList<RecordingSegmenter::Segment> kept = segmenter.segments();
+        QCOMPARE(kept.size(), 5);
+        QCOMPARE(kept.first().sequence, 2);
+        QVERIFY(!QFile::exists(dir.filePath("long-00001.mkv")));
+        QVERIFY(QFile::exists(dir.filePath("long-00002.mkv")));
+        QCOMPARE(readIndex(segmenter.indexPath()).value("segments").toArray().size(), 5);
+
+        // Retention alone, much later: the open segment is never removed
+        segmenter.applyRetention(kStart + 60 * kMinute);
+        QCOMPARE(segmenter.segments().size(), 1);
+        QCOMPARE(segmenter.segments().first().sequence, 6);
+    }
+
+    void testResumeAfterCrash() {
+        QTemporaryDir dir;
+        const QString output = dir.filePath("kvm.avi");
+        {
+            RecordingSegmenter segmenter;
+            QVERIFY(segmenter.begin(output, minutePolicy()));
+            writeBytes(segmenter.openSegment(kStart), 10);
+            writeBytes(segmenter.openSegment(kStart + kMinute), 25);
+            // Never closed: the process died with segment 2 open
+        }
+
+        RecordingSegmenter segmenter;
+        QVERIFY(segmenter.begin(output, minutePolicy()));
+        const QList<RecordingSegmenter::Segment> found = segmenter.segments();
+        QCOMPARE(found.size(), 2);
+        QVERIFY(found.at(1).endMs >= found.at(1).startMs);
+        QCOMPARE(found.at(1).bytes, qint64(25));
+
+        QCOMPARE(segmenter.openSegment(kStart + 10 * kMinute), dir.filePath("kvm-00003.avi"));
+        const QJsonArray segments = readIndex(segmenter.indexPath()).value("segments").toArray();
+        QCOMPARE(segments.size(), 3);
+        QVERIFY(segments.at(1).toObject().value("complete").toBool());
+        QVERIFY(!segments.at(2).toObject().value("complete").toBool());
+    }
+
+    void testPreallocationKeepsSize() {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("prealloc.bin");
+        if (!RecordingSegmenter::preallocate(path, 1024 * 1024)) {
+            QSKIP("Preallocation not supported on this platform or file system");
+        }
+        QCOMPARE(QFileInfo(path).size(), qint64(0));   // Reserved, not written
+
+        writeBytes(path, 123);
+        RecordingSegmenter::releasePreallocation(path);
+        QCOMPARE(QFileInfo(path).size(), qint64(123));
+    }
+
+    void testUnwritableDirectoryFails() {
+        RecordingSegmenter segmenter;
+        QString error;
+        QVERIFY(!segmenter.begin(QStringLiteral("/nonexistent-dir/rec.mkv"), minutePolicy(), &error));
+        QVERIFY(!error.isEmpty());
+        QVERIFY(segmenter.openSegment(kStart).isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestRecordingSegmenter)
+#include "test_recording_segmenter.moc"
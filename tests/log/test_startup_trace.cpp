@@ -0,0 +1,155 @@
+#include <QTest>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+#include "log/startuptrace.h"
+
+/**
+ * @brief Unit tests for StartupTrace.
+ *
+ * Checks that markers are dropped while tracing is off, that spans come out
+ * as matched begin/end events in Chrome trace JSON with their thread names,
+ * that the first frame is recorded once and that only the first finish()
+ * writes the file.
+ */
+class TestStartupTrace : public QObject {
+    Q_OBJECT
+
+private:
+    static StartupTrace& trace() { return StartupTrace::instance(); }
+
+    static QJsonArray events() {
+        return QJsonDocument::fromJson(trace().toJson()).object().value("traceEvents").toArray();
+    }
+
+    static QList<QJsonObject> eventsNamed(const QString& name, const QString& phase) {
+        QList<QJsonObject> found;
+        for (const QJsonValue& value : events()) {
+            const QJsonObject event = value.toObject();
+            if (event.value("name").toString() == name && event.value("ph").toString() == phase) {
+                found.append(event);
+            }
+        }
+        return found;
+    }
+
+private slots:
+    void init() {
+        trace().reset();
+    }
+
+    void cleanup() {
+        trace().reset();
+    }
+
+    void testDisabledRecordsNothing() {
+        QVERIFY(!StartupTrace::isEnabled());
+        {
+            OPF_STARTUP_SPAN("ignored", "test");
+            trace().instant("ignored", "test");
+            trace().markFirstFrame("test");
+        }
+        QCOMPARE(trace().eventCount(), 0);
+        QCOMPARE(trace().firstFrameUs(), qint64(-1));
+        QVERIFY(!trace().finish());
+    }
+
+    void testSpansNestAndOrder() {
+        QTemporaryDir dir;
+        trace().start(dir.filePath("trace.json"));
+        QVERIFY(StartupTrace::isEnabled());
+        {
+            OPF_STARTUP_SPAN("outer", "test");
+            QThread::msleep(2);
+            {
+                OPF_STARTUP_SPAN("inner", "test");
+                QThread::msleep(2);
+            }
+        }
+
+        const QList<QJsonObject> outerBegin = eventsNamed("outer", "B");
+        const QList<QJsonObject> outerEnd = eventsNamed("outer", "E");
+        const QList<QJsonObject> innerBegin = eventsNamed("inner", "B");
+        const QList<QJsonObject> innerEnd = eventsNamed("inner", "E");
+        QCOMPARE(outerBegin.size(), 1);
+        QCOMPARE(outerEnd.size(), 1);
+        QCOMPARE(innerBegin.size(), 1);
+        QCOMPARE(innerEnd.size(), 1);
+
+        const qint64 ob = outerBegin.first().value("ts").toInteger();
+        const qint64 ib = innerBegin.first().value("ts").toInteger();
+        const qint64 ie = innerEnd.first().value("ts").toInteger();
+        const qint64 oe = outerEnd.first().value("ts").toInteger();
+        QVERIFY(ob <= ib);
+        QVERIFY(ib < ie);
+        QVERIFY(ie <= oe);
+        QVERIFY(ie - ib >= 2000);   // Microseconds
+        QCOMPARE(outerBegin.first().value("cat").toString(), QStringLiteral("test"));
+        QCOMPARE(outerBegin.first().value("tid"), outerEnd.first().value("tid"));
+    }
+
+    void testThreadsAreNamed() {
+        trace().start(QString());
+        trace().instant("on main", "test");
+
+        QThread worker;
+        worker.setObjectName(QStringLiteral("TraceWorker"));
+        QObject::connect(&worker, &QThread::started, &worker, []() {
+            OPF_STARTUP_SPAN("on worker", "test");
+        }, Qt::DirectConnection);
+        worker.start();
+        QVERIFY(worker.wait(5000));
+
+        const qint64 mainTid = eventsNamed("on main", "i").first().value("tid").toInteger();
+        const qint64 workerTid = eventsNamed("on worker", "B").first().value("tid").toInteger();
+        QVERIFY(mainTid != workerTid);
+
+        QHash<qint64, QString> names;
+        for (const QJsonObject& meta : eventsNamed("thread_name", "M")) {
+            names.insert(meta.value("tid").toInteger(), meta.value("args").toObject().value("name").toString());
+        }
+        QCOMPARE(names.value(mainTid), QStringLiteral("main"));
+        QCOMPARE(names.value(workerTid), QStringLiteral("TraceWorker"));
+    }
+
+    void testFirstFrameRecordedOnce() {
+        trace().start(QString());
+        trace().markFirstFrame("first");
+        trace().markFirstFrame("second");
+
+        QVERIFY(trace().firstFrameUs() >= 0);
+        QCOMPARE(eventsNamed("first frame", "i").size(), 1);
+        const QJsonObject other = QJsonDocument::fromJson(trace().toJson()).object().value("otherData").toObject();
+        QCOMPARE(other.value("firstFrameSource").toString(), QStringLiteral("first"));
+        QVERIFY(other.value("firstFrameMs").toDouble() >= 0.0);
+    }
+
+    void testFinishWritesOnce() {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("trace.json");
+        trace().start(path);
+        {
+            OPF_STARTUP_SPAN("step", "test");
+        }
+        QVERIFY(trace().finish());
+        QVERIFY(!StartupTrace::isEnabled());
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+        QVERIFY(root.value("traceEvents").isArray());
+        QCOMPARE(root.value("displayTimeUnit").toString(), QStringLiteral("ms"));
+        file.close();
+
+        // Markers after the write are dropped and the file stays as written
+        trace().instant("late", "test");
+        QVERIFY(!trace().finish());
+        QVERIFY(eventsNamed("late", "i").isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestStartupTrace)
+#include "test_startup_trace.moc"
@@ -0,0 +1,135 @@
+#include <QTest>
+#include <QSemaphore>
+#include <QSignalSpy>
+#include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <atomic>
+#include <stdexcept>
+#include "ui/initializer/startuptaskgraph.h"
+
+/**
+ * @brief Unit tests for StartupTaskGraph.
+ *
+ * Checks that a task only runs once its dependencies have finished, that
+ * independent pool tasks really overlap, that context tasks run on their
+ * context's thread, that a throwing task does not stall its dependents, and
+ * that unknown dependencies and cycles are refused before anything runs.
+ */
+class TestStartupTaskGraph : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testDependenciesRunInOrder() {
+        StartupTaskGraph graph;
+        QMutex mutex;
+        QStringList order;
+        auto record = [&mutex, &order](const QString& name) {
+            QMutexLocker locker(&mutex);
+            order << name;
+        };
+        graph.addTask("a", nullptr, [&]() { QThread::msleep(20); record("a"); });
+        graph.addTask("b", nullptr, [&]() { record("b"); }, {"a"});
+        graph.addTask("c", &graph, [&]() { record("c"); }, {"a"});
+        graph.addTask("d", nullptr, [&]() { record("d"); }, {"b", "c"});
+
+        QSignalSpy finished(&graph, &StartupTaskGraph::finished);
+        QVERIFY(graph.start());
+        QVERIFY(finished.wait(5000));
+        QCOMPARE(finished.count(), 1);
+        QVERIFY(graph.isFinished());
+        QVERIFY(!graph.isRunning());
+
+        QCOMPARE(order.size(), 4);
+        QCOMPARE(order.first(), QStringLiteral("a"));
+        QCOMPARE(order.last(), QStringLiteral("d"));
+        QCOMPARE(graph.completedTasks().size(), 4);
+    }
+
+    void testIndependentPoolTasksOverlap() {
+        // Each task waits for the other to start: they can only both finish
+        // when the pool runs them at the same time
+        QThreadPool pool;
+        pool.setMaxThreadCount(2);
+        StartupTaskGraph graph;
+        graph.setThreadPool(&pool);
+        QSemaphore first;
+        QSemaphore second;
+        std::atomic<int> met{0};
+        graph.addTask("first", nullptr, [&]() {
+            second.release();
+            if (first.tryAcquire(1, 2000)) met++;
+        });
+        graph.addTask("second", nullptr, [&]() {
+            first.release();
+            if (second.tryAcquire(1, 2000)) met++;
+        });
+
+        QSignalSpy finished(&graph, &StartupTaskGraph::finished);
+        QVERIFY(graph.start());
+        QVERIFY(finished.wait(5000));
+        QCOMPARE(met.load(), 2);
+    }
+
+    void testContextTaskRunsOnContextThread() {
+        QThread worker;
+        QObject context;
+        context.moveToThread(&worker);
+        worker.start();
+
+        StartupTaskGraph graph;
+        QThread* ranOn = nullptr;
+        graph.addTask("onWorker", &context, [&ranOn]() { ranOn = QThread::currentThread(); });
+        QThread* guiRanOn = nullptr;
+        graph.addTask("onGui", &graph, [&guiRanOn]() { guiRanOn = QThread::currentThread(); }, {"onWorker"});
+
+        QSignalSpy finished(&graph, &StartupTaskGraph::finished);
+        QVERIFY(graph.start());
+        QVERIFY(finished.wait(5000));
+        QCOMPARE(ranOn, &worker);
+        QCOMPARE(guiRanOn, QThread::currentThread());
+
+        worker.quit();
+        worker.wait();
+    }
+
+    void testThrowingTaskDoesNotStall() {
+        StartupTaskGraph graph;
+        bool dependentRan = false;
+        graph.addTask("throws", &graph, []() { throw std::runtime_error("boom"); });
+        graph.addTask("after", &graph, [&dependentRan]() { dependentRan = true; }, {"throws"});
+
+        QSignalSpy finished(&graph, &StartupTaskGraph::finished);
+        QVERIFY(graph.start());
+        QVERIFY(finished.wait(5000));
+        QVERIFY(dependentRan);
+    }
+
+    void testInvalidGraphsAreRefused() {
+        bool ran = false;
+        StartupTaskGraph unknown;
+        unknown.addTask("a", nullptr, [&ran]() { ran = true; }, {"missing"});
+        QVERIFY(!unknown.start());
+
+        StartupTaskGraph cyclic;
+        cyclic.addTask("root", nullptr, [&ran]() { ran = true; });
+        cyclic.addTask("x", nullptr, [&ran]() { ran = true; }, {"root", "y"});
+        cyclic.addTask("y", nullptr, [&ran]() { ran = true; }, {"x"});
+        QVERIFY(!cyclic.start());
+
+        QThreadPool::globalInstance()->waitForDone();
+        QCoreApplication::processEvents();
+        QVERIFY(!ran);
+    }
+
+    void testEmptyGraphFinishesImmediately() {
+        StartupTaskGraph graph;
+        QSignalSpy finished(&graph, &StartupTaskGraph::finished);
+        QVERIFY(graph.start());
+        QCOMPARE(finished.count(), 1);
+        QVERIFY(graph.isFinished());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestStartupTaskGraph)
+#include "test_startup_task_graph.moc"
@@ -9,11 +9,13 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QFileInfo>
+#include <QFileDialog>
 #include <QSvgWidget>
 #include "diagnostics/diagnosticsmanager.h"
 #include "diagnostics/diagnostics_constants.h"
 #include "diagnostics/SupportEmailDialog.h"
 #include "../../serial/SerialPortManager.h"
+#include "../../host/frametiming.h"
 #include "log/opflogging.h"
 
 OPF_LOGGING_CATEGORY(log_device_diagnostics, "opf.diagnostics")
@@ -80,6 +82,7 @@ DeviceDiagnosticsDialog::DeviceDiagnosticsDialog(QWidget *parent)
     , m_nextButton(nullptr)
     , m_checkNowButton(nullptr)
     , m_supportEmailButton(nullptr)
+    , m_exportTimingButton(nullptr)
     , m_currentTestIndex(0)
     , m_connectionSvg(nullptr)
     , m_svgAnimationTimer(nullptr)
@@ -344,11 +347,18 @@ void DeviceDiagnosticsDialog::setupRightPanel()
     m_supportEmailButton->setMinimumHeight(35);
     connect(m_supportEmailButton, &QPushButton::clicked, this, &DeviceDiagnosticsDialog::onSupportEmailClicked);
     
+    m_exportTimingButton = new QPushButton(tr("Export Frame Timing"), this);
+    m_exportTimingButton->setIcon(style()->standardIcon(QStyle::SP_DialogSaveButton));
+    m_exportTimingButton->setMinimumHeight(35);
+    m_exportTimingButton->setToolTip(tr("Save capture interval, decode time, dropped frames and display jitter of the current video session"));
+    connect(m_exportTimingButton, &QPushButton::clicked, this, &DeviceDiagnosticsDialog::onExportFrameTimingClicked);
+    
     m_buttonLayout->addWidget(m_restartButton);
     m_buttonLayout->addStretch();
     m_buttonLayout->addWidget(m_previousButton);
     m_buttonLayout->addWidget(m_nextButton);
     m_buttonLayout->addWidget(m_checkNowButton);
+    m_buttonLayout->addWidget(m_exportTimingButton);
     m_buttonLayout->addWidget(m_supportEmailButton);
     
     m_rightLayout->addLayout(m_buttonLayout);
@@ -651,3 +661,26 @@ void DeviceDiagnosticsDialog::onSupportEmailClicked()
     dialog->exec();
 }
 
+void DeviceDiagnosticsDialog::onExportFrameTimingClicked()
+{
+    FrameTimingRecorder& timing = FrameTimingRecorder::instance();
+    if (timing.snapshot().totalCaptured == 0) {
+        QMessageBox::information(this, tr("Frame Timing"),
+            tr("No frame timing recorded yet. Start video capture, then export again."));
+        return;
+    }
+
+    QString defaultName = QString("frame-timing-%1.csv")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+    QString defaultPath = QDir(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).filePath(defaultName);
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Export Frame Timing"), defaultPath,
+                                                    tr("CSV Files (*.csv);;JSON Files (*.json)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QString error;
+    if (!timing.exportToFile(filePath, &error)) {
+        QMessageBox::warning(this, tr("Frame Timing"), tr("Failed to write %1: %2").arg(filePath, error));
+    }
+}
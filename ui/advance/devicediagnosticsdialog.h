@@ -54,6 +54,7 @@ public slots:
     void onTestItemClicked(QListWidgetItem* item);
     void onOpenLogFileClicked();
     void onSupportEmailClicked();
+    void onExportFrameTimingClicked();
     
 private slots:
     void onLogAppended(const QString &entry);
@@ -96,6 +97,7 @@ private:
     QPushButton* m_nextButton;
     QPushButton* m_checkNowButton;
     QPushButton* m_supportEmailButton;
+    QPushButton* m_exportTimingButton;
     
     // Test management
     int m_currentTestIndex;
@@ -37,6 +37,7 @@
 #include <QLabel>
 #include <QComboBox>
 #include <QSpinBox>
+#include <QCheckBox>
 #include <QPushButton>
 #include <QLineEdit>
 #include <QProgressBar>
@@ -283,7 +284,7 @@ void RecordingSettingsDialog::setupVideoSettings()
     QString configuredBackend = GlobalSetting::instance().getMediaBackend();
     if (configuredBackend.toLower() == "gstreamer") {
         m_videoCodecCombo->addItems({"mjpeg", "x264enc", "x265enc"}); // GStreamer codec names
-        m_videoCodecCombo->setToolTip(tr("GStreamer codecs: mjpeg (fast), x264enc (good compression), x265enc (best compression)"));
+        m_videoCodecCombo->setToolTip(tr("GStreamer codecs: mjpeg (camera frames stored as-is in AVI/MKV), x264enc (good compression), x265enc (best compression)"));
     } else {
         m_videoCodecCombo->addItems({"mjpeg"}); // FFmpeg/default - MJPEG encoder for AVI container creates playable video files
         m_videoCodecCombo->setToolTip(tr("FFmpeg codec: mjpeg (compatible with AVI format)"));
@@ -304,6 +305,10 @@ void RecordingSettingsDialog::setupVideoSettings()
     m_videoBitrateSpin->setSuffix(" kbps");
     layout->addWidget(m_videoBitrateSpin, row++, 1);
     
+    m_variableFrameRateCheck = new QCheckBox(tr("Variable frame rate"));
+    m_variableFrameRateCheck->setToolTip(tr("Only encode frames where the screen changed; an idle desktop costs almost nothing (FFmpeg backend)"));
+    layout->addWidget(m_variableFrameRateCheck, row++, 1);
+    
     // Connect quality preset to update bitrate
     connect(m_videoQualityCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             [this](int index) {
@@ -363,6 +368,35 @@ void RecordingSettingsDialog::setupOutputSettings()
             m_outputPathEdit->setText(newPath);
         }
     });
+    
+    // Long sessions: numbered files next to the output path, listed in
+    // <name>.segments.json
+    layout->addWidget(new QLabel(tr("Split Every:")), row, 0);
+    m_segmentMinutesSpin = new QSpinBox();
+    m_segmentMinutesSpin->setRange(0, 24 * 60);
+    m_segmentMinutesSpin->setSuffix(tr(" min"));
+    m_segmentMinutesSpin->setSpecialValueText(tr("Single file"));
+    m_segmentMinutesSpin->setToolTip(tr("Start a new file at this interval so a crash only loses the current segment"));
+    layout->addWidget(m_segmentMinutesSpin, row++, 1);
+    
+    layout->addWidget(new QLabel(tr("Keep Last:")), row, 0);
+    m_retentionHoursSpin = new QSpinBox();
+    m_retentionHoursSpin->setRange(0, 24 * 30);
+    m_retentionHoursSpin->setSuffix(tr(" h"));
+    m_retentionHoursSpin->setSpecialValueText(tr("All segments"));
+    m_retentionHoursSpin->setToolTip(tr("Delete segments older than this while recording"));
+    layout->addWidget(m_retentionHoursSpin, row++, 1);
+    
+    m_retentionHoursSpin->setEnabled(false);
+    connect(m_segmentMinutesSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int minutes) {
+        m_retentionHoursSpin->setEnabled(minutes > 0);
+    });
+    
+    // Codec and bitrate come from Preferences > Audio
+    m_recordAudioCheck = new QCheckBox(tr("Record target audio"));
+    m_recordAudioCheck->setChecked(true);
+    m_recordAudioCheck->setToolTip(tr("Add the captured HDMI audio to the recording (FFmpeg backend)"));
+    layout->addWidget(m_recordAudioCheck, row++, 1);
 }
 
 void RecordingSettingsDialog::connectSignals()
@@ -573,11 +607,30 @@ void RecordingSettingsDialog::onApplySettings()
         config.video_bitrate = m_videoBitrateSpin->value() * 1000; // Convert to bps
         config.video_quality = 23; // Use default CRF value
         config.use_hardware_acceleration = false; // Default to false for compatibility
+        config.segment_duration_sec = m_segmentMinutesSpin->value() * 60;
+        config.retention_hours = m_retentionHoursSpin->value();
+        config.record_audio = m_recordAudioCheck->isChecked();
+        config.variable_frame_rate = m_variableFrameRateCheck->isChecked();
+        config.audio_codec = GlobalSetting::instance().getRecordingAudioCodec().toLower();
+        config.audio_bitrate = GlobalSetting::instance().getRecordingAudioBitrate();
+        if (config.audio_bitrate < 1000) {
+            config.audio_bitrate *= 1000;  // The audio preferences page stores kbps
+        }
         
         m_ffmpegBackend->setRecordingConfig(config);
     }
-    // For GStreamer backend, we'll handle the config in the backend itself
-    // since GStreamer doesn't need the same config structure
+    // GStreamer only needs the codec/format pair to decide whether the camera's
+    // MJPEG can be muxed as-is
+    if (GStreamerBackendHandler* gstBackend = qobject_cast<GStreamerBackendHandler*>(backend)) {
+        GStreamerBackendHandler::RecordingConfig config;
+        config.outputPath = m_outputPathEdit->text();
+        config.format = m_formatCombo->currentText();
+        config.videoCodec = m_videoCodecCombo->currentText();
+        config.videoBitrate = m_videoBitrateSpin->value() * 1000; // Convert to bps
+        config.segmentDurationSec = m_segmentMinutesSpin->value() * 60;
+        config.retentionHours = m_retentionHoursSpin->value();
+        gstBackend->setRecordingConfig(config);
+    }
 #endif
     
     saveSettings();
@@ -590,9 +643,13 @@ void RecordingSettingsDialog::onResetToDefaults()
     m_videoCodecCombo->setCurrentText("mjpeg");
     m_videoQualityCombo->setCurrentIndex(1); // Medium
     m_videoBitrateSpin->setValue(2000);
+    m_variableFrameRateCheck->setChecked(false);
     
     m_formatCombo->setCurrentText("avi");
     m_outputPathEdit->setText(generateDefaultOutputPath());
+    m_segmentMinutesSpin->setValue(0);
+    m_retentionHoursSpin->setValue(0);
+    m_recordAudioCheck->setChecked(true);
 }
 
 void RecordingSettingsDialog::onRecordingStarted(const QString& outputPath)
@@ -695,7 +752,37 @@ void RecordingSettingsDialog::updateRecordingInfo()
         if (backend) {
             qint64 duration = backend->getRecordingDuration();
             if (duration > 0) {
-                m_durationLabel->setText(tr("Duration: %1").arg(formatDuration(duration)));
+                QString text = tr("Duration: %1").arg(formatDuration(duration));
+#ifndef Q_OS_WIN
+                // Show encoder backlog so dropped recording frames are visible
+                if (m_ffmpegBackend && backend == m_ffmpegBackend && m_ffmpegBackend->supportsRecordingStats()) {
+                    RecordingStats stats = m_ffmpegBackend->getRecordingStats();
+                    if (stats.queue_capacity > 0) {
+                        text += tr("  |  Encoder queue: %1/%2, dropped: %3, repeated: %4")
+                                    .arg(stats.queue_length)
+                                    .arg(stats.queue_capacity)
+                                    .arg(stats.frames_dropped)
+                                    .arg(stats.frames_duplicated);
+                    }
+                    if (stats.frames_skipped > 0) {
+                        text += tr(", unchanged: %1").arg(stats.frames_skipped);
+                    }
+                    if (stats.has_audio) {
+                        text += tr(", audio resync: +%1/-%2 samples")
+                                    .arg(stats.audio_samples_padded)
+                                    .arg(stats.audio_samples_dropped);
+                    }
+                } else if (GStreamerBackendHandler* gstBackend = qobject_cast<GStreamerBackendHandler*>(backend)) {
+                    GstRecordingStats stats = gstBackend->getRecordingStats();
+                    if (stats.active && stats.backlogLimitBytes > 0) {
+                        text += tr("  |  Encoder backlog: %1/%2 KB, dropped: %3")
+                                    .arg(stats.backlogBytes / 1024)
+                                    .arg(stats.backlogLimitBytes / 1024)
+                                    .arg(stats.framesDropped + stats.queueOverruns);
+                    }
+                }
+#endif
+                m_durationLabel->setText(text);
             }
         }
     }
@@ -770,7 +857,7 @@ void RecordingSettingsDialog::refreshUIForBackend()
     m_videoCodecCombo->clear();
     if (configuredBackend.toLower() == "gstreamer") {
         m_videoCodecCombo->addItems({"mjpeg", "x264enc", "x265enc"}); 
-        m_videoCodecCombo->setToolTip(tr("GStreamer codecs: mjpeg (fast), x264enc (good compression), x265enc (best compression)"));
+        m_videoCodecCombo->setToolTip(tr("GStreamer codecs: mjpeg (camera frames stored as-is in AVI/MKV), x264enc (good compression), x265enc (best compression)"));
     } else {
         m_videoCodecCombo->addItems({"mjpeg"}); 
         m_videoCodecCombo->setToolTip(tr("FFmpeg codec: mjpeg (compatible with AVI format)"));
@@ -808,6 +895,7 @@ void RecordingSettingsDialog::loadSettings()
     
     m_videoCodecCombo->setCurrentText(settings.getRecordingVideoCodec());
     m_videoBitrateSpin->setValue(settings.getRecordingVideoBitrate() / 1000);
+    m_variableFrameRateCheck->setChecked(settings.getRecordingVariableFrameRate());
     
     m_formatCombo->setCurrentText(settings.getRecordingOutputFormat());
     
@@ -816,6 +904,10 @@ void RecordingSettingsDialog::loadSettings()
         savedPath = generateDefaultOutputPath();
     }
     m_outputPathEdit->setText(savedPath);
+    
+    m_segmentMinutesSpin->setValue(settings.getRecordingSegmentMinutes());
+    m_retentionHoursSpin->setValue(settings.getRecordingRetentionHours());
+    m_recordAudioCheck->setChecked(settings.getRecordingAudioEnabled());
 }
 
 void RecordingSettingsDialog::saveSettings()
@@ -824,8 +916,12 @@ void RecordingSettingsDialog::saveSettings()
     
     settings.setRecordingVideoCodec(m_videoCodecCombo->currentText());
     settings.setRecordingVideoBitrate(m_videoBitrateSpin->value() * 1000);
+    settings.setRecordingVariableFrameRate(m_variableFrameRateCheck->isChecked());
     settings.setRecordingOutputFormat(m_formatCombo->currentText());
     settings.setRecordingOutputPath(m_outputPathEdit->text());
+    settings.setRecordingSegmentMinutes(m_segmentMinutesSpin->value());
+    settings.setRecordingRetentionHours(m_retentionHoursSpin->value());
+    settings.setRecordingAudioEnabled(m_recordAudioCheck->isChecked());
 }
 
 QString RecordingSettingsDialog::formatDuration(qint64 milliseconds)
@@ -27,6 +27,7 @@
 #include <QLabel>
 #include <QComboBox>
 #include <QSpinBox>
+#include <QCheckBox>
 #include <QPushButton>
 #include <QLineEdit>
 #include <QVBoxLayout>
@@ -135,12 +136,16 @@ private:
     QComboBox* m_videoCodecCombo;
     QComboBox* m_videoQualityCombo;
     QSpinBox* m_videoBitrateSpin;
+    QCheckBox* m_variableFrameRateCheck;
     
     // Output settings
     QGroupBox* m_outputGroup;
     QLineEdit* m_outputPathEdit;
     QPushButton* m_browseButton;
     QComboBox* m_formatCombo;
+    QSpinBox* m_segmentMinutesSpin;
+    QSpinBox* m_retentionHoursSpin;
+    QCheckBox* m_recordAudioCheck;
     
     // Control buttons
     QPushButton* m_applyButton;
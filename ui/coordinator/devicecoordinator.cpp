@@ -57,6 +57,11 @@ DeviceCoordinator::~DeviceCoordinator()
 }
 
 void DeviceCoordinator::setupDeviceMenu()
+{
+    setupDeviceMenu(DeviceManager::getInstance().discoverDevices());
+}
+
+void DeviceCoordinator::setupDeviceMenu(const QList<DeviceInfo> &devices)
 {
     qCDebug(log_ui_devicecoordinator) << "Setting up device menu";
     
@@ -70,10 +75,16 @@ void DeviceCoordinator::setupDeviceMenu()
     }
     
     // Initial population of device menu
-    updateDeviceMenu();
+    updateDeviceMenu(devices);
 }
 
 void DeviceCoordinator::updateDeviceMenu()
+{
+    // Force discovery for up-to-date list
+    updateDeviceMenu(DeviceManager::getInstance().discoverDevices());
+}
+
+void DeviceCoordinator::updateDeviceMenu(const QList<DeviceInfo> &devices)
 {
     qCDebug(log_ui_devicecoordinator) << "Updating device menu";
     if (!m_deviceMenuGroup || !m_deviceMenu) {
@@ -85,10 +96,6 @@ void DeviceCoordinator::updateDeviceMenu()
     m_deviceMenu->clear();
     qDeleteAll(m_deviceMenuGroup->actions());
     
-    // Get available devices from DeviceManager
-    DeviceManager& deviceManager = DeviceManager::getInstance();
-    QList<DeviceInfo> devices = deviceManager.discoverDevices(); // Force discovery for up-to-date list
-    
     // Get currently selected device port chain
     QString currentPortChain = GlobalSetting::instance().getOpenterfacePortChain();
     
@@ -67,12 +67,24 @@ public:
      * Sets up the menu structure and populates with available devices
      */
     void setupDeviceMenu();
+
+    /**
+     * @brief Initialize device menu from an already discovered device list
+     * @param devices Result of DeviceManager::discoverDevices(), e.g. from a worker thread
+     */
+    void setupDeviceMenu(const QList<DeviceInfo> &devices);
     
     /**
      * @brief Update device menu with latest device list
      * Refreshes the menu to reflect current device availability
      */
     void updateDeviceMenu();
+
+    /**
+     * @brief Update device menu from an already discovered device list
+     * @param devices Result of DeviceManager::discoverDevices()
+     */
+    void updateDeviceMenu(const QList<DeviceInfo> &devices);
     
     /**
      * @brief Get the currently selected device port chain
@@ -169,6 +169,51 @@ QString GlobalSetting::getScalingQuality() const {
     return m_settings.value("video/scalingQuality", "balanced").toString();
 }
 
+void GlobalSetting::setDecodeWorkerCount(int workers) {
+    m_settings.setValue("video/decodeWorkers", workers);
+    m_settings.sync();
+}
+
+int GlobalSetting::getDecodeWorkerCount() const {
+    return m_settings.value("video/decodeWorkers", 0).toInt();
+}
+
+void GlobalSetting::setDecodeQueueDepth(int depth) {
+    m_settings.setValue("video/decodeQueueDepth", depth);
+    m_settings.sync();
+}
+
+int GlobalSetting::getDecodeQueueDepth() const {
+    return m_settings.value("video/decodeQueueDepth", 4).toInt();
+}
+
+void GlobalSetting::setStripDecodeThreads(int threads) {
+    m_settings.setValue("video/stripDecodeThreads", threads);
+    m_settings.sync();
+}
+
+int GlobalSetting::getStripDecodeThreads() const {
+    return m_settings.value("video/stripDecodeThreads", 0).toInt();
+}
+
+void GlobalSetting::setDecodeLatencyBudget(int ms) {
+    m_settings.setValue("video/decodeLatencyBudgetMs", ms);
+    m_settings.sync();
+}
+
+int GlobalSetting::getDecodeLatencyBudget() const {
+    return m_settings.value("video/decodeLatencyBudgetMs", -1).toInt();
+}
+
+void GlobalSetting::setLatencyOverlayEnabled(bool enabled) {
+    m_settings.setValue("video/latencyOverlay", enabled);
+    m_settings.sync();
+}
+
+bool GlobalSetting::getLatencyOverlayEnabled() const {
+    return m_settings.value("video/latencyOverlay", false).toBool();
+}
+
 void GlobalSetting::setGStreamerPipelineTemplate(const QString &pipelineTemplate) {
     m_settings.setValue("video/gstreamerPipelineTemplate", pipelineTemplate);
 }
@@ -177,6 +222,7 @@ QString GlobalSetting::getGStreamerPipelineTemplate() const {
     // Default GStreamer pipeline template with placeholders, tee, and valve for recording support
     QString defaultTemplate = "v4l2src device=%DEVICE% do-timestamp=true ! "
                              "image/jpeg,width=%WIDTH%,height=%HEIGHT%,framerate=%FRAMERATE%/1 ! "
+                             "tee name=jpeg-tee allow-not-linked=true ! "
                              "jpegdec ! "
                              "videoconvert ! "
                              "identity sync=true ! "
@@ -539,6 +585,16 @@ int GlobalSetting::getRecordingAudioSampleRate() const
     return m_settings.value("recording/audioSampleRate", 44100).toInt();
 }
 
+void GlobalSetting::setRecordingAudioEnabled(bool enabled)
+{
+    m_settings.setValue("recording/audioEnabled", enabled);
+}
+
+bool GlobalSetting::getRecordingAudioEnabled() const
+{
+    return m_settings.value("recording/audioEnabled", true).toBool();
+}
+
 void GlobalSetting::setRecordingOutputFormat(const QString& format)
 {
     m_settings.setValue("recording/outputFormat", format);
@@ -559,6 +615,36 @@ QString GlobalSetting::getRecordingOutputPath() const
     return m_settings.value("recording/outputPath", "").toString();
 }
 
+void GlobalSetting::setRecordingSegmentMinutes(int minutes)
+{
+    m_settings.setValue("recording/segmentMinutes", minutes);
+}
+
+int GlobalSetting::getRecordingSegmentMinutes() const
+{
+    return m_settings.value("recording/segmentMinutes", 0).toInt();
+}
+
+void GlobalSetting::setRecordingRetentionHours(int hours)
+{
+    m_settings.setValue("recording/retentionHours", hours);
+}
+
+int GlobalSetting::getRecordingRetentionHours() const
+{
+    return m_settings.value("recording/retentionHours", 0).toInt();
+}
+
+void GlobalSetting::setRecordingVariableFrameRate(bool enabled)
+{
+    m_settings.setValue("recording/variableFrameRate", enabled);
+}
+
+bool GlobalSetting::getRecordingVariableFrameRate() const
+{
+    return m_settings.value("recording/variableFrameRate", false).toBool();
+}
+
 void GlobalSetting::setAudioMuted(bool muted)
 {
     m_settings.setValue("audio/muted", muted);
@@ -600,6 +686,16 @@ bool GlobalSetting::getVideoSmoothTransform() const
     return m_settings.value("video/smoothTransform", true).toBool();
 }
 
+void GlobalSetting::setOpenGLVideoEnabled(bool enabled)
+{
+    m_settings.setValue("video/openglRenderer", enabled);
+}
+
+bool GlobalSetting::getOpenGLVideoEnabled() const
+{
+    return m_settings.value("video/openglRenderer", false).toBool();
+}
+
 // Custom key import path settings
 void GlobalSetting::setLastCustomKeyImportPath(const QString& path)
 {
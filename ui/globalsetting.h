@@ -62,6 +62,22 @@ public:
     
     void setScalingQuality(const QString &quality);
     QString getScalingQuality() const;
+
+    // Pipelined MJPEG decode (FFmpeg backend); 0 workers = automatic
+    void setDecodeWorkerCount(int workers);
+    int getDecodeWorkerCount() const;
+    void setDecodeQueueDepth(int depth);
+    int getDecodeQueueDepth() const;
+    // Restart-marker strip decoding of 4K MJPEG; 0 threads = automatic, 1 = off
+    void setStripDecodeThreads(int threads);
+    int getStripDecodeThreads() const;
+    // Decode governor budget in ms per frame; 0 disables the governor,
+    // -1 = automatic (on for ARM hosts only)
+    void setDecodeLatencyBudget(int ms);
+    int getDecodeLatencyBudget() const;
+    // On-screen frame latency statistics in the video pane
+    void setLatencyOverlayEnabled(bool enabled);
+    bool getLatencyOverlayEnabled() const;
     
     void setGStreamerPipelineTemplate(const QString &pipelineTemplate);
     QString getGStreamerPipelineTemplate() const;
@@ -142,11 +158,23 @@ public:
     int getRecordingAudioBitrate() const;
     void setRecordingAudioSampleRate(int sampleRate);
     int getRecordingAudioSampleRate() const;
+    // Whether recordings include the captured target audio
+    void setRecordingAudioEnabled(bool enabled);
+    bool getRecordingAudioEnabled() const;
     
     void setRecordingOutputFormat(const QString& format);
     QString getRecordingOutputFormat() const;
     void setRecordingOutputPath(const QString& path);
     QString getRecordingOutputPath() const;
+    // Long recordings: a new file every N minutes (0 = one file), and how many
+    // hours of segments to keep (0 = all)
+    void setRecordingSegmentMinutes(int minutes);
+    int getRecordingSegmentMinutes() const;
+    void setRecordingRetentionHours(int hours);
+    int getRecordingRetentionHours() const;
+    // Encode only frames that changed (plus a keepalive) instead of a constant rate
+    void setRecordingVariableFrameRate(bool enabled);
+    bool getRecordingVariableFrameRate() const;
     
     // Audio mute setting
     void setAudioMuted(bool muted);
@@ -159,6 +187,8 @@ public:
     bool getVideoTextAntialiasing() const;
     void setVideoSmoothTransform(bool enabled);
     bool getVideoSmoothTransform() const;
+    void setOpenGLVideoEnabled(bool enabled);   // Takes effect on the next start
+    bool getOpenGLVideoEnabled() const;
 
     // Custom key import path persistence
     void setLastCustomKeyImportPath(const QString& path);
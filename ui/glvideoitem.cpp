@@ -0,0 +1,462 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "glvideoitem.h"
+
+#include <QLoggingCategory>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLWidget>
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPainterPath>
+
+#include "log/opflogging.h"
+OPF_LOGGING_CATEGORY(log_ui_glvideo, "opf.ui.glvideo")
+
+// Written for GLSL 1.10 / GLSL ES 1.00 so the same program links on desktop
+// drivers, GLES 2 and Mesa llvmpipe. Qt defines the precision qualifiers
+// away on desktop GL.
+static const char *kVertexShader =
+    "attribute highp vec2 position;\n"
+    "attribute highp vec2 texCoord;\n"
+    "varying highp vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    v_texCoord = texCoord;\n"
+    "    gl_Position = vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+// QImage::Format_RGB32 is BGRA in memory on little-endian hosts; it is
+// uploaded as RGBA and swizzled here instead of converted on the CPU.
+static const char *kFragmentShader =
+    "varying highp vec2 v_texCoord;\n"
+    "uniform sampler2D frame;\n"
+    "uniform lowp float swapRedBlue;\n"
+    "void main() {\n"
+    "    lowp vec3 color = texture2D(frame, v_texCoord).rgb;\n"
+    "    gl_FragColor = vec4(mix(color, color.bgr, swapRedBlue), 1.0);\n"
+    "}\n";
+
+static constexpr int kPositionAttribute = 0;
+static constexpr int kTexCoordAttribute = 1;
+
+// Same placeholder size VideoPane uses before the first FFmpeg frame
+static const QSizeF kPlaceholderSize(640, 480);
+
+// Past this many rectangles or this share of the frame one full upload is
+// cheaper than the per-rectangle copies and calls
+static constexpr int kMaxPartialRects = 64;
+static constexpr double kMaxPartialAreaRatio = 0.5;
+
+GLVideoItem::GLVideoItem(QGraphicsItem *parent)
+    : QGraphicsPixmapItem(parent)
+    , m_dpr(1.0)
+    , m_frameDirty(false)
+    , m_smoothScaling(true)
+    , m_initialized(false)
+    , m_initFailed(false)
+    , m_program(nullptr)
+    , m_texture(0)
+    , m_textureFormat(0)
+    , m_swapRedBlue(false)
+    , m_nextPixelBuffer(0)
+    , m_usePixelBuffers(false)
+{
+    for (QOpenGLBuffer &buffer : m_pixelBuffers) {
+        buffer = QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer);
+        buffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    }
+    setCacheMode(QGraphicsItem::NoCache);
+}
+
+GLVideoItem::~GLVideoItem()
+{
+    releaseResources();
+}
+
+bool GLVideoItem::isOpenGLAvailable()
+{
+    static const bool available = []() {
+        QOpenGLContext context;
+        if (!context.create()) {
+            return false;
+        }
+        QOffscreenSurface surface;
+        surface.setFormat(context.format());
+        surface.create();
+        if (!surface.isValid() || !context.makeCurrent(&surface)) {
+            return false;
+        }
+        context.doneCurrent();
+        return true;
+    }();
+    return available;
+}
+
+void GLVideoItem::setFrame(const QImage &frame, qreal dpr, const QRegion &dirty)
+{
+    if (frame.isNull()) {
+        return;
+    }
+    dpr = dpr > 0 ? dpr : 1.0;
+    const QSizeF logicalSize(frame.width() / dpr, frame.height() / dpr);
+    const bool geometryChanged = m_frame.isNull() || logicalSize != boundingRect().size()
+                                 || frame.size() != m_frame.size() || dpr != m_dpr;
+    if (geometryChanged) {
+        prepareGeometryChange();
+    }
+
+    // Regions of frames not yet uploaded add up; any full update wins
+    const bool partial = !geometryChanged && !dirty.isEmpty()
+                         && (!m_frameDirty || !m_dirtyRegion.isEmpty());
+    m_dirtyRegion = partial ? m_dirtyRegion.united(dirty) : QRegion();
+
+    m_frame = frame;  // Implicitly shared with the decoder, nothing is copied here
+    m_dpr = dpr;
+    m_frameDirty = true;
+
+    if (partial) {
+        const QRectF changed = dirty.boundingRect();
+        update(QRectF(changed.x() / dpr, changed.y() / dpr, changed.width() / dpr, changed.height() / dpr));
+    } else {
+        update();
+    }
+}
+
+void GLVideoItem::clearFrame()
+{
+    if (m_frame.isNull()) {
+        return;
+    }
+    QImage black(m_frame.size(), QImage::Format_RGB32);
+    black.fill(Qt::black);
+    setFrame(black, m_dpr);
+}
+
+QSize GLVideoItem::frameSize() const
+{
+    return m_frame.size();
+}
+
+void GLVideoItem::setSmoothScaling(bool smooth)
+{
+    if (m_smoothScaling != smooth) {
+        m_smoothScaling = smooth;
+        update();
+    }
+}
+
+QRectF GLVideoItem::boundingRect() const
+{
+    if (m_frame.isNull()) {
+        return QRectF(QPointF(0, 0), kPlaceholderSize);
+    }
+    return QRectF(0, 0, m_frame.width() / m_dpr, m_frame.height() / m_dpr);
+}
+
+QPainterPath GLVideoItem::shape() const
+{
+    QPainterPath path;
+    path.addRect(boundingRect());
+    return path;
+}
+
+void GLVideoItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+
+    const QRectF target = boundingRect();
+    if (m_frame.isNull()) {
+        painter->fillRect(target, Qt::black);
+        return;
+    }
+
+    QOpenGLWidget *glWidget = qobject_cast<QOpenGLWidget *>(widget);
+    if (glWidget && painter->paintEngine() && painter->paintEngine()->type() == QPaintEngine::OpenGL2) {
+        painter->beginNativePainting();
+        bool drawn = initializeResources(glWidget) && uploadFrame();
+        if (drawn) {
+            drawFrame(painter, glWidget->size());
+        }
+        painter->endNativePainting();
+        if (drawn) {
+            return;
+        }
+    }
+
+    // Not an OpenGL paint (grab(), render()) or the GL path is unusable
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, m_smoothScaling);
+    painter->drawImage(target, m_frame);
+}
+
+bool GLVideoItem::initializeResources(QOpenGLWidget *glWidget)
+{
+    if (m_initialized && m_glWidget == glWidget) {
+        return true;
+    }
+    if (m_initialized) {
+        releaseResources();  // The viewport was replaced
+    }
+    if (m_initFailed) {
+        return false;
+    }
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context) {
+        m_initFailed = true;
+        return false;
+    }
+    initializeOpenGLFunctions();
+
+    m_program = new QOpenGLShaderProgram();
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShader);
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, kFragmentShader);
+    m_program->bindAttributeLocation("position", kPositionAttribute);
+    m_program->bindAttributeLocation("texCoord", kTexCoordAttribute);
+    if (!m_program->link()) {
+        qCWarning(log_ui_glvideo) << "Video shader failed to link, drawing frames with QPainter:" << m_program->log();
+        delete m_program;
+        m_program = nullptr;
+        m_initFailed = true;
+        return false;
+    }
+
+    glGenTextures(1, &m_texture);
+    m_textureSize = QSize();
+    m_textureFormat = 0;
+
+    // Pixel unpack buffers are core in GL 2.1 and GLES 3.0
+    const QSurfaceFormat format = context->format();
+    if (context->isOpenGLES()) {
+        m_usePixelBuffers = format.majorVersion() >= 3 || context->hasExtension("GL_NV_pixel_buffer_object");
+    } else {
+        m_usePixelBuffers = format.version() >= qMakePair(2, 1) || context->hasExtension("GL_ARB_pixel_buffer_object");
+    }
+    for (QOpenGLBuffer &buffer : m_pixelBuffers) {
+        if (m_usePixelBuffers && !buffer.create()) {
+            m_usePixelBuffers = false;
+        }
+    }
+
+    m_glWidget = glWidget;
+    m_contextConnection = QObject::connect(context, &QOpenGLContext::aboutToBeDestroyed,
+                                           [this]() { releaseResources(); });
+    m_initialized = true;
+
+    qCInfo(log_ui_glvideo) << "OpenGL video path ready:"
+                           << reinterpret_cast<const char *>(glGetString(GL_RENDERER))
+                           << reinterpret_cast<const char *>(glGetString(GL_VERSION))
+                           << "pixel buffers:" << m_usePixelBuffers;
+    return true;
+}
+
+void GLVideoItem::releaseResources()
+{
+    if (!m_initialized) {
+        return;
+    }
+    m_initialized = false;
+    QObject::disconnect(m_contextConnection);
+
+    // Deleting GL objects needs our context current; it already is when the
+    // context announces its destruction
+    QOpenGLContext *context = m_glWidget ? m_glWidget->context() : nullptr;
+    bool madeCurrent = false;
+    if (context && QOpenGLContext::currentContext() != context) {
+        m_glWidget->makeCurrent();
+        madeCurrent = true;
+    }
+
+    if (context) {
+        glDeleteTextures(1, &m_texture);
+        for (QOpenGLBuffer &buffer : m_pixelBuffers) {
+            buffer.destroy();
+        }
+    }
+    delete m_program;
+    m_program = nullptr;
+    m_texture = 0;
+    m_textureSize = QSize();
+    m_frameDirty = !m_frame.isNull();  // Re-upload into the next context
+    m_dirtyRegion = QRegion();
+
+    if (madeCurrent) {
+        m_glWidget->doneCurrent();
+    }
+    m_glWidget = nullptr;
+}
+
+bool GLVideoItem::uploadFrame()
+{
+    if (!m_frameDirty) {
+        return true;
+    }
+
+    GLenum format = GL_RGBA;
+    bool swapRedBlue = false;
+    bool convert = false;
+    switch (m_frame.format()) {
+    case QImage::Format_RGB888:
+        format = GL_RGB;
+        break;
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+        break;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        swapRedBlue = true;
+        break;
+#endif
+    default:
+        convert = true;
+        break;
+    }
+
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    if (m_frame.width() > maxTextureSize || m_frame.height() > maxTextureSize) {
+        return false;
+    }
+
+    // GLES 2 has no GL_UNPACK_ROW_LENGTH: rows must be packed to the
+    // 4-byte alignment QImage uses by default
+    const int bytesPerPixel = (format == GL_RGB) ? 3 : 4;
+    auto uploadable = [convert, bytesPerPixel](const QImage &image) {
+        QImage pixels = convert ? image.convertToFormat(QImage::Format_RGBX8888) : image;
+        const qsizetype packedLine = (pixels.width() * bytesPerPixel + 3) & ~3;
+        if (pixels.bytesPerLine() != packedLine) {
+            pixels = pixels.copy();
+        }
+        return pixels;
+    };
+
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    bool partial = !m_dirtyRegion.isEmpty();
+    if (m_frame.size() != m_textureSize || format != m_textureFormat) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, m_frame.width(), m_frame.height(), 0, format,
+                     GL_UNSIGNED_BYTE, nullptr);
+        m_textureSize = m_frame.size();
+        m_textureFormat = format;
+        partial = false;
+    }
+    if (partial) {
+        qint64 area = 0;
+        for (const QRect &rect : m_dirtyRegion) {
+            area += qint64(rect.width()) * rect.height();
+        }
+        partial = m_dirtyRegion.rectCount() <= kMaxPartialRects
+                  && area <= kMaxPartialAreaRatio * m_frame.width() * m_frame.height();
+    }
+
+    if (partial) {
+        // Changed tiles only; each is small enough to upload directly
+        for (const QRect &rect : m_dirtyRegion) {
+            const QImage tile = uploadable(m_frame.copy(rect));
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                            format, GL_UNSIGNED_BYTE, tile.constBits());
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        m_swapRedBlue = swapRedBlue;
+        m_frameDirty = false;
+        m_dirtyRegion = QRegion();
+        return true;
+    }
+
+    const QImage frame = uploadable(m_frame);
+    if (m_usePixelBuffers) {
+        // Alternate buffers and orphan the storage on every write, so the
+        // copy never blocks on a transfer the GPU is still doing from the
+        // previous frame. The texture is updated from the buffer just
+        // filled, in the same paint, so this adds no frame of latency.
+        QOpenGLBuffer &buffer = m_pixelBuffers[m_nextPixelBuffer];
+        m_nextPixelBuffer ^= 1;
+        buffer.bind();
+        buffer.allocate(frame.constBits(), static_cast<int>(frame.sizeInBytes()));
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frame.width(), frame.height(), format,
+                        GL_UNSIGNED_BYTE, nullptr);
+        buffer.release();  // The paint engine's own uploads must not read from it
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frame.width(), frame.height(), format,
+                        GL_UNSIGNED_BYTE, frame.constBits());
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_swapRedBlue = swapRedBlue;
+    m_frameDirty = false;
+    m_dirtyRegion = QRegion();
+    return true;
+}
+
+void GLVideoItem::drawFrame(QPainter *painter, const QSize &viewportSize)
+{
+    if (viewportSize.isEmpty()) {
+        return;
+    }
+
+    // Item -> viewport mapping carries the view zoom, scroll position and
+    // the item's own scale; only the four corners go through it and the
+    // GPU does the resampling
+    const QTransform transform = painter->combinedTransform();
+    const QRectF target = boundingRect();
+    const QPointF corners[4] = {
+        transform.map(target.topLeft()),
+        transform.map(target.topRight()),
+        transform.map(target.bottomLeft()),
+        transform.map(target.bottomRight()),
+    };
+    GLfloat positions[8];
+    for (int i = 0; i < 4; ++i) {
+        positions[i * 2] = static_cast<GLfloat>(2.0 * corners[i].x() / viewportSize.width() - 1.0);
+        positions[i * 2 + 1] = static_cast<GLfloat>(1.0 - 2.0 * corners[i].y() / viewportSize.height());
+    }
+    static const GLfloat texCoords[8] = { 0, 0, 1, 0, 0, 1, 1, 1 };
+
+    const GLint filter = m_smoothScaling ? GL_LINEAR : GL_NEAREST;
+    glDisable(GL_BLEND);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_program->bind();
+    m_program->setUniformValue("frame", 0);
+    m_program->setUniformValue("swapRedBlue", m_swapRedBlue ? 1.0f : 0.0f);
+    m_program->enableAttributeArray(kPositionAttribute);
+    m_program->enableAttributeArray(kTexCoordAttribute);
+    m_program->setAttributeArray(kPositionAttribute, GL_FLOAT, positions, 2);
+    m_program->setAttributeArray(kTexCoordAttribute, GL_FLOAT, texCoords, 2);
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    m_program->disableAttributeArray(kPositionAttribute);
+    m_program->disableAttributeArray(kTexCoordAttribute);
+    m_program->release();
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,101 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef GLVIDEOITEM_H
+#define GLVIDEOITEM_H
+
+#include <QGraphicsPixmapItem>
+#include <QImage>
+#include <QMetaObject>
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QPointer>
+#include <QRegion>
+
+class QOpenGLShaderProgram;
+class QOpenGLWidget;
+
+// Video frame item for a VideoPane whose viewport is a QOpenGLWidget.
+//
+// Frames are kept as the decoder's QImage (implicitly shared, no copy) and
+// uploaded into one persistent texture when painted, through two pixel
+// unpack buffers used alternately so an upload never waits for the GPU to
+// finish reading the previous one. When the producer says which part of a
+// frame changed, only those rectangles are uploaded and repainted. Byte
+// order swizzling, scaling and zoom happen on the GPU: the quad is drawn
+// with the painter's transform, so the view's zoom, scroll and the item
+// transform set by VideoPane apply exactly as they do to a pixmap item.
+//
+// It derives from QGraphicsPixmapItem so VideoPane's geometry code (item
+// transform, scene rect, mouse mapping) works on it unchanged; the bounding
+// rect comes from the frame instead of a pixmap. When the painter is not
+// OpenGL (grab(), printing) or GL setup fails, the frame is drawn with
+// QPainter instead.
+class GLVideoItem : public QGraphicsPixmapItem, protected QOpenGLFunctions
+{
+public:
+    explicit GLVideoItem(QGraphicsItem *parent = nullptr);
+    ~GLVideoItem() override;
+
+    // True when an OpenGL context can be created on this system
+    static bool isOpenGLAvailable();
+
+    // dpr sets the logical size, like QPixmap::setDevicePixelRatio.
+    // dirty is the changed part of frame in image pixels; empty means all of it.
+    void setFrame(const QImage &frame, qreal dpr, const QRegion &dirty = QRegion());
+    void clearFrame();
+    QImage frame() const { return m_frame; }
+    QSize frameSize() const;
+
+    void setSmoothScaling(bool smooth);
+
+    QRectF boundingRect() const override;
+    QPainterPath shape() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+private:
+    bool initializeResources(QOpenGLWidget *glWidget);
+    void releaseResources();
+    bool uploadFrame();
+    void drawFrame(QPainter *painter, const QSize &viewportSize);
+
+    QImage m_frame;
+    qreal m_dpr;
+    bool m_frameDirty;
+    QRegion m_dirtyRegion;   // Pending partial upload; empty with m_frameDirty = whole frame
+    bool m_smoothScaling;
+
+    QPointer<QOpenGLWidget> m_glWidget;
+    QMetaObject::Connection m_contextConnection;
+    bool m_initialized;
+    bool m_initFailed;
+    QOpenGLShaderProgram *m_program;
+    GLuint m_texture;
+    QSize m_textureSize;
+    GLenum m_textureFormat;
+    bool m_swapRedBlue;
+    QOpenGLBuffer m_pixelBuffers[2];
+    int m_nextPixelBuffer;
+    bool m_usePixelBuffers;
+};
+
+#endif // GLVIDEOITEM_H
@@ -52,11 +52,14 @@
 #include "../../server/tcpServer.h"
 #include "../../SysKeyBlocker/SystemKeyBlocker.h"
 #include "../customkey/customkeymanager.h"
+#include "startuptaskgraph.h"
 
 #include <QTimer>
 #include <QStackedLayout>
 #include <QShortcut>
+#include <memory>
 #include "log/opflogging.h"
+#include "log/startuptrace.h"
 
 // Define the logging category
 OPF_LOGGING_CATEGORY(log_ui_mainwindowinitializer, "opf.ui.mainwindowinitializer")
@@ -78,6 +81,7 @@ MainWindowInitializer::MainWindowInitializer(MainWindow *mainWindow, QObject *pa
     , m_languageManager(mainWindow->m_languageManager)
     , m_mouseEdgeTimer(nullptr)  // Will be created during initialization
     , m_hidThread(nullptr)  // Will be created during initialization
+    , m_startupGraph(nullptr)  // Created by startDeferredInitialization()
 {
     qCDebug(log_ui_mainwindowinitializer) << "MainWindowInitializer created";
 }
@@ -89,6 +93,7 @@ MainWindowInitializer::~MainWindowInitializer()
 
 void MainWindowInitializer::initialize()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::initialize", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Starting initialization sequence...";
     
     setupCentralWidget();
@@ -110,6 +115,7 @@ void MainWindowInitializer::initialize()
 
 void MainWindowInitializer::setupCentralWidget()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::setupCentralWidget", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Setting up central widget...";
     // Use the existing central widget from the .ui file (created by ui->setupUi(this))
     // This avoids the QLayout conflict warning:
@@ -148,6 +154,7 @@ void MainWindowInitializer::setupCentralWidget()
 
 void MainWindowInitializer::setupCoordinators()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::setupCoordinators", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Setting up coordinators...";
     // WindowLayoutCoordinator is initialized early in MainWindow constructor
     
@@ -167,7 +174,7 @@ void MainWindowInitializer::setupCoordinators()
 
     if (m_deviceCoordinator) {
         m_deviceCoordinator->connectHotplugMonitor(hotplugMonitor);
-        // Device menu setup is deferred - call deferredSetupCoordinators() after window shown
+        // Device menu setup is deferred - see startDeferredInitialization()
     }
     
     if (m_menuCoordinator) {
@@ -183,20 +190,9 @@ void MainWindowInitializer::setupCoordinators()
     }
 }
 
-void MainWindowInitializer::deferredSetupCoordinators()
-{
-    qCDebug(log_ui_mainwindowinitializer) << "Deferred: Setting up device menu (device enumeration)...";
-    
-    // This is the heavy operation - enumerate and populate device menu
-    if (m_deviceCoordinator) {
-        m_deviceCoordinator->setupDeviceMenu();
-    }
-    
-    qCDebug(log_ui_mainwindowinitializer) << "Deferred: Device menu setup complete";
-}
-
 void MainWindowInitializer::connectCornerWidgetSignals()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::connectCornerWidgetSignals", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Connecting corner widget signals...";
     m_cornerWidgetManager->setMenuBar(m_ui->menubar);
 
@@ -270,6 +266,7 @@ void MainWindowInitializer::connectCornerWidgetSignals()
 
 void MainWindowInitializer::connectDeviceManagerSignals()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::connectDeviceManagerSignals", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Connecting device manager signals...";
     m_statusBarManager = new StatusBarManager(m_ui->statusbar, m_mainWindow);
     m_mainWindow->m_statusBarManager = m_statusBarManager;
@@ -350,6 +347,7 @@ void MainWindowInitializer::connectDeviceManagerSignals()
 
 void MainWindowInitializer::connectActionSignals()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::connectActionSignals", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Connecting action signals...";
     connect(m_ui->actionRelative, &QAction::triggered, m_mainWindow, &MainWindow::onActionRelativeTriggered);
     connect(m_ui->actionAbsolute, &QAction::triggered, m_mainWindow, &MainWindow::onActionAbsoluteTriggered);
@@ -380,6 +378,7 @@ void MainWindowInitializer::connectActionSignals()
 
 void MainWindowInitializer::setupToolbar()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::setupToolbar", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Setting up toolbar...";
     m_mainWindow->addToolBar(Qt::TopToolBarArea, m_toolbarManager->getToolbar());
     m_toolbarManager->getToolbar()->setVisible(false);
@@ -427,6 +426,7 @@ void MainWindowInitializer::setupToolbar()
 
 void MainWindowInitializer::connectCameraSignals()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::connectCameraSignals", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Connecting camera signals...";
     connect(m_cameraManager, &CameraManager::cameraActiveChanged, m_mainWindow, &MainWindow::updateCameraActive);
     connect(m_cameraManager, &CameraManager::cameraError, m_mainWindow, &MainWindow::displayCameraError);
@@ -448,6 +448,8 @@ void MainWindowInitializer::connectCameraSignals()
     // Connect fpsChanged signal from CameraManager to StatusBarManager
     connect(m_cameraManager, &CameraManager::fpsChanged,
             m_statusBarManager, &StatusBarManager::setFps);
+    connect(m_cameraManager, &CameraManager::decodeStateChanged,
+            m_statusBarManager, &StatusBarManager::setDecodeState);
     
     connect(m_cameraManager, &CameraManager::cameraDeviceSwitching,
             m_videoPane, &VideoPane::onCameraDeviceSwitching);
@@ -459,6 +461,7 @@ void MainWindowInitializer::connectCameraSignals()
 
 void MainWindowInitializer::connectVideoHidSignals()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::connectVideoHidSignals", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Connecting video HID signals...";
 
     // Move VideoHid to a dedicated thread so its operations don't block the UI main thread.
@@ -481,6 +484,7 @@ void MainWindowInitializer::connectVideoHidSignals()
 
 void MainWindowInitializer::setupRecordingController()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::setupRecordingController", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Setting up recording controller...";
     
     // Create the recording controller with status bar manager (no UI widget)
@@ -496,41 +500,67 @@ void MainWindowInitializer::setupRecordingController()
 void MainWindowInitializer::initializeCamera()
 {
     qCDebug(log_ui_mainwindowinitializer) << "Camera initialization deferred to after window shown";
-    // This function is now a no-op, actual initialization happens in deferredInitializeCamera()
+    // This function is now a no-op, actual initialization happens in startDeferredInitialization()
 }
 
-void MainWindowInitializer::deferredInitializeCamera()
+void MainWindowInitializer::startDeferredInitialization()
 {
-    qCDebug(log_ui_mainwindowinitializer) << "Deferred: Starting VideoHid on HID thread...";
-    // Start VideoHid on its dedicated thread — same deferred pattern as camera/audio.
-    // m_hidThread was started in connectVideoHidSignals(); QueuedConnection posts the
-    // call to that thread's event loop so start() never blocks the UI main thread.
-    QMetaObject::invokeMethod(&VideoHid::getInstance(), []() {
+    if (m_startupGraph) {
+        qCWarning(log_ui_mainwindowinitializer) << "Deferred initialization already started";
+        return;
+    }
+    qCDebug(log_ui_mainwindowinitializer) << "Deferred: Starting startup task graph...";
+
+    // Only widget, camera-pipeline and QAudio work stays on the GUI thread.
+    // Device enumeration runs on the thread pool and VideoHid on its own
+    // thread, so neither delays the first frame. Serial baud probing is
+    // started by the device auto-selection and runs on the serial worker
+    // thread while video is already up.
+    m_startupGraph = new StartupTaskGraph(this);
+    auto devices = std::make_shared<QList<DeviceInfo>>();
+
+    // m_hidThread was started in connectVideoHidSignals(); the task is queued
+    // to that thread's event loop so start() never blocks the UI main thread.
+    m_startupGraph->addTask("VideoHid::start", &VideoHid::getInstance(), []() {
         VideoHid::getInstance().start();
         qInfo() << "VideoHid started (on HID thread)";
-    }, Qt::QueuedConnection);
+    });
 
-    qCDebug(log_ui_mainwindowinitializer) << "Deferred: Initializing camera...";
-    m_mainWindow->initCamera();
-    
-    // Set up VideoPane with FFmpeg backend BEFORE device auto-selection
+    m_startupGraph->addTask("discoverDevices", nullptr, [devices]() {
+        *devices = DeviceManager::getInstance().discoverDevices();
+    });
+
+    // Set up VideoPane with the video backend BEFORE device auto-selection
     // This ensures the video pipeline is ready when the device is switched
-    CameraManager* cameraManager = m_cameraManager;
-    VideoPane* videoPane = m_videoPane;
-    
-    // Initialize camera video pipeline WITHOUT starting capture yet
-    // The device auto-selection will start the capture with the correct device
-    bool success = cameraManager->initializeCameraWithVideoOutput(videoPane, false);
-    if (success) {
-        qCDebug(log_ui_mainwindowinitializer) << "✓ Camera video pipeline initialized (waiting for device selection)";
-    } else {
-        qCWarning(log_ui_mainwindowinitializer) << "Failed to initialize camera video pipeline";
-    }
+    MainWindow *mainWindow = m_mainWindow;
+    CameraManager *cameraManager = m_cameraManager;
+    VideoPane *videoPane = m_videoPane;
+    m_startupGraph->addTask("initializeCamera", m_mainWindow, [mainWindow, cameraManager, videoPane]() {
+        mainWindow->initCamera();
+
+        // Initialize camera video pipeline WITHOUT starting capture yet
+        // The device auto-selection will start the capture with the correct device
+        bool success = cameraManager->initializeCameraWithVideoOutput(videoPane, false);
+        if (success) {
+            qCDebug(log_ui_mainwindowinitializer) << "✓ Camera video pipeline initialized (waiting for device selection)";
+        } else {
+            qCWarning(log_ui_mainwindowinitializer) << "Failed to initialize camera video pipeline";
+        }
+    });
+
+    // Populating the menu auto-selects a single attached device, which
+    // switches camera, HID, audio and serial to it
+    DeviceCoordinator *deviceCoordinator = m_deviceCoordinator;
+    m_startupGraph->addTask("setupDeviceMenu", m_mainWindow, [deviceCoordinator, devices]() {
+        if (deviceCoordinator) {
+            deviceCoordinator->setupDeviceMenu(*devices);
+        }
+    }, {QStringLiteral("discoverDevices"), QStringLiteral("initializeCamera")});
 
     // Capture audioManager pointer directly to avoid dangling reference
-    AudioManager* audioManager = m_mainWindow->m_audioManager;
-    CornerWidgetManager* cornerWidgetManager = m_cornerWidgetManager;
-    QTimer::singleShot(300, m_mainWindow, [audioManager, cornerWidgetManager]() {
+    AudioManager *audioManager = m_mainWindow->m_audioManager;
+    CornerWidgetManager *cornerWidgetManager = m_cornerWidgetManager;
+    m_startupGraph->addTask("initializeAudio", m_mainWindow, [audioManager, cornerWidgetManager]() {
         audioManager->initializeAudio();
         
         // Restore mute state from settings
@@ -543,11 +573,18 @@ void MainWindowInitializer::deferredInitializeCamera()
         if (cornerWidgetManager) {
             cornerWidgetManager->restoreMuteState(isMuted);
         }
+    }, {QStringLiteral("initializeCamera")});
+
+    connect(m_startupGraph, &StartupTaskGraph::finished, this, [this](qint64 elapsedMs) {
+        qCDebug(log_ui_mainwindowinitializer) << "Deferred: startup tasks complete in" << elapsedMs << "ms";
+        emit deferredInitializationFinished();
     });
+    m_startupGraph->start();
 }
 
 void MainWindowInitializer::setupScriptComponents()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::setupScriptComponents", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Setting up script components...";
     m_mainWindow->mouseManager = std::make_unique<MouseManager>();
     m_mainWindow->keyboardMouse = std::make_unique<KeyboardMouse>();
@@ -576,6 +613,7 @@ void MainWindowInitializer::setupScriptComponents()
 
 void MainWindowInitializer::setupEventCallbacks()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::setupEventCallbacks", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Setting up event callbacks...";
     HostManager::getInstance().setEventCallback(m_mainWindow);
     VideoHid::getInstance().setEventCallback(m_mainWindow);
@@ -585,6 +623,7 @@ void MainWindowInitializer::setupEventCallbacks()
 
 void MainWindowInitializer::setupKeyboardShortcuts()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::setupKeyboardShortcuts", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Setting up keyboard shortcuts...";
     
     // Alt+F11: Toggle fullscreen
@@ -613,6 +652,10 @@ void MainWindowInitializer::setupKeyboardShortcuts()
     // Ctrl+Shift+F9: Toggle mute audio
     QShortcut *muteShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F9), m_mainWindow);
 
+    // Ctrl+Shift+F8: Toggle frame latency overlay; Ctrl+Shift+F7: export latency report
+    QShortcut *latencyOverlayShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F8), m_mainWindow);
+    QShortcut *latencyExportShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F7), m_mainWindow);
+
     // Ctrl+Shift+K: Toggle function key and composite key toolbar
     QShortcut *virtualKeyboardShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_K), m_mainWindow);
     
@@ -668,6 +711,10 @@ void MainWindowInitializer::setupKeyboardShortcuts()
     // Connect Ctrl+Shift+F9 shortcut to toggle mute audio
     QObject::connect(muteShortcut, &QShortcut::activated, mainWindow, &MainWindow::toggleMute);
 
+    // Connect latency shortcuts to the overlay toggle and report export
+    QObject::connect(latencyOverlayShortcut, &QShortcut::activated, mainWindow, &MainWindow::toggleLatencyOverlay);
+    QObject::connect(latencyExportShortcut, &QShortcut::activated, mainWindow, &MainWindow::exportLatencyReport);
+
     // Connect Ctrl+Shift+K shortcut to toggle function key and composite key toolbar
     QObject::connect(virtualKeyboardShortcut, &QShortcut::activated, mainWindow, &MainWindow::onToggleVirtualKeyboard);
     
@@ -683,11 +730,13 @@ void MainWindowInitializer::setupKeyboardShortcuts()
     qCDebug(log_ui_mainwindowinitializer) << "Registered Ctrl+Shift+F10 shortcut for mouse dance toggle";
     qCDebug(log_ui_mainwindowinitializer) << "Registered Ctrl+Shift+F11 shortcut for toggle recording";
     qCDebug(log_ui_mainwindowinitializer) << "Registered Ctrl+Shift+F9 shortcut for toggle mute audio";
+    qCDebug(log_ui_mainwindowinitializer) << "Registered Ctrl+Shift+F8/F7 shortcuts for latency overlay and report export";
     qCDebug(log_ui_mainwindowinitializer) << "Registered Ctrl+Shift+K shortcut for toggle virtual keyboard toolbar";
 }
 
 void MainWindowInitializer::finalize()
 {
+    OPF_STARTUP_SPAN("MainWindowInitializer::finalize", "startup");
     qCDebug(log_ui_mainwindowinitializer) << "Finalizing initialization...";
     QString windowTitle = QString("Openterface - %1").arg(APP_VERSION);
     m_mainWindow->setWindowTitle(windowTitle);
@@ -41,6 +41,7 @@ class DeviceCoordinator;
 class MenuCoordinator;
 class LanguageManager;
 class QTimer;
+class StartupTaskGraph;
 
 namespace Ui {
     class MainWindow;
@@ -188,18 +189,19 @@ private:
     
 public:
     /**
-     * @brief Deferred setup of coordinators (after window shown)
+     * @brief Deferred startup work (after window shown)
      * 
-     * Performs device enumeration and menu setup - expensive operations
+     * Runs device enumeration, VideoHid start, camera pipeline, device menu
+     * and audio as a StartupTaskGraph, so independent steps overlap and only
+     * GUI work uses the main thread
      */
-    void deferredSetupCoordinators();
-    
+    void startDeferredInitialization();
+
+signals:
     /**
-     * @brief Deferred camera initialization (after window shown)
-     * 
-     * Initializes camera, video pipeline, and audio - blocking operations
+     * @brief Emitted when every deferred startup task has finished
      */
-    void deferredInitializeCamera();
+    void deferredInitializationFinished();
 
 private:
     // Member variables
@@ -220,6 +222,7 @@ private:
     LanguageManager *m_languageManager;
     QTimer *m_mouseEdgeTimer;
     QThread *m_hidThread;  ///< Thread for VideoHid operations
+    StartupTaskGraph *m_startupGraph;  ///< Deferred startup tasks (owned)
 };
 
 #endif // MAINWINDOWINITIALIZER_H
@@ -0,0 +1,225 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "startuptaskgraph.h"
+#include "log/startuptrace.h"
+
+#include <QThreadPool>
+#include <exception>
+#include "log/opflogging.h"
+
+OPF_LOGGING_CATEGORY(log_ui_startuptaskgraph, "opf.ui.startuptaskgraph")
+
+StartupTaskGraph::StartupTaskGraph(QObject *parent)
+    : QObject(parent)
+    , m_pool(QThreadPool::globalInstance())
+    , m_remaining(0)
+    , m_started(false)
+    , m_running(false)
+{
+}
+
+StartupTaskGraph::~StartupTaskGraph()
+{
+    if (m_running) {
+        qCWarning(log_ui_startuptaskgraph) << "Destroyed with" << m_remaining << "startup tasks unfinished";
+    }
+}
+
+void StartupTaskGraph::addTask(const char *name, QObject *context, TaskFunction function,
+                               const QStringList &dependencies)
+{
+    const QString key = QString::fromLatin1(name);
+    if (m_started) {
+        qCWarning(log_ui_startuptaskgraph) << "Cannot add task" << key << "after the graph started";
+        return;
+    }
+    if (m_indexByName.contains(key)) {
+        qCWarning(log_ui_startuptaskgraph) << "Duplicate startup task" << key << "ignored";
+        return;
+    }
+
+    Task task;
+    task.name = name;
+    task.context = context;
+    task.onPool = (context == nullptr);
+    task.function = std::move(function);
+    task.dependencies = dependencies;
+    task.pendingDependencies = 0;
+
+    m_indexByName.insert(key, m_tasks.size());
+    m_tasks.append(task);
+}
+
+void StartupTaskGraph::setThreadPool(QThreadPool *pool)
+{
+    m_pool = pool ? pool : QThreadPool::globalInstance();
+}
+
+bool StartupTaskGraph::validate()
+{
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        Task &task = m_tasks[i];
+        task.dependents.clear();
+        task.pendingDependencies = 0;
+    }
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        for (const QString &dependency : m_tasks[i].dependencies) {
+            const auto it = m_indexByName.constFind(dependency);
+            if (it == m_indexByName.constEnd()) {
+                qCWarning(log_ui_startuptaskgraph) << "Startup task" << m_tasks[i].name
+                                                   << "depends on unknown task" << dependency;
+                return false;
+            }
+            m_tasks[it.value()].dependents.append(i);
+            ++m_tasks[i].pendingDependencies;
+        }
+    }
+
+    // Kahn's algorithm: every task is reachable from the roots unless there is a cycle
+    QList<int> pending;
+    QList<int> ready;
+    for (const Task &task : m_tasks) {
+        pending.append(task.pendingDependencies);
+    }
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        if (pending[i] == 0) {
+            ready.append(i);
+        }
+    }
+    int visited = 0;
+    while (!ready.isEmpty()) {
+        const int index = ready.takeLast();
+        ++visited;
+        for (int dependent : m_tasks[index].dependents) {
+            if (--pending[dependent] == 0) {
+                ready.append(dependent);
+            }
+        }
+    }
+    if (visited != m_tasks.size()) {
+        QStringList cyclic;
+        for (int i = 0; i < m_tasks.size(); ++i) {
+            if (pending[i] > 0) {
+                cyclic << QString::fromLatin1(m_tasks[i].name);
+            }
+        }
+        qCWarning(log_ui_startuptaskgraph) << "Startup task dependency cycle among" << cyclic;
+        return false;
+    }
+    return true;
+}
+
+bool StartupTaskGraph::start()
+{
+    if (m_started) {
+        qCWarning(log_ui_startuptaskgraph) << "Startup task graph already started";
+        return false;
+    }
+    if (!validate()) {
+        return false;
+    }
+
+    m_started = true;
+    m_remaining = m_tasks.size();
+    m_timer.start();
+    qCDebug(log_ui_startuptaskgraph) << "Starting" << m_remaining << "startup tasks";
+
+    if (m_remaining == 0) {
+        emit finished(0);
+        return true;
+    }
+    m_running = true;
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        if (m_tasks[i].pendingDependencies == 0) {
+            dispatch(i);
+        }
+    }
+    return true;
+}
+
+qint64 StartupTaskGraph::runTask(const char *name, const TaskFunction &function)
+{
+    StartupTraceSpan span(name, "startup task");
+    QElapsedTimer timer;
+    timer.start();
+    try {
+        function();
+    } catch (const std::exception &e) {
+        qCWarning(log_ui_startuptaskgraph) << "Startup task" << name << "threw:" << e.what();
+    } catch (...) {
+        qCWarning(log_ui_startuptaskgraph) << "Startup task" << name << "threw an unknown exception";
+    }
+    return timer.elapsed();
+}
+
+void StartupTaskGraph::dispatch(int index)
+{
+    const Task &task = m_tasks[index];
+
+    // Completion is always reported back on the graph's thread
+    QPointer<StartupTaskGraph> self(this);
+    const char *name = task.name;
+    TaskFunction function = task.function;
+    auto run = [self, index, name, function]() {
+        const qint64 elapsedMs = runTask(name, function);
+        if (self) {
+            QMetaObject::invokeMethod(self.data(), [self, index, elapsedMs]() {
+                if (self) {
+                    self->onTaskDone(index, elapsedMs);
+                }
+            }, Qt::QueuedConnection);
+        }
+    };
+
+    if (task.onPool) {
+        m_pool->start(run);
+        return;
+    }
+    if (!task.context) {
+        qCWarning(log_ui_startuptaskgraph) << "Context of startup task" << name << "is gone, skipping it";
+        QMetaObject::invokeMethod(this, [this, index]() { onTaskDone(index, 0); }, Qt::QueuedConnection);
+        return;
+    }
+    QMetaObject::invokeMethod(task.context.data(), run, Qt::QueuedConnection);
+}
+
+void StartupTaskGraph::onTaskDone(int index, qint64 elapsedMs)
+{
+    const QString name = QString::fromLatin1(m_tasks[index].name);
+    m_completed.append(name);
+    qCDebug(log_ui_startuptaskgraph) << "Startup task" << name << "finished in" << elapsedMs << "ms";
+    emit taskFinished(name, elapsedMs);
+
+    for (int dependent : m_tasks[index].dependents) {
+        if (--m_tasks[dependent].pendingDependencies == 0) {
+            dispatch(dependent);
+        }
+    }
+
+    if (--m_remaining == 0) {
+        m_running = false;
+        const qint64 totalMs = m_timer.elapsed();
+        qCInfo(log_ui_startuptaskgraph) << "All" << m_tasks.size() << "startup tasks finished in" << totalMs << "ms";
+        emit finished(totalMs);
+    }
+}
@@ -0,0 +1,122 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef STARTUPTASKGRAPH_H
+#define STARTUPTASKGRAPH_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QStringList>
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(log_ui_startuptaskgraph)
+
+class QThreadPool;
+
+/**
+ * @brief Runs startup work as a dependency graph
+ *
+ * Each task names the tasks it depends on and the thread it must run on.
+ * Once all of a task's dependencies have finished it is dispatched: to the
+ * thread pool when it has no context object, otherwise queued to the thread
+ * of its context (the GUI thread for anything touching widgets, or a
+ * worker object's own thread). Independent tasks therefore overlap, and GUI
+ * tasks are queued one at a time so the window keeps painting between them.
+ *
+ * Bookkeeping happens on the thread the graph lives on. A task that throws
+ * is logged and counted as finished, so a failing subsystem does not hold
+ * the rest of startup hostage.
+ */
+class StartupTaskGraph : public QObject
+{
+    Q_OBJECT
+
+public:
+    using TaskFunction = std::function<void()>;
+
+    explicit StartupTaskGraph(QObject *parent = nullptr);
+    ~StartupTaskGraph();
+
+    /**
+     * @brief Add a task; only valid before start()
+     * @param name Unique task name; must be a string literal (it also labels the startup trace)
+     * @param context Object whose thread runs the task, nullptr for the thread pool
+     * @param function Work to run
+     * @param dependencies Names of tasks that must finish first
+     */
+    void addTask(const char *name, QObject *context, TaskFunction function,
+                 const QStringList &dependencies = QStringList());
+
+    /**
+     * @brief Use a specific pool for context-less tasks (default: the global pool)
+     */
+    void setThreadPool(QThreadPool *pool);
+
+    /**
+     * @brief Validate the graph and dispatch every task without dependencies
+     * @return false (and nothing runs) on an unknown dependency or a cycle
+     */
+    bool start();
+
+    bool isRunning() const { return m_running; }
+    bool isFinished() const { return m_started && m_remaining == 0; }
+
+    /**
+     * @brief Names of finished tasks, in completion order
+     */
+    QStringList completedTasks() const { return m_completed; }
+
+signals:
+    void taskFinished(const QString &name, qint64 elapsedMs);
+    void finished(qint64 elapsedMs);
+
+private:
+    struct Task {
+        const char *name;
+        QPointer<QObject> context;
+        bool onPool;
+        TaskFunction function;
+        QStringList dependencies;
+        QList<int> dependents;
+        int pendingDependencies;
+    };
+
+    bool validate();
+    void dispatch(int index);
+    void onTaskDone(int index, qint64 elapsedMs);
+    static qint64 runTask(const char *name, const TaskFunction &function);
+
+    QList<Task> m_tasks;
+    QHash<QString, int> m_indexByName;
+    QStringList m_completed;
+    QThreadPool *m_pool;
+    QElapsedTimer m_timer;
+    int m_remaining;
+    bool m_started;
+    bool m_running;
+};
+
+#endif // STARTUPTASKGRAPH_H
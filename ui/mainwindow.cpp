@@ -30,6 +30,7 @@
 #include "ui/statusbar/statusbarmanager.h"
 #include "host/HostManager.h"
 #include "host/cameramanager.h"
+#include "host/framelatency.h"
 #include "serial/SerialPortManager.h"
 #include <QStandardPaths>
 #include "device/DeviceManager.h"
@@ -55,6 +56,7 @@
 #include <QMediaRecorder>
 #include <QStackedLayout>
 #include <QMessageBox>
+#include <QFileDialog>
 #include <QCheckBox>
 #include <QImageCapture>
 #include <QToolBar>
@@ -166,17 +168,10 @@ MainWindow::MainWindow(LanguageManager *languageManager, QWidget *parent)
     qCDebug(log_ui_mainwindow) << "MainWindow initialization complete, window ID:" << this->winId();
 }
 
-void MainWindow::deferredSetupCoordinators()
+void MainWindow::startDeferredInitialization()
 {
     if (m_initializer) {
-        m_initializer->deferredSetupCoordinators();
-    }
-}
-
-void MainWindow::deferredInitializeCamera()
-{
-    if (m_initializer) {
-        m_initializer->deferredInitializeCamera();
+        m_initializer->startDeferredInitialization();
     }
 }
 
@@ -906,6 +901,39 @@ void MainWindow::toggleMute() {
     }
 }
 
+void MainWindow::toggleLatencyOverlay() {
+    if (!videoPane) {
+        return;
+    }
+    bool enable = !videoPane->isLatencyOverlayEnabled();
+    videoPane->setLatencyOverlayEnabled(enable);
+    GlobalSetting::instance().setLatencyOverlayEnabled(enable);
+}
+
+void MainWindow::exportLatencyReport() {
+    FrameLatencyTracker& latency = FrameLatencyTracker::instance();
+    if (latency.report().framesCompleted == 0) {
+        QMessageBox::information(this, tr("Latency Report"),
+            tr("No latency samples yet. Turn on the latency overlay (Ctrl+Shift+F8) while video is playing, then export again."));
+        return;
+    }
+
+    QString source = latency.source().isEmpty() ? QString("video") : latency.source().toLower();
+    QString defaultName = QString("latency-%1-%2.json")
+        .arg(source, QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+    QString defaultPath = QDir(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).filePath(defaultName);
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Export Latency Report"), defaultPath,
+                                                    tr("JSON Files (*.json);;All Files (*)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QString error;
+    if (!latency.exportToFile(filePath, &error)) {
+        QMessageBox::warning(this, tr("Latency Report"), tr("Failed to write %1: %2").arg(filePath, error));
+    }
+}
+
 void MainWindow::showRecordingSettings() {
     
     // Stop any active recording before showing settings
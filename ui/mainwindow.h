@@ -135,8 +135,7 @@ public:
     ~MainWindow() override;
     
     // Deferred initialization methods (called after window is shown)
-    void deferredSetupCoordinators();
-    void deferredInitializeCamera();
+    void startDeferredInitialization();
     
     // Zoom functionality
     void zoomIn();
@@ -157,6 +156,8 @@ public slots:
     void showRecordingSettings();
     void toggleRecording();
     void toggleMute();
+    void toggleLatencyOverlay();
+    void exportLatencyReport();
 
 private slots:
     void initCamera();
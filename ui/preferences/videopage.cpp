@@ -315,6 +315,10 @@ void VideoPage::setupUI()
     smoothTransformCheckBox->setObjectName("smoothTransformCheckBox");
     smoothTransformCheckBox->setChecked(GlobalSetting::instance().getVideoSmoothTransform());
 
+    QCheckBox *openglVideoCheckBox = new QCheckBox(tr("Use OpenGL video renderer (FFmpeg backend, takes effect after restart)"));
+    openglVideoCheckBox->setObjectName("openglVideoCheckBox");
+    openglVideoCheckBox->setChecked(GlobalSetting::instance().getOpenGLVideoEnabled());
+
     QLabel *renderingQualityHintLabel = new QLabel(tr("Note: These settings control video display quality. Disabling may improve performance on slower systems."));
     renderingQualityHintLabel->setStyleSheet("color: #666666; font-style: italic;");
     renderingQualityHintLabel->setWordWrap(true);
@@ -323,6 +327,7 @@ void VideoPage::setupUI()
     videoLayout->addWidget(antialiasingCheckBox);
     videoLayout->addWidget(textAntialiasingCheckBox);
     videoLayout->addWidget(smoothTransformCheckBox);
+    videoLayout->addWidget(openglVideoCheckBox);
     videoLayout->addWidget(renderingQualityHintLabel);
 
     videoLayout->addStretch();
@@ -342,6 +347,7 @@ void VideoPage::setupUI()
     connect(antialiasingCheckBox, &QCheckBox::toggled, this, [this]{ checkDirtyState(); });
     connect(textAntialiasingCheckBox, &QCheckBox::toggled, this, [this]{ checkDirtyState(); });
     connect(smoothTransformCheckBox, &QCheckBox::toggled, this, [this]{ checkDirtyState(); });
+    connect(openglVideoCheckBox, &QCheckBox::toggled, this, [this]{ checkDirtyState(); });
     connect(gstSinkEdit, &QLineEdit::textChanged, this, [this]{ checkDirtyState(); });
 
     // Connect the checkbox state change to the slot
@@ -614,6 +620,11 @@ void VideoPage::applySettings() {
         GlobalSetting::instance().setVideoSmoothTransform(smoothTransformCheckBox->isChecked());
     }
 
+    QCheckBox *openglVideoCheckBox = this->findChild<QCheckBox*>("openglVideoCheckBox");
+    if (openglVideoCheckBox) {
+        GlobalSetting::instance().setOpenGLVideoEnabled(openglVideoCheckBox->isChecked());
+    }
+
     // Emit the signal with the new width and height
     emit videoSettingsChanged();
 
@@ -790,6 +801,9 @@ void VideoPage::captureSnapshot()
     QCheckBox *smoothTransformCheckBox = this->findChild<QCheckBox*>("smoothTransformCheckBox");
     m_snap_smoothTransform = smoothTransformCheckBox ? smoothTransformCheckBox->isChecked() : false;
 
+    QCheckBox *openglVideoCheckBox = this->findChild<QCheckBox*>("openglVideoCheckBox");
+    m_snap_openglVideo = openglVideoCheckBox ? openglVideoCheckBox->isChecked() : false;
+
     // Media backend
     QComboBox *mediaBackendBox = this->findChild<QComboBox*>("mediaBackendBox");
     m_snap_mediaBackendIndex = mediaBackendBox ? mediaBackendBox->currentIndex() : -1;
@@ -853,6 +867,11 @@ void VideoPage::revertToSnapshot()
         smoothTransformCheckBox->setChecked(m_snap_smoothTransform);
     }
 
+    QCheckBox *openglVideoCheckBox = this->findChild<QCheckBox*>("openglVideoCheckBox");
+    if (openglVideoCheckBox) {
+        openglVideoCheckBox->setChecked(m_snap_openglVideo);
+    }
+
     // Media backend — restore combo, then trigger the visibility update slot
     QComboBox *mediaBackendBox = this->findChild<QComboBox*>("mediaBackendBox");
     if (mediaBackendBox && m_snap_mediaBackendIndex >= 0) {
@@ -890,6 +909,7 @@ bool VideoPage::valuesMatchSnapshot() const
     QCheckBox *antialiasingCheckBox = this->findChild<QCheckBox*>("antialiasingCheckBox");
     QCheckBox *textAntialiasingCheckBox = this->findChild<QCheckBox*>("textAntialiasingCheckBox");
     QCheckBox *smoothTransformCheckBox = this->findChild<QCheckBox*>("smoothTransformCheckBox");
+    QCheckBox *openglVideoCheckBox = this->findChild<QCheckBox*>("openglVideoCheckBox");
     QComboBox *mediaBackendBox = this->findChild<QComboBox*>("mediaBackendBox");
     QCheckBox *overrideSettingsCheckBox = this->findChild<QCheckBox*>("overrideSettingsCheckBox");
     QLineEdit *customInputWidthEdit = this->findChild<QLineEdit*>("customInputWidthEdit");
@@ -904,6 +924,7 @@ bool VideoPage::valuesMatchSnapshot() const
         && (antialiasingCheckBox ? antialiasingCheckBox->isChecked() : false) == m_snap_antialiasing
         && (textAntialiasingCheckBox ? textAntialiasingCheckBox->isChecked() : false) == m_snap_textAntialiasing
         && (smoothTransformCheckBox ? smoothTransformCheckBox->isChecked() : false) == m_snap_smoothTransform
+        && (openglVideoCheckBox ? openglVideoCheckBox->isChecked() : false) == m_snap_openglVideo
         && (mediaBackendBox ? mediaBackendBox->currentIndex() : -1) == m_snap_mediaBackendIndex
         && (overrideSettingsCheckBox ? overrideSettingsCheckBox->isChecked() : false) == m_snap_overrideSettings
         && (customInputWidthEdit ? customInputWidthEdit->text().toInt() : 0) == m_snap_customWidth
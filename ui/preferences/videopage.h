@@ -97,6 +97,7 @@ private:
     bool m_snap_antialiasing;
     bool m_snap_textAntialiasing;
     bool m_snap_smoothTransform;
+    bool m_snap_openglVideo;
     int m_snap_mediaBackendIndex;
     bool m_snap_overrideSettings;
     int m_snap_customWidth;
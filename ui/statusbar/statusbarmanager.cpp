@@ -213,6 +213,11 @@ void StatusBarManager::setFps(double fps)
     m_statusWidget->setFps(fps, backend);
 }
 
+void StatusBarManager::setDecodeState(const QString& state)
+{
+    m_statusWidget->setDecodeState(state);
+}
+
 QPixmap StatusBarManager::recolorSvg(const QString &svgPath, const QColor &color, const QSize &size)
 {
     QSvgRenderer svgRenderer(svgPath);
@@ -35,6 +35,7 @@
 #include <QApplication>
 #include <QRegularExpression>
 #include "serial/SerialPortManager.h"
+#include "host/frametiming.h"
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -164,6 +165,7 @@ StatusWidget::StatusWidget(QWidget *parent) : QWidget(parent), m_captureWidth(0)
     // Setup CPU monitoring timer
     cpuTimer = new QTimer(this);
     connect(cpuTimer, &QTimer::timeout, this, &StatusWidget::updateCpuUsage);
+    connect(cpuTimer, &QTimer::timeout, this, &StatusWidget::updateFrameTiming);
     cpuTimer->start(2000); // Update every 2 seconds
 
     QHBoxLayout *layout = new QHBoxLayout(this);
@@ -440,9 +442,23 @@ void StatusWidget::updateCpuUsage()
 }
 
 void StatusWidget::setFps(const double &fps, const QString &backend) {
+    m_fps = fps;
+    m_fpsBackend = backend;
     QString backendPrefix = backend.toUpper();
     if (fps >= 0) {
         QString text = QString("%1: %2fps").arg(backendPrefix).arg(QString::number(fps, 'f', 1));
+        QString toolTip = QString("Video FPS (%1): %2").arg(backend).arg(QString::number(fps, 'f', 1));
+        if (!m_decodeState.isEmpty()) {
+            // The decode governor has traded resolution or frame rate for latency
+            text += QString(" (%1)").arg(m_decodeState);
+            toolTip += QString("\nAdaptive decode: %1").arg(m_decodeState);
+        }
+        if (m_recentFrameDrops > 0) {
+            text += QString(" -%1").arg(m_recentFrameDrops);
+        }
+        if (!m_frameTimingSummary.isEmpty()) {
+            toolTip += "\n\n" + m_frameTimingSummary;
+        }
         QColor color;
         
         // Choose color based on fps (green for good, yellow for ok, red for poor)
@@ -455,7 +471,7 @@ void StatusWidget::setFps(const double &fps, const QString &backend) {
         }
         
         fpsLabel->setPixmap(createIconTextLabel("", text, color));
-        fpsLabel->setToolTip(QString("Video FPS (%1): %2").arg(backend).arg(QString::number(fps, 'f', 1)));
+        fpsLabel->setToolTip(toolTip);
     } else {
         fpsLabel->setPixmap(createIconTextLabel("", QString("%1: N/A").arg(backendPrefix)));
         fpsLabel->setToolTip(QString("Video FPS (%1) unavailable").arg(backend));
@@ -463,6 +479,41 @@ void StatusWidget::setFps(const double &fps, const QString &backend) {
     update();
 }
 
+void StatusWidget::setDecodeState(const QString &state) {
+    if (state == m_decodeState) {
+        return;
+    }
+    m_decodeState = state;
+    if (!m_fpsBackend.isEmpty()) {
+        setFps(m_fps, m_fpsBackend);  // Otherwise shown with the first FPS update
+    }
+}
+
+// Stale frames the capture had to skip in the last few seconds show next to
+// the FPS; the full timing breakdown goes in its tooltip. Rate-limited and
+// never-shown frames are expected whenever capture outpaces the display, so
+// they are only listed there.
+void StatusWidget::updateFrameTiming() {
+    static constexpr qint64 kWindowMs = 10000;
+    const FrameTimingRecorder& timing = FrameTimingRecorder::instance();
+    const FrameTimingRecorder::Snapshot snapshot = timing.snapshot(kWindowMs);
+
+    QString summary;
+    if (snapshot.captureInterval.count > 0) {
+        summary = timing.summary(kWindowMs);
+    }
+    const quint64 drops = snapshot.captureInterval.count > 0
+        ? snapshot.drops[FrameTimingRecorder::LiveEdgeDiscard] : 0;
+    if (summary == m_frameTimingSummary && drops == m_recentFrameDrops) {
+        return;
+    }
+    m_frameTimingSummary = summary;
+    m_recentFrameDrops = drops;
+    if (!m_fpsBackend.isEmpty()) {
+        setFps(m_fps, m_fpsBackend);
+    }
+}
+
 QPixmap StatusWidget::createIconTextLabel(const QString &svgPath, const QString &text, const QColor &textColor, const QColor &iconColor)
 {
     // Determine colors to use
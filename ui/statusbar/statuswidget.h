@@ -42,6 +42,7 @@ public:
     void setInputResolution(const int &width, const int &height, const float &fps, const float &pixelClk);
     void setCaptureResolution(const int &width, const int &height, const float &fps);
     void setFps(const double &fps, const QString &backend = QString());
+    void setDecodeState(const QString &state);  // Shown next to the FPS; empty = full quality
     void setKeyboardIndicators(const QString &indicators);
     void setConnectedPort(const QString &port, const int &baudrate);
     void setStatusUpdate(const QString &status);
@@ -58,6 +59,7 @@ protected:
 
 private slots:
     void updateCpuUsage();
+    void updateFrameTiming();
     void refreshAllIcons();
     void onNumLockClicked();
     void onCapsLockClicked();
@@ -83,6 +85,11 @@ private:
     int m_captureWidth;
     int m_captureHeight;
     float m_captureFramerate;
+    double m_fps = -1;
+    QString m_fpsBackend;
+    QString m_decodeState;
+    QString m_frameTimingSummary;   // Frame timing of the last few seconds, for the FPS tooltip
+    quint64 m_recentFrameDrops = 0;      // Live-edge discards in the same window
     
     // SVG icon pixmaps
     QPixmap keyboardIcon;
@@ -21,10 +21,15 @@
 */
 
 #include "videopane.h"
+#include "glvideoitem.h"
 #include "host/HostManager.h"
 #include "inputhandler.h"
 #include "../global.h"
 #include "globalsetting.h"
+#include "../host/framelatency.h"
+#include "../host/presentationqueue.h"
+#include "../host/frametiming.h"
+#include "../log/startuptrace.h"
 #include "../SysKeyBlocker/SystemKeyBlocker.h"
 
 #include <QtWidgets>
@@ -34,6 +39,7 @@
 #include <QTimer>
 #include <QPropertyAnimation>
 #include <QGraphicsOpacityEffect>
+#include <QOpenGLWidget>
 #include <thread>
 #include <chrono>
 #include <cmath>
@@ -62,9 +68,18 @@ VideoPane::VideoPane(QWidget *parent) : QGraphicsView(parent),
     m_directFFmpegMode(false),
     m_lastViewportSize(QSize()),
     m_frameIsViewportSized(false),
+    m_openGLViewport(false),
+    m_glVideoItem(nullptr),
     m_zoomHintLabel(nullptr),
     m_zoomHintShown(false),
-    m_zoomHintTimer(nullptr)
+    m_zoomHintTimer(nullptr),
+    m_latencyOverlayLabel(nullptr),
+    m_latencyOverlayTimer(nullptr),
+    m_latencyOverlayEnabled(false),
+    m_latencyFrameKey(0),
+    m_presentationQueue(std::make_shared<PresentationQueue>()),
+    m_presentationTimer(nullptr),
+    m_presentationPaced(false)
 {
     qDebug(log_ui_video) << "VideoPane init...";
     
@@ -109,9 +124,26 @@ VideoPane::VideoPane(QWidget *parent) : QGraphicsView(parent),
     // We keep antialiasing adjustments enabled for better text rendering
     setOptimizationFlag(QGraphicsView::DontAdjustForAntialiasing, false);
     
+    // Optional OpenGL viewport for the FFmpeg backend: frames are uploaded to a
+    // texture and scaled on the GPU instead of becoming a QPixmap per frame.
+    // The native GStreamer overlay keeps the plain widget viewport.
+    if (GlobalSetting::instance().getOpenGLVideoEnabled()
+        && GlobalSetting::instance().getMediaBackend() == "ffmpeg") {
+        if (GLVideoItem::isOpenGLAvailable()) {
+            setViewport(new QOpenGLWidget());
+            m_openGLViewport = true;
+            qCInfo(log_ui_video) << "VideoPane: Using OpenGL viewport";
+        } else {
+            qCWarning(log_ui_video) << "VideoPane: OpenGL unavailable, using the QGraphicsView raster path";
+        }
+    }
+
     // CRITICAL FIX: Use MinimalViewportUpdate for better video streaming performance
-    // FullViewportUpdate can cause update batching that leads to freezing
-    setViewportUpdateMode(QGraphicsView::MinimalViewportUpdate);
+    // FullViewportUpdate can cause update batching that leads to freezing.
+    // A QOpenGLWidget viewport redraws everything on each paint regardless, which
+    // is the case Qt documents FullViewportUpdate for.
+    setViewportUpdateMode(m_openGLViewport ? QGraphicsView::FullViewportUpdate
+                                           : QGraphicsView::MinimalViewportUpdate);
     
     // CRITICAL FIX: Disable cache for video streaming to prevent stale frames
     // CacheBackground can hold old frames and prevent updates
@@ -153,10 +185,49 @@ VideoPane::VideoPane(QWidget *parent) : QGraphicsView(parent),
     m_zoomHintTimer = new QTimer(this);
     m_zoomHintTimer->setSingleShot(true);
     connect(m_zoomHintTimer, &QTimer::timeout, this, &VideoPane::startZoomHintFadeOut);
+
+    // Latency overlay: refreshed twice a second while visible
+    m_latencyOverlayLabel = new QLabel(this);
+    m_latencyOverlayLabel->setStyleSheet(
+        "QLabel { "
+        "background-color: rgba(0, 0, 0, 180); "
+        "color: white; "
+        "padding: 6px 8px; "
+        "border-radius: 5px; "
+        "font-family: monospace; "
+        "font-size: 12px; "
+        "}"
+    );
+    m_latencyOverlayLabel->setAttribute(Qt::WA_TransparentForMouseEvents);
+    m_latencyOverlayLabel->hide();
+    m_latencyOverlayTimer = new QTimer(this);
+    m_latencyOverlayTimer->setInterval(500);
+    connect(m_latencyOverlayTimer, &QTimer::timeout, this, &VideoPane::updateLatencyOverlay);
+    setLatencyOverlayEnabled(GlobalSetting::instance().getLatencyOverlayEnabled());
+
+    // The OpenGL viewport paces presentation by its buffer swaps, which
+    // follow vsync; the raster viewport by a timer at the refresh rate
+    if (m_openGLViewport) {
+        connect(static_cast<QOpenGLWidget*>(viewport()), &QOpenGLWidget::frameSwapped,
+                this, &VideoPane::onPresentationRefresh);
+    } else {
+        m_presentationTimer = new QTimer(this);
+        m_presentationTimer->setSingleShot(true);
+        m_presentationTimer->setTimerType(Qt::PreciseTimer);
+        connect(m_presentationTimer, &QTimer::timeout, this, &VideoPane::onPresentationRefresh);
+    }
+
+    // Runs on the backend's thread: only post the request to the GUI thread
+    m_presentationQueue->setScheduleCallback([this]() {
+        QMetaObject::invokeMethod(this, [this]() { requestPresentation(); }, Qt::QueuedConnection);
+    });
 }
 
 VideoPane::~VideoPane()
 {
+    // 0. Stop backends still holding the presentation queue from posting to us
+    m_presentationQueue->setScheduleCallback(nullptr);
+    m_presentationQueue->clear();
     
     // 1. FIRST: Clean up overlay widget before anything else (to prevent event filter crashes)
     if (m_overlayWidget) {
@@ -208,6 +279,10 @@ VideoPane::~VideoPane()
             m_scene->removeItem(m_pixmapItem);
             m_pixmapItem = nullptr;
         }
+        if (m_glVideoItem) {
+            delete m_glVideoItem;  // Releases its GL objects while the viewport still exists
+            m_glVideoItem = nullptr;
+        }
         
         // Clear and delete scene
         m_scene->clear();
@@ -235,6 +310,9 @@ void VideoPane::setRenderQuality(bool highQuality)
     setRenderHint(QPainter::Antialiasing, highQuality);
     setRenderHint(QPainter::TextAntialiasing, highQuality);
     setOptimizationFlag(QGraphicsView::DontAdjustForAntialiasing, !highQuality);
+    if (m_glVideoItem) {
+        m_glVideoItem->setSmoothScaling(highQuality);
+    }
 
     // changing quality may require a full repaint
     viewport()->update();
@@ -358,8 +436,9 @@ void VideoPane::captureCurrentFrame()
 void VideoPane::paintEvent(QPaintEvent *event)
 {
     // PERFORMANCE: Reduce redundant visibility checks and updates
-    if (m_isCameraSwitching && !m_lastFrame.isNull()) {
+    if (m_isCameraSwitching && !m_lastFrame.isNull() && !m_glVideoItem) {
         // During camera switching, show preserved frame using pixmap item
+        // (the OpenGL item simply keeps showing the last frame it received)
         if (!m_pixmapItem) {
             m_pixmapItem = m_scene->addPixmap(m_lastFrame);
             m_pixmapItem->setZValue(1); // Above video item
@@ -402,6 +481,12 @@ void VideoPane::paintEvent(QPaintEvent *event)
     
     // Call the base class paintEvent
     QGraphicsView::paintEvent(event);
+
+    // First paint since the frame arrived: it is now on its way to the screen
+    if (m_latencyFrameKey != 0) {
+        FrameLatencyTracker::instance().stamp(m_latencyFrameKey, FrameLatencyTracker::Painted);
+        m_latencyFrameKey = 0;
+    }
 }
 
 // QVideoWidget compatibility methods
@@ -444,6 +529,7 @@ void VideoPane::resetZoom()
     resetTransform(); // Reset view transform
     updateVideoItemTransform();
     updateScrollBarsAndSceneRect();
+    updateVisibleSourceRect();
     
     // Log zoom reset
     qCDebug(log_ui_video) << "Zoom reset: current zoom=" << m_scaleFactor
@@ -479,6 +565,7 @@ void VideoPane::zoomIn(double factor)
     
     // Center back on the same scene point to maintain focus during zoom
     centerOn(centerPoint);
+    updateVisibleSourceRect();
     
     // Show hint if this is the first zoom in and hint hasn't been shown yet
     if (wasNotZoomed && m_scaleFactor > 1.0 && !m_zoomHintShown) {
@@ -505,6 +592,7 @@ void VideoPane::zoomOut(double factor)
     
     // Center back on the same scene point to maintain focus during zoom
     centerOn(centerPoint);
+    updateVisibleSourceRect();
     
     // Log zoom information
     qCDebug(log_ui_video) << "Zoom out: factor=" << factor << "current zoom=" << m_scaleFactor
@@ -524,6 +612,7 @@ void VideoPane::fitToWindow()
         updateVideoItemTransform();
         updateScrollBarsAndSceneRect();
     }
+    updateVisibleSourceRect();
 }
 
 void VideoPane::actualSize()
@@ -571,6 +660,52 @@ void VideoPane::resizeEvent(QResizeEvent *event)
         // The overlay is a child of the viewport, so it does not need top-level raising.
         emit videoPaneResized(m_overlayWidget->size());
     }
+
+    if (m_latencyOverlayEnabled) {
+        updateLatencyOverlay();  // Keep it pinned to the top-right corner
+    }
+
+    updateVisibleSourceRect();
+}
+
+void VideoPane::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    updateVisibleSourceRect();
+}
+
+QRectF VideoPane::visibleSourceRect() const
+{
+    if (!m_directFFmpegMode || !m_pixmapItem || m_scaleFactor <= 1.0 || !viewport()) {
+        return QRectF();
+    }
+
+    QRectF itemRect = m_pixmapItem->boundingRect();
+    if (itemRect.isEmpty()) {
+        return QRectF();
+    }
+
+    // Viewport -> scene -> pixmap item coordinates, so view zoom, item
+    // transform and device pixel ratio are all accounted for
+    QRectF visible = m_pixmapItem->mapFromScene(mapToScene(viewport()->rect())).boundingRect();
+    visible = visible.intersected(itemRect);
+    if (visible.isEmpty()) {
+        return QRectF();
+    }
+
+    return QRectF((visible.x() - itemRect.x()) / itemRect.width(),
+                  (visible.y() - itemRect.y()) / itemRect.height(),
+                  visible.width() / itemRect.width(),
+                  visible.height() / itemRect.height());
+}
+
+void VideoPane::updateVisibleSourceRect()
+{
+    QRectF rect = visibleSourceRect();
+    if (rect != m_lastVisibleSourceRect) {
+        m_lastVisibleSourceRect = rect;
+        emit visibleSourceRectChanged(rect);
+    }
 }
 
 // Helper methods
@@ -1281,10 +1416,34 @@ void VideoPane::setupForGStreamerOverlay()
 
 // FFmpeg direct video frame support - optimized version receiving QImage
 void VideoPane::updateVideoFrameFromImage(const QImage& image)
+{
+    updateVideoFrameRegion(image, QRegion());
+}
+
+// The OpenGL item uploads and repaints just the dirty tiles. A pixmap item
+// has no partial update, so the raster path still replaces the whole frame;
+// it gains from the backend not sending unchanged frames at all.
+void VideoPane::updateVideoFrameRegion(const QImage& image, const QRegion& dirty)
 {
     if (image.isNull()) {
         return;
     }
+    if (StartupTrace::isEnabled()) {
+        StartupTrace::instance().markFirstFrame("VideoPane");
+    }
+
+    // Backends stamp earlier stages under the same key; a frame replaced
+    // before it was painted is counted as dropped by the tracker
+    FrameLatencyTracker& latency = FrameLatencyTracker::instance();
+    if (latency.isEnabled()) {
+        m_latencyFrameKey = image.cacheKey();
+        latency.stamp(m_latencyFrameKey, FrameLatencyTracker::Received);
+    }
+
+    if (m_glVideoItem) {
+        updateGLVideoFrame(image, dirty);
+        return;
+    }
 
     // Use window/widget DPR to ensure consistent logical/physical pixel mapping
     qreal widgetDpr = 1.0;
@@ -1301,9 +1460,6 @@ void VideoPane::updateVideoFrameFromImage(const QImage& image)
     //                      << " resulting pixmap.logicalSize=" << QSizeF(frame.width()/widgetDpr, frame.height()/widgetDpr);
 
     updateVideoFrame(frame);
-    
-    // CRITICAL FIX: Force immediate viewport update to prevent freezing
-    viewport()->update();
 }
 
 // Update QGraphicsVideoItem from QImage (GUI thread conversion)
@@ -1344,6 +1500,14 @@ void VideoPane::updateVideoFrame(const QPixmap& frame)
     if (!m_directFFmpegMode || frame.isNull()) {
         return;
     }
+    if (StartupTrace::isEnabled()) {
+        StartupTrace::instance().markFirstFrame("VideoPane");
+    }
+
+    if (m_glVideoItem) {
+        updateGLVideoFrame(frame.toImage());
+        return;
+    }
 
     // Ensure widget DPR is used consistently
     qreal widgetDpr = 1.0;
@@ -1410,11 +1574,8 @@ void VideoPane::updateVideoFrame(const QPixmap& frame)
         m_pixmapItem->setPos(0, 0);
         m_scene->setSceneRect(QRectF(0, 0, viewportLogical.width(), viewportLogical.height()));
 
-        // CRITICAL FIX: Force immediate updates to prevent freezing
-        QRectF updateRect = m_pixmapItem->boundingRect();
-        m_pixmapItem->update(updateRect);
-        m_scene->invalidate(updateRect, QGraphicsScene::ForegroundLayer);
-        m_scene->update(updateRect);
+        // Frames arrive paced to the display refresh; one coalesced viewport
+        // update repaints the item within the same refresh.
         viewport()->update();
         
         return;
@@ -1439,15 +1600,104 @@ void VideoPane::updateVideoFrame(const QPixmap& frame)
     updateVideoItemTransform();
     centerVideoItem();
     updateScrollBarsAndSceneRect();
+    updateVisibleSourceRect();  // Frame size changes can move the visible region
     
-    // CRITICAL FIX: Force updates in fallback path to prevent freezing
-    QRectF updateRect = m_pixmapItem->boundingRect();
-    m_pixmapItem->update(updateRect);
-    m_scene->invalidate(updateRect, QGraphicsScene::ForegroundLayer);
-    m_scene->update(updateRect);
     viewport()->update();
 }
 
+// OpenGL viewport: the image goes to the GPU as-is. No QPixmap conversion,
+// no pre-scale to the viewport; the item transform does the fitting.
+void VideoPane::updateGLVideoFrame(const QImage& image, const QRegion& dirty)
+{
+    if (!m_directFFmpegMode || image.isNull()) {
+        return;
+    }
+
+    qreal widgetDpr = 1.0;
+    if (window()) widgetDpr = window()->devicePixelRatioF();
+    else widgetDpr = this->devicePixelRatioF();
+
+    const QSize previousSize = m_glVideoItem->frameSize();
+    m_glVideoItem->setFrame(image, widgetDpr, dirty);
+    m_glVideoItem->setVisible(true);
+    if (m_videoItem) m_videoItem->setVisible(false);
+
+    m_originalVideoSize = QSize(qRound(image.width() / widgetDpr), qRound(image.height() / widgetDpr));
+
+    // Geometry only changes with the frame size
+    if (image.size() != previousSize) {
+        updateVideoItemTransform();
+        updateScrollBarsAndSceneRect();
+        updateVisibleSourceRect();
+        viewport()->update();
+    } else if (dirty.isEmpty()) {
+        viewport()->update();
+    }
+    // else: the item has already scheduled a repaint of the changed tiles
+}
+
+void VideoPane::setPresentationItem(QGraphicsVideoItem* videoItem)
+{
+    m_presentationItem = videoItem;
+    m_presentationQueue->clear();  // A pending frame was meant for the old target
+}
+
+// Present at most one frame per viewport refresh instead of painting every
+// decoded frame. A frame is shown straight away unless the previous one is
+// still waiting for its refresh; frames arriving meanwhile collapse into the
+// queue's slot and the newest is taken on the next refresh. Only the
+// viewport repaints, never the rest of the window.
+void VideoPane::requestPresentation()
+{
+    // A refresh that never came (viewport hidden mid-frame) must not stall
+    // presentation; the queue asks again for a frame left pending this long
+    static constexpr qint64 kLostRefreshMs = 100;
+
+    if (!m_presentationQueue->hasPending()) {
+        return;
+    }
+    if (m_presentationPaced && m_presentationPacedSince.elapsed() < kLostRefreshMs) {
+        return;
+    }
+    m_presentationPaced = false;
+
+    presentPendingFrame();
+    if (!isVisible()) {
+        return;  // No refresh is coming; the state is current anyway
+    }
+
+    m_presentationPaced = true;
+    m_presentationPacedSince.start();
+    if (m_openGLViewport) {
+        viewport()->update();   // One repaint, followed by frameSwapped
+    } else if (m_presentationTimer) {
+        QScreen* paneScreen = screen();
+        const qreal refreshRate = paneScreen ? paneScreen->refreshRate() : 60.0;
+        m_presentationTimer->start(qMax(1, qRound(1000.0 / (refreshRate > 0 ? refreshRate : 60.0))));
+    }
+}
+
+void VideoPane::onPresentationRefresh()
+{
+    m_presentationPaced = false;
+    requestPresentation();
+}
+
+void VideoPane::presentPendingFrame()
+{
+    PresentationQueue::Frame frame;
+    if (!m_presentationQueue->take(&frame)) {
+        return;
+    }
+    FrameTimingRecorder::instance().recordPresent();
+
+    if (m_presentationItem) {
+        updateGraphicsVideoItemFromImage(m_presentationItem, frame.image);
+    } else {
+        updateVideoFrameRegion(frame.image, frame.dirty);
+    }
+}
+
 void VideoPane::enableDirectFFmpegMode(bool enable)
 {
     qCDebug(log_ui_video) << "VideoPane: enableDirectFFmpegMode called with:" << enable << "current mode:" << m_directFFmpegMode;
@@ -1463,8 +1713,16 @@ void VideoPane::enableDirectFFmpegMode(bool enable)
             qCDebug(log_ui_video) << "VideoPane: Hidden Qt video item for FFmpeg mode";
         }
         
-        // Ensure we have a pixmap item ready for frame display
-        if (!m_pixmapItem) {
+        // Ensure we have a pixmap item ready for frame display. On an OpenGL
+        // viewport it is a GLVideoItem, which shows black until the first frame.
+        if (!m_pixmapItem && m_openGLViewport) {
+            m_glVideoItem = new GLVideoItem();
+            m_glVideoItem->setZValue(2); // Above video item
+            m_glVideoItem->setSmoothScaling(m_highQualityRendering);
+            m_scene->addItem(m_glVideoItem);
+            m_pixmapItem = m_glVideoItem;
+            qCDebug(log_ui_video) << "VideoPane: Created OpenGL item for FFmpeg frames";
+        } else if (!m_pixmapItem) {
             QPixmap placeholder(640, 480);
             placeholder.fill(Qt::black);
             m_pixmapItem = m_scene->addPixmap(placeholder);
@@ -1514,6 +1772,13 @@ void VideoPane::enableDirectFFmpegMode(bool enable)
 void VideoPane::clearVideoFrame()
 {
     qWarning() << "VideoPane: Clearing current video frame";
+    emit frameCleared();  // Backends that skip unchanged frames must resend
+
+    if (m_glVideoItem) {
+        m_glVideoItem->clearFrame();
+        qCDebug(log_ui_video) << "VideoPane: Cleared OpenGL item with black frame";
+        return;
+    }
     
     if (m_pixmapItem) {
         // Create a black pixmap of the same size as the current one or default size
@@ -1613,3 +1878,33 @@ void VideoPane::startZoomHintFadeOut()
     fadeAnimation->start(QAbstractAnimation::DeleteWhenStopped);
 }
 
+void VideoPane::setLatencyOverlayEnabled(bool enabled)
+{
+    m_latencyOverlayEnabled = enabled;
+    m_latencyFrameKey = 0;
+    FrameLatencyTracker::instance().setEnabled(enabled);
+
+    if (!m_latencyOverlayLabel || !m_latencyOverlayTimer) {
+        return;
+    }
+    if (enabled) {
+        updateLatencyOverlay();
+        m_latencyOverlayLabel->show();
+        m_latencyOverlayLabel->raise();
+        m_latencyOverlayTimer->start();
+    } else {
+        m_latencyOverlayTimer->stop();
+        m_latencyOverlayLabel->hide();
+    }
+    qCDebug(log_ui_video) << "Latency overlay" << (enabled ? "enabled" : "disabled");
+}
+
+void VideoPane::updateLatencyOverlay()
+{
+    if (!m_latencyOverlayLabel) {
+        return;
+    }
+    m_latencyOverlayLabel->setText(FrameLatencyTracker::instance().summary());
+    m_latencyOverlayLabel->adjustSize();
+    m_latencyOverlayLabel->move(qMax(0, width() - m_latencyOverlayLabel->width() - 10), 10);
+}
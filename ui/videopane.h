@@ -30,9 +30,13 @@
 #include <QtMultimedia>
 #include <QtMultimediaWidgets>
 #include <QLoggingCategory>
+#include <memory>
 
 Q_DECLARE_LOGGING_CATEGORY(log_ui_video)
 
+class GLVideoItem;
+class PresentationQueue;
+
 class VideoPane : public QGraphicsView
 {
     Q_OBJECT
@@ -77,11 +81,18 @@ public:
     // FFmpeg direct video frame support
     void updateVideoFrame(const QPixmap& frame);
     void updateVideoFrameFromImage(const QImage& image);  // Optimized: receives QImage, converts to QPixmap on GUI thread
+    void updateVideoFrameRegion(const QImage& image, const QRegion& dirty);  // Only dirty (image pixels) changed; empty = all
     void updateGraphicsVideoItemFromImage(QGraphicsVideoItem* videoItem, const QImage& image);  // Updates QGraphicsVideoItem from QImage
     void enableDirectFFmpegMode(bool enable = true);
     bool isDirectFFmpegModeEnabled() const { return m_directFFmpegMode; }
     void clearVideoFrame(); // Clear the current video frame display
 
+    // Latest-frame slot drained at the viewport's refresh rate. Backends submit
+    // from any thread; frames go to the item set here, or the pane itself.
+    std::shared_ptr<PresentationQueue> presentationQueue() const { return m_presentationQueue; }
+    void setPresentationItem(QGraphicsVideoItem* videoItem);
+    bool isOpenGLViewportEnabled() const { return m_openGLViewport; }
+
     // Mouse position transformation for InputHandler
     QPointF getTransformedMousePosition(const QPoint& viewportPos);
     void setOriginalVideoSize(const QSize& size) { m_originalVideoSize = size; }
@@ -94,6 +105,10 @@ public:
     // Get current zoom factor
     double getZoomFactor() const { return m_scaleFactor; }
     
+    // Part of the video visible in the viewport, normalized to 0..1;
+    // empty when the whole frame is shown (not zoomed)
+    QRectF visibleSourceRect() const;
+    
     // Set coordinate correction for zoom mode
     void setZoomOffsetCorrection(int x, int y) { m_zoomOffsetCorrectionX = x; m_zoomOffsetCorrectionY = y; }
 
@@ -101,10 +116,16 @@ public:
     void setRenderQuality(bool highQuality);
     bool renderQualityHigh() const { return m_highQualityRendering; }
 
+    // On-screen p50/p95/p99 per latency stage; also turns latency tracking on or off
+    void setLatencyOverlayEnabled(bool enabled);
+    bool isLatencyOverlayEnabled() const { return m_latencyOverlayEnabled; }
+
 signals:
     void mouseMoved(const QPoint& position, const QString& event);
     void videoPaneResized(const QSize& newSize);  // Signal for video pane resize events
     void viewportSizeChanged(const QSize& size);   // Signal for viewport size changes
+    void visibleSourceRectChanged(const QRectF& rect);  // Zoom or scroll changed the visible part
+    void frameCleared();  // The displayed frame was replaced with black
 
 public slots:
     void onCameraDeviceSwitching(const QString& fromDevice, const QString& toDevice);
@@ -120,6 +141,7 @@ protected:
     void resizeEvent(QResizeEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
 
 private:
     int lastX=0;
@@ -158,8 +180,13 @@ private:
     // Direct FFmpeg mode support
     bool m_directFFmpegMode;
     QSize m_lastViewportSize;
+    QRectF m_lastVisibleSourceRect;
     bool m_frameIsViewportSized;
 
+    // OpenGL viewport: FFmpeg frames go to a texture-backed item instead of a QPixmap
+    bool m_openGLViewport;
+    GLVideoItem* m_glVideoItem;
+
     // rendering quality hint flag (true=antialiasing enabled)
     bool m_highQualityRendering;
     
@@ -168,6 +195,19 @@ private:
     bool m_zoomHintShown;
     QTimer* m_zoomHintTimer;
     
+    // Latency overlay, and the received frame still waiting for its first paint
+    QLabel* m_latencyOverlayLabel;
+    QTimer* m_latencyOverlayTimer;
+    bool m_latencyOverlayEnabled;
+    quint64 m_latencyFrameKey;
+
+    // Refresh-paced presentation of backend frames
+    std::shared_ptr<PresentationQueue> m_presentationQueue;
+    QPointer<QGraphicsVideoItem> m_presentationItem;
+    QTimer* m_presentationTimer;           // Raster viewport: one tick per screen refresh
+    bool m_presentationPaced;              // A frame was presented and its refresh is pending
+    QElapsedTimer m_presentationPacedSince;
+    
     MouseEventDTO* calculateRelativePosition(QMouseEvent *event);
     MouseEventDTO* calculateAbsolutePosition(QMouseEvent *event);
     MouseEventDTO* calculateMouseEventDto(QMouseEvent *event);
@@ -178,8 +218,14 @@ private:
     void centerVideoItem();
     void setupScene();
     void updateScrollBarsAndSceneRect();
+    void updateVisibleSourceRect();
+    void updateGLVideoFrame(const QImage& image, const QRegion& dirty = QRegion());
     void showZoomHint();
     void startZoomHintFadeOut();
+    void updateLatencyOverlay();
+    void requestPresentation();
+    void onPresentationRefresh();
+    void presentPendingFrame();
 };
 
 #endif